@@ -277,52 +277,60 @@ AtomicString AtomicString::ToLowerSlow(JSContext* ctx) const {
   return AtomicString(ctx, str);
 }
 
+template <typename CharType>
+inline bool MatchesCharacter(const bool* table, CharType c) {
+  return c < 256 && table[c];
+}
+
 template <typename CharType>
 inline AtomicString RemoveCharactersInternal(JSContext* ctx,
                                              const AtomicString& self,
                                              const CharType* characters,
                                              size_t len,
                                              CharacterMatchFunctionPtr find_match) {
+  // The predicate takes a char, so only Latin-1 characters can match. It is evaluated once per character value
+  // instead of once per character of the string.
+  bool table[256];
+  for (int c = 0; c < 256; c++)
+    table[c] = find_match(static_cast<char>(c));
+
   const CharType* from = characters;
   const CharType* fromend = from + len;
 
   // Assume the common case will not remove any characters
-  while (from != fromend && !find_match(*from))
+  while (from != fromend && !MatchesCharacter(table, *from))
     ++from;
   if (from == fromend)
     return self;
 
-  auto* to = (CharType*)js_malloc(ctx, len);
+  auto* to = (CharType*)js_malloc(ctx, len * sizeof(CharType));
   size_t outc = static_cast<size_t>(from - characters);
 
   if (outc)
     memcpy(to, characters, outc * sizeof(CharType));
 
   while (true) {
-    while (from != fromend && find_match(*from))
+    while (from != fromend && MatchesCharacter(table, *from))
+      ++from;
+    const CharType* run = from;
+    while (from != fromend && !MatchesCharacter(table, *from))
       ++from;
-    while (from != fromend && !find_match(*from))
-      to[outc++] = *from++;
+    memcpy(to + outc, run, (from - run) * sizeof(CharType));
+    outc += from - run;
     if (from == fromend)
       break;
   }
 
   AtomicString str;
-
   if (outc == 0) {
-    return AtomicString::Empty();
-  }
-
-  auto data = (CharType*)js_malloc(ctx, outc);
-  memcpy(data, to, outc);
-  js_free(ctx, to);
-  if (self.Is8Bit()) {
-    str = AtomicString(ctx, reinterpret_cast<const char*>(data), outc);
+    str = AtomicString::Empty();
+  } else if (self.Is8Bit()) {
+    str = AtomicString(ctx, reinterpret_cast<const char*>(to), outc);
   } else {
-    str = AtomicString(ctx, reinterpret_cast<const uint16_t*>(data), outc);
+    str = AtomicString(ctx, reinterpret_cast<const uint16_t*>(to), outc);
   }
 
-  js_free(ctx, data);
+  js_free(ctx, to);
   return str;
 }
 
@@ -6,6 +6,7 @@
 #ifndef BRIDGE_BINDINGS_QJS_ATOMIC_STRING_H_
 #define BRIDGE_BINDINGS_QJS_ATOMIC_STRING_H_
 
+#include <quickjs/libstring.h>
 #include <quickjs/quickjs.h>
 #include <cassert>
 #include <functional>
@@ -116,11 +117,7 @@ bool AtomicString::ContainsOnlyLatin1OrEmpty() const {
   if (Is8Bit())
     return true;
 
-  const uint16_t* characters = Character16();
-  uint16_t ored = 0;
-  for (size_t i = 0; i < length_; ++i)
-    ored |= characters[i];
-  return !(ored & 0xFF00);
+  return lstr_is_latin1_16(Character16(), length_);
 }
 }  // namespace mercury
 
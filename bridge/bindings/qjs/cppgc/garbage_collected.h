@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "bindings/qjs/qjs_engine_patch.h"
+#include "core/script_state.h"
 #include "foundation/casting.h"
 #include "foundation/macros.h"
 #include "local_handle.h"
@@ -39,6 +40,10 @@ class GarbageCollected {
   // Must use MakeGarbageCollected.
   void* operator new(size_t) = delete;
   void* operator new[](size_t) = delete;
+#if ENABLE_CONTEXT_HEAP
+  // MakeGarbageCollected places objects in the heap of the entered context.
+  void operator delete(void* ptr) { mi_free(ptr); }
+#endif
 
   /**
    * This Trace method must be override by objects inheriting from
@@ -59,7 +64,13 @@ class MakeGarbageCollectedTrait {
  public:
   template <typename... Args>
   static T* Allocate(Args&&... args) {
+#if ENABLE_CONTEXT_HEAP
+    mi_heap_t* heap = ScriptState::CurrentHeap();
+    void* memory = mi_heap_malloc_aligned(heap != nullptr ? heap : mi_heap_get_default(), sizeof(T), alignof(T));
+    T* object = ::new (memory) T(std::forward<Args>(args)...);
+#else
     T* object = ::new T(std::forward<Args>(args)...);
+#endif
     object->InitializeQuickJSObject();
     return object;
   }
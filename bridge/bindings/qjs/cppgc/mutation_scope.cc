@@ -10,7 +10,7 @@
 namespace mercury {
 
 MemberMutationScope::MemberMutationScope(ExecutingContext* context)
-    : context_(context), runtime_(context->GetScriptState()->runtime()) {
+    : context_(context), runtime_(context->GetScriptState()->runtime()), heap_scope_(context->GetScriptState()) {
   context->SetMutationScope(*this);
 }
 
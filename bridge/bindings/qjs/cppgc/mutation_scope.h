@@ -8,6 +8,7 @@
 
 #include <quickjs/quickjs.h>
 #include <unordered_map>
+#include "core/script_state.h"
 #include "foundation/macros.h"
 
 namespace mercury {
@@ -17,6 +18,7 @@ class ScriptWrappable;
 
 /**
  * A stack-allocated class that record all members mutations in stack scope.
+ * It also enters the heap of the context, see ContextHeapScope.
  */
 class MemberMutationScope {
   MERCURY_DISALLOW_NEW();
@@ -37,6 +39,7 @@ class MemberMutationScope {
   MemberMutationScope* parent_scope_{nullptr};
   ExecutingContext* context_;
   JSRuntime* runtime_{nullptr};
+  ContextHeapScope heap_scope_;
   std::unordered_map<ScriptWrappable*, int> mutation_records_;
 };
 
@@ -33,6 +33,7 @@ class JSEventListener final : public JSBasedEventListener {
     const auto* other_listener = DynamicTo<JSEventListener>(other);
     return other_listener && *event_listener_ == *other_listener->event_listener_;
   }
+  const void* MatchKey() const override { return JS_VALUE_GET_PTR(event_listener_->ToQuickJSUnsafe()); }
 
   void Trace(GCVisitor* visitor) const override;
 
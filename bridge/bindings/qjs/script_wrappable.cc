@@ -51,10 +51,18 @@ static void HandleJSObjectFinalized(JSRuntime* rt, JSValue val) {
     MemberMutationScope scope{object->GetExecutingContext()};
     delete object;
   } else {
+    object->DetachExecutingContext();
     delete object;
   }
 }
 
+/// The global object is an ordinary object which inherits from the Global wrapper, so every global variable it misses,
+/// including `typeof x === 'undefined'` feature checks, continues the lookup at the wrapper's exotic handlers.
+static bool IsGlobalObjectLookup(ExecutingContext* context, JSValueConst obj, JSValueConst receiver) {
+  return JS_IsObject(receiver) && JS_VALUE_GET_PTR(receiver) != JS_VALUE_GET_PTR(obj) &&
+         JS_VALUE_GET_PTR(receiver) == JS_VALUE_GET_PTR(context->GlobalObject());
+}
+
 /// This callback will be called when JS code access this object using [] or `.` operator.
 /// When exec `obj[1]`, it will call indexed_property_getter_handler_ defined in WrapperTypeInfo.
 /// When exec `obj['hello']`, it will call string_property_getter_handler_ defined in WrapperTypeInfo.
@@ -63,6 +71,17 @@ static JSValue HandleJSPropertyGetterCallback(JSContext* ctx, JSValueConst obj,
   auto* object = static_cast<ScriptWrappable*>(JS_GetOpaque(obj, JSValueGetClassId(obj)));
   auto* wrapper_type_info = object->GetWrapperTypeInfo();
 
+  // Global lookups resolve ordinary prototype properties before the named-property handlers are consulted. The chain
+  // is walked once: a property it lacks reads as undefined and continues at the handlers.
+  bool is_global_lookup = IsGlobalObjectLookup(context, obj, receiver);
+  if (UNLIKELY(is_global_lookup)) {
+    JSValue prototypeObject = context->contextData()->prototypeForType(wrapper_type_info);
+    JSValue result = JS_GetPropertyInternal(ctx, prototypeObject, atom, obj, NULL, 0);
+    if (!JS_IsUndefined(result)) {
+      return result;
+    }
+  }
+
   JSValue getterValue = JS_UNDEFINED;
   if (wrapper_type_info->indexed_property_getter_handler_ != nullptr && JS_AtomIsTaggedInt(atom)) {
     getterValue = wrapper_type_info->indexed_property_getter_handler_(ctx, obj, JS_AtomToUInt32(atom));
@@ -70,7 +89,7 @@ static JSValue HandleJSPropertyGetterCallback(JSContext* ctx, JSValueConst obj,
     getterValue = wrapper_type_info->string_property_getter_handler_(ctx, obj, atom);
   }
 
-  if (!JS_IsUndefined(getterValue)) {
+  if (!JS_IsUndefined(getterValue) || is_global_lookup) {
     return getterValue;
   }
 
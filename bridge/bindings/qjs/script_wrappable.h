@@ -65,6 +65,10 @@ class ScriptWrappable : public GarbageCollected<ScriptWrappable> {
   void KeepAlive();
   void ReleaseAlive();
 
+  // The ExecutingContext can be freed before the GC collects this object, e.g. for the cycles left by a disposed
+  // isolate. The finalizer then detaches the object first, so its destructors see a null context.
+  void DetachExecutingContext() { context_ = nullptr; }
+
  private:
   bool is_alive = false;
   JSValue jsObject_{JS_NULL};
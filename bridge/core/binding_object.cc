@@ -9,8 +9,10 @@
 #include "bindings/qjs/script_promise_resolver.h"
 #include "core/event/event_target.h"
 #include "core/executing_context.h"
+#include "foundation/isolate_command_buffer.h"
 #include "foundation/native_string.h"
 #include "foundation/native_value_converter.h"
+#include "qjs_event_target.h"
 
 namespace mercury {
 
@@ -69,6 +71,11 @@ NativeValue BindingObject::InvokeBindingMethod(const AtomicString& method,
                                                int32_t argc,
                                                const NativeValue* argv,
                                                ExceptionState& exception_state) const {
+  // Dart has to see the writes deferred before this call.
+  if (UNLIKELY(GetExecutingContext()->isolateCommandBuffer()->HasDeferredWrites())) {
+    GetExecutingContext()->FlushIsolateCommand();
+  }
+
   if (binding_object_->invoke_bindings_methods_from_native == nullptr) {
     GetExecutingContext()->FlushIsolateCommand();
     exception_state.ThrowException(GetExecutingContext()->ctx(), ErrorType::InternalError,
@@ -88,6 +95,11 @@ NativeValue BindingObject::InvokeBindingMethod(BindingMethodCallOperations bindi
                                                size_t argc,
                                                const NativeValue* argv,
                                                ExceptionState& exception_state) const {
+  // Dart has to see the writes deferred before this call.
+  if (UNLIKELY(GetExecutingContext()->isolateCommandBuffer()->HasDeferredWrites())) {
+    GetExecutingContext()->FlushIsolateCommand();
+  }
+
   if (binding_object_->invoke_bindings_methods_from_native == nullptr) {
     GetExecutingContext()->FlushIsolateCommand();
     exception_state.ThrowException(GetExecutingContext()->ctx(), ErrorType::InternalError,
@@ -122,18 +134,84 @@ NativeValue BindingObject::SetBindingProperty(const AtomicString& prop,
         "Can not set binding property on BindingObject, dart binding object had been disposed");
     return Native_NewNull();
   }
+  if (GetExecutingContext()->IsBindingWriteCoalescing()) {
+    DeferBindingPropertySet(prop, value);
+    return Native_NewBool(true);
+  }
+
   GetExecutingContext()->FlushIsolateCommand();
   const NativeValue argv[] = {Native_NewString(prop.ToNativeString(GetExecutingContext()->ctx()).release()), value};
   return InvokeBindingMethod(BindingMethodCallOperations::kSetProperty, 2, argv, exception_state);
 }
 
+NativeValue BindingObject::GetBindingProperties(const AtomicString* props,
+                                                size_t count,
+                                                ExceptionState& exception_state) const {
+  if (UNLIKELY(binding_object_->disposed_)) {
+    exception_state.ThrowException(
+        ctx(), ErrorType::InternalError,
+        "Can not get binding properties on BindingObject, dart binding object had been disposed");
+    return Native_NewNull();
+  }
+  std::vector<NativeValue> argv;
+  argv.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    argv.emplace_back(Native_NewString(props[i].ToNativeString(ctx()).release()));
+  }
+  return InvokeBindingMethod(BindingMethodCallOperations::kGetProperties, argv.size(), argv.data(), exception_state);
+}
+
+void BindingObject::DeferBindingPropertySet(const AtomicString& prop, NativeValue value) const {
+  IsolateCommandBuffer* buffer = GetExecutingContext()->isolateCommandBuffer();
+  if (deferred_batch_id_ != buffer->batchId()) {
+    deferred_property_sets_.clear();
+    deferred_batch_id_ = buffer->batchId();
+  }
+
+  auto it = deferred_property_sets_.find(prop);
+  if (it != deferred_property_sets_.end()) {
+    auto* pending_value = reinterpret_cast<NativeValue*>(buffer->data()[it->second].nativePtr2);
+    Native_FreeValue(*pending_value);
+    *pending_value = value;
+    return;
+  }
+
+  int64_t index = buffer->size();
+  // Dart frees the value once it has applied the write.
+  auto* pending_value = static_cast<NativeValue*>(dart_malloc(sizeof(NativeValue)));
+  *pending_value = value;
+  buffer->addCommand(IsolateCommand::kSetProperty, prop.ToNativeString(ctx()), bindingObject(), pending_value);
+  if (buffer->size() > index) {
+    deferred_property_sets_[prop] = index;
+  } else {
+    // The command was dropped because Dart is going away.
+    Native_FreeValue(*pending_value);
+    dart_free(pending_value);
+  }
+}
+
+// Method functions are shared by all instances of a class, so the receiver comes from `this` and must be checked.
+static EventTarget* MethodReceiverFromThis(JSContext* ctx, const ScriptValue& this_val) {
+  ExecutingContext* context = ExecutingContext::From(ctx);
+  if (UNLIKELY(!QJSEventTarget::HasInstance(context, this_val.QJSValue()))) {
+    ExceptionState exception_state;
+    exception_state.ThrowException(ctx, ErrorType::TypeError, "Illegal invocation");
+    context->HandleException(exception_state);
+    return nullptr;
+  }
+  return toScriptWrappable<EventTarget>(this_val.QJSValue());
+}
+
 ScriptValue BindingObject::AnonymousFunctionCallback(JSContext* ctx,
                                                      const ScriptValue& this_val,
                                                      uint32_t argc,
                                                      const ScriptValue* argv,
                                                      void* private_data) {
   auto* data = reinterpret_cast<AnonymousFunctionData*>(private_data);
-  auto* event_target = toScriptWrappable<EventTarget>(this_val.QJSValue());
+  auto* event_target = MethodReceiverFromThis(ctx, this_val);
+  if (event_target == nullptr) {
+    return ScriptValue::Empty(ctx);
+  }
 
   std::vector<NativeValue> arguments;
   arguments.reserve(argc + 1);
@@ -164,6 +242,8 @@ void BindingObject::HandleAnonymousAsyncCalledFromDart(void* ptr,
                                                        NativeValue* native_value,
                                                        int32_t contextId,
                                                        const char* errmsg) {
+  if (!isContextValid(contextId))
+    return;
   auto* promise_context = static_cast<BindingObjectPromiseContext*>(ptr);
   if (!promise_context->context->IsContextValid())
     return;
@@ -194,7 +274,10 @@ ScriptValue BindingObject::AnonymousAsyncFunctionCallback(JSContext* ctx,
                                                           const ScriptValue* argv,
                                                           void* private_data) {
   auto* data = reinterpret_cast<AnonymousFunctionData*>(private_data);
-  auto* event_target = toScriptWrappable<EventTarget>(this_val.QJSValue());
+  auto* event_target = MethodReceiverFromThis(ctx, this_val);
+  if (event_target == nullptr) {
+    return ScriptValue::Empty(ctx);
+  }
 
   auto promise_resolver = ScriptPromiseResolver::Create(event_target->GetExecutingContext());
 
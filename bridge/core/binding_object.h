@@ -9,6 +9,7 @@
 #include <include/dart_api_dl.h>
 #include <cinttypes>
 #include <set>
+#include <unordered_map>
 #include "bindings/qjs/cppgc/member.h"
 #include "bindings/qjs/atomic_string.h"
 #include "bindings/qjs/script_wrappable.h"
@@ -61,6 +62,7 @@ enum BindingMethodCallOperations {
   kGetAllPropertyNames,
   kAnonymousFunctionCall,
   kAsyncAnonymousFunction,
+  kGetProperties,
 };
 
 enum CreateBindingObjectType { kCreateDOMMatrix = 0 };
@@ -109,6 +111,9 @@ class BindingObject : public ScriptWrappable {
                                   ExceptionState& exception_state) const;
   NativeValue GetBindingProperty(const AtomicString& prop, ExceptionState& exception_state) const;
   NativeValue SetBindingProperty(const AtomicString& prop, NativeValue value, ExceptionState& exception_state) const;
+  // Read several properties with a single call into Dart. Returns a list of the values in the order of |props|.
+  // Writes need no batch counterpart: with write coalescing they reach Dart together at the next flush.
+  NativeValue GetBindingProperties(const AtomicString* props, size_t count, ExceptionState& exception_state) const;
   NativeValue GetAllBindingPropertyNames(ExceptionState& exception_state) const;
 
   FORCE_INLINE NativeBindingObject* bindingObject() const { return binding_object_; }
@@ -139,8 +144,14 @@ class BindingObject : public ScriptWrappable {
   explicit BindingObject(JSContext* ctx, NativeBindingObject* native_binding_object);
 
  private:
+  void DeferBindingPropertySet(const AtomicString& prop, NativeValue value) const;
+
   NativeBindingObject* binding_object_ = nullptr;
   std::set<BindingObjectPromiseContext*> pending_promise_contexts_;
+  // Command buffer indices of the property writes deferred in the current batch, so a later write of the same property
+  // replaces the pending value instead of adding another command.
+  mutable std::unordered_map<AtomicString, int64_t, AtomicString::KeyHasher> deferred_property_sets_;
+  mutable int64_t deferred_batch_id_{-1};
 };
 
 }  // namespace mercury
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "binding_object.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/dart_methods.h"
+#include "core/module/global.h"
+#include "foundation/isolate_command_buffer.h"
+#include "foundation/native_value_converter.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+namespace mercury {
+namespace {
+
+// Stands in for Dart: keeps the properties of the binding object, applies the writes deferred into the isolate
+// commands when they are flushed, and counts the calls crossing the FFI boundary.
+struct FakeDart {
+  ExecutingContext* context{nullptr};
+  FlushIsolateCommand original_flush{nullptr};
+  InvokeBindingsMethodsFromNative original_invoke{nullptr};
+  std::unordered_map<std::string, int64_t> properties;
+  int64_t calls{0};
+  int64_t flushes{0};
+  int64_t applied_writes{0};
+};
+
+FakeDart* fake_dart = nullptr;
+
+std::string KeyOf(NativeValue& value) {
+  return NativeValueConverter<NativeTypeString>::FromNativeValue(fake_dart->context->ctx(), value)
+      .ToStdString(fake_dart->context->ctx());
+}
+
+void FlushIsolateCommandToFakeDart(int32_t context_id) {
+  auto* buffer = fake_dart->context->isolateCommandBuffer();
+  buffer->removeCancelledCommands();
+  for (int64_t i = 0; i < buffer->size(); i++) {
+    const IsolateCommandItem& item = buffer->data()[i];
+    auto type = static_cast<IsolateCommand>(item.type);
+    if (type == IsolateCommand::kSetProperty) {
+      auto* chars = reinterpret_cast<const uint16_t*>(item.string_01);
+      auto* value = reinterpret_cast<NativeValue*>(item.nativePtr2);
+      fake_dart->properties[std::string(chars, chars + item.args_01_length)] = value->u.int64;
+      fake_dart->applied_writes++;
+      dart_free(value);
+    }
+    if (type == IsolateCommand::kAddEvent)
+      dart_free(reinterpret_cast<void*>(item.nativePtr2));
+    if (type == IsolateCommand::kDisposeBindingObject)
+      dart_free(reinterpret_cast<void*>(item.nativePtr));
+    if (item.string_01 != 0)
+      dart_free(reinterpret_cast<void*>(item.string_01));
+  }
+  buffer->clear();
+  fake_dart->flushes++;
+}
+
+void InvokeFakeDart(int32_t context_id,
+                    const NativeBindingObject* binding_object,
+                    NativeValue* return_value,
+                    NativeValue* method,
+                    int32_t argc,
+                    const NativeValue* argv) {
+  fake_dart->calls++;
+  auto operation = static_cast<BindingMethodCallOperations>(method->u.int64);
+  std::vector<NativeValue> args(argv, argv + argc);
+  switch (operation) {
+    case BindingMethodCallOperations::kGetProperty:
+      *return_value = Native_NewInt64(fake_dart->properties[KeyOf(args[0])]);
+      break;
+    case BindingMethodCallOperations::kSetProperty:
+      fake_dart->properties[KeyOf(args[0])] = args[1].u.int64;
+      *return_value = Native_NewBool(true);
+      break;
+    case BindingMethodCallOperations::kGetProperties: {
+      auto* values = new NativeValue[argc];
+      for (int32_t i = 0; i < argc; i++) {
+        values[i] = Native_NewInt64(fake_dart->properties[KeyOf(args[i])]);
+      }
+      *return_value = Native_NewList(argc, values);
+      break;
+    }
+    default:
+      *return_value = Native_NewNull();
+      break;
+  }
+}
+
+// Binds the global object of |context| to a fresh FakeDart, dropping the commands queued so far.
+BindingObject* BindToFakeDart(ExecutingContext* context, FakeDart* dart) {
+  fake_dart = dart;
+  dart->context = context;
+  dart->original_flush = context->dartMethodPtr()->flushIsolateCommand;
+  context->dartMethodPtr()->flushIsolateCommand = FlushIsolateCommandToFakeDart;
+  FlushIsolateCommandToFakeDart(context->contextId());
+  dart->flushes = 0;
+
+  BindingObject* object = context->global();
+  dart->original_invoke = object->bindingObject()->invoke_bindings_methods_from_native;
+  object->bindingObject()->invoke_bindings_methods_from_native = InvokeFakeDart;
+  return object;
+}
+
+void UnbindFakeDart(ExecutingContext* context, BindingObject* object) {
+  FlushIsolateCommandToFakeDart(context->contextId());
+  context->SetBindingWriteCoalescing(false);
+  object->bindingObject()->invoke_bindings_methods_from_native = fake_dart->original_invoke;
+  context->dartMethodPtr()->flushIsolateCommand = fake_dart->original_flush;
+  fake_dart = nullptr;
+}
+
+int64_t Int64Of(const NativeValue& value) {
+  return NativeValueConverter<NativeTypeInt64>::FromNativeValue(value);
+}
+
+// Reads the values of a list returned by the fake Dart and releases it.
+std::vector<int64_t> Int64ListOf(const NativeValue& list) {
+  EXPECT_EQ(list.tag, NativeTag::TAG_LIST);
+  auto* values = static_cast<NativeValue*>(list.u.ptr);
+  std::vector<int64_t> result;
+  for (uint32_t i = 0; i < list.uint32; i++) {
+    result.emplace_back(Int64Of(values[i]));
+  }
+  delete[] values;
+  return result;
+}
+
+}  // namespace
+}  // namespace mercury
+
+TEST(BindingObject, ReadFlushesDeferredWritesFirst) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeDart dart;
+  BindingObject* object = BindToFakeDart(context, &dart);
+  context->SetBindingWriteCoalescing(true);
+
+  ExceptionState exception_state;
+  AtomicString width(context->ctx(), "width");
+  object->SetBindingProperty(width, Native_NewInt64(10), exception_state);
+  EXPECT_EQ(dart.calls, 0);
+  EXPECT_EQ(dart.properties.count("width"), 0);
+  EXPECT_TRUE(context->isolateCommandBuffer()->HasDeferredWrites());
+
+  EXPECT_EQ(Int64Of(object->GetBindingProperty(width, exception_state)), 10);
+  EXPECT_EQ(dart.flushes, 1);
+  EXPECT_EQ(dart.calls, 1);
+  EXPECT_FALSE(context->isolateCommandBuffer()->HasDeferredWrites());
+  EXPECT_FALSE(exception_state.HasException());
+
+  UnbindFakeDart(context, object);
+}
+
+TEST(BindingObject, LastDeferredWriteWins) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeDart dart;
+  BindingObject* object = BindToFakeDart(context, &dart);
+  context->SetBindingWriteCoalescing(true);
+
+  ExceptionState exception_state;
+  AtomicString width(context->ctx(), "width");
+  AtomicString height(context->ctx(), "height");
+  for (int64_t i = 1; i <= 3; i++) {
+    object->SetBindingProperty(width, Native_NewInt64(i), exception_state);
+  }
+  object->SetBindingProperty(height, Native_NewInt64(7), exception_state);
+  EXPECT_EQ(context->isolateCommandBuffer()->size(), 2);
+
+  context->FlushIsolateCommand();
+  EXPECT_EQ(dart.applied_writes, 2);
+  EXPECT_EQ(dart.properties["width"], 3);
+  EXPECT_EQ(dart.properties["height"], 7);
+
+  // A write after the flush belongs to the next batch and is not merged into a command Dart already consumed.
+  object->SetBindingProperty(width, Native_NewInt64(4), exception_state);
+  EXPECT_EQ(Int64Of(object->GetBindingProperty(width, exception_state)), 4);
+  EXPECT_EQ(dart.applied_writes, 3);
+
+  UnbindFakeDart(context, object);
+}
+
+TEST(BindingObject, GetBindingPropertiesReadsInOneCall) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeDart dart;
+  BindingObject* object = BindToFakeDart(context, &dart);
+  dart.properties = {{"a", 1}, {"b", 2}, {"c", 3}};
+
+  ExceptionState exception_state;
+  std::vector<AtomicString> keys = {AtomicString(context->ctx(), "c"), AtomicString(context->ctx(), "a"),
+                                    AtomicString(context->ctx(), "b")};
+  auto values = Int64ListOf(object->GetBindingProperties(keys.data(), keys.size(), exception_state));
+  std::vector<int64_t> expected = {3, 1, 2};
+  EXPECT_EQ(values, expected);
+  EXPECT_EQ(dart.calls, 1);
+
+  UnbindFakeDart(context, object);
+}
+
+// An object with 20 properties is written and read back 1000 times, one property at a time through synchronous calls,
+// then with coalesced writes and a single batched read. Counts the calls into Dart.
+TEST(BindingObject, TwentyPropertiesBenchmark) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeDart dart;
+  BindingObject* object = BindToFakeDart(context, &dart);
+
+  const int kProperties = 20;
+  const int kRounds = 1000;
+  std::vector<AtomicString> keys;
+  for (int i = 0; i < kProperties; i++) {
+    keys.emplace_back(context->ctx(), "property" + std::to_string(i));
+  }
+  ExceptionState exception_state;
+
+  auto start = std::chrono::steady_clock::now();
+  int64_t sum = 0;
+  for (int round = 0; round < kRounds; round++) {
+    for (int i = 0; i < kProperties; i++) {
+      object->SetBindingProperty(keys[i], Native_NewInt64(round + i), exception_state);
+    }
+    for (int i = 0; i < kProperties; i++) {
+      sum += Int64Of(object->GetBindingProperty(keys[i], exception_state));
+    }
+  }
+  auto one_by_one_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  int64_t one_by_one_crossings = dart.calls + dart.flushes;
+
+  dart.calls = 0;
+  dart.flushes = 0;
+  context->SetBindingWriteCoalescing(true);
+  start = std::chrono::steady_clock::now();
+  int64_t batched_sum = 0;
+  for (int round = 0; round < kRounds; round++) {
+    for (int i = 0; i < kProperties; i++) {
+      object->SetBindingProperty(keys[i], Native_NewInt64(round + i), exception_state);
+    }
+    for (int64_t value : Int64ListOf(object->GetBindingProperties(keys.data(), keys.size(), exception_state))) {
+      batched_sum += value;
+    }
+  }
+  auto batched_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  int64_t batched_crossings = dart.calls + dart.flushes;
+
+  EXPECT_FALSE(exception_state.HasException());
+  EXPECT_EQ(sum, batched_sum);
+  EXPECT_EQ(batched_crossings, int64_t(kRounds) * 2);
+  std::cout << kProperties << " properties x " << kRounds << " rounds: one by one " << one_by_one_crossings
+            << " crossings " << one_by_one_time << "us, batched " << batched_crossings << " crossings "
+            << batched_time << "us" << std::endl;
+
+  UnbindFakeDart(context, object);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "binding_property_cache.h"
+#include "bindings/qjs/cppgc/gc_visitor.h"
+
+namespace mercury {
+
+BindingPropertyCache::~BindingPropertyCache() {
+  InvalidateAll();
+}
+
+JSValue BindingPropertyCache::Get(const AtomicString& key) const {
+  auto it = values_.find(key);
+  return it != values_.end() ? it->second : JS_UNINITIALIZED;
+}
+
+void BindingPropertyCache::Set(const AtomicString& key, JSValue value) {
+  auto it = values_.find(key);
+  if (it != values_.end()) {
+    JS_FreeValue(ctx_, it->second);
+    it->second = JS_DupValue(ctx_, value);
+    return;
+  }
+  values_.emplace(key, JS_DupValue(ctx_, value));
+}
+
+void BindingPropertyCache::Invalidate(const AtomicString& key) {
+  auto it = values_.find(key);
+  if (it == values_.end())
+    return;
+  JS_FreeValue(ctx_, it->second);
+  values_.erase(it);
+}
+
+void BindingPropertyCache::InvalidateAll() {
+  for (auto& entry : values_) {
+    JS_FreeValue(ctx_, entry.second);
+  }
+  values_.clear();
+}
+
+void BindingPropertyCache::Trace(GCVisitor* visitor) const {
+  for (auto& entry : values_) {
+    visitor->TraceValue(entry.second);
+  }
+}
+
+}  // namespace mercury
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef MERCURY_CORE_BINDING_PROPERTY_CACHE_H_
+#define MERCURY_CORE_BINDING_PROPERTY_CACHE_H_
+
+#include <quickjs/quickjs.h>
+#include <unordered_map>
+#include "bindings/qjs/atomic_string.h"
+#include "foundation/macros.h"
+
+namespace mercury {
+
+class GCVisitor;
+
+// Values of the Dart properties a binding object read last, for the properties Dart marked cacheable in the shape of
+// its class. A cached value is served until Dart invalidates it.
+class BindingPropertyCache final {
+ public:
+  explicit BindingPropertyCache(JSContext* ctx) : ctx_(ctx) {}
+  ~BindingPropertyCache();
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(BindingPropertyCache);
+
+  // Returns the cached value without a reference count of its own, or JS_UNINITIALIZED when nothing is cached.
+  JSValue Get(const AtomicString& key) const;
+  void Set(const AtomicString& key, JSValue value);
+
+  void Invalidate(const AtomicString& key);
+  void InvalidateAll();
+
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+
+  void Trace(GCVisitor* visitor) const;
+
+ private:
+  JSContext* ctx_;
+  std::unordered_map<AtomicString, JSValue, AtomicString::KeyHasher> values_;
+};
+
+}  // namespace mercury
+
+#endif  // MERCURY_CORE_BINDING_PROPERTY_CACHE_H_
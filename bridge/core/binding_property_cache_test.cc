@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "binding_property_cache.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "binding_call_methods.h"
+#include "core/dart_methods.h"
+#include "core/event/event_target.h"
+#include "foundation/isolate_command_buffer.h"
+#include "foundation/native_value_converter.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+static JSValue NewString(JSContext* ctx, const std::string& value) {
+  return JS_NewStringLen(ctx, value.c_str(), value.size());
+}
+
+static std::string ToString(JSContext* ctx, JSValue value) {
+  const char* chars = JS_ToCString(ctx, value);
+  std::string result = chars;
+  JS_FreeCString(ctx, chars);
+  return result;
+}
+
+TEST(BindingPropertyCache, ServesCachedValuesUntilInvalidated) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    BindingPropertyCache cache(ctx);
+    AtomicString value_key(ctx, "value");
+    AtomicString checked_key(ctx, "checked");
+    EXPECT_TRUE(JS_IsUninitialized(cache.Get(value_key)));
+
+    JSValue text = NewString(ctx, "hello");
+    cache.Set(value_key, text);
+    JS_FreeValue(ctx, text);
+    cache.Set(checked_key, JS_TRUE);
+    EXPECT_EQ(ToString(ctx, cache.Get(value_key)), "hello");
+    EXPECT_TRUE(JS_VALUE_GET_BOOL(cache.Get(checked_key)));
+
+    // Invalidating one key leaves the others cached.
+    cache.Invalidate(value_key);
+    EXPECT_TRUE(JS_IsUninitialized(cache.Get(value_key)));
+    EXPECT_FALSE(JS_IsUninitialized(cache.Get(checked_key)));
+    cache.Invalidate(value_key);
+
+    // Invalidating every key empties the cache.
+    cache.InvalidateAll();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_TRUE(JS_IsUninitialized(cache.Get(checked_key)));
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(BindingPropertyCache, ReplacingValueReleasesOldOne) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    BindingPropertyCache cache(ctx);
+    AtomicString key(ctx, "value");
+    for (int i = 0; i < 100; i++) {
+      JSValue text = NewString(ctx, "value" + std::to_string(i));
+      cache.Set(key, text);
+      JS_FreeValue(ctx, text);
+    }
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(ToString(ctx, cache.Get(key)), "value99");
+
+    JSValue object = JS_NewObject(ctx);
+    cache.Set(AtomicString(ctx, "style"), object);
+    JS_FreeValue(ctx, object);
+  }
+  // JS_FreeRuntime asserts when the cache leaked a reference to any of the values.
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+namespace mercury {
+namespace {
+
+// Stands in for the Dart widgets: keeps their properties, applies the writes deferred into the isolate commands when
+// they are flushed, and counts the calls crossing the FFI boundary. Writing "value" makes Dart recompute "length" and
+// invalidate its cached value, like a text input does.
+struct FakeWidgets {
+  ExecutingContext* context{nullptr};
+  FlushIsolateCommand original_flush{nullptr};
+  std::unordered_map<const NativeBindingObject*, EventTarget*> targets;
+  std::unordered_map<const NativeBindingObject*, std::unordered_map<std::string, int64_t>> properties;
+  std::vector<std::string> last_read;
+  int64_t calls{0};
+  int64_t applied_writes{0};
+};
+
+FakeWidgets* fake_widgets = nullptr;
+
+std::string KeyOf(NativeValue& value) {
+  return NativeValueConverter<NativeTypeString>::FromNativeValue(fake_widgets->context->ctx(), value)
+      .ToStdString(fake_widgets->context->ctx());
+}
+
+int64_t Int64Of(const NativeValue& value) {
+  return value.tag == NativeTag::TAG_FLOAT64 ? static_cast<int64_t>(value.u.float64) : value.u.int64;
+}
+
+// Dart reports that the given properties of |target| changed, or all of them when |keys| is empty.
+void InvalidateFromDart(EventTarget* target, const std::vector<std::string>& keys) {
+  auto* list = new NativeValue[keys.size()];
+  for (size_t i = 0; i < keys.size(); i++) {
+    list[i] = NativeValueConverter<NativeTypeString>::ToNativeValue(keys[i]);
+  }
+  NativeValue argv[] = {Native_NewList(keys.size(), list)};
+  target->HandleCallFromDartSide(binding_call_methods::kinvalidatePropertyCache, keys.empty() ? 0 : 1, argv, nullptr);
+  delete[] list;
+}
+
+void ApplyWrite(const NativeBindingObject* binding_object, const std::string& key, int64_t value) {
+  auto& properties = fake_widgets->properties[binding_object];
+  properties[key] = value;
+  fake_widgets->applied_writes++;
+  if (key == "value") {
+    properties["length"] = value * 10;
+    InvalidateFromDart(fake_widgets->targets[binding_object], {"length"});
+  }
+}
+
+void FlushIsolateCommandToFakeWidgets(int32_t context_id) {
+  auto* buffer = fake_widgets->context->isolateCommandBuffer();
+  buffer->removeCancelledCommands();
+  for (int64_t i = 0; i < buffer->size(); i++) {
+    const IsolateCommandItem& item = buffer->data()[i];
+    auto type = static_cast<IsolateCommand>(item.type);
+    if (type == IsolateCommand::kSetProperty) {
+      auto* chars = reinterpret_cast<const uint16_t*>(item.string_01);
+      auto* value = reinterpret_cast<NativeValue*>(item.nativePtr2);
+      ApplyWrite(reinterpret_cast<const NativeBindingObject*>(item.nativePtr),
+                 std::string(chars, chars + item.args_01_length), Int64Of(*value));
+      dart_free(value);
+    }
+    if (type == IsolateCommand::kAddEvent)
+      dart_free(reinterpret_cast<void*>(item.nativePtr2));
+    if (type == IsolateCommand::kDisposeBindingObject)
+      dart_free(reinterpret_cast<void*>(item.nativePtr));
+    if (item.string_01 != 0)
+      dart_free(reinterpret_cast<void*>(item.string_01));
+  }
+  buffer->clear();
+}
+
+void InvokeFakeWidgets(int32_t context_id,
+                       const NativeBindingObject* binding_object,
+                       NativeValue* return_value,
+                       NativeValue* method,
+                       int32_t argc,
+                       const NativeValue* argv) {
+  fake_widgets->calls++;
+  auto& properties = fake_widgets->properties[binding_object];
+  auto operation = static_cast<BindingMethodCallOperations>(method->u.int64);
+  std::vector<NativeValue> args(argv, argv + argc);
+  switch (operation) {
+    case BindingMethodCallOperations::kGetProperty:
+      fake_widgets->last_read = {KeyOf(args[0])};
+      *return_value = Native_NewInt64(properties[fake_widgets->last_read[0]]);
+      break;
+    case BindingMethodCallOperations::kSetProperty:
+      ApplyWrite(binding_object, KeyOf(args[0]), Int64Of(args[1]));
+      *return_value = Native_NewBool(true);
+      break;
+    case BindingMethodCallOperations::kGetProperties: {
+      fake_widgets->last_read.clear();
+      auto* values = new NativeValue[argc];
+      for (int32_t i = 0; i < argc; i++) {
+        fake_widgets->last_read.emplace_back(KeyOf(args[i]));
+        values[i] = Native_NewInt64(properties[fake_widgets->last_read.back()]);
+      }
+      *return_value = Native_NewList(argc, values);
+      break;
+    }
+    default:
+      *return_value = Native_NewNull();
+      break;
+  }
+}
+
+// Routes the isolate commands of |context| to |widgets|, dropping the commands queued so far.
+void BindFakeWidgets(ExecutingContext* context, FakeWidgets* widgets) {
+  fake_widgets = widgets;
+  widgets->context = context;
+  widgets->original_flush = context->dartMethodPtr()->flushIsolateCommand;
+  context->dartMethodPtr()->flushIsolateCommand = FlushIsolateCommandToFakeWidgets;
+  FlushIsolateCommandToFakeWidgets(context->contextId());
+}
+
+void UnbindFakeWidgets(ExecutingContext* context) {
+  FlushIsolateCommandToFakeWidgets(context->contextId());
+  context->SetBindingWriteCoalescing(false);
+  for (auto& [binding_object, target] : fake_widgets->targets) {
+    target->ReleaseAlive();
+  }
+  context->dartMethodPtr()->flushIsolateCommand = fake_widgets->original_flush;
+  fake_widgets = nullptr;
+}
+
+// Registers the shape Dart would sync for |class_name|, with every property cacheable or none.
+void RegisterWidgetShape(const std::string& class_name, const std::vector<std::string>& properties, bool cacheable) {
+  JSContext* ctx = fake_widgets->context->ctx();
+  std::vector<AtomicString> keys;
+  for (auto& property : properties) {
+    keys.emplace_back(ctx, property);
+  }
+  fake_widgets->context->dartIsolateContext()->EnsureData()->SetWidgetElementShape(
+      AtomicString(ctx, class_name),
+      std::make_shared<WidgetElementShape>(keys, std::vector<AtomicString>{}, std::vector<AtomicString>{},
+                                           cacheable ? keys : std::vector<AtomicString>{}));
+}
+
+EventTarget* NewWidget(const std::string& class_name, const std::unordered_map<std::string, int64_t>& properties) {
+  ExceptionState exception_state;
+  EventTarget* target =
+      EventTarget::Create(fake_widgets->context, AtomicString(fake_widgets->context->ctx(), class_name), exception_state);
+  target->KeepAlive();
+  target->bindingObject()->invoke_bindings_methods_from_native = InvokeFakeWidgets;
+  fake_widgets->targets[target->bindingObject()] = target;
+  fake_widgets->properties[target->bindingObject()] = properties;
+  return target;
+}
+
+int64_t Read(EventTarget* target, const std::string& key) {
+  JSContext* ctx = fake_widgets->context->ctx();
+  ExceptionState exception_state;
+  ScriptValue value = target->item(AtomicString(ctx, key), exception_state);
+  EXPECT_FALSE(exception_state.HasException());
+  int64_t result = 0;
+  JS_ToInt64(ctx, &result, value.QJSValue());
+  return result;
+}
+
+void Write(EventTarget* target, const std::string& key, int32_t value) {
+  JSContext* ctx = fake_widgets->context->ctx();
+  ExceptionState exception_state;
+  target->SetItem(AtomicString(ctx, key), ScriptValue(ctx, JS_NewInt32(ctx, value)), exception_state);
+  EXPECT_FALSE(exception_state.HasException());
+}
+
+}  // namespace
+}  // namespace mercury
+
+TEST(BindingPropertyCache, DartInvalidatesSingleKeys) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeWidgets widgets;
+  BindFakeWidgets(context, &widgets);
+  RegisterWidgetShape("InvalidatedWidget", {"value", "length", "checked"}, true);
+  EventTarget* widget = NewWidget("InvalidatedWidget", {{"value", 1}, {"length", 10}, {"checked", 0}});
+
+  // The first miss reads every cacheable property in one call.
+  EXPECT_EQ(Read(widget, "value"), 1);
+  EXPECT_EQ(Read(widget, "length"), 10);
+  EXPECT_EQ(Read(widget, "checked"), 0);
+  EXPECT_EQ(widgets.calls, 1);
+  EXPECT_EQ(widgets.last_read, std::vector<std::string>({"value", "length", "checked"}));
+
+  // Dart changes one property and invalidates it. Only that key is read again.
+  widgets.properties[widget->bindingObject()]["checked"] = 1;
+  InvalidateFromDart(widget, {"checked"});
+  EXPECT_EQ(Read(widget, "value"), 1);
+  EXPECT_EQ(widgets.calls, 1);
+  EXPECT_EQ(Read(widget, "checked"), 1);
+  EXPECT_EQ(widgets.calls, 2);
+  EXPECT_EQ(widgets.last_read, std::vector<std::string>({"checked"}));
+  EXPECT_EQ(Read(widget, "length"), 10);
+  EXPECT_EQ(widgets.calls, 2);
+
+  // Without keys, every cached value of the widget is stale.
+  widgets.properties[widget->bindingObject()]["value"] = 2;
+  InvalidateFromDart(widget, {});
+  EXPECT_EQ(Read(widget, "length"), 10);
+  EXPECT_EQ(widgets.last_read, std::vector<std::string>({"length", "value", "checked"}));
+  EXPECT_EQ(Read(widget, "value"), 2);
+  EXPECT_EQ(widgets.calls, 3);
+
+  UnbindFakeWidgets(context);
+}
+
+TEST(BindingPropertyCache, DeferredWritesReachDartBeforeCachedReads) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeWidgets widgets;
+  BindFakeWidgets(context, &widgets);
+  RegisterWidgetShape("CoalescedWidget", {"value", "length"}, true);
+  EventTarget* widget = NewWidget("CoalescedWidget", {{"value", 1}, {"length", 10}});
+  context->SetBindingWriteCoalescing(true);
+
+  EXPECT_EQ(Read(widget, "length"), 10);
+  EXPECT_EQ(widgets.calls, 1);
+
+  // The write waits in the isolate commands. Reading "length" flushes it first, and Dart invalidates "length" while
+  // applying it, so the stale cached value is not served.
+  Write(widget, "value", 5);
+  EXPECT_EQ(widgets.calls, 1);
+  EXPECT_TRUE(context->isolateCommandBuffer()->HasDeferredWrites());
+  EXPECT_EQ(Read(widget, "length"), 50);
+  EXPECT_FALSE(context->isolateCommandBuffer()->HasDeferredWrites());
+  EXPECT_EQ(widgets.applied_writes, 1);
+
+  // The write dropped the cached "value", so the same call read it back.
+  EXPECT_EQ(widgets.last_read, std::vector<std::string>({"length", "value"}));
+  EXPECT_EQ(Read(widget, "value"), 5);
+  EXPECT_EQ(widgets.calls, 2);
+
+  UnbindFakeWidgets(context);
+}
+
+TEST(BindingPropertyCache, MissReadsBoundedNumberOfProperties) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeWidgets widgets;
+  BindFakeWidgets(context, &widgets);
+  std::vector<std::string> keys;
+  std::unordered_map<std::string, int64_t> properties;
+  for (int i = 0; i < 20; i++) {
+    keys.emplace_back("property" + std::to_string(i));
+    properties[keys.back()] = i;
+  }
+  RegisterWidgetShape("LargeWidget", keys, true);
+  EventTarget* widget = NewWidget("LargeWidget", properties);
+
+  EXPECT_EQ(Read(widget, "property0"), 0);
+  EXPECT_EQ(widgets.last_read.size(), EventTarget::kMaximumCacheablePropertiesPerRead);
+  EXPECT_EQ(Read(widget, "property19"), 19);
+  EXPECT_EQ(widgets.last_read.size(), EventTarget::kMaximumCacheablePropertiesPerRead);
+  EXPECT_EQ(widgets.last_read[0], "property19");
+
+  // property0-7 and property8-14 came with the two reads above, the rest takes one more call.
+  for (int i = 0; i < 20; i++) {
+    EXPECT_EQ(Read(widget, keys[i]), i);
+  }
+  EXPECT_EQ(widgets.calls, 3);
+
+  UnbindFakeWidgets(context);
+}
+
+// A read-mostly access pattern: 100 widgets read 4 properties 100 times each, and Dart changes the value of every
+// widget every 10 rounds. The same reads run against plain and cacheable properties, counting the calls into Dart.
+TEST(BindingPropertyCache, ReadMostlyBenchmark) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* context = env->page()->GetExecutingContext();
+  FakeWidgets widgets;
+  BindFakeWidgets(context, &widgets);
+
+  const int kWidgets = 100;
+  const int kRounds = 100;
+  std::vector<std::string> keys = {"value", "placeholder", "disabled", "name"};
+  RegisterWidgetShape("PlainBenchmarkWidget", keys, false);
+  RegisterWidgetShape("CachedBenchmarkWidget", keys, true);
+
+  auto run = [&](const std::string& class_name, int64_t& sum) {
+    std::vector<EventTarget*> targets;
+    for (int i = 0; i < kWidgets; i++) {
+      targets.emplace_back(NewWidget(class_name, {{"value", 0}, {"placeholder", 1}, {"disabled", 0}, {"name", i}}));
+    }
+    widgets.calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < kRounds; round++) {
+      for (EventTarget* target : targets) {
+        if (round > 0 && round % 10 == 0) {
+          widgets.properties[target->bindingObject()]["value"] = round;
+          InvalidateFromDart(target, {"value"});
+        }
+        for (auto& key : keys) {
+          sum += Read(target, key);
+        }
+      }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  int64_t plain_sum = 0;
+  auto plain_time = run("PlainBenchmarkWidget", plain_sum);
+  int64_t plain_calls = widgets.calls;
+  int64_t cached_sum = 0;
+  auto cached_time = run("CachedBenchmarkWidget", cached_sum);
+  int64_t cached_calls = widgets.calls;
+
+  // Both observe exactly the same values. Cacheable widgets call Dart once for the first read and once per change.
+  EXPECT_EQ(plain_sum, cached_sum);
+  EXPECT_EQ(plain_calls, int64_t(kWidgets) * kRounds * keys.size());
+  EXPECT_EQ(cached_calls, int64_t(kWidgets) * (kRounds / 10));
+  std::cout << kWidgets * kRounds * keys.size() << " reads: plain " << plain_calls << " calls into Dart "
+            << plain_time << "us, cacheable " << cached_calls << " calls into Dart " << cached_time << "us"
+            << std::endl;
+
+  UnbindFakeWidgets(context);
+}
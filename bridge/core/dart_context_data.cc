@@ -6,8 +6,64 @@
 
 namespace mercury {
 
+WidgetElementShape::WidgetElementShape(const std::vector<AtomicString>& properties,
+                                       const std::vector<AtomicString>& sync_methods,
+                                       const std::vector<AtomicString>& async_methods,
+                                       const std::vector<AtomicString>& cacheable_properties)
+    : cacheable_properties_(cacheable_properties) {
+  // Keep the table at most half full, so misses end at an empty slot quickly.
+  size_t members = properties.size() + sync_methods.size() + async_methods.size() + cacheable_properties.size();
+  size_t capacity = 8;
+  shift_ = 29;
+  while (capacity < members * 2) {
+    capacity <<= 1;
+    shift_--;
+  }
+  table_.resize(capacity);
+
+  // Properties take precedence over methods of the same name. Cacheable properties are also listed as properties.
+  for (auto& property : cacheable_properties) {
+    Add(property, WidgetElementMemberKind::kCacheableProperty);
+  }
+  for (auto& property : properties) {
+    Add(property, WidgetElementMemberKind::kProperty);
+  }
+  for (auto& method : sync_methods) {
+    Add(method, WidgetElementMemberKind::kMethod);
+  }
+  for (auto& method : async_methods) {
+    Add(method, WidgetElementMemberKind::kAsyncMethod);
+  }
+}
+
+WidgetElementMemberKind WidgetElementShape::Find(const AtomicString& key) const {
+  uint32_t mask = table_.size() - 1;
+  for (uint32_t slot = SlotOf(key.Impl());; slot = (slot + 1) & mask) {
+    const Entry& entry = table_[slot];
+    if (entry.kind == WidgetElementMemberKind::kNone || entry.key == key)
+      return entry.kind;
+  }
+}
+
+void WidgetElementShape::Add(const AtomicString& key, WidgetElementMemberKind kind) {
+  uint32_t mask = table_.size() - 1;
+  for (uint32_t slot = SlotOf(key.Impl());; slot = (slot + 1) & mask) {
+    Entry& entry = table_[slot];
+    if (entry.kind != WidgetElementMemberKind::kNone) {
+      if (entry.key == key)
+        return;
+      continue;
+    }
+    entry.key = key;
+    entry.kind = kind;
+    size_++;
+    return;
+  }
+}
+
 const WidgetElementShape* DartContextData::GetWidgetElementShape(const AtomicString& key) {
-  return widget_element_shapes_[key].get();
+  auto it = widget_element_shapes_.find(key);
+  return it != widget_element_shapes_.end() ? it->second.get() : nullptr;
 }
 
 bool DartContextData::HasWidgetElementShape(const AtomicString& key) {
@@ -16,6 +72,80 @@ bool DartContextData::HasWidgetElementShape(const AtomicString& key) {
 
 void DartContextData::SetWidgetElementShape(const AtomicString& key, const std::shared_ptr<WidgetElementShape>& shape) {
   widget_element_shapes_[key] = shape;
+  missing_widget_element_shapes_.erase(key);
+}
+
+bool DartContextData::IsWidgetElementShapeMissing(const AtomicString& key) const {
+  return missing_widget_element_shapes_.count(key) > 0;
+}
+
+void DartContextData::MarkWidgetElementShapeMissing(const AtomicString& key) {
+  missing_widget_element_shapes_.emplace(key);
+}
+
+namespace {
+
+class PackedShapeReader {
+ public:
+  PackedShapeReader(JSContext* ctx, const uint16_t* buffer, size_t length)
+      : ctx_(ctx), cursor_(buffer), end_(buffer + length) {}
+
+  bool AtEnd() const { return cursor_ == end_; }
+
+  bool ReadName(AtomicString& name) {
+    uint16_t length;
+    if (!ReadLength(length) || static_cast<size_t>(end_ - cursor_) < length)
+      return false;
+    name = AtomicString(ctx_, cursor_, length);
+    cursor_ += length;
+    return true;
+  }
+
+  bool ReadNames(std::vector<AtomicString>& names) {
+    uint16_t count;
+    if (!ReadLength(count))
+      return false;
+    names.resize(count);
+    for (auto& name : names) {
+      if (!ReadName(name))
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  bool ReadLength(uint16_t& length) {
+    if (cursor_ == end_)
+      return false;
+    length = *cursor_++;
+    return true;
+  }
+
+  JSContext* ctx_;
+  const uint16_t* cursor_;
+  const uint16_t* end_;
+};
+
+}  // namespace
+
+int32_t DartContextData::RegisterWidgetElementShapes(JSContext* ctx, const uint16_t* buffer, size_t length) {
+  PackedShapeReader reader(ctx, buffer, length);
+  int32_t count = 0;
+  while (!reader.AtEnd()) {
+    AtomicString class_name;
+    std::vector<AtomicString> properties;
+    std::vector<AtomicString> sync_methods;
+    std::vector<AtomicString> async_methods;
+    std::vector<AtomicString> cacheable_properties;
+    if (!reader.ReadName(class_name) || !reader.ReadNames(properties) || !reader.ReadNames(sync_methods) ||
+        !reader.ReadNames(async_methods) || !reader.ReadNames(cacheable_properties)) {
+      return -1;
+    }
+    SetWidgetElementShape(class_name, std::make_shared<WidgetElementShape>(properties, sync_methods, async_methods,
+                                                                           cacheable_properties));
+    count++;
+  }
+  return count;
 }
 
 }  // namespace mercury
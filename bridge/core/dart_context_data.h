@@ -5,16 +5,48 @@
 #ifndef MERCURY_CORE_DART_CONTEXT_DATA_H_
 #define MERCURY_CORE_DART_CONTEXT_DATA_H_
 
-#include <set>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "bindings/qjs/atomic_string.h"
 
 namespace mercury {
 
-struct WidgetElementShape {
-  std::set<AtomicString> built_in_properties_;
-  std::set<AtomicString> built_in_methods_;
-  std::set<AtomicString> built_in_async_methods_;
+// Dart marks a property cacheable when it pushes an invalidation every time the value changes, so reads may be served
+// from the value cached by the binding object.
+enum class WidgetElementMemberKind : uint8_t { kNone, kProperty, kCacheableProperty, kMethod, kAsyncMethod };
+
+// Properties and methods a WidgetElement class defines in Dart, compiled into an open addressing table indexed by atom.
+// Looking up a key costs a multiply and a probe or two whether the key is a member or not.
+class WidgetElementShape {
+ public:
+  WidgetElementShape(const std::vector<AtomicString>& properties,
+                     const std::vector<AtomicString>& sync_methods,
+                     const std::vector<AtomicString>& async_methods,
+                     const std::vector<AtomicString>& cacheable_properties = {});
+
+  WidgetElementMemberKind Find(const AtomicString& key) const;
+  bool HasMember(const AtomicString& key) const { return Find(key) != WidgetElementMemberKind::kNone; }
+  static bool IsProperty(WidgetElementMemberKind kind) {
+    return kind == WidgetElementMemberKind::kProperty || kind == WidgetElementMemberKind::kCacheableProperty;
+  }
+
+  size_t size() const { return size_; }
+  const std::vector<AtomicString>& cacheable_properties() const { return cacheable_properties_; }
+
+ private:
+  struct Entry {
+    AtomicString key;
+    WidgetElementMemberKind kind{WidgetElementMemberKind::kNone};
+  };
+
+  uint32_t SlotOf(JSAtom atom) const { return (atom * 2654435761u) >> shift_; }
+  void Add(const AtomicString& key, WidgetElementMemberKind kind);
+
+  std::vector<Entry> table_;
+  std::vector<AtomicString> cacheable_properties_;
+  uint32_t shift_;
+  size_t size_{0};
 };
 
 class DartContextData {
@@ -22,13 +54,22 @@ class DartContextData {
   const WidgetElementShape* GetWidgetElementShape(const AtomicString& key);
   bool HasWidgetElementShape(const AtomicString& key);
   void SetWidgetElementShape(const AtomicString& key, const std::shared_ptr<WidgetElementShape>& shape);
+  // Remember that flushing the isolate commands did not sync any shape for |key|, so later lookups skip the flush.
+  bool IsWidgetElementShapeMissing(const AtomicString& key) const;
+  void MarkWidgetElementShapeMissing(const AtomicString& key);
+
+  // Register the shapes of many classes at once, packed by Dart into a single UTF-16 buffer. Each shape is laid out as
+  // the class name followed by the property, sync method, async method and cacheable property lists, where a list is
+  // its length followed by its names and every name is its length followed by its code units. Returns the number of
+  // shapes registered, or -1 when reading stopped at a malformed shape.
+  int32_t RegisterWidgetElementShapes(JSContext* ctx, const uint16_t* buffer, size_t length);
 
  private:
   // WidgetElements' properties and methods are defined in the dart Side.
-  // When a new kind of WidgetElement first created, Dart code will sync properties and methods to C++ code to generate
-  // prop getter and setter and functions for JS code. This map store the properties and methods of WidgetElement which
-  // already created.
+  // Dart registers the shapes it knows about at startup, and syncs the shape of any other kind of WidgetElement when
+  // it is first created. This map store the properties and methods of WidgetElement which already registered.
   std::unordered_map<AtomicString, std::shared_ptr<WidgetElementShape>, AtomicString::KeyHasher> widget_element_shapes_;
+  std::unordered_set<AtomicString, AtomicString::KeyHasher> missing_widget_element_shapes_;
 };
 
 }  // namespace mercury
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "dart_context_data.h"
+#include <chrono>
+#include <set>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+static std::vector<AtomicString> ToAtoms(JSContext* ctx, const std::vector<std::string>& names) {
+  std::vector<AtomicString> atoms;
+  for (auto& name : names) {
+    atoms.emplace_back(ctx, name);
+  }
+  return atoms;
+}
+
+static void PackName(std::vector<uint16_t>& buffer, const std::string& name) {
+  buffer.emplace_back(name.size());
+  buffer.insert(buffer.end(), name.begin(), name.end());
+}
+
+static void PackNames(std::vector<uint16_t>& buffer, const std::vector<std::string>& names) {
+  buffer.emplace_back(names.size());
+  for (auto& name : names) {
+    PackName(buffer, name);
+  }
+}
+
+TEST(WidgetElementShape, FindMembers) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    WidgetElementShape shape(ToAtoms(ctx, {"value", "checked", "focus"}), ToAtoms(ctx, {"focus", "blur"}),
+                             ToAtoms(ctx, {"fetch"}));
+    EXPECT_EQ(shape.size(), 5);
+    EXPECT_EQ(shape.Find(AtomicString(ctx, "value")), WidgetElementMemberKind::kProperty);
+    // Properties take precedence over methods of the same name.
+    EXPECT_EQ(shape.Find(AtomicString(ctx, "focus")), WidgetElementMemberKind::kProperty);
+    EXPECT_EQ(shape.Find(AtomicString(ctx, "blur")), WidgetElementMemberKind::kMethod);
+    EXPECT_EQ(shape.Find(AtomicString(ctx, "fetch")), WidgetElementMemberKind::kAsyncMethod);
+    EXPECT_EQ(shape.Find(AtomicString(ctx, "missing")), WidgetElementMemberKind::kNone);
+    EXPECT_FALSE(shape.HasMember(AtomicString(ctx, "")));
+
+    WidgetElementShape empty({}, {}, {});
+    EXPECT_FALSE(empty.HasMember(AtomicString(ctx, "value")));
+
+    WidgetElementShape cacheable(ToAtoms(ctx, {"value", "checked"}), {}, {}, ToAtoms(ctx, {"checked"}));
+    EXPECT_EQ(cacheable.size(), 2);
+    EXPECT_EQ(cacheable.Find(AtomicString(ctx, "value")), WidgetElementMemberKind::kProperty);
+    EXPECT_EQ(cacheable.Find(AtomicString(ctx, "checked")), WidgetElementMemberKind::kCacheableProperty);
+    EXPECT_TRUE(WidgetElementShape::IsProperty(cacheable.Find(AtomicString(ctx, "checked"))));
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(DartContextData, RegisterPackedShapes) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    std::vector<uint16_t> buffer;
+    PackName(buffer, "globalThis");
+    PackNames(buffer, {});
+    PackNames(buffer, {});
+    PackNames(buffer, {});
+    PackNames(buffer, {});
+    PackName(buffer, "FlutterInput");
+    PackNames(buffer, {"value", "placeholder"});
+    PackNames(buffer, {"focus"});
+    PackNames(buffer, {"validate"});
+    PackNames(buffer, {"placeholder"});
+
+    DartContextData data;
+    EXPECT_EQ(data.RegisterWidgetElementShapes(ctx, buffer.data(), buffer.size()), 2);
+    EXPECT_TRUE(data.HasWidgetElementShape(AtomicString(ctx, "globalThis")));
+    auto* shape = data.GetWidgetElementShape(AtomicString(ctx, "FlutterInput"));
+    ASSERT_NE(shape, nullptr);
+    EXPECT_EQ(shape->Find(AtomicString(ctx, "value")), WidgetElementMemberKind::kProperty);
+    EXPECT_EQ(shape->Find(AtomicString(ctx, "placeholder")), WidgetElementMemberKind::kCacheableProperty);
+    EXPECT_EQ(shape->Find(AtomicString(ctx, "validate")), WidgetElementMemberKind::kAsyncMethod);
+    EXPECT_EQ(data.GetWidgetElementShape(AtomicString(ctx, "FlutterButton")), nullptr);
+
+    // A truncated buffer is rejected instead of being read past its end.
+    buffer.pop_back();
+    DartContextData truncated;
+    EXPECT_EQ(truncated.RegisterWidgetElementShapes(ctx, buffer.data(), buffer.size()), -1);
+    EXPECT_EQ(truncated.GetWidgetElementShape(AtomicString(ctx, "FlutterInput")), nullptr);
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+// Property access on 10k widget objects: every object reads a few Dart properties and methods and misses a few keys,
+// once against the ordered sets shapes used to hold and once against the compiled table.
+TEST(WidgetElementShape, PropertyAccessBenchmark) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    const int kObjects = 10000;
+    std::vector<std::string> property_names;
+    std::vector<std::string> method_names;
+    for (int i = 0; i < 40; i++) {
+      property_names.emplace_back("property" + std::to_string(i));
+      method_names.emplace_back("method" + std::to_string(i));
+    }
+    auto properties = ToAtoms(ctx, property_names);
+    auto methods = ToAtoms(ctx, method_names);
+    auto misses = ToAtoms(ctx, {"toJSON", "then", "constructor", "nodeType", "length"});
+
+    std::set<AtomicString> property_set(properties.begin(), properties.end());
+    std::set<AtomicString> method_set(methods.begin(), methods.end());
+    std::set<AtomicString> async_method_set;
+    WidgetElementShape shape(properties, methods, {});
+
+    std::vector<AtomicString> accesses;
+    for (int i = 0; i < 8; i++) {
+      accesses.emplace_back(properties[i * 5]);
+      accesses.emplace_back(methods[i * 5]);
+    }
+    accesses.insert(accesses.end(), misses.begin(), misses.end());
+
+    int64_t set_hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int object = 0; object < kObjects; object++) {
+      for (auto& key : accesses) {
+        if (property_set.count(key) > 0 || method_set.count(key) > 0 || async_method_set.count(key) > 0)
+          set_hits++;
+      }
+    }
+    auto set_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t table_hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (int object = 0; object < kObjects; object++) {
+      for (auto& key : accesses) {
+        if (shape.HasMember(key))
+          table_hits++;
+      }
+    }
+    auto table_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(set_hits, table_hits);
+    EXPECT_EQ(table_hits, int64_t(kObjects) * 16);
+    std::cout << kObjects << " widget objects: std::set " << set_time << "us, compiled table " << table_time << "us"
+              << std::endl;
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
@@ -3,33 +3,39 @@
  */
 
 #include "dart_isolate_context.h"
-#include <set>
+#include <chrono>
 #include "event_factory.h"
+#include "foundation/generational_slab.h"
 #include "mercury_isolate.h"
 #include "names_installer.h"
 
 namespace mercury {
 
-thread_local std::set<DartWireContext*> alive_wires;
+thread_local GenerationalSlab<ScriptValue> dart_wires;
 
-void WatchDartWire(DartWireContext* wire) {
-  alive_wires.emplace(wire);
+int64_t CreateDartWire(const ScriptValue& js_object) {
+  return dart_wires.Insert(ScriptValue(js_object));
 }
 
-bool IsDartWireAlive(DartWireContext* wire) {
-  return alive_wires.find(wire) != alive_wires.end();
+bool IsDartWireAlive(int64_t wire) {
+  return dart_wires.Contains(wire);
 }
 
-void DeleteDartWire(DartWireContext* wire) {
-  alive_wires.erase(wire);
-  delete wire;
+size_t ReleaseDartWires(const int64_t* wires, int32_t count) {
+  return dart_wires.RemoveAll(wires, count);
 }
 
 static void ClearUpWires() {
-  for (auto& wire : alive_wires) {
-    delete wire;
-  }
-  alive_wires.clear();
+  dart_wires.Clear();
+}
+
+NativeTaskQueue::NativeTaskQueue() {
+  setWakeupHook(WakeupDart, this);
+}
+
+void NativeTaskQueue::WakeupDart(void* data) {
+  auto* queue = static_cast<NativeTaskQueue*>(data);
+  Dart_PostInteger_DL(queue->dart_port_.load(std::memory_order_acquire), 0);
 }
 
 const std::unique_ptr<DartContextData>& DartIsolateContext::EnsureData() const {
@@ -53,6 +59,7 @@ void InitializeBuiltInStrings(JSContext* ctx) {
 DartIsolateContext::DartIsolateContext(const uint64_t* dart_methods, int32_t dart_methods_length)
     : is_valid_(true),
       running_thread_(std::this_thread::get_id()),
+      native_task_queue_(fml::MakeRefCounted<NativeTaskQueue>()),
       dart_method_ptr_(std::make_unique<DartMethodPointer>(dart_methods, dart_methods_length)) {
   if (runtime_ == nullptr) {
     runtime_ = JS_NewRuntime();
@@ -71,6 +78,7 @@ DartIsolateContext::DartIsolateContext(const uint64_t* dart_methods, int32_t dar
 DartIsolateContext::~DartIsolateContext() {
   is_valid_ = false;
   mercury_isolates_.clear();
+  disposed_isolates_.clear();
   running_isolates_--;
 
   if (running_isolates_ == 0) {
@@ -92,10 +100,26 @@ void DartIsolateContext::AddNewIsolate(std::unique_ptr<MercuryIsolate>&& new_iso
 void DartIsolateContext::RemoveIsolate(const MercuryIsolate* isolate) {
   for (auto it = mercury_isolates_.begin(); it != mercury_isolates_.end(); ++it) {
     if (it->get() == isolate) {
-      mercury_isolates_.erase(it);
+      auto disposed = std::move(mercury_isolates_.extract(it).value());
+      disposed->GetExecutingContext()->Deactivate();
+      disposed_isolates_.push_back(std::move(disposed));
       break;
     }
   }
 }
 
+bool DartIsolateContext::CollectDisposedIsolates(int64_t budget_in_microseconds) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget_in_microseconds);
+
+  while (!disposed_isolates_.empty()) {
+    auto& isolate = disposed_isolates_.front();
+    isolate->GetExecutingContext()->GetScriptState()->SetCollectGarbageOnDispose(false);
+    disposed_isolates_.pop_front();
+    if (std::chrono::steady_clock::now() >= deadline)
+      return disposed_isolates_.empty();
+  }
+
+  return true;
+}
+
 }  // namespace mercury
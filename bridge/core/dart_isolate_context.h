@@ -5,25 +5,42 @@
 #ifndef MERCURY_DART_CONTEXT_H_
 #define MERCURY_DART_CONTEXT_H_
 
+#include <atomic>
+#include <deque>
 #include <set>
 #include "bindings/qjs/script_value.h"
 #include "dart_context_data.h"
 #include "dart_methods.h"
+#include "foundation/task_queue.h"
 
 namespace mercury {
 
 class MercuryIsolate;
 class DartIsolateContext;
 
-struct DartWireContext {
-  ScriptValue jsObject;
-};
-
 void InitializeBuiltInStrings(JSContext* ctx);
 
-void WatchDartWire(DartWireContext* wire);
-bool IsDartWireAlive(DartWireContext* wire);
-void DeleteDartWire(DartWireContext* wire);
+// Tasks posted from native worker threads back to the Dart isolate thread. Posting wakes up the Dart side through a
+// native port, which answers by calling flushNativeTasks().
+class NativeTaskQueue : public TaskQueue {
+ public:
+  NativeTaskQueue();
+
+  void SetDartPort(Dart_Port port) { dart_port_.store(port, std::memory_order_release); }
+  bool HasDartPort() const { return dart_port_.load(std::memory_order_acquire) != ILLEGAL_PORT; }
+
+ private:
+  static void WakeupDart(void* data);
+
+  std::atomic<Dart_Port> dart_port_{ILLEGAL_PORT};
+};
+
+// Wires keep the JS object of an event dispatched from Dart alive until Dart acknowledges it is done with the event,
+// which it does in batches through releaseDartWires(). Wires are addressed by generational handles, so a handle
+// released twice or after the runtime is gone is ignored.
+int64_t CreateDartWire(const ScriptValue& js_object);
+bool IsDartWireAlive(int64_t wire);
+size_t ReleaseDartWires(const int64_t* wires, int32_t count);
 
 // DartIsolateContext has a 1:1 correspondence with a dart isolates.
 class DartIsolateContext {
@@ -40,13 +57,28 @@ class DartIsolateContext {
   const std::unique_ptr<DartContextData>& EnsureData() const;
 
   void AddNewIsolate(std::unique_ptr<MercuryIsolate>&& new_isolate);
+  // Deactivate the isolate right away and queue it for CollectDisposedIsolates. Freeing a context synchronously runs a
+  // GC over the whole runtime, which would pause every other isolate of this Dart isolate.
   void RemoveIsolate(const MercuryIsolate* isolate);
+  // Free queued isolates until the budget runs out, at least one per call. Returns true when nothing is left to
+  // collect.
+  //
+  // No runtime-wide GC is forced: its cost grows with the heap of every isolate, not with the budget. The cycles left
+  // by the freed contexts are collected by the next GC the runtime triggers on its own, whose finalizers detach the
+  // wrappers from their freed ExecutingContext.
+  bool CollectDisposedIsolates(int64_t budget_in_microseconds);
+  FORCE_INLINE size_t disposedIsolateCount() const { return disposed_isolates_.size(); }
+
+  FORCE_INLINE const fml::RefPtr<NativeTaskQueue>& nativeTaskQueue() const { return native_task_queue_; }
 
   ~DartIsolateContext();
 
  private:
   int is_valid_{false};
   std::set<std::unique_ptr<MercuryIsolate>> mercury_isolates_;
+  std::deque<std::unique_ptr<MercuryIsolate>> disposed_isolates_;
+  // Worker threads hold references, the queue may outlive this context.
+  fml::RefPtr<NativeTaskQueue> native_task_queue_;
   std::thread::id running_thread_;
   mutable std::unique_ptr<DartContextData> data_;
   static thread_local JSRuntime* runtime_;
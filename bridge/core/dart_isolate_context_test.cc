@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "dart_isolate_context.h"
+#include "gtest/gtest.h"
+#include "include/mercury_bridge.h"
+#include "mercury_isolate.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+// Wrappers and plain objects kept alive by cycles only, which outlive the context until a GC collects them.
+static MercuryIsolate* AllocateIsolateWithCycles(DartIsolateContext* dart_isolate_context) {
+  auto* isolate = static_cast<MercuryIsolate*>(allocateNewMercuryIsolate(dart_isolate_context, newMercuryIsolateId()));
+  std::string code = R"(
+globalThis.items = [];
+for (let i = 0; i < 100; i++) {
+  const target = new EventTarget();
+  const item = { target };
+  item.self = item;
+  target.addEventListener('e', () => item);
+  items.push(item);
+}
+)";
+  isolate->evaluateScript(code.c_str(), code.size(), "vm://", 0);
+  return isolate;
+}
+
+// A slice which runs out of budget still frees one context, so collection always makes progress and its cost per call
+// is bounded by a single context.
+TEST(DartIsolateContext, CollectionSliceFreesOneContextPastBudget) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  auto* context = env->page()->GetExecutingContext();
+  auto* dart_isolate_context = context->dartIsolateContext();
+
+  for (int i = 0; i < 3; i++) {
+    disposeMercuryIsolate(dart_isolate_context, AllocateIsolateWithCycles(dart_isolate_context));
+  }
+  EXPECT_EQ(dart_isolate_context->disposedIsolateCount(), 3);
+
+  EXPECT_FALSE(dart_isolate_context->CollectDisposedIsolates(0));
+  EXPECT_EQ(dart_isolate_context->disposedIsolateCount(), 2);
+  EXPECT_FALSE(dart_isolate_context->CollectDisposedIsolates(0));
+  EXPECT_EQ(dart_isolate_context->disposedIsolateCount(), 1);
+  EXPECT_TRUE(dart_isolate_context->CollectDisposedIsolates(0));
+  EXPECT_EQ(dart_isolate_context->disposedIsolateCount(), 0);
+  EXPECT_TRUE(dart_isolate_context->CollectDisposedIsolates(0));
+  EXPECT_EQ(errorCalled, false);
+}
+
+// The cycles of freed contexts are collected by a later GC. Their finalizers must not reach the freed ExecutingContext.
+TEST(DartIsolateContext, LaterGCFinalizesWrappersOfFreedContexts) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  auto* context = env->page()->GetExecutingContext();
+  auto* dart_isolate_context = context->dartIsolateContext();
+
+  for (int i = 0; i < 3; i++) {
+    disposeMercuryIsolate(dart_isolate_context, AllocateIsolateWithCycles(dart_isolate_context));
+  }
+  EXPECT_TRUE(dart_isolate_context->CollectDisposedIsolates(10 * 1000 * 1000));
+  EXPECT_EQ(dart_isolate_context->disposedIsolateCount(), 0);
+
+  JS_RunGC(JS_GetRuntime(context->ctx()));
+  std::string code = "globalThis.alive = new EventTarget();";
+  EXPECT_TRUE(context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0));
+  EXPECT_EQ(errorCalled, false);
+}
@@ -50,16 +50,15 @@ CloseEvent::CloseEvent(ExecutingContext* context,
 CloseEvent::CloseEvent(ExecutingContext* context, const AtomicString& type, NativeCloseEvent* native_close_event)
     : Event(context, type, &native_close_event->native_event),
       code_(native_close_event->code),
-#if ANDROID_32_BIT
-      reason_(AtomicString(
-          context->ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_close_event->reason)))),
-#else
-      reason_(AtomicString(
-          context->ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_close_event->reason)))),
-#endif
-      was_clean_(native_close_event->wasClean) {
+      native_reason_(reinterpret_cast<SharedNativeString*>(native_close_event->reason)),
+      was_clean_(native_close_event->wasClean) {}
+
+CloseEvent::~CloseEvent() {
+  delete static_cast<AutoFreeNativeString*>(native_reason_);
+}
+
+void CloseEvent::FreeNativeEvent(NativeCloseEvent* native_close_event) {
+  delete reinterpret_cast<AutoFreeNativeString*>(native_close_event->reason);
 }
 
 bool CloseEvent::IsCloseEvent() const {
@@ -71,6 +70,11 @@ int64_t CloseEvent::code() const {
 }
 
 const AtomicString& CloseEvent::reason() const {
+  if (native_reason_ != nullptr) {
+    reason_ =
+        AtomicString(ctx(), std::unique_ptr<AutoFreeNativeString>(static_cast<AutoFreeNativeString*>(native_reason_)));
+    native_reason_ = nullptr;
+  }
   return reason_;
 }
 
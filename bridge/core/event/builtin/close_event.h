@@ -45,6 +45,10 @@ class CloseEvent : public Event {
                       const std::shared_ptr<CloseEventInit>& initializer,
                       ExceptionState& exception_state);
   explicit CloseEvent(ExecutingContext* context, const AtomicString& type, NativeCloseEvent* raw_event);
+  ~CloseEvent() override;
+
+  // Release the members of a native close event which is dropped without being dispatched.
+  static void FreeNativeEvent(NativeCloseEvent* native_close_event);
 
   bool IsCloseEvent() const override;
 
@@ -54,7 +58,9 @@ class CloseEvent : public Event {
 
  private:
   int64_t code_;
-  AtomicString reason_;
+  // The reason of events dispatched from Dart is decoded from |native_reason_| on first access.
+  mutable SharedNativeString* native_reason_{nullptr};
+  mutable AtomicString reason_;
   bool was_clean_;
 };
 
@@ -5,6 +5,7 @@
 
 #include "message_event.h"
 #include "core/event/event.h"
+#include "foundation/native_value.h"
 #include "qjs_message_event.h"
 
 namespace mercury {
@@ -38,46 +39,65 @@ MessageEvent::MessageEvent(ExecutingContext* context,
                            const AtomicString& type,
                            NativeMessageEvent* native_message_event)
     : Event(context, type, &native_message_event->native_event),
-#if ANDROID_32_BIT
-      data_(ScriptValue(ctx(), *(reinterpret_cast<NativeValue*>(native_message_event->data)))),
-      origin_(AtomicString(ctx(),
-                           std::unique_ptr<AutoFreeNativeString>(
-                               reinterpret_cast<AutoFreeNativeString*>(native_message_event->origin)))),
-      lastEventId_(AtomicString(ctx(),
-                                std::unique_ptr<AutoFreeNativeString>(
-                                    reinterpret_cast<AutoFreeNativeString*>(native_message_event->lastEventId)))),
-      source_(AtomicString(
-          ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_message_event->source))))
-#else
-      data_(ScriptValue(ctx(), *(static_cast<NativeValue*>(native_message_event->data)))),
-      origin_(AtomicString(ctx(),
-                           std::unique_ptr<AutoFreeNativeString>(
-                               reinterpret_cast<AutoFreeNativeString*>(native_message_event->origin)))),
-      lastEventId_(AtomicString(ctx(),
-                                std::unique_ptr<AutoFreeNativeString>(
-                                    reinterpret_cast<AutoFreeNativeString*>(native_message_event->lastEventId)))),
-      source_(AtomicString(
-          ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_message_event->source))))
-#endif
-
-{
+      native_message_event_(native_message_event),
+      pending_native_members_(kData | kOrigin | kLastEventId | kSource) {}
+
+MessageEvent::~MessageEvent() {
+  if (native_message_event_ == nullptr)
+    return;
+  // Only the members which were never read are still owned by the native event.
+  if (pending_native_members_ & kData)
+    Native_FreeValue(*reinterpret_cast<NativeValue*>(native_message_event_->data));
+  if (pending_native_members_ & kOrigin)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->origin);
+  if (pending_native_members_ & kLastEventId)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->lastEventId);
+  if (pending_native_members_ & kSource)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->source);
+}
+
+void MessageEvent::FreeNativeEvent(NativeMessageEvent* native_message_event) {
+  Native_FreeValue(*reinterpret_cast<NativeValue*>(native_message_event->data));
+  delete reinterpret_cast<AutoFreeNativeString*>(native_message_event->origin);
+  delete reinterpret_cast<AutoFreeNativeString*>(native_message_event->lastEventId);
+  delete reinterpret_cast<AutoFreeNativeString*>(native_message_event->source);
+}
+
+bool MessageEvent::TakeNativeMember(NativeMember member) const {
+  if (LIKELY(!(pending_native_members_ & member)))
+    return false;
+  pending_native_members_ &= ~member;
+  return true;
 }
 
 ScriptValue MessageEvent::data() const {
+  if (TakeNativeMember(kData)) {
+    data_ = ScriptValue(ctx(), *reinterpret_cast<NativeValue*>(native_message_event_->data));
+  }
   return data_;
 }
 
 AtomicString MessageEvent::origin() const {
+  if (TakeNativeMember(kOrigin)) {
+    origin_ = AtomicString(ctx(), std::unique_ptr<AutoFreeNativeString>(
+                                      reinterpret_cast<AutoFreeNativeString*>(native_message_event_->origin)));
+  }
   return origin_;
 }
 
 AtomicString MessageEvent::lastEventId() const {
+  if (TakeNativeMember(kLastEventId)) {
+    lastEventId_ = AtomicString(ctx(), std::unique_ptr<AutoFreeNativeString>(
+                                           reinterpret_cast<AutoFreeNativeString*>(native_message_event_->lastEventId)));
+  }
   return lastEventId_;
 }
 
 AtomicString MessageEvent::source() const {
+  if (TakeNativeMember(kSource)) {
+    source_ = AtomicString(ctx(), std::unique_ptr<AutoFreeNativeString>(
+                                      reinterpret_cast<AutoFreeNativeString*>(native_message_event_->source)));
+  }
   return source_;
 }
 
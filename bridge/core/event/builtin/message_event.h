@@ -30,6 +30,10 @@ class MessageEvent : public Event {
                         const AtomicString& type,
                         const std::shared_ptr<MessageEventInit>& init);
   explicit MessageEvent(ExecutingContext* context, const AtomicString& type, NativeMessageEvent* native_message_event);
+  ~MessageEvent() override;
+
+  // Release the members of a native message event which is dropped without being dispatched.
+  static void FreeNativeEvent(NativeMessageEvent* native_message_event);
 
   ScriptValue data() const;
   AtomicString origin() const;
@@ -39,10 +43,23 @@ class MessageEvent : public Event {
   bool IsMessageEvent() const override;
 
  private:
-  ScriptValue data_;
-  AtomicString origin_;
-  AtomicString lastEventId_;
-  AtomicString source_;
+  enum NativeMember : uint8_t {
+    kData = 1 << 0,
+    kOrigin = 1 << 1,
+    kLastEventId = 1 << 2,
+    kSource = 1 << 3,
+  };
+
+  // Members of events dispatched from Dart are decoded from |native_message_event_| on first access, so events no
+  // script ever reads do not pay for the conversion.
+  bool TakeNativeMember(NativeMember member) const;
+
+  NativeMessageEvent* native_message_event_{nullptr};
+  mutable uint8_t pending_native_members_{0};
+  mutable ScriptValue data_;
+  mutable AtomicString origin_;
+  mutable AtomicString lastEventId_;
+  mutable AtomicString source_;
 };
 
 }  // namespace mercury
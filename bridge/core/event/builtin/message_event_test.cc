@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include <chrono>
+#include "event_factory.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+#include "message_event.h"
+#include "qjs_message_event.h"
+
+using namespace mercury;
+
+// Build a raw message event the way Dart's MessageEvent.toRaw() lays it out.
+static RawEvent* CreateRawMessageEvent(const std::string& data) {
+  auto* bytes = new uint64_t[sizeof(NativeMessageEvent) / sizeof(int64_t)]{};
+  auto* native_message_event = reinterpret_cast<NativeMessageEvent*>(bytes);
+  native_message_event->native_event.type = stringToNativeString("message").release();
+  native_message_event->data = new NativeValue(Native_NewCString(data));
+  native_message_event->origin = stringToNativeString("https://example.com").release();
+  native_message_event->lastEventId = stringToNativeString("1").release();
+  native_message_event->source = stringToNativeString("").release();
+  auto* raw_event = new RawEvent();
+  raw_event->bytes = bytes;
+  raw_event->length = sizeof(NativeMessageEvent) / sizeof(int64_t);
+  raw_event->is_custom_event = 0;
+  return raw_event;
+}
+
+static int64_t DispatchMessageEvents(MercuryMain* page, int count) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) {
+    NativeValue extra = Native_NewNull();
+    auto* module_name = stringToNativeString("bench").release();
+    NativeValue* result = page->invokeModuleEvent(module_name, "message", CreateRawMessageEvent("payload"), &extra);
+    free(result);
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(MessageEvent, DispatchFromDartWithoutListeners) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {};
+
+  int64_t elapsed = DispatchMessageEvents(env->page(), 100000);
+  std::cout << "100k message events without listeners: " << elapsed << "ms" << std::endl;
+  EXPECT_EQ(errorCalled, false);
+}
+
+TEST(MessageEvent, DispatchFromDartWithListeners) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "100000 50000");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = std::string(R"(
+globalThis.received = 0;
+globalThis.read = 0;
+__mercury_add_module_listener__('bench', (event) => {
+  // Only every other event reads its members, the rest stay undecoded.
+  if (received++ % 2 == 0 && event.data == 'payload' && event.origin == 'https://example.com') read++;
+});
+)");
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  int64_t elapsed = DispatchMessageEvents(env->page(), 100000);
+  std::cout << "100k message events with listeners: " << elapsed << "ms" << std::endl;
+
+  std::string log = "console.log(received, read);";
+  context->EvaluateJavaScript(log.c_str(), log.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
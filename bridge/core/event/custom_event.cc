@@ -29,8 +29,7 @@ CustomEvent::CustomEvent(ExecutingContext* context, const AtomicString& type, Ex
     : Event(context, type) {}
 
 CustomEvent::CustomEvent(ExecutingContext* context, const AtomicString& type, NativeCustomEvent* native_custom_event)
-    : Event(context, type, &native_custom_event->native_event),
-      detail_(ScriptValue(ctx(), *native_custom_event->detail)) {}
+    : Event(context, type, &native_custom_event->native_event), native_detail_(native_custom_event->detail) {}
 
 CustomEvent::CustomEvent(ExecutingContext* context,
                          const AtomicString& type,
@@ -38,7 +37,21 @@ CustomEvent::CustomEvent(ExecutingContext* context,
                          ExceptionState& exception_state)
     : Event(context, type), detail_(initialize->detail()) {}
 
+CustomEvent::~CustomEvent() {
+  if (native_detail_ != nullptr)
+    Native_FreeValue(*native_detail_);
+}
+
+void CustomEvent::FreeNativeEvent(NativeCustomEvent* native_custom_event) {
+  if (native_custom_event->detail != nullptr)
+    Native_FreeValue(*native_custom_event->detail);
+}
+
 ScriptValue CustomEvent::detail() const {
+  if (native_detail_ != nullptr) {
+    detail_ = ScriptValue(ctx(), *native_detail_);
+    native_detail_ = nullptr;
+  }
   return detail_;
 }
 
@@ -61,6 +74,10 @@ void CustomEvent::initCustomEvent(const AtomicString& type,
                                   ExceptionState& exception_state) {
   initEvent(type, can_bubble, cancelable, exception_state);
   if (!IsBeingDispatched() && !detail.IsEmpty()) {
+    if (native_detail_ != nullptr) {
+      Native_FreeValue(*native_detail_);
+      native_detail_ = nullptr;
+    }
     detail_ = detail;
   }
 }
@@ -37,6 +37,10 @@ class CustomEvent final : public Event {
                        const AtomicString& type,
                        const std::shared_ptr<CustomEventInit>& initialize,
                        ExceptionState& exception_state);
+  ~CustomEvent() override;
+
+  // Release the members of a native custom event which is dropped without being dispatched.
+  static void FreeNativeEvent(NativeCustomEvent* native_custom_event);
 
   ScriptValue detail() const;
 
@@ -54,7 +58,9 @@ class CustomEvent final : public Event {
   void Trace(GCVisitor* visitor) const override;
 
  private:
-  ScriptValue detail_;
+  // The detail of events dispatched from Dart is decoded from |native_detail_| on first access.
+  mutable NativeValue* native_detail_{nullptr};
+  mutable ScriptValue detail_;
 };
 
 template <>
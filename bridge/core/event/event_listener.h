@@ -50,6 +50,9 @@ class EventListener {
   // produce the same result as b.Matches(a).
   virtual bool Matches(const EventListener&) const = 0;
 
+  // Returns a key which is equal for all the event listeners this one Matches(), used to index listeners.
+  virtual const void* MatchKey() const { return this; }
+
   virtual void Trace(GCVisitor* visitor) const = 0;
 
  private:
@@ -3,9 +3,152 @@
  * Copyright (C) 2022-present The WebF authors. All rights reserved.
  */
 #include "event_listener_map.h"
+#include <algorithm>
 
 namespace mercury {
 
+bool EventListenerVector::Add(const RegisteredEventListener& registered_listener) {
+  if (IsDuplicate(registered_listener))
+    return false;
+
+  if (!spilled_ && size_ == 0) {
+    inline_ = registered_listener;
+  } else {
+    if (!spilled_) {
+      out_of_line_.reserve(4);
+      out_of_line_.emplace_back(std::move(inline_));
+      inline_ = RegisteredEventListener();
+      spilled_ = true;
+    }
+    out_of_line_.emplace_back(registered_listener);
+  }
+  size_++;
+  live_count_++;
+  IndexListener(registered_listener);
+  return true;
+}
+
+bool EventListenerVector::Remove(const std::shared_ptr<EventListener>& listener,
+                                 const std::shared_ptr<EventListenerOptions>& options,
+                                 size_t* index_of_removed_listener,
+                                 RegisteredEventListener* registered_event_listener) {
+  for (size_t i = 0; i < size_; i++) {
+    RegisteredEventListener& registered_listener = data()[i];
+    if (registered_listener.Removed() || !registered_listener.Matches(listener, options))
+      continue;
+
+    *registered_event_listener = registered_listener;
+    *index_of_removed_listener = i;
+    UnindexListener(registered_listener);
+    live_count_--;
+    if (firing_depth_ > 0) {
+      registered_listener.SetRemoved();
+    } else {
+      EraseAt(i);
+    }
+    return true;
+  }
+
+  *index_of_removed_listener = -1;
+  return false;
+}
+
+void EventListenerVector::SetCallback(RegisteredEventListener& registered_listener,
+                                      const std::shared_ptr<EventListener>& callback) {
+  UnindexListener(registered_listener);
+  if (firing_depth_ > 0) {
+    // The old callback may be the one running right now.
+    retired_callbacks_.emplace_back(registered_listener.Callback());
+  }
+  registered_listener.SetCallback(callback);
+  IndexListener(registered_listener);
+}
+
+void EventListenerVector::EndFiring() {
+  assert(firing_depth_ > 0);
+  if (--firing_depth_ > 0)
+    return;
+  if (live_count_ != size_)
+    Compact();
+  retired_callbacks_.clear();
+}
+
+void EventListenerVector::Trace(GCVisitor* visitor) const {
+  for (const auto& registered_listener : *this) {
+    registered_listener.Trace(visitor);
+  }
+  for (const auto& callback : retired_callbacks_) {
+    callback->Trace(visitor);
+  }
+}
+
+bool EventListenerVector::IsDuplicate(const RegisteredEventListener& registered_listener) const {
+  if (listener_index_ != nullptr &&
+      listener_index_->find(registered_listener.Callback()->MatchKey()) == listener_index_->end()) {
+    return false;
+  }
+  for (const auto& existing : *this) {
+    if (!existing.Removed() && existing == registered_listener)
+      return true;
+  }
+  return false;
+}
+
+void EventListenerVector::IndexListener(const RegisteredEventListener& registered_listener) {
+  if (listener_index_ == nullptr) {
+    if (live_count_ <= kListenerIndexThreshold)
+      return;
+    listener_index_ = std::make_unique<std::unordered_map<const void*, uint32_t>>();
+    for (const auto& existing : *this) {
+      if (!existing.Removed())
+        (*listener_index_)[existing.Callback()->MatchKey()]++;
+    }
+    return;
+  }
+  (*listener_index_)[registered_listener.Callback()->MatchKey()]++;
+}
+
+void EventListenerVector::UnindexListener(const RegisteredEventListener& registered_listener) {
+  if (listener_index_ == nullptr)
+    return;
+  auto it = listener_index_->find(registered_listener.Callback()->MatchKey());
+  assert(it != listener_index_->end());
+  if (--it->second == 0)
+    listener_index_->erase(it);
+}
+
+void EventListenerVector::EraseAt(size_t index) {
+  if (spilled_) {
+    out_of_line_.erase(out_of_line_.begin() + index);
+  } else {
+    inline_ = RegisteredEventListener();
+  }
+  size_--;
+  if (size_ == 0 && spilled_) {
+    out_of_line_.clear();
+    spilled_ = false;
+  }
+  if (listener_index_ != nullptr && live_count_ <= kListenerIndexThreshold / 2)
+    listener_index_.reset();
+}
+
+void EventListenerVector::Compact() {
+  if (!spilled_) {
+    inline_ = RegisteredEventListener();
+    size_ = 0;
+    return;
+  }
+  out_of_line_.erase(std::remove_if(out_of_line_.begin(), out_of_line_.end(),
+                                    [](const RegisteredEventListener& listener) { return listener.Removed(); }),
+                     out_of_line_.end());
+  size_ = out_of_line_.size();
+  if (size_ == 0) {
+    spilled_ = false;
+  }
+  if (listener_index_ != nullptr && live_count_ <= kListenerIndexThreshold / 2)
+    listener_index_.reset();
+}
+
 EventListenerMap::EventListenerMap() {}
 
 static bool AddListenerToVector(EventListenerVector* vector,
@@ -15,65 +158,94 @@ static bool AddListenerToVector(EventListenerVector* vector,
                                 uint32_t* listener_count) {
   *registered_event_listener = RegisteredEventListener(listener, options);
 
-  if (std::find(vector->begin(), vector->end(), *registered_event_listener) != vector->end()) {
+  if (!vector->Add(*registered_event_listener)) {
     return false;  // Duplicate listener.
   }
 
-  vector->push_back(*registered_event_listener);
-  *listener_count = vector->size();
+  *listener_count = vector->LiveCount();
   return true;
 }
 
-static bool RemoveListenerFromVector(EventListenerVector* listener_vector,
-                                     const std::shared_ptr<EventListener>& listener,
-                                     const std::shared_ptr<EventListenerOptions>& options,
-                                     size_t* index_of_removed_listener,
-                                     RegisteredEventListener* registered_event_listener,
-                                     uint32_t* listener_count) {
-  // Do a manual search for the matching listener. It is not
-  // possible to create a listener on the stack because of the
-  // const on |listener|.
-  auto it = std::find_if(listener_vector->begin(), listener_vector->end(),
-                         [listener, options](const RegisteredEventListener& event_listener) -> bool {
-                           return event_listener.Matches(listener, options);
-                         });
-
-  if (it == listener_vector->end()) {
-    *index_of_removed_listener = -1;
-    return false;
+static inline uint32_t HashAtom(JSAtom atom) {
+  return atom * 2654435761u;
+}
+
+int32_t EventListenerMap::FindEntry(JSAtom event_type) const {
+  if (type_index_.empty()) {
+    for (size_t i = 0; i < entries_.size(); i++) {
+      if (entries_[i].first.Impl() == event_type)
+        return static_cast<int32_t>(i);
+    }
+    return -1;
   }
 
-  *registered_event_listener = *it;
-  *index_of_removed_listener = it - listener_vector->begin();
-  listener_vector->erase(it);
-  *listener_count = listener_vector->size();
+  size_t mask = type_index_.size() - 1;
+  for (size_t slot = HashAtom(event_type) & mask;; slot = (slot + 1) & mask) {
+    int32_t entry_index = type_index_[slot];
+    if (entry_index < 0 || entries_[entry_index].first.Impl() == event_type)
+      return entry_index;
+  }
+}
 
-  return true;
+void EventListenerMap::EraseEntry(int32_t entry_index) {
+  // Order of event types does not matter, move the last entry into the hole.
+  if (static_cast<size_t>(entry_index) != entries_.size() - 1) {
+    std::swap(entries_[entry_index], entries_.back());
+  }
+  entries_.pop_back();
+  RebuildTypeIndex();
 }
 
-bool EventListenerMap::Contains(const AtomicString& event_type) const {
-  for (const auto& entry : entries_) {
-    if (entry.first == event_type)
-      return true;
+void EventListenerMap::IndexLastEntry() {
+  if (type_index_.empty() || entries_.size() * 2 > type_index_.size()) {
+    RebuildTypeIndex();
+    return;
   }
-  return false;
+  size_t mask = type_index_.size() - 1;
+  size_t slot = HashAtom(entries_.back().first.Impl()) & mask;
+  while (type_index_[slot] >= 0)
+    slot = (slot + 1) & mask;
+  type_index_[slot] = static_cast<int32_t>(entries_.size() - 1);
+}
+
+void EventListenerMap::RebuildTypeIndex() {
+  if (entries_.size() <= kTypeIndexThreshold) {
+    type_index_.clear();
+    return;
+  }
+
+  // Keep the load factor at or below 1/2.
+  size_t capacity = 16;
+  while (capacity < entries_.size() * 2)
+    capacity <<= 1;
+  type_index_.assign(capacity, -1);
+  size_t mask = capacity - 1;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    size_t slot = HashAtom(entries_[i].first.Impl()) & mask;
+    while (type_index_[slot] >= 0)
+      slot = (slot + 1) & mask;
+    type_index_[slot] = static_cast<int32_t>(i);
+  }
+}
+
+bool EventListenerMap::Contains(const AtomicString& event_type) const {
+  return FindEntry(event_type.Impl()) >= 0;
 }
 
 bool EventListenerMap::ContainsCapturing(const AtomicString& event_type) const {
-  for (const auto& entry : entries_) {
-    if (entry.first == event_type) {
-      for (const auto& event_listener : *entry.second) {
-        if (event_listener.Capture())
-          return true;
-      }
-      return false;
-    }
+  int32_t entry_index = FindEntry(event_type.Impl());
+  if (entry_index < 0)
+    return false;
+  for (const auto& event_listener : *entries_[entry_index].second) {
+    if (!event_listener.Removed() && event_listener.Capture())
+      return true;
   }
   return false;
 }
 
 void EventListenerMap::Clear() {
   entries_.clear();
+  type_index_.clear();
 }
 
 bool EventListenerMap::Add(const AtomicString& event_type,
@@ -81,12 +253,14 @@ bool EventListenerMap::Add(const AtomicString& event_type,
                            const std::shared_ptr<AddEventListenerOptions>& options,
                            RegisteredEventListener* registered_event_listener,
                            uint32_t* listener_count) {
-  for (const auto& entry : entries_) {
-    if (entry.first == event_type)
-      return AddListenerToVector(entry.second.get(), listener, options, registered_event_listener, listener_count);
+  int32_t entry_index = FindEntry(event_type.Impl());
+  if (entry_index >= 0) {
+    return AddListenerToVector(entries_[entry_index].second.get(), listener, options, registered_event_listener,
+                               listener_count);
   }
 
   entries_.emplace_back(event_type, std::make_unique<EventListenerVector>());
+  IndexLastEntry();
   return AddListenerToVector(entries_.back().second.get(), listener, options, registered_event_listener,
                              listener_count);
 }
@@ -97,34 +271,36 @@ bool EventListenerMap::Remove(const AtomicString& event_type,
                               size_t* index_of_removed_listener,
                               RegisteredEventListener* registered_event_listener,
                               uint32_t* listener_count) {
-  for (unsigned i = 0; i < entries_.size(); ++i) {
-    if (entries_[i].first == event_type) {
-      bool was_removed = RemoveListenerFromVector(entries_[i].second.get(), listener, options,
-                                                  index_of_removed_listener, registered_event_listener, listener_count);
-      if (entries_[i].second->empty()) {
-        entries_.erase(entries_.begin() + i);
-      }
-      return was_removed;
-    }
-  }
+  int32_t entry_index = FindEntry(event_type.Impl());
+  if (entry_index < 0)
+    return false;
 
-  return false;
+  EventListenerVector* listener_vector = entries_[entry_index].second.get();
+  bool was_removed =
+      listener_vector->Remove(listener, options, index_of_removed_listener, registered_event_listener);
+  *listener_count = listener_vector->LiveCount();
+  // A vector being dispatched still holds its removed listeners, RemoveIfEmpty() drops it afterwards.
+  if (listener_vector->size() == 0) {
+    EraseEntry(entry_index);
+  }
+  return was_removed;
 }
 
-EventListenerVector* EventListenerMap::Find(const AtomicString& event_type) const {
-  for (const auto& entry : entries_) {
-    if (entry.first == event_type)
-      return entry.second.get();
+void EventListenerMap::RemoveIfEmpty(const AtomicString& event_type) {
+  int32_t entry_index = FindEntry(event_type.Impl());
+  if (entry_index >= 0 && entries_[entry_index].second->size() == 0) {
+    EraseEntry(entry_index);
   }
+}
 
-  return nullptr;
+EventListenerVector* EventListenerMap::Find(const AtomicString& event_type) const {
+  int32_t entry_index = FindEntry(event_type.Impl());
+  return entry_index >= 0 ? entries_[entry_index].second.get() : nullptr;
 }
 
 void EventListenerMap::Trace(GCVisitor* visitor) const {
   for (const auto& entry : entries_) {
-    for (auto& listener : *entry.second) {
-      listener.Trace(visitor);
-    }
+    entry.second->Trace(visitor);
   }
 }
 
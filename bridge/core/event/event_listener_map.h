@@ -7,6 +7,8 @@
 
 #include <quickjs/quickjs.h>
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "bindings/qjs/atomic_string.h"
@@ -19,7 +21,63 @@ namespace mercury {
 class AddEventListenerOptions;
 class EventListenerOptions;
 
-using EventListenerVector = std::vector<RegisteredEventListener>;
+// The listeners of one event type. A single listener, which is by far the most common case, is stored inline.
+//
+// While the listeners are being fired, removed listeners are only flagged as removed and replaced callbacks are
+// retired instead of freed. Both are released when the outermost dispatch finishes. This keeps indexes and callbacks
+// stable, so dispatch iterates the listeners in place without copying them.
+class EventListenerVector final {
+ public:
+  EventListenerVector() = default;
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(EventListenerVector);
+
+  // The number of slots, including listeners flagged removed during dispatch.
+  size_t size() const { return size_; }
+  bool empty() const { return live_count_ == 0; }
+  uint32_t LiveCount() const { return live_count_; }
+
+  RegisteredEventListener& operator[](size_t index) { return data()[index]; }
+  RegisteredEventListener* begin() { return data(); }
+  RegisteredEventListener* end() { return data() + size_; }
+  const RegisteredEventListener* begin() const { return data(); }
+  const RegisteredEventListener* end() const { return data() + size_; }
+
+  // Returns false if an equal listener is already registered.
+  bool Add(const RegisteredEventListener& registered_listener);
+  bool Remove(const std::shared_ptr<EventListener>& listener,
+              const std::shared_ptr<EventListenerOptions>& options,
+              size_t* index_of_removed_listener,
+              RegisteredEventListener* registered_event_listener);
+  void SetCallback(RegisteredEventListener& registered_listener, const std::shared_ptr<EventListener>& callback);
+
+  void BeginFiring() { firing_depth_++; }
+  void EndFiring();
+
+  void Trace(GCVisitor* visitor) const;
+
+ private:
+  // Use the listener index once a type has more listeners than this.
+  static constexpr uint32_t kListenerIndexThreshold = 8;
+
+  RegisteredEventListener* data() { return spilled_ ? out_of_line_.data() : &inline_; }
+  const RegisteredEventListener* data() const { return spilled_ ? out_of_line_.data() : &inline_; }
+
+  bool IsDuplicate(const RegisteredEventListener& registered_listener) const;
+  void IndexListener(const RegisteredEventListener& registered_listener);
+  void UnindexListener(const RegisteredEventListener& registered_listener);
+  void EraseAt(size_t index);
+  void Compact();
+
+  RegisteredEventListener inline_;
+  std::vector<RegisteredEventListener> out_of_line_;
+  // Counts the live listeners by EventListener::MatchKey(). A key missing from it can not be a duplicate.
+  std::unique_ptr<std::unordered_map<const void*, uint32_t>> listener_index_;
+  std::vector<std::shared_ptr<EventListener>> retired_callbacks_;
+  uint32_t size_{0};
+  uint32_t live_count_{0};
+  uint32_t firing_depth_{0};
+  bool spilled_{false};
+};
 
 class EventListenerMap final {
   MERCURY_DISALLOW_NEW();
@@ -45,16 +103,25 @@ class EventListenerMap final {
               RegisteredEventListener* registered_event_listener,
               uint32_t* listener_count);
   EventListenerVector* Find(const AtomicString& event_type) const;
+  // Drop the entry of |event_type| if its last listener was removed while it was being dispatched.
+  void RemoveIfEmpty(const AtomicString& event_type);
 
   void Trace(GCVisitor* visitor) const;
 
  private:
-  // EventListener handlers registered with addEventListener API.
-  // We use vector instead of hashMap because
-  //  - vector is much more space efficient than hashMap.
-  //  - An EventTarget rarely has event listeners for many event types, and
-  //    vector is faster in such cases.
+  // Event types are found by a linear scan up to this many types, and with a hash index above.
+  static constexpr size_t kTypeIndexThreshold = 8;
+
+  int32_t FindEntry(JSAtom event_type) const;
+  void EraseEntry(int32_t entry_index);
+  void IndexLastEntry();
+  void RebuildTypeIndex();
+
+  // EventListener handlers registered with addEventListener API. An EventTarget rarely has event listeners for many
+  // event types, a vector is more space efficient and faster in such cases.
   std::vector<std::pair<AtomicString, std::unique_ptr<EventListenerVector>>> entries_;
+  // Open addressing index of |entries_| by atom, -1 for empty slots. Empty while below kTypeIndexThreshold.
+  std::vector<int32_t> type_index_;
 };
 
 }  // namespace mercury
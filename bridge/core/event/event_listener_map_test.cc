@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "event_listener_map.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+TEST(EventListenerMap, ListenersChangedDuringDispatch) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "a,c,once,a,c,added");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = std::string(R"(
+let target = new EventTarget();
+let log = [];
+function a() { log.push('a'); target.removeEventListener('e', b); target.addEventListener('e', added); }
+function b() { log.push('b'); }
+function c() { log.push('c'); }
+function added() { log.push('added'); }
+target.addEventListener('e', a);
+target.addEventListener('e', b);
+target.addEventListener('e', c);
+target.addEventListener('e', () => log.push('once'), { once: true });
+target.dispatchEvent(new Event('e'));
+target.dispatchEvent(new Event('e'));
+console.log(log.join(','));
+)");
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+TEST(EventListenerMap, DuplicateListenersWithManyTypes) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "6400 0");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = std::string(R"(
+let target = new EventTarget();
+let count = 0;
+let listeners = [];
+for (let i = 0; i < 64; i++) listeners.push(() => count++);
+for (let t = 0; t < 100; t++) {
+  for (let l of listeners) {
+    target.addEventListener('type' + t, l);
+    target.addEventListener('type' + t, l);
+  }
+}
+for (let t = 0; t < 100; t++) target.dispatchEvent(new Event('type' + t));
+let first = count;
+for (let t = 0; t < 100; t++) for (let l of listeners) target.removeEventListener('type' + t, l);
+count = 0;
+for (let t = 0; t < 100; t++) target.dispatchEvent(new Event('type' + t));
+console.log(first, count);
+)");
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+TEST(EventListenerMap, Benchmark) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    std::cout << message << std::endl;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = std::string(R"(
+for (let listenerCount of [1, 10, 100, 1000, 10000]) {
+  for (let typeCount of [1, 10, 200]) {
+    let target = new EventTarget();
+    let listeners = [];
+    for (let i = 0; i < listenerCount; i++) listeners.push(() => {});
+    let start = performance.now();
+    for (let i = 0; i < listenerCount; i++) target.addEventListener('type' + (i % typeCount), listeners[i]);
+    let added = performance.now();
+    for (let t = 0; t < typeCount; t++) target.dispatchEvent(new Event('type' + t));
+    let dispatched = performance.now();
+    for (let i = 0; i < listenerCount; i++) target.removeEventListener('type' + (i % typeCount), listeners[i]);
+    let removed = performance.now();
+    console.log(`${listenerCount} listeners, ${typeCount} types: add ${(added - start).toFixed(2)}ms, ` +
+                `dispatch ${(dispatched - added).toFixed(2)}ms, remove ${(removed - dispatched).toFixed(2)}ms`);
+  }
+}
+)");
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+}
@@ -23,20 +23,6 @@
 
 namespace mercury {
 
-struct EventDispatchResult : public DartReadable {
-  bool canceled{false};
-  bool propagationStopped{false};
-};
-
-struct DartEventListenerOptions : public DartReadable {
-  bool capture{false};
-};
-
-struct DartAddEventListenerOptions : public DartEventListenerOptions {
-  bool passive{false};
-  bool once{false};
-};
-
 Event::PassiveMode EventPassiveMode(const RegisteredEventListener& event_listener) {
   if (!event_listener.Passive()) {
     return Event::PassiveMode::kNotPassiveDefault;
@@ -63,7 +49,8 @@ EventTarget* EventTarget::Create(ExecutingContext* context,
 EventTarget::~EventTarget() {
 #if UNIT_TEST
   // Callback to unit test specs before eventTarget finalized.
-  if (TEST_getEnv(GetExecutingContext()->uniqueId())->on_event_target_disposed != nullptr) {
+  if (GetExecutingContext() != nullptr &&
+      TEST_getEnv(GetExecutingContext()->uniqueId())->on_event_target_disposed != nullptr) {
     TEST_getEnv(GetExecutingContext()->uniqueId())->on_event_target_disposed(this);
   }
 #endif
@@ -181,7 +168,7 @@ DispatchEventResult EventTarget::FireEventListeners(Event& event, ExceptionState
 
   bool fired_event_listeners = false;
   if (listeners_vector) {
-    fired_event_listeners = FireEventListeners(event, d, *listeners_vector, exception_state);
+    fired_event_listeners = FireEventListeners(event, d->event_listener_map, *listeners_vector, exception_state);
   }
 
   // Only invoke the callback if event listeners were fired for this phase.
@@ -198,15 +185,12 @@ DispatchEventResult EventTarget::FireEventListeners(Event& event, bool isCapture
   if (!d)
     return DispatchEventResult::kNotCanceled;
 
-  EventListenerVector* listeners_vector;
-  if (!isCapture)
-    listeners_vector = d->event_listener_map.Find(event.type());
-  else
-    listeners_vector = d->event_capture_listener_map.Find(event.type());
+  EventListenerMap& listener_map = isCapture ? d->event_capture_listener_map : d->event_listener_map;
+  EventListenerVector* listeners_vector = listener_map.Find(event.type());
 
   bool fired_event_listeners = false;
   if (listeners_vector) {
-    fired_event_listeners = FireEventListeners(event, d, *listeners_vector, exception_state);
+    fired_event_listeners = FireEventListeners(event, listener_map, *listeners_vector, exception_state);
   }
 
   // Only invoke the callback if event listeners were fired for this phase.
@@ -234,7 +218,7 @@ bool EventTarget::SetAttributeEventListener(const AtomicString& event_type,
     return false;
   }
   if (registered_listener) {
-    registered_listener->SetCallback(listener);
+    GetEventListeners(event_type)->SetCallback(*registered_listener, listener);
     return true;
   }
   return addEventListener(event_type, listener, exception_state);
@@ -254,6 +238,15 @@ EventListenerVector* EventTarget::GetEventListeners(const AtomicString& event_ty
   return data->event_listener_map.Find(event_type);
 }
 
+bool EventTarget::HasEventListeners(const AtomicString& event_type, bool is_capture) {
+  EventTargetData* data = GetEventTargetData();
+  if (!data)
+    return false;
+  const EventListenerMap& listener_map = is_capture ? data->event_capture_listener_map : data->event_listener_map;
+  EventListenerVector* listeners = listener_map.Find(event_type);
+  return listeners != nullptr && listeners->LiveCount() > 0;
+}
+
 bool EventTarget::IsEventTarget() const {
   return true;
 }
@@ -264,14 +257,7 @@ void EventTarget::Trace(GCVisitor* visitor) const {
   for (auto& entry : unimplemented_properties_) {
     entry.second.Trace(visitor);
   }
-
-  for (auto& entry : cached_methods_) {
-    entry.second.Trace(visitor);
-  }
-
-  for (auto& entry : async_cached_methods_) {
-    entry.second.Trace(visitor);
-  }
+  property_cache_.Trace(visitor);
 }
 
 bool EventTarget::AddEventListenerInternal(const AtomicString& event_type,
@@ -327,26 +313,6 @@ bool EventTarget::RemoveEventListenerInternal(const AtomicString& event_type,
                                     &listener_count))
     return false;
 
-  // Notify firing events planning to invoke the listener at 'index' that
-  // they have one less listener to invoke.
-  if (d->firing_event_iterators) {
-    for (const auto& firing_iterator : *d->firing_event_iterators) {
-      if (event_type != firing_iterator.event_type)
-        continue;
-
-      if (index_of_removed_listener >= firing_iterator.end)
-        continue;
-
-      --firing_iterator.end;
-      // Note that when firing an event listener,
-      // firingIterator.iterator indicates the next event listener
-      // that would fire, not the currently firing event
-      // listener. See EventTarget::fireEventListeners.
-      if (index_of_removed_listener < firing_iterator.iterator)
-        --firing_iterator.iterator;
-    }
-  }
-
   if (listener_count == 0) {
     bool has_capture = options->hasCapture() && options->capture();
 
@@ -379,6 +345,8 @@ NativeValue EventTarget::HandleCallFromDartSide(const AtomicString& method,
     return HandleDispatchEventFromDart(argc, argv, dart_object);
   } else if (method == binding_call_methods::ksyncPropertiesAndMethods) {
     return HandleSyncPropertiesAndMethodsFromDart(argc, argv);
+  } else if (method == binding_call_methods::kinvalidatePropertyCache) {
+    return HandleInvalidatePropertyCacheFromDart(argc, argv);
   }
 
   return Native_NewNull();
@@ -393,38 +361,43 @@ NativeValue EventTarget::HandleDispatchEventFromDart(int32_t argc, const NativeV
       NativeValueConverter<NativeTypeString>::FromNativeValue(ctx(), std::move(native_event_type));
   RawEvent* raw_event = NativeValueConverter<NativeTypePointer<RawEvent>>::FromNativeValue(argv[1]);
 
+  auto* result = new EventDispatchResult();
+  Event* event = DispatchEventFromDart(event_type, raw_event, isCapture, result);
+  if (event != nullptr) {
+    result->wire = CreateDartWire(event->ToValue());
+  }
+  return NativeValueConverter<NativeTypePointer<EventDispatchResult>>::ToNativeValue(result);
+}
+
+Event* EventTarget::DispatchEventFromDart(const AtomicString& event_type,
+                                          RawEvent* raw_event,
+                                          bool is_capture,
+                                          EventDispatchResult* result) {
+  // Nothing can observe an event without listeners, so skip creating it and its Dart wire altogether.
+  if (!HasEventListeners(event_type, is_capture)) {
+    EventFactory::Discard(event_type, raw_event);
+    *result = EventDispatchResult{};
+    return nullptr;
+  }
+
   Event* event = EventFactory::Create(GetExecutingContext(), event_type, raw_event);
   assert(event->target() != nullptr);
   assert(event->currentTarget() != nullptr);
   ExceptionState exception_state;
   event->SetTrusted(false);
   event->SetEventPhase(Event::kAtTarget);
-  DispatchEventResult dispatch_result = FireEventListeners(*event, isCapture, exception_state);
+  DispatchEventResult dispatch_result = FireEventListeners(*event, is_capture, exception_state);
   event->SetEventPhase(0);
 
-  auto* wire = new DartWireContext();
-  wire->jsObject = event->ToValue();
-
-  auto dart_object_finalize_callback = [](void* isolate_callback_data, void* peer) {
-    auto* wire = (DartWireContext*)(peer);
-    if (IsDartWireAlive(wire)) {
-      DeleteDartWire(wire);
-    }
-  };
-
-  WatchDartWire(wire);
-  Dart_NewFinalizableHandle_DL(dart_object, reinterpret_cast<void*>(wire), sizeof(DartWireContext),
-                               dart_object_finalize_callback);
-
   if (exception_state.HasException()) {
     JSValue error = JS_GetException(ctx());
     GetExecutingContext()->ReportError(error);
     JS_FreeValue(ctx(), error);
   }
 
-  auto* result = new EventDispatchResult{.canceled = dispatch_result == DispatchEventResult::kCanceledByEventHandler,
-                                         .propagationStopped = event->propagationStopped()};
-  return NativeValueConverter<NativeTypePointer<EventDispatchResult>>::ToNativeValue(result);
+  result->canceled = dispatch_result == DispatchEventResult::kCanceledByEventHandler;
+  result->propagationStopped = event->propagationStopped();
+  return event;
 }
 
 RegisteredEventListener* EventTarget::GetAttributeRegisteredEventListener(const AtomicString& event_type) {
@@ -433,7 +406,9 @@ RegisteredEventListener* EventTarget::GetAttributeRegisteredEventListener(const
     return nullptr;
 
   for (auto& event_listener : *listener_vector) {
-    auto listener = event_listener.Callback();
+    if (event_listener.Removed())
+      continue;
+    const auto& listener = event_listener.Callback();
     if (GetExecutingContext() && listener->IsEventHandler())
       return &event_listener;
   }
@@ -441,7 +416,7 @@ RegisteredEventListener* EventTarget::GetAttributeRegisteredEventListener(const
 }
 
 bool EventTarget::FireEventListeners(Event& event,
-                                     EventTargetData* d,
+                                     EventListenerMap& listener_map,
                                      EventListenerVector& entry,
                                      ExceptionState& exception_state) {
   // Fire all listeners registered for this event. Don't fire listeners removed
@@ -453,38 +428,28 @@ bool EventTarget::FireEventListeners(Event& event,
   if (!context)
     return false;
 
-  size_t i = 0;
+  // While firing, removed listeners are only flagged and replaced callbacks are kept alive, so indexes and
+  // listeners stay stable and nothing needs to be copied.
+  entry.BeginFiring();
   size_t size = entry.size();
-  if (!d->firing_event_iterators)
-    d->firing_event_iterators = std::make_unique<FiringEventIteratorVector>();
-  d->firing_event_iterators->push_back(FiringEventIterator(event.type(), i, size));
-
   bool fired_listener = false;
 
-  while (i < size) {
+  for (size_t i = 0; i < size; i++) {
     // If stopImmediatePropagation has been called, we just break out
     // immediately, without handling any more events on this target.
     if (event.ImmediatePropagationStopped())
       break;
 
-    RegisteredEventListener registered_listener = entry[i];
-
-    // Move the iterator past this event listener. This must match
-    // the handling of the FiringEventIterator::iterator in
-    // EventTarget::removeEventListener.
-    ++i;
-
-    if (!registered_listener.ShouldFire(event))
+    // Adding listeners may reallocate the vector, don't hold references to the entry across calls to script.
+    const RegisteredEventListener& registered_listener = entry[i];
+    if (registered_listener.Removed() || !registered_listener.ShouldFire(event))
       continue;
 
-    std::shared_ptr<EventListener> listener = registered_listener.Callback();
-    // The listener will be retained by Member<EventListener> in the
-    // registeredListener, i and size are updated with the firing event iterator
-    // in case the listener is removed from the listener vector below.
-    if (registered_listener.Once())
-      removeEventListener(event.type(), listener, registered_listener.Capture(), exception_state);
-
+    EventListener* listener = registered_listener.Callback().get();
+    bool capture = registered_listener.Capture();
     event.SetHandlingPassive(EventPassiveMode(registered_listener));
+    if (registered_listener.Once())
+      removeEventListener(event.type(), registered_listener.Callback(), capture, exception_state);
 
     // To match Mozilla, the AT_TARGET phase fires both capturing and bubbling
     // event listeners, even though that violates some versions of the DOM spec.
@@ -492,10 +457,11 @@ bool EventTarget::FireEventListeners(Event& event,
     fired_listener = true;
 
     event.SetHandlingPassive(Event::PassiveMode::kNotPassive);
-
-    assert(i <= size);
   }
-  d->firing_event_iterators->pop_back();
+
+  entry.EndFiring();
+  if (entry.size() == 0)
+    listener_map.RemoveIfEmpty(event.type());
   return fired_listener;
 }
 
@@ -505,7 +471,12 @@ void EventTargetWithInlineData::Trace(GCVisitor* visitor) const {
 }
 
 bool EventTarget::NamedPropertyQuery(const AtomicString& key, ExceptionState& exception_state) {
-  return GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(key);
+  if (unimplemented_properties_.count(key) > 0) {
+    return true;
+  }
+
+  auto shape = EnsureWidgetElementShape();
+  return shape != nullptr && shape->HasMember(key);
 }
 
 void EventTarget::NamedPropertyEnumerator(std::vector<AtomicString>& names, ExceptionState& exception_state) {
@@ -524,52 +495,33 @@ ScriptValue EventTarget::item(const AtomicString& key, ExceptionState& exception
     return unimplemented_properties_[key];
   }
 
-  if (!GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(className())) {
-    GetExecutingContext()->FlushIsolateCommand();
-  }
-
   if (key == built_in_string::kSymbol_toStringTag) {
     return ScriptValue(ctx(), className().ToNativeString(ctx()).release());
   }
 
-  auto shape = GetExecutingContext()->dartIsolateContext()->EnsureData()->GetWidgetElementShape(className());
-  if (shape != nullptr) {
-    if (shape->built_in_properties_.find(key) != shape->built_in_properties_.end()) {
+  auto shape = EnsureWidgetElementShape();
+  switch (shape != nullptr ? shape->Find(key) : WidgetElementMemberKind::kNone) {
+    case WidgetElementMemberKind::kProperty:
       return ScriptValue(ctx(), GetBindingProperty(key, exception_state));
-    }
-
-    if (shape->built_in_methods_.find(key) != shape->built_in_methods_.end()) {
-      if (cached_methods_.count(key) > 0) {
-        return cached_methods_[key];
-      }
-
-      auto func = CreateSyncMethodFunc(key);
-      cached_methods_[key] = func;
-      return func;
-    }
-
-    if (shape->built_in_async_methods_.find(key) != shape->built_in_async_methods_.end()) {
-      if (async_cached_methods_.count(key) > 0) {
-        return async_cached_methods_[key];
-      }
-
-      auto func = CreateAsyncMethodFunc(key);
-      async_cached_methods_[key] = CreateAsyncMethodFunc(key);
-      return func;
-    }
+    case WidgetElementMemberKind::kCacheableProperty:
+      return GetCacheableBindingProperty(key, exception_state);
+    case WidgetElementMemberKind::kMethod:
+      return GetOrCreateMethodFunc(key, false);
+    case WidgetElementMemberKind::kAsyncMethod:
+      return GetOrCreateMethodFunc(key, true);
+    case WidgetElementMemberKind::kNone:
+      break;
   }
 
   return ScriptValue::Undefined(ctx());
 }
 
 bool EventTarget::SetItem(const AtomicString& key, const ScriptValue& value, ExceptionState& exception_state) {
-  if (!GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(className())) {
-    GetExecutingContext()->FlushIsolateCommand();
-  }
-
-  auto shape = GetExecutingContext()->dartIsolateContext()->EnsureData()->GetWidgetElementShape(className());
+  auto shape = EnsureWidgetElementShape();
   // This property is defined in the Dart side
-  if (shape != nullptr && shape->built_in_properties_.count(key) > 0) {
+  if (shape != nullptr && WidgetElementShape::IsProperty(shape->Find(key))) {
+    // Dart may store the value in another form, so read it back from Dart next time.
+    property_cache_.Invalidate(key);
     NativeValue result = SetBindingProperty(key, value.ToNative(ctx(), exception_state), exception_state);
     return NativeValueConverter<NativeTypeBool>::FromNativeValue(result);
   }
@@ -591,31 +543,115 @@ bool EventTarget::DeleteItem(const AtomicString& key, ExceptionState& exception_
 }
 
 NativeValue EventTarget::HandleSyncPropertiesAndMethodsFromDart(int32_t argc, const NativeValue* argv) {
-  assert(argc == 3);
+  assert(argc == 3 || argc == 4);
   AtomicString key = className();
-  assert(!GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(key));
-
-  auto shape = std::make_shared<WidgetElementShape>();
 
   auto&& properties = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[0]);
   auto&& sync_methods = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[1]);
   auto&& async_methods = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[2]);
+  std::vector<AtomicString> cacheable_properties;
+  if (argc > 3) {
+    cacheable_properties = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[3]);
+  }
+
+  // The first instance of a class may still sync a shape Dart registered at startup. The synced one comes from a live
+  // instance, so it replaces the registered one.
+  GetExecutingContext()->dartIsolateContext()->EnsureData()->SetWidgetElementShape(
+      key, std::make_shared<WidgetElementShape>(properties, sync_methods, async_methods, cacheable_properties));
+
+  return Native_NewBool(true);
+}
+
+NativeValue EventTarget::HandleInvalidatePropertyCacheFromDart(int32_t argc, const NativeValue* argv) {
+  // Without a list of keys, every cached value of this object is stale.
+  if (argc == 0 || argv[0].tag != NativeTag::TAG_LIST) {
+    property_cache_.InvalidateAll();
+    return Native_NewBool(true);
+  }
+
+  auto&& keys = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[0]);
+  for (auto& key : keys) {
+    property_cache_.Invalidate(key);
+  }
+  return Native_NewBool(true);
+}
 
-  for (auto& property : properties) {
-    shape->built_in_properties_.emplace(property);
+ScriptValue EventTarget::GetCacheableBindingProperty(const AtomicString& key, ExceptionState& exception_state) {
+  // Dart invalidates values while applying deferred writes, so apply them before trusting the cache.
+  if (UNLIKELY(GetExecutingContext()->isolateCommandBuffer()->HasDeferredWrites())) {
+    GetExecutingContext()->FlushIsolateCommand();
   }
 
-  for (auto& method : sync_methods) {
-    shape->built_in_methods_.emplace(method);
+  JSValue cached = property_cache_.Get(key);
+  if (!JS_IsUninitialized(cached)) {
+    return ScriptValue(ctx(), cached);
   }
 
-  for (auto& method : async_methods) {
-    shape->built_in_async_methods_.emplace(method);
+  // A miss also reads the other cacheable properties missing from the cache in the same call into Dart, so reading
+  // the properties of a widget one after another costs a single round trip. Dart marks only cheap getters cacheable,
+  // and the batch is capped so a miss on one key never converts a large shape.
+  std::vector<AtomicString> keys = {key};
+  for (auto& property : EnsureWidgetElementShape()->cacheable_properties()) {
+    if (keys.size() == kMaximumCacheablePropertiesPerRead) {
+      break;
+    }
+    if (property != key && JS_IsUninitialized(property_cache_.Get(property))) {
+      keys.emplace_back(property);
+    }
   }
 
-  GetExecutingContext()->dartIsolateContext()->EnsureData()->SetWidgetElementShape(key, shape);
+  if (keys.size() == 1) {
+    ScriptValue value(ctx(), GetBindingProperty(key, exception_state));
+    if (!exception_state.HasException()) {
+      property_cache_.Set(key, value.QJSValue());
+    }
+    return value;
+  }
 
-  return Native_NewBool(true);
+  NativeValue result = GetBindingProperties(keys.data(), keys.size(), exception_state);
+  if (exception_state.HasException()) {
+    return ScriptValue::Empty(ctx());
+  }
+  assert(result.tag == NativeTag::TAG_LIST && result.uint32 == keys.size());
+  auto* values = static_cast<NativeValue*>(result.u.ptr);
+  ScriptValue value(ctx(), values[0]);
+  property_cache_.Set(key, value.QJSValue());
+  for (size_t i = 1; i < keys.size(); i++) {
+    property_cache_.Set(keys[i], ScriptValue(ctx(), values[i]).QJSValue());
+  }
+  return value;
+}
+
+const WidgetElementShape* EventTarget::EnsureWidgetElementShape() {
+  auto& data = GetExecutingContext()->dartIsolateContext()->EnsureData();
+  auto shape = data->GetWidgetElementShape(className());
+  if (shape != nullptr || data->IsWidgetElementShapeMissing(className())) {
+    return shape;
+  }
+
+  // Dart syncs the shape while handling the pending command which created this object. When nothing was synced, do
+  // not flush again for every missing key looked up on objects of this class.
+  GetExecutingContext()->FlushIsolateCommand();
+  shape = data->GetWidgetElementShape(className());
+  if (shape == nullptr) {
+    data->MarkWidgetElementShapeMissing(className());
+  }
+  return shape;
+}
+
+ScriptValue EventTarget::GetOrCreateMethodFunc(const AtomicString& method_name, bool is_async) {
+  // Method functions dispatch on `this`, so every instance of a class shares the same ones.
+  JSValue methods = GetExecutingContext()->contextData()->methodsForWidgetElementClass(className());
+  JSValue func = JS_GetProperty(ctx(), methods, method_name.Impl());
+  if (JS_IsFunction(ctx(), func)) {
+    ScriptValue result(ctx(), func);
+    JS_FreeValue(ctx(), func);
+    return result;
+  }
+
+  ScriptValue result = is_async ? CreateAsyncMethodFunc(method_name) : CreateSyncMethodFunc(method_name);
+  JS_SetProperty(ctx(), methods, method_name.Impl(), JS_DupValue(ctx(), result.QJSValue()));
+  return result;
 }
 
 ScriptValue EventTarget::CreateSyncMethodFunc(const AtomicString& method_name) {
@@ -10,6 +10,7 @@
 #include "bindings/qjs/qjs_function.h"
 #include "bindings/qjs/script_wrappable.h"
 #include "core/binding_object.h"
+#include "core/binding_property_cache.h"
 #include "event_listener_map.h"
 #include "foundation/logging.h"
 #include "foundation/native_string.h"
@@ -42,19 +43,26 @@ enum class DispatchEventResult {
   kCanceledBeforeDispatch,
 };
 
-struct FiringEventIterator {
-  MERCURY_DISALLOW_NEW();
-
- public:
-  FiringEventIterator(const AtomicString& event_type, size_t& iterator, size_t& end)
-      : event_type(event_type), iterator(iterator), end(end) {}
-
-  const AtomicString& event_type;
-  size_t& iterator;
-  size_t& end;
+// The outcome of an event dispatched from Dart, read back by the Dart side.
+struct EventDispatchResult : public DartReadable {
+  bool canceled{false};
+  bool propagationStopped{false};
+  // The Dart wire keeping the dispatched event alive, to be released by Dart. 0 if no event was created.
+  int64_t wire{0};
 };
 
-using FiringEventIteratorVector = std::vector<FiringEventIterator>;
+struct RawEvent;
+struct WidgetElementShape;
+
+// One event of a batch dispatched from Dart by dispatchEventBatch(). Members are 64 bits wide to match the Dart struct.
+struct NativeEventDispatchRecord : public DartReadable {
+  NativeBindingObject* target{nullptr};
+  // Ownership of the type string and of the members of the raw event passes to the native side. Dart frees the raw event
+  // itself once dispatchEventBatch() returns.
+  SharedNativeString* type{nullptr};
+  RawEvent* raw_event{nullptr};
+  int64_t is_capture{0};
+};
 
 class EventTargetData final {
   MERCURY_DISALLOW_NEW();
@@ -69,8 +77,6 @@ class EventTargetData final {
 
   EventListenerMap event_listener_map;
   EventListenerMap event_capture_listener_map;
-
-  std::unique_ptr<FiringEventIteratorVector> firing_event_iterators;
 };
 
 class Node;
@@ -129,6 +135,14 @@ class EventTarget : public BindingObject {
   std::shared_ptr<EventListener> GetAttributeEventListener(const AtomicString& event_type);
 
   EventListenerVector* GetEventListeners(const AtomicString& event_type);
+  // Dispatch an event created from Dart at this target and fill in |result|. Returns the dispatched event, or nullptr
+  // when no listener could observe it and the raw event was released without creating one.
+  Event* DispatchEventFromDart(const AtomicString& event_type,
+                               RawEvent* raw_event,
+                               bool is_capture,
+                               EventDispatchResult* result);
+  // Cheap check for whether dispatching |event_type| at this target in the given phase would run any listener.
+  bool HasEventListeners(const AtomicString& event_type, bool is_capture);
 
   virtual bool IsGlobalOrWorkerScope() const { return false; }
   virtual bool IsNode() const { return false; }
@@ -148,6 +162,9 @@ class EventTarget : public BindingObject {
   bool SetItem(const AtomicString& key, const ScriptValue& value, ExceptionState& exception_state);
   bool DeleteItem(const AtomicString& key, ExceptionState& exception_state);
 
+  // A read missing the property cache fetches at most this many cacheable properties in one call into Dart.
+  static constexpr size_t kMaximumCacheablePropertiesPerRead = 8;
+
  protected:
   virtual bool AddEventListenerInternal(const AtomicString& event_type,
                                         const std::shared_ptr<EventListener>& listener,
@@ -168,15 +185,19 @@ class EventTarget : public BindingObject {
  private:
   RegisteredEventListener* GetAttributeRegisteredEventListener(const AtomicString& event_type);
 
-  bool FireEventListeners(Event&, EventTargetData*, EventListenerVector&, ExceptionState&);
+  bool FireEventListeners(Event&, EventListenerMap&, EventListenerVector&, ExceptionState&);
 
+  // Shape of the Dart widget element backing this object, or nullptr if Dart defines none.
+  const WidgetElementShape* EnsureWidgetElementShape();
+  ScriptValue GetOrCreateMethodFunc(const AtomicString& method_name, bool is_async);
   ScriptValue CreateSyncMethodFunc(const AtomicString& method_name);
   ScriptValue CreateAsyncMethodFunc(const AtomicString& method_name);
   NativeValue HandleSyncPropertiesAndMethodsFromDart(int32_t argc, const NativeValue* argv);
+  NativeValue HandleInvalidatePropertyCacheFromDart(int32_t argc, const NativeValue* argv);
+  ScriptValue GetCacheableBindingProperty(const AtomicString& key, ExceptionState& exception_state);
 
-  std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> cached_methods_;
-  std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> async_cached_methods_;
   std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> unimplemented_properties_;
+  BindingPropertyCache property_cache_{ctx()};
 
   AtomicString className_;
 };
@@ -8,7 +8,8 @@
 
 namespace mercury {
 
-RegisteredEventListener::RegisteredEventListener() = default;
+RegisteredEventListener::RegisteredEventListener()
+    : use_capture_(false), passive_(false), once_(false), blocked_event_warning_emitted_(false), removed_(false) {}
 
 RegisteredEventListener::RegisteredEventListener(const std::shared_ptr<EventListener>& listener,
                                                  std::shared_ptr<AddEventListenerOptions> options)
@@ -16,7 +17,8 @@ RegisteredEventListener::RegisteredEventListener(const std::shared_ptr<EventList
       use_capture_(options->hasCapture() && options->capture()),
       passive_(options->hasPassive() && options->passive()),
       once_(options->hasOnce() && options->once()),
-      blocked_event_warning_emitted_(false){};
+      blocked_event_warning_emitted_(false),
+      removed_(false){};
 
 RegisteredEventListener::RegisteredEventListener(const RegisteredEventListener& that) = default;
 
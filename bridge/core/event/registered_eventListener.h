@@ -24,7 +24,7 @@ class RegisteredEventListener final {
   RegisteredEventListener(const RegisteredEventListener& that);
   RegisteredEventListener& operator=(const RegisteredEventListener& that);
 
-  const std::shared_ptr<EventListener> Callback() const { return callback_; }
+  const std::shared_ptr<EventListener>& Callback() const { return callback_; }
   void SetCallback(const std::shared_ptr<EventListener>& listener);
 
   void SetCallback(EventListener* listener);
@@ -35,6 +35,11 @@ class RegisteredEventListener final {
 
   bool Capture() const { return use_capture_; }
 
+  // Listeners removed while their event type is being dispatched stay in place until the dispatch finishes.
+  bool Removed() const { return removed_; }
+
+  void SetRemoved() { removed_ = true; }
+
   bool BlockedEventWarningEmitted() const { return blocked_event_warning_emitted_; }
 
   void SetBlockedEventWarningEmitted() { blocked_event_warning_emitted_ = true; }
@@ -52,8 +57,7 @@ class RegisteredEventListener final {
   unsigned passive_ : 1;
   unsigned once_ : 1;
   unsigned blocked_event_warning_emitted_ : 1;
-
- private:
+  unsigned removed_ : 1;
 };
 
 bool operator==(const RegisteredEventListener&, const RegisteredEventListener&);
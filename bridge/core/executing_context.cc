@@ -12,6 +12,8 @@
 #include "core/event/builtin/error_event.h"
 #include "core/event/builtin/promise_rejection_event.h"
 #include "event_type_names.h"
+#include "foundation/generational_handle_table.h"
+#include "foundation/native_worker_pool.h"
 #include "polyfill.h"
 #include "qjs_global.h"
 
@@ -19,9 +21,22 @@ namespace mercury {
 
 static std::atomic<int32_t> context_unique_id{0};
 
-#define MAX_JS_CONTEXT 8192
-bool valid_contexts[MAX_JS_CONTEXT];
-std::atomic<uint32_t> running_context_list{0};
+// Context ids are generational handles: a slot is reserved by AllocateContextId() and published by the
+// ExecutingContext constructor. Once released, ids of disposed contexts never resolve to a newer context.
+static GenerationalHandleTable<ExecutingContext*>& ContextHandleTable() {
+  static auto* table = new GenerationalHandleTable<ExecutingContext*>();
+  return *table;
+}
+
+int32_t AllocateContextId() {
+  return ContextHandleTable().Allocate(nullptr);
+}
+
+void ReleaseUnusedContextId(int32_t contextId) {
+  if (ContextHandleTable().IsValid(contextId) && ContextHandleTable().Lookup(contextId) == nullptr) {
+    ContextHandleTable().Release(contextId);
+  }
+}
 
 ExecutingContext::ExecutingContext(DartIsolateContext* dart_isolate_context,
                                    int32_t contextId,
@@ -34,14 +49,13 @@ ExecutingContext::ExecutingContext(DartIsolateContext* dart_isolate_context,
       unique_id_(context_unique_id++),
       is_context_valid_(true) {
 
-  // @FIXME: maybe contextId will larger than MAX_JS_CONTEXT
-  assert_m(valid_contexts[contextId] != true, "Conflict context found!");
-  valid_contexts[contextId] = true;
-  if (contextId > running_context_list)
-    running_context_list = contextId;
+  assert_m(ContextHandleTable().Lookup(contextId) == nullptr, "Conflict context found!");
+  [[maybe_unused]] bool published = ContextHandleTable().Set(contextId, this);
+  assert_m(published, "Context id must be allocated by AllocateContextId()");
 
   time_origin_ = std::chrono::system_clock::now();
 
+  ContextHeapScope heap_scope{&script_state_};
   JSContext* ctx = script_state_.ctx();
   global_object_ = JS_GetGlobalObject(script_state_.ctx());
 
@@ -67,7 +81,7 @@ ExecutingContext::ExecutingContext(DartIsolateContext* dart_isolate_context,
 
 ExecutingContext::~ExecutingContext() {
   is_context_valid_ = false;
-  valid_contexts[context_id_] = false;
+  ContextHandleTable().Release(context_id_);
 
   // Check if current context have unhandled exceptions.
   JSValue exception = JS_GetException(script_state_.ctx());
@@ -95,6 +109,7 @@ bool ExecutingContext::EvaluateJavaScript(const uint16_t* code,
                                           uint64_t* bytecode_len,
                                           const char* sourceURL,
                                           int startLine) {
+  ContextHeapScope heap_scope{&script_state_};
   std::string utf8Code = toUTF8(std::u16string(reinterpret_cast<const char16_t*>(code), codeLength));
   JSValue result;
   if (parsed_bytecodes == nullptr) {
@@ -121,6 +136,7 @@ bool ExecutingContext::EvaluateJavaScript(const uint16_t* code,
 }
 
 bool ExecutingContext::EvaluateJavaScript(const char16_t* code, size_t length, const char* sourceURL, int startLine) {
+  ContextHeapScope heap_scope{&script_state_};
   std::string utf8Code = toUTF8(std::u16string(reinterpret_cast<const char16_t*>(code), length));
   JSValue result = JS_Eval(script_state_.ctx(), utf8Code.c_str(), utf8Code.size(), sourceURL, JS_EVAL_TYPE_GLOBAL);
   DrainPendingPromiseJobs();
@@ -130,6 +146,7 @@ bool ExecutingContext::EvaluateJavaScript(const char16_t* code, size_t length, c
 }
 
 bool ExecutingContext::EvaluateJavaScript(const char* code, size_t codeLength, const char* sourceURL, int startLine) {
+  ContextHeapScope heap_scope{&script_state_};
   JSValue result = JS_Eval(script_state_.ctx(), code, codeLength, sourceURL, JS_EVAL_TYPE_GLOBAL);
   DrainPendingPromiseJobs();
   bool success = HandleException(&result);
@@ -138,6 +155,7 @@ bool ExecutingContext::EvaluateJavaScript(const char* code, size_t codeLength, c
 }
 
 bool ExecutingContext::EvaluateByteCode(uint8_t* bytes, size_t byteLength) {
+  ContextHeapScope heap_scope{&script_state_};
   JSValue obj, val;
   obj = JS_ReadObject(script_state_.ctx(), bytes, byteLength, JS_READ_OBJ_BYTECODE);
   if (!HandleException(&obj))
@@ -150,10 +168,23 @@ bool ExecutingContext::EvaluateByteCode(uint8_t* bytes, size_t byteLength) {
   return true;
 }
 
+ExecutingContext* ExecutingContext::FromContextId(int32_t context_id) {
+  return ContextHandleTable().Lookup(context_id);
+}
+
 bool ExecutingContext::IsContextValid() const {
   return is_context_valid_;
 }
 
+void ExecutingContext::Deactivate() {
+  if (!is_context_valid_)
+    return;
+  is_context_valid_ = false;
+  ContextHandleTable().Release(context_id_);
+  timers_.stopAllTimers(this);
+  module_listener_container_.Clear();
+}
+
 bool ExecutingContext::IsCtxValid() const {
   return script_state_.Invalid();
 }
@@ -237,6 +268,9 @@ void ExecutingContext::ReportError(JSValueConst error) {
 }
 
 void ExecutingContext::DrainPendingPromiseJobs() {
+  if (microtask_checkpoint_deferrals_ > 0)
+    return;
+
   // should executing pending promise jobs.
   JSContext* pctx;
   int finished = JS_ExecutePendingJob(script_state_.runtime(), &pctx);
@@ -407,11 +441,62 @@ void ExecutingContext::InActiveScriptWrappers(ScriptWrappable* script_wrappable)
   active_wrappers_.erase(script_wrappable);
 }
 
+namespace {
+
+// Posted back to the context thread once the work is done. The queue node is embedded, so no extra allocation.
+struct NativeWorkCompletion {
+  NativeWorkCompletion(int32_t context_id, int32_t work_id) : context_id(context_id), work_id(work_id) {
+    node.task = Run;
+    node.on_cancel = Drop;
+    node.data = this;
+  }
+
+  static void Run(void* data) {
+    auto* completion = static_cast<NativeWorkCompletion*>(data);
+    if (auto* context = ExecutingContext::FromContextId(completion->context_id)) {
+      context->FinishNativeWork(completion->work_id);
+    }
+    delete completion;
+  }
+  static void Drop(void* data) { delete static_cast<NativeWorkCompletion*>(data); }
+
+  TaskNode node;
+  int32_t context_id;
+  int32_t work_id;
+};
+
+}  // namespace
+
+void ExecutingContext::PostNativeWork(std::function<void()>&& work, std::function<void()>&& complete) {
+  fml::RefPtr<NativeTaskQueue> task_queue = dart_isolate_context_->nativeTaskQueue();
+  if (!task_queue->HasDartPort()) {
+    work();
+    complete();
+    return;
+  }
+
+  int32_t work_id = native_work_id_++;
+  pending_native_works_[work_id] = std::move(complete);
+  NativeWorkerPool::Shared()->PostJob([work = std::move(work), task_queue, context_id = context_id_, work_id]() {
+    work();
+    task_queue->postTaskNode(&(new NativeWorkCompletion(context_id, work_id))->node);
+  });
+}
+
+void ExecutingContext::FinishNativeWork(int32_t work_id) {
+  auto it = pending_native_works_.find(work_id);
+  if (it == pending_native_works_.end())
+    return;
+  std::function<void()> complete = std::move(it->second);
+  pending_native_works_.erase(it);
+
+  MemberMutationScope scope{this};
+  complete();
+}
+
 // A lock free context validator.
 bool isContextValid(int32_t contextId) {
-  if (contextId > running_context_list)
-    return false;
-  return valid_contexts[contextId];
+  return ContextHandleTable().Lookup(contextId) != nullptr;
 }
 
 }  // namespace mercury
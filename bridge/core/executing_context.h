@@ -11,6 +11,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <functional>
 #include <locale>
 #include <memory>
 #include <mutex>
@@ -46,6 +47,12 @@ class ScriptWrappable;
 
 using JSExceptionHandler = std::function<void(ExecutingContext* context, const char* message)>;
 
+// Reserve a context id for a new ExecutingContext. Ids of disposed contexts are never handed out again in a way that
+// makes them valid, so stale ids held by Dart or by pending callbacks are safely rejected by isContextValid().
+int32_t AllocateContextId();
+// Give back an id reserved by AllocateContextId() which no ExecutingContext was created for. Ids of live contexts are
+// left alone, they are released when the context is deactivated.
+void ReleaseUnusedContextId(int32_t contextId);
 bool isContextValid(int32_t contextId);
 
 // An environment in which script can execute. This class exposes the common
@@ -61,6 +68,8 @@ class ExecutingContext {
   ~ExecutingContext();
 
   static ExecutingContext* From(JSContext* ctx);
+  // Returns nullptr when the context has been disposed.
+  static ExecutingContext* FromContextId(int32_t context_id);
 
   bool EvaluateJavaScript(const uint16_t* code,
                           size_t codeLength,
@@ -73,6 +82,9 @@ class ExecutingContext {
   bool EvaluateByteCode(uint8_t* bytes, size_t byteLength);
   bool IsContextValid() const;
   bool IsCtxValid() const;
+  // Detach this context before its heap is released: mark it invalid, cancel its timers and drop its module
+  // listeners. No script will run in this context afterwards.
+  void Deactivate();
   JSValue GlobalObject();
   JSContext* ctx();
   FORCE_INLINE int32_t contextId() const { return context_id_; };
@@ -82,6 +94,7 @@ class ExecutingContext {
   bool HandleException(ScriptValue* exc);
   bool HandleException(ExceptionState& exception_state);
   void ReportError(JSValueConst error);
+  // Run a microtask checkpoint, unless a MicrotaskCheckpointDeferral is active.
   void DrainPendingPromiseJobs();
   void DefineGlobalProperty(const char* prop, JSValueConst value);
   ExecutionContextData* contextData();
@@ -127,6 +140,20 @@ class ExecutingContext {
 
   void FlushIsolateCommand();
 
+  // With write coalescing, binding property writes are deferred into the isolate command buffer instead of calling
+  // into Dart one by one. Later writes of the same property in a batch replace the earlier value. Deferred writes reach
+  // Dart at the next flush, which happens before any synchronous call into Dart. A deferred write succeeds at once, so
+  // an exception thrown by the Dart setter or its return value is lost. Off by default.
+  FORCE_INLINE bool IsBindingWriteCoalescing() const { return binding_write_coalescing_; }
+  void SetBindingWriteCoalescing(bool enabled) { binding_write_coalescing_ = enabled; }
+
+  // Run |work| on the native worker pool, then |complete| on the thread of this context. |work| must be pure native
+  // code and share its result with |complete| through captured native state. |complete| is destroyed without being
+  // called if the context is disposed first. Both run synchronously when the Dart side has not registered a native
+  // task port.
+  void PostNativeWork(std::function<void()>&& work, std::function<void()>&& complete);
+  void FinishNativeWork(int32_t work_id);
+
   void DispatchErrorEvent(ErrorEvent* error_event);
   void DispatchErrorEventInterval(ErrorEvent* error_event);
   void ReportErrorEvent(ErrorEvent* error_event);
@@ -143,6 +170,8 @@ class ExecutingContext {
   static std::unordered_map<std::string, std::string> plugin_string_code;
 
  private:
+  friend class MicrotaskCheckpointDeferral;
+
   std::chrono::time_point<std::chrono::system_clock> time_origin_;
   int32_t unique_id_;
 
@@ -175,7 +204,30 @@ class ExecutingContext {
   bool in_dispatch_error_event_{false};
   RejectedPromises rejected_promises_;
   MemberMutationScope* active_mutation_scope{nullptr};
+  int32_t microtask_checkpoint_deferrals_{0};
+  bool binding_write_coalescing_{false};
   std::set<ScriptWrappable*> active_wrappers_;
+  std::unordered_map<int32_t, std::function<void()>> pending_native_works_;
+  int32_t native_work_id_{0};
+};
+
+// Batch several callbacks into JS behind a single microtask checkpoint: checkpoints requested while any deferral is
+// alive are skipped, and the outermost deferral runs one when it goes away.
+class MicrotaskCheckpointDeferral {
+  MERCURY_STACK_ALLOCATED();
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(MicrotaskCheckpointDeferral);
+
+ public:
+  explicit MicrotaskCheckpointDeferral(ExecutingContext* context) : context_(context) {
+    context_->microtask_checkpoint_deferrals_++;
+  }
+  ~MicrotaskCheckpointDeferral() {
+    if (--context_->microtask_checkpoint_deferrals_ == 0)
+      context_->DrainPendingPromiseJobs();
+  }
+
+ private:
+  ExecutingContext* context_;
 };
 
 class ObjectProperty {
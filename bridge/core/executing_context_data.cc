@@ -25,6 +25,18 @@ JSValue ExecutionContextData::prototypeForType(const WrapperTypeInfo* type) {
   return it != prototype_map_.end() ? it->second : JS_NULL;
 }
 
+JSValue ExecutionContextData::methodsForWidgetElementClass(const AtomicString& class_name) {
+  auto it = widget_element_methods_map_.find(class_name);
+  if (it != widget_element_methods_map_.end()) {
+    return it->second;
+  }
+
+  // Without a prototype, method names never resolve to Object.prototype members.
+  JSValue methods = JS_NewObjectProto(m_context->ctx(), JS_NULL);
+  widget_element_methods_map_[class_name] = methods;
+  return methods;
+}
+
 JSValue ExecutionContextData::constructorForIdSlowCase(const WrapperTypeInfo* type) {
   JSContext* ctx = m_context->ctx();
 
@@ -84,6 +96,10 @@ void ExecutionContextData::Dispose() {
   for (auto& entry : constructor_map_) {
     JS_FreeValueRT(m_context->dartIsolateContext()->runtime(), entry.second);
   }
+
+  for (auto& entry : widget_element_methods_map_) {
+    JS_FreeValueRT(m_context->dartIsolateContext()->runtime(), entry.second);
+  }
 }
 
 }  // namespace mercury
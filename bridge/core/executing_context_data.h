@@ -7,6 +7,7 @@
 
 #include <quickjs/quickjs.h>
 #include <unordered_map>
+#include "bindings/qjs/atomic_string.h"
 #include "bindings/qjs/wrapper_type_info.h"
 
 namespace mercury {
@@ -25,6 +26,8 @@ class ExecutionContextData final {
   JSValue constructorForType(const WrapperTypeInfo* type);
   // Returns the prototype object that is appropriately initialized.
   JSValue prototypeForType(const WrapperTypeInfo* type);
+  // Returns the object holding the method functions of a WidgetElement class, shared by all of its instances.
+  JSValue methodsForWidgetElementClass(const AtomicString& class_name);
 
   void Dispose();
 
@@ -32,6 +35,7 @@ class ExecutionContextData final {
   JSValue constructorForIdSlowCase(const WrapperTypeInfo* type);
   std::unordered_map<const WrapperTypeInfo*, JSValue> constructor_map_;
   std::unordered_map<const WrapperTypeInfo*, JSValue> prototype_map_;
+  std::unordered_map<AtomicString, JSValue, AtomicString::KeyHasher> widget_element_methods_map_;
 
   ExecutingContext* m_context;
 };
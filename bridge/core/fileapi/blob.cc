@@ -4,6 +4,7 @@
  */
 #include "blob.h"
 #include <modp_b64/modp_b64.h>
+#include <cstring>
 #include <string>
 #include "bindings/qjs/script_promise_resolver.h"
 #include "built_in_string.h"
@@ -11,41 +12,72 @@
 
 namespace mercury {
 
+// Reads the bytes of a Blob on the native worker pool and resolves the promise back on the JS thread.
 class BlobReaderClient {
  public:
   enum ReadType { kReadAsText, kReadAsArrayBuffer, kReadAsBase64 };
 
-  BlobReaderClient(ExecutingContext* context,
-                   Blob* blob,
-                   std::shared_ptr<ScriptPromiseResolver> resolver,
-                   ReadType read_type)
-      : context_(context), blob_(blob), resolver_(std::move(resolver)), read_type_(read_type) {
-    Start();
-  };
-
-  void Start();
-  void DidFinishLoading();
+  static void Start(ExecutingContext* context,
+                    Blob* blob,
+                    std::shared_ptr<ScriptPromiseResolver> resolver,
+                    ReadType read_type);
 
  private:
-  ExecutingContext* context_;
-  Blob* blob_;
-  std::shared_ptr<ScriptPromiseResolver> resolver_;
-  ReadType read_type_;
+  // Only holds native data, it is shared with the worker thread.
+  struct ReadState {
+    ReadType read_type;
+    // Owned by the worker as well, the Blob may be freed with its context while the read is running.
+    std::shared_ptr<const std::vector<uint8_t>> bytes;
+    std::string mime_type;
+    std::string string_result;
+    std::unique_ptr<std::vector<uint8_t>> array_buffer_result;
+  };
+
+  static void Read(ReadState* state);
+  static void DidFinishLoading(ExecutingContext* context, ScriptPromiseResolver* resolver, ReadState* state);
 };
 
-void BlobReaderClient::Start() {
-  DidFinishLoading();
+void BlobReaderClient::Start(ExecutingContext* context,
+                             Blob* blob,
+                             std::shared_ptr<ScriptPromiseResolver> resolver,
+                             ReadType read_type) {
+  auto state = std::make_shared<ReadState>();
+  state->read_type = read_type;
+  state->bytes = blob->SharedBytes();
+  state->mime_type = blob->type();
+
+  context->PostNativeWork([state]() { Read(state.get()); },
+                          [context, state, resolver = std::move(resolver)]() {
+                            DidFinishLoading(context, resolver.get(), state.get());
+                          });
+}
+
+void BlobReaderClient::Read(ReadState* state) {
+  const std::vector<uint8_t>& bytes = *state->bytes;
+  if (state->read_type == ReadType::kReadAsText) {
+    state->string_result = std::string(bytes.begin(), bytes.end());
+  } else if (state->read_type == ReadType::kReadAsArrayBuffer) {
+    state->array_buffer_result = std::make_unique<std::vector<uint8_t>>(bytes);
+  } else if (state->read_type == ReadType::kReadAsBase64) {
+    state->string_result = Blob::EncodeBase64(bytes.data(), bytes.size(), state->mime_type);
+  }
 }
 
-void BlobReaderClient::DidFinishLoading() {
-  if (read_type_ == ReadType::kReadAsText) {
-    resolver_->Resolve<std::string>(blob_->StringResult());
-  } else if (read_type_ == ReadType::kReadAsArrayBuffer) {
-    resolver_->Resolve<ArrayBufferData>(blob_->ArrayBufferResult());
-  } else if (read_type_ == ReadType::kReadAsBase64) {
-    resolver_->Resolve<std::string>(blob_->Base64Result());
+void BlobReaderClient::DidFinishLoading(ExecutingContext* context,
+                                        ScriptPromiseResolver* resolver,
+                                        ReadState* state) {
+  if (state->read_type == ReadType::kReadAsArrayBuffer) {
+    // Hand the buffer over to QuickJS, so the JS thread does not copy it again.
+    std::vector<uint8_t>* buffer = state->array_buffer_result.release();
+    JSValue array_buffer = JS_NewArrayBuffer(
+        context->ctx(), buffer->data(), buffer->size(),
+        [](JSRuntime* rt, void* opaque, void* ptr) { delete static_cast<std::vector<uint8_t>*>(opaque); }, buffer,
+        false);
+    resolver->Resolve(array_buffer);
+    JS_FreeValue(context->ctx(), array_buffer);
+  } else {
+    resolver->Resolve<std::string>(state->string_result);
   }
-  delete this;
 }
 
 Blob* Blob::Create(ExecutingContext* context, ExceptionState& exception_state) {
@@ -70,20 +102,28 @@ Blob* Blob::Create(ExecutingContext* context,
 }
 
 int32_t Blob::size() {
-  return _data.size();
+  return _data->size();
 }
 
 uint8_t* Blob::bytes() {
-  return _data.data();
+  return _data->data();
+}
+
+std::vector<uint8_t>& Blob::MutableData() {
+  // A reader still holds the bytes, leave its copy untouched.
+  if (_data.use_count() > 1) {
+    _data = std::make_shared<std::vector<uint8_t>>(*_data);
+  }
+  return *_data;
 }
 
 void Blob::Trace(GCVisitor* visitor) const {}
 
 Blob* Blob::slice(ExceptionState& exception_state) {
-  return slice(0, _data.size(), exception_state);
+  return slice(0, _data->size(), exception_state);
 }
 Blob* Blob::slice(int64_t start, ExceptionState& exception_state) {
-  return slice(start, _data.size(), exception_state);
+  return slice(start, _data->size(), exception_state);
 }
 Blob* Blob::slice(int64_t start, int64_t end, ExceptionState& exception_state) {
   return slice(start, end, AtomicString::Empty(), exception_state);
@@ -91,9 +131,9 @@ Blob* Blob::slice(int64_t start, int64_t end, ExceptionState& exception_state) {
 Blob* Blob::slice(int64_t start, int64_t end, const AtomicString& content_type, ExceptionState& exception_state) {
   auto* newBlob = MakeGarbageCollected<Blob>(ctx());
   std::vector<uint8_t> newData;
-  newData.reserve(_data.size() - (end - start));
-  newData.insert(newData.begin(), _data.begin() + start, _data.end() - (_data.size() - end));
-  newBlob->_data = newData;
+  newData.reserve(_data->size() - (end - start));
+  newData.insert(newData.begin(), _data->begin() + start, _data->end() - (_data->size() - end));
+  newBlob->_data = std::make_shared<std::vector<uint8_t>>(std::move(newData));
   newBlob->mime_type_ = content_type != built_in_string::kempty_string ? content_type.ToStdString(ctx()) : mime_type_;
   return newBlob;
 }
@@ -103,15 +143,20 @@ std::string Blob::StringResult() {
 }
 
 std::string Blob::Base64Result() {
-  size_t encode_len = modp_b64_encode_data_len(size());
+  return EncodeBase64(bytes(), size(), mime_type_);
+}
+
+std::string Blob::EncodeBase64(const uint8_t* bytes, int32_t size, const std::string& mime_type) {
+  std::string prefix = "data:" + mime_type + ";base64,";
+  size_t encode_len = modp_b64_encode_data_len(size);
   std::string buffer;
-  buffer.resize(encode_len);
+  buffer.resize(prefix.size() + encode_len);
+  memcpy(buffer.data(), prefix.data(), prefix.size());
 
-  const size_t output_size =
-      modp_b64_encode_data(reinterpret_cast<char*>(buffer.data()), reinterpret_cast<const char*>(bytes()), size());
+  const size_t output_size = modp_b64_encode_data(buffer.data() + prefix.size(), reinterpret_cast<const char*>(bytes), size);
   assert(output_size == encode_len);
 
-  return "data:" + mime_type_ + ";base64," + buffer;
+  return buffer;
 }
 
 ArrayBufferData Blob::ArrayBufferResult() {
@@ -128,19 +173,19 @@ void Blob::SetMineType(const std::string& mine_type) {
 
 ScriptPromise Blob::arrayBuffer(ExceptionState& exception_state) {
   auto resolver = ScriptPromiseResolver::Create(GetExecutingContext());
-  new BlobReaderClient(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsArrayBuffer);
+  BlobReaderClient::Start(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsArrayBuffer);
   return resolver->Promise();
 }
 
 ScriptPromise Blob::text(ExceptionState& exception_state) {
   auto resolver = ScriptPromiseResolver::Create(GetExecutingContext());
-  new BlobReaderClient(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsText);
+  BlobReaderClient::Start(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsText);
   return resolver->Promise();
 }
 
 ScriptPromise Blob::base64(ExceptionState& exception_state) {
   auto resolver = ScriptPromiseResolver::Create(GetExecutingContext());
-  new BlobReaderClient(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsBase64);
+  BlobReaderClient::Start(GetExecutingContext(), this, resolver, BlobReaderClient::ReadType::kReadAsBase64);
   return resolver->Promise();
 }
 
@@ -168,14 +213,16 @@ void Blob::PopulateBlobData(const std::vector<std::shared_ptr<BlobPart>>& data)
 
 void Blob::AppendText(const std::string& string) {
   std::vector<uint8_t> strArr(string.begin(), string.end());
-  _data.reserve(_data.size() + strArr.size());
-  _data.insert(_data.end(), strArr.begin(), strArr.end());
+  std::vector<uint8_t>& data = MutableData();
+  data.reserve(data.size() + strArr.size());
+  data.insert(data.end(), strArr.begin(), strArr.end());
 }
 
 void Blob::AppendBytes(uint8_t* buffer, uint32_t length) {
-  _data.reserve(_data.size() + length);
+  std::vector<uint8_t>& data = MutableData();
+  data.reserve(data.size() + length);
   for (size_t i = 0; i < length; i++) {
-    _data.emplace_back(buffer[i]);
+    data.emplace_back(buffer[i]);
   }
 }
 
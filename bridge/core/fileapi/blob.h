@@ -5,6 +5,7 @@
 #ifndef BRIDGE_BLOB_H
 #define BRIDGE_BLOB_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "array_buffer_data.h"
@@ -48,6 +49,9 @@ class Blob : public ScriptWrappable {
 
   /// get an pointer of bytes data from JSBlob
   uint8_t* bytes();
+  /// Readers on native worker threads keep the bytes alive through this reference, even if the Blob is freed while
+  /// they run. Appending to the Blob afterwards copies the bytes first.
+  std::shared_ptr<const std::vector<uint8_t>> SharedBytes() const { return _data; }
   /// get bytes data's length
   int32_t size();
   std::string type();
@@ -66,14 +70,19 @@ class Blob : public ScriptWrappable {
   std::string Base64Result();
   ArrayBufferData ArrayBufferResult();
 
+  // Thread safe, used by Blob readers running on native worker threads.
+  static std::string EncodeBase64(const uint8_t* bytes, int32_t size, const std::string& mime_type);
+
   void Trace(GCVisitor* visitor) const override;
 
  protected:
   void PopulateBlobData(const std::vector<std::shared_ptr<BlobPart>>& data);
 
  private:
+  std::vector<uint8_t>& MutableData();
+
   std::string mime_type_;
-  std::vector<uint8_t> _data;
+  std::shared_ptr<std::vector<uint8_t>> _data{std::make_shared<std::vector<uint8_t>>()};
 };
 
 }  // namespace mercury
@@ -8,6 +8,7 @@
 #include "bindings/qjs/atomic_string.h"
 #include "bindings/qjs/binding_initializer.h"
 #include "core/dart_methods.h"
+#include "core/event/event_target.h"
 #include "core/module/global.h"
 #include "event_factory.h"
 #include "foundation/logging.h"
@@ -42,23 +43,29 @@ NativeValue* MercuryIsolate::invokeModuleEvent(SharedNativeString* native_module
   MemberMutationScope scope{context_};
 
   JSContext* ctx = context_->ctx();
-  Event* event = nullptr;
-  if (ptr != nullptr) {
-    std::string type = std::string(eventType);
-    auto* raw_event = static_cast<RawEvent*>(ptr);
-    event = EventFactory::Create(context_, AtomicString(ctx, type), raw_event);
-    delete raw_event;
-  }
-
-  ScriptValue extraObject = ScriptValue(ctx, const_cast<const NativeValue&>(*extra));
   AtomicString module_name = AtomicString(
       ctx, std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_module_name)));
   auto listener = context_->ModuleListeners()->listener(module_name);
+  auto* raw_event = static_cast<RawEvent*>(ptr);
 
+  // Without a listener nothing observes the event, so only release what Dart handed over.
   if (listener == nullptr) {
+    if (raw_event != nullptr) {
+      EventFactory::Discard(AtomicString(ctx, eventType), raw_event);
+      delete raw_event;
+    }
+    Native_FreeValue(*extra);
     return nullptr;
   }
 
+  Event* event = nullptr;
+  if (raw_event != nullptr) {
+    event = EventFactory::Create(context_, AtomicString(ctx, eventType), raw_event);
+    delete raw_event;
+  }
+
+  ScriptValue extraObject = ScriptValue(ctx, const_cast<const NativeValue&>(*extra));
+
   ScriptValue arguments[] = {event != nullptr ? event->ToValue() : ScriptValue::Empty(ctx), extraObject};
   ScriptValue result = listener->value()->Invoke(ctx, ScriptValue::Empty(ctx), 2, arguments);
   if (result.IsException()) {
@@ -78,6 +85,60 @@ NativeValue* MercuryIsolate::invokeModuleEvent(SharedNativeString* native_module
   return return_value;
 }
 
+int32_t MercuryIsolate::dispatchEventBatch(NativeEventDispatchRecord* records,
+                                           int32_t count,
+                                           EventDispatchResult* results) {
+  JSContext* ctx = context_->ctx();
+
+  // No event reaches a deactivated context. Still release what Dart handed over and report empty results.
+  if (!context_->IsContextValid()) {
+    for (int32_t i = 0; i < count; i++) {
+      AtomicString event_type = AtomicString(
+          ctx, std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(records[i].type)));
+      EventFactory::Discard(event_type, records[i].raw_event);
+      results[i] = EventDispatchResult{};
+    }
+    return 0;
+  }
+
+  MemberMutationScope scope{context_};
+  MicrotaskCheckpointDeferral microtask_checkpoint_deferral{context_};
+
+  JSValue dispatched_events = JS_NewArray(ctx);
+  uint32_t dispatched_count = 0;
+  int32_t dispatched = 0;
+
+  for (int32_t i = 0; i < count; i++) {
+    NativeEventDispatchRecord& record = records[i];
+    AtomicString event_type = AtomicString(
+        ctx, std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(record.type)));
+    auto* event_target =
+        record.target != nullptr ? DynamicTo<EventTarget>(BindingObject::From(record.target)) : nullptr;
+
+    if (event_target == nullptr || event_target->GetExecutingContext() != context_) {
+      EventFactory::Discard(event_type, record.raw_event);
+      results[i] = EventDispatchResult{};
+      continue;
+    }
+
+    Event* event = event_target->DispatchEventFromDart(event_type, record.raw_event, record.is_capture, &results[i]);
+    dispatched++;
+    if (event != nullptr) {
+      JS_SetPropertyUint32(ctx, dispatched_events, dispatched_count++, event->ToQuickJS());
+    }
+  }
+
+  // All the events of the batch share one wire.
+  if (dispatched_count > 0) {
+    int64_t wire = CreateDartWire(ScriptValue(ctx, dispatched_events));
+    for (int32_t i = 0; i < count; i++) {
+      results[i].wire = wire;
+    }
+  }
+  JS_FreeValue(ctx, dispatched_events);
+  return dispatched;
+}
+
 bool MercuryIsolate::evaluateScript(const SharedNativeString* script,
                               uint8_t** parsed_bytecodes,
                               uint64_t* bytecode_len,
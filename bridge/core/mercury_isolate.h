@@ -19,6 +19,8 @@ namespace mercury {
 
 class MercuryIsolate;
 class DartContext;
+struct NativeEventDispatchRecord;
+struct EventDispatchResult;
 
 using JSBridgeDisposeCallback = void (*)(MercuryIsolate* bridge);
 using ConsoleMessageHandler = std::function<void(void* ctx, const std::string& message, int logLevel)>;
@@ -62,6 +64,11 @@ class MercuryIsolate final {
                                  const char* eventType,
                                  void* event,
                                  NativeValue* extra);
+  // Dispatch |count| events from Dart in order, writing the outcome of each into |results|, with a single microtask
+  // checkpoint after the last one. The dispatched events share one wire, which Dart releases when done with them.
+  // Returns the number of events dispatched to their target. Records whose target is gone or belongs to another
+  // context are skipped with an empty result, and so are all of them when the context is no longer valid.
+  int32_t dispatchEventBatch(NativeEventDispatchRecord* records, int32_t count, EventDispatchResult* results);
   void reportError(const char* errmsg);
 
   int32_t contextId;
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include <chrono>
+#include "core/event/event.h"
+#include "core/event/event_target.h"
+#include "gtest/gtest.h"
+#include "mercury_isolate.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+static RawEvent* CreateRawEvent(EventTarget* target) {
+  auto* bytes = new uint64_t[sizeof(NativeEvent) / sizeof(int64_t)]{};
+  auto* native_event = reinterpret_cast<NativeEvent*>(bytes);
+  native_event->type = stringToNativeString("e").release();
+  native_event->target = target->bindingObject();
+  native_event->currentTarget = target->bindingObject();
+  auto* raw_event = new RawEvent();
+  raw_event->bytes = bytes;
+  raw_event->length = sizeof(NativeEvent) / sizeof(int64_t);
+  raw_event->is_custom_event = 0;
+  return raw_event;
+}
+
+// Dispatch |count| events one at a time, the way separate dispatchEvent calls from Dart do.
+static int64_t DispatchOneByOne(ExecutingContext* context, EventTarget* target, int count) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) {
+    MemberMutationScope scope{context};
+    mercury::EventDispatchResult result;
+    target->DispatchEventFromDart(AtomicString(context->ctx(), "e"), CreateRawEvent(target), false, &result);
+    context->DrainPendingPromiseJobs();
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int64_t DispatchBatched(MercuryIsolate* page, EventTarget* target, int count) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<mercury::NativeEventDispatchRecord> records(count);
+  std::vector<mercury::EventDispatchResult> results(count);
+  for (int i = 0; i < count; i++) {
+    records[i].target = target->bindingObject();
+    records[i].type = stringToNativeString("e").release();
+    records[i].raw_event = CreateRawEvent(target);
+  }
+  page->dispatchEventBatch(records.data(), count, results.data());
+  ReleaseDartWires(&results[0].wire, 1);
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(MercuryIsolate, DispatchEventBatch) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "3 3");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = std::string(R"(
+globalThis.target = new EventTarget();
+globalThis.received = 0;
+globalThis.checkpoints = 0;
+target.addEventListener('e', (event) => {
+  received++;
+  if (received == 2) event.preventDefault();
+  Promise.resolve().then(() => { if (received == 3) checkpoints++; });
+});
+)");
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  JSValue target_value = JS_GetPropertyStr(context->ctx(), context->GlobalObject(), "target");
+  auto* target = toScriptWrappable<EventTarget>(target_value);
+  JS_FreeValue(context->ctx(), target_value);
+
+  mercury::NativeEventDispatchRecord records[3];
+  mercury::EventDispatchResult results[3];
+  for (auto& record : records) {
+    record.target = target->bindingObject();
+    record.type = stringToNativeString("e").release();
+    record.raw_event = CreateRawEvent(target);
+  }
+  // Cancelable events only report preventDefault() if the raw event says so.
+  reinterpret_cast<NativeEvent*>(records[1].raw_event->bytes)->cancelable = 1;
+  EXPECT_EQ(env->page()->dispatchEventBatch(records, 3, results), 3);
+  EXPECT_EQ(results[0].canceled, false);
+  EXPECT_EQ(results[1].canceled, true);
+  EXPECT_EQ(results[2].canceled, false);
+
+  // The events of the batch share one wire, and releasing it again is a no-op.
+  EXPECT_NE(results[0].wire, 0);
+  EXPECT_EQ(results[0].wire, results[2].wire);
+  EXPECT_TRUE(IsDartWireAlive(results[0].wire));
+  EXPECT_EQ(ReleaseDartWires(&results[0].wire, 1), 1);
+  EXPECT_FALSE(IsDartWireAlive(results[0].wire));
+  EXPECT_EQ(ReleaseDartWires(&results[0].wire, 1), 0);
+
+  // All three promise reactions ran after the last listener, in the single checkpoint of the batch.
+  std::string log = "console.log(received, checkpoints);";
+  context->EvaluateJavaScript(log.c_str(), log.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+// Records without a live target are skipped and not counted as dispatched.
+TEST(MercuryIsolate, DispatchEventBatchSkipsRecordsWithoutTarget) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  auto context = env->page()->GetExecutingContext();
+  std::string code = "globalThis.target = new EventTarget(); target.addEventListener('e', () => {});";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  JSValue target_value = JS_GetPropertyStr(context->ctx(), context->GlobalObject(), "target");
+  auto* target = toScriptWrappable<EventTarget>(target_value);
+  JS_FreeValue(context->ctx(), target_value);
+
+  mercury::NativeEventDispatchRecord records[2];
+  mercury::EventDispatchResult results[2];
+  for (auto& record : records) {
+    record.type = stringToNativeString("e").release();
+    record.raw_event = CreateRawEvent(target);
+  }
+  records[0].target = nullptr;
+  records[1].target = target->bindingObject();
+  EXPECT_EQ(env->page()->dispatchEventBatch(records, 2, results), 1);
+  EXPECT_EQ(results[0].canceled, false);
+  EXPECT_NE(results[1].wire, 0);
+  ReleaseDartWires(&results[1].wire, 1);
+  EXPECT_EQ(errorCalled, false);
+}
+
+TEST(MercuryIsolate, DispatchEventBatchBenchmark) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {};
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = "globalThis.target = new EventTarget(); target.addEventListener('e', () => {});";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+  JSValue target_value = JS_GetPropertyStr(context->ctx(), context->GlobalObject(), "target");
+  auto* target = toScriptWrappable<EventTarget>(target_value);
+  JS_FreeValue(context->ctx(), target_value);
+
+  for (int count : {1000, 10000, 100000}) {
+    int64_t one_by_one = DispatchOneByOne(context, target, count);
+    int64_t batched = DispatchBatched(env->page(), target, count);
+    std::cout << count << " events: one by one " << one_by_one << "us, batched " << batched << "us" << std::endl;
+  }
+  EXPECT_EQ(errorCalled, false);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+// Implicit globals are stored by the Global wrapper like any other unknown property, not as own properties of the
+// global object.
+TEST(Global, GlobalVariablesResolveBeforeNamedProperties) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "1 false true undefined true false function");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = R"(
+implicitGlobal = 1;
+console.log(
+  implicitGlobal,
+  Object.getOwnPropertyNames(globalThis).indexOf('implicitGlobal') >= 0,
+  'implicitGlobal' in globalThis,
+  globalThis.notDefinedAnywhere,
+  typeof notDefinedAnywhere === 'undefined',
+  'notDefinedAnywhere' in globalThis,
+  typeof btoa
+);
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+TEST(Global, AssignEventHandlerAtGlobalScope) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "message false true");
+    logCalled = true;
+  };
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = R"(
+onmessage = (e) => console.log(e.type, Object.getOwnPropertyNames(globalThis).indexOf('onmessage') >= 0, typeof onmessage === 'function');
+dispatchEvent(new Event('message'));
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+// Global-variable-heavy code: feature checks for missing globals, prototype methods reached through the global object
+// and implicit globals written and read in a loop.
+TEST(Global, GlobalLookupBenchmark) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {};
+
+  auto context = env->page()->GetExecutingContext();
+  std::string code = R"(
+counter = 0;
+for (let i = 0; i < 1000000; i++) {
+  if (typeof requestIdleCallback === 'undefined' && typeof btoa === 'function') {
+    counter = counter + 1;
+  }
+  globalThis.missingFeature;
+}
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+}
@@ -20,6 +20,10 @@ NativeValue* handleInvokeModuleTransientCallback(void* ptr,
                                                  int32_t contextId,
                                                  const char* errmsg,
                                                  NativeValue* extra_data) {
+  // The context may already be disposed, check the id before touching anything it owns.
+  if (!isContextValid(contextId))
+    return nullptr;
+
   auto* moduleContext = static_cast<ModuleContext*>(ptr);
   ExecutingContext* context = moduleContext->context;
 
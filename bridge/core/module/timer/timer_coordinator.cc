@@ -42,6 +42,17 @@ void TimerCoordinator::forceStopTimeoutById(int32_t timer_id) {
   }
 }
 
+void TimerCoordinator::stopAllTimers(ExecutingContext* context) {
+  for (auto& entry : active_timers_) {
+    if (context->dartMethodPtr()->clearTimeout != nullptr) {
+      context->dartMethodPtr()->clearTimeout(context->contextId(), entry.first);
+    }
+    entry.second->Terminate();
+  }
+  active_timers_.clear();
+  terminated_timers.clear();
+}
+
 std::shared_ptr<Timer> TimerCoordinator::getTimerById(int32_t timer_id) {
   if (active_timers_.count(timer_id) == 0)
     return nullptr;
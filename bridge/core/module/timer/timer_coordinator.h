@@ -30,6 +30,8 @@ class TimerCoordinator {
   void removeTimeoutById(int32_t timer_id);
   // Force stop and remove a timer, even if it's still executing.
   void forceStopTimeoutById(int32_t timer_id);
+  // Cancel all active timers at the dart side and drop their callbacks.
+  void stopAllTimers(ExecutingContext* context);
 
   std::shared_ptr<Timer> getTimerById(int32_t timer_id);
 
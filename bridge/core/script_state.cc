@@ -10,8 +10,20 @@ namespace mercury {
 
 thread_local std::atomic<int32_t> runningContexts{0};
 
+#if ENABLE_CONTEXT_HEAP
+thread_local mi_heap_t* current_heap_{nullptr};
+
+mi_heap_t* ScriptState::CurrentHeap() {
+  return current_heap_;
+}
+#endif
+
 ScriptState::ScriptState(DartIsolateContext* dart_context) : dart_isolate_context_(dart_context) {
   runningContexts++;
+#if ENABLE_CONTEXT_HEAP
+  heap_ = mi_heap_new();
+  ContextHeapScope heap_scope{this};
+#endif
   // Avoid stack overflow when running in multiple threads.
   ctx_ = JS_NewContext(dart_isolate_context_->runtime());
   InitializeBuiltInStrings(ctx_);
@@ -21,14 +33,64 @@ JSRuntime* ScriptState::runtime() {
   return dart_isolate_context_->runtime();
 }
 
+#if ENABLE_CONTEXT_HEAP
+static bool AccumulateHeapArea(const mi_heap_t* heap,
+                               const mi_heap_area_t* area,
+                               void* block,
+                               size_t block_size,
+                               void* arg) {
+  *static_cast<size_t*>(arg) += area->used * area->block_size;
+  return true;
+}
+#endif
+
+size_t ScriptState::HeapUsage() const {
+#if ENABLE_CONTEXT_HEAP
+  size_t used = 0;
+  mi_heap_visit_blocks(heap_, false, AccumulateHeapArea, &used);
+  return used;
+#else
+  return 0;
+#endif
+}
+
 ScriptState::~ScriptState() {
   ctx_invalid_ = true;
   JSRuntime* rt = JS_GetRuntime(ctx_);
   JS_FreeContext(ctx_);
 
   // Run GC to clean up remaining objects about m_ctx;
-  JS_RunGC(rt);
+  if (collect_garbage_on_dispose_) {
+    JS_RunGC(rt);
+  }
+
+#if ENABLE_CONTEXT_HEAP
+  // Atoms, shapes and other runtime owned data may have been allocated while this context was entered and are still
+  // referenced by the shared JSRuntime, so the heap can not be destroyed outright. mi_heap_delete migrates the blocks
+  // that survived the GC to the default heap and releases all the pages of this context at once. The objects
+  // themselves are freed one by one by the GC above, or by a later one when it was skipped.
+  assert(current_heap_ != heap_);
+  mi_heap_delete(heap_);
+  heap_ = nullptr;
+#endif
 
   ctx_ = nullptr;
 }
+
+ContextHeapScope::ContextHeapScope(ScriptState* script_state) {
+#if ENABLE_CONTEXT_HEAP
+  runtime_ = script_state->runtime();
+  prev_heap_ = current_heap_;
+  current_heap_ = script_state->heap_;
+  JS_SetMallocHeap(runtime_, current_heap_);
+#endif
+}
+
+ContextHeapScope::~ContextHeapScope() {
+#if ENABLE_CONTEXT_HEAP
+  current_heap_ = prev_heap_;
+  JS_SetMallocHeap(runtime_, prev_heap_);
+#endif
+}
+
 }  // namespace mercury
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "script_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+// Creates and tears down 1,000 contexts holding 1,000 cyclic objects each. Reports the time spent creating and filling
+// a context and the time its teardown takes, which includes the runtime GC collecting its objects.
+TEST(ScriptState, CreateAndDispose1000Contexts) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* dart_isolate_context = env->page()->GetExecutingContext()->dartIsolateContext();
+  const char* fill = "globalThis.items = []; for (let i = 0; i < 1000; i++) { const o = { i }; o.self = o; items.push(o); }";
+
+  const int kContexts = 1000;
+  int64_t create_time = 0;
+  int64_t teardown_time = 0;
+  size_t heap_usage = 0;
+  for (int i = 0; i < kContexts; i++) {
+    auto start = std::chrono::steady_clock::now();
+    auto* script_state = new ScriptState(dart_isolate_context);
+    {
+      ContextHeapScope heap_scope{script_state};
+      JSValue result = JS_Eval(script_state->ctx(), fill, strlen(fill), "vm://", JS_EVAL_TYPE_GLOBAL);
+      EXPECT_FALSE(JS_IsException(result));
+      JS_FreeValue(script_state->ctx(), result);
+    }
+    heap_usage = std::max(heap_usage, script_state->HeapUsage());
+    auto created = std::chrono::steady_clock::now();
+    delete script_state;
+    auto deleted = std::chrono::steady_clock::now();
+
+    create_time += std::chrono::duration_cast<std::chrono::microseconds>(created - start).count();
+    teardown_time += std::chrono::duration_cast<std::chrono::microseconds>(deleted - created).count();
+  }
+
+#if ENABLE_CONTEXT_HEAP
+  EXPECT_GT(heap_usage, 0);
+#else
+  EXPECT_EQ(heap_usage, 0);
+#endif
+  std::cout << kContexts << " contexts: create " << create_time / kContexts << "us, teardown "
+            << teardown_time / kContexts << "us per context, heap usage " << heap_usage << " bytes" << std::endl;
+}
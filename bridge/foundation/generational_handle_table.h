@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_GENERATIONAL_HANDLE_TABLE_H_
+#define BRIDGE_FOUNDATION_GENERATIONAL_HANDLE_TABLE_H_
+
+#include <atomic>
+#include <cinttypes>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include "foundation/macros.h"
+
+namespace mercury {
+
+// A table of slots addressed by handles which pack a slot index and a generation into a positive int32_t, so they
+// can be passed through the Dart FFI boundary as plain ids.
+//
+// Every time a slot is released its generation is bumped, which makes all the handles given out for the previous
+// occupant stale: Lookup() returns an empty value for them instead of the new occupant.
+//
+// Slots live in fixed-size chunks which are never moved or freed while the table is alive, so Lookup() is lock free
+// and may run concurrently with Allocate()/Release() from other threads. Allocate() and Release() are O(1) and take
+// a mutex.
+//
+// Released slots wait in a FIFO queue and are only reused once kMinimumFreeSlots of them are queued, so a slot is
+// reused at most once every kMinimumFreeSlots + 1 allocations. Its generation wraps around after 2^kGenerationBits
+// reuses, which makes a handle value come back no earlier than (kMinimumFreeSlots + 1) * 2^kGenerationBits
+// allocations, about 134 million, after it was released. The table hands out handles without a lifetime limit and
+// at most 2^kIndexBits - kMinimumFreeSlots of them are live at once.
+template <typename T>
+class GenerationalHandleTable {
+  static_assert(std::is_trivially_copyable<T>::value, "GenerationalHandleTable values must be trivially copyable.");
+
+ public:
+  static constexpr int32_t kIndexBits = 18;
+  static constexpr int32_t kGenerationBits = 31 - kIndexBits;
+  static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+  static constexpr uint32_t kGenerationMask = (1u << kGenerationBits) - 1;
+  static constexpr uint32_t kChunkBits = 10;
+  static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+  static constexpr uint32_t kMaxChunks = (1u << kIndexBits) / kChunkSize;
+  static constexpr size_t kMinimumFreeSlots = 16384;
+  static constexpr int32_t kInvalidHandle = -1;
+
+  GenerationalHandleTable() {
+    for (auto& chunk : chunks_) {
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  ~GenerationalHandleTable() {
+    for (auto& chunk : chunks_) {
+      delete[] chunk.load(std::memory_order_relaxed);
+    }
+  }
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(GenerationalHandleTable);
+
+  // Take a free slot and store |value| in it. Returns kInvalidHandle when all the slots are in use.
+  int32_t Allocate(T value) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    uint32_t index;
+    if (free_slots_.size() > kMinimumFreeSlots) {
+      index = free_slots_.front();
+      free_slots_.pop_front();
+    } else {
+      if (UNLIKELY(next_index_ > kIndexMask))
+        return kInvalidHandle;
+      index = next_index_++;
+      uint32_t chunk_index = index >> kChunkBits;
+      if (chunks_[chunk_index].load(std::memory_order_relaxed) == nullptr) {
+        chunks_[chunk_index].store(new Slot[kChunkSize], std::memory_order_release);
+      }
+    }
+    Slot& slot = SlotAt(index);
+    slot.value.store(value, std::memory_order_relaxed);
+    uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+    // Publish the value before marking the slot live.
+    slot.live.store(true, std::memory_order_release);
+    return static_cast<int32_t>((generation << kIndexBits) | index);
+  }
+
+  // Replace the value of a live slot. Returns false if the handle is stale.
+  bool Set(int32_t handle, T value) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Slot* slot = Resolve(handle);
+    if (slot == nullptr)
+      return false;
+    slot->value.store(value, std::memory_order_release);
+    return true;
+  }
+
+  // Release the slot of |handle|, making the handle and all its copies stale. Returns false if it already was.
+  bool Release(int32_t handle) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Slot* slot = Resolve(handle);
+    if (slot == nullptr)
+      return false;
+    slot->live.store(false, std::memory_order_release);
+    uint32_t generation = (slot->generation.load(std::memory_order_relaxed) + 1) & kGenerationMask;
+    slot->generation.store(generation, std::memory_order_release);
+    slot->value.store(T{}, std::memory_order_relaxed);
+    free_slots_.push_back(static_cast<uint32_t>(handle) & kIndexMask);
+    return true;
+  }
+
+  // Lock free. Returns T{} for stale or malformed handles.
+  T Lookup(int32_t handle) const {
+    const Slot* slot = Resolve(handle);
+    if (slot == nullptr)
+      return T{};
+    T value = slot->value.load(std::memory_order_acquire);
+    // The slot may have been released while the value was read.
+    if (!IsSlotOwnedBy(*slot, handle))
+      return T{};
+    return value;
+  }
+
+  bool IsValid(int32_t handle) const { return Resolve(handle) != nullptr; }
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> generation{0};
+    std::atomic<bool> live{false};
+    std::atomic<T> value{T{}};
+  };
+
+  static bool IsSlotOwnedBy(const Slot& slot, int32_t handle) {
+    uint32_t generation = (static_cast<uint32_t>(handle) >> kIndexBits) & kGenerationMask;
+    return slot.live.load(std::memory_order_acquire) &&
+           slot.generation.load(std::memory_order_acquire) == generation;
+  }
+
+  Slot& SlotAt(uint32_t index) const {
+    return chunks_[index >> kChunkBits].load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+  }
+
+  Slot* Resolve(int32_t handle) const {
+    if (UNLIKELY(handle < 0))
+      return nullptr;
+    uint32_t index = static_cast<uint32_t>(handle) & kIndexMask;
+    Slot* chunk = chunks_[index >> kChunkBits].load(std::memory_order_acquire);
+    if (chunk == nullptr)
+      return nullptr;
+    Slot* slot = &chunk[index & (kChunkSize - 1)];
+    return IsSlotOwnedBy(*slot, handle) ? slot : nullptr;
+  }
+
+  std::atomic<Slot*> chunks_[kMaxChunks];
+  std::mutex mutex_;
+  std::deque<uint32_t> free_slots_;
+  uint32_t next_index_{0};
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_GENERATIONAL_HANDLE_TABLE_H_
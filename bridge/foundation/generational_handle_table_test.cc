@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "generational_handle_table.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+TEST(GenerationalHandleTable, StaleHandleDoesNotResolveToNewOccupant) {
+  GenerationalHandleTable<int*> table;
+  int first = 1;
+  int second = 2;
+  int32_t handle = table.Allocate(&first);
+  EXPECT_GE(handle, 0);
+  EXPECT_EQ(table.Lookup(handle), &first);
+  EXPECT_TRUE(table.Release(handle));
+  EXPECT_FALSE(table.Release(handle));
+  EXPECT_EQ(table.Lookup(handle), nullptr);
+
+  // Force the released slot to be reused.
+  std::vector<int32_t> handles;
+  for (size_t i = 0; i < GenerationalHandleTable<int*>::kMinimumFreeSlots; i++) {
+    int32_t h = table.Allocate(&second);
+    handles.emplace_back(h);
+    table.Release(h);
+  }
+  int32_t reused = table.Allocate(&second);
+  EXPECT_EQ(reused & GenerationalHandleTable<int*>::kIndexMask, handle & GenerationalHandleTable<int*>::kIndexMask);
+  EXPECT_NE(reused, handle);
+  EXPECT_EQ(table.Lookup(handle), nullptr);
+  EXPECT_EQ(table.Lookup(reused), &second);
+  EXPECT_FALSE(table.Set(handle, &first));
+  EXPECT_EQ(table.Lookup(reused), &second);
+}
+
+TEST(GenerationalHandleTable, RecycleSlotAfterGenerationWraps) {
+  using Table = GenerationalHandleTable<int*>;
+  Table table;
+  int value = 0;
+  int32_t first = table.Allocate(&value);
+  table.Release(first);
+
+  // The slot is reused every kMinimumFreeSlots + 1 allocations and its generation wraps after 2^kGenerationBits
+  // reuses. The handle value comes back once, and the table never runs out of handles.
+  int64_t window = int64_t(Table::kMinimumFreeSlots + 1) << Table::kGenerationBits;
+  int64_t allocations = 0;
+  int32_t handle;
+  do {
+    handle = table.Allocate(&value);
+    ASSERT_NE(handle, Table::kInvalidHandle);
+    allocations++;
+    table.Release(handle);
+  } while (handle != first && allocations <= window);
+  EXPECT_EQ(handle, first);
+  EXPECT_EQ(allocations, window);
+}
+
+TEST(GenerationalHandleTable, RejectMalformedHandles) {
+  GenerationalHandleTable<int*> table;
+  EXPECT_EQ(table.Lookup(-1), nullptr);
+  EXPECT_EQ(table.Lookup(0), nullptr);
+  EXPECT_EQ(table.Lookup(INT32_MAX), nullptr);
+  EXPECT_FALSE(table.Release(12345));
+}
+
+TEST(GenerationalHandleTable, ChurnBenchmark) {
+  GenerationalHandleTable<int*> table;
+  int value = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000000; i++) {
+    int32_t handle = table.Allocate(&value);
+    ASSERT_EQ(table.Lookup(handle), &value);
+    table.Release(handle);
+  }
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "1M allocate/lookup/release: " << elapsed << "ms" << std::endl;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_GENERATIONAL_SLAB_H_
+#define BRIDGE_FOUNDATION_GENERATIONAL_SLAB_H_
+
+#include <cinttypes>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "foundation/macros.h"
+
+namespace mercury {
+
+// A single threaded slab of values addressed by 64-bit handles which pack a slot index and a generation, so they can
+// be handed to Dart as plain integers.
+//
+// Removing a value bumps the generation of its slot, which makes every handle given out for it stale: Get() returns
+// nullptr and Remove() does nothing for them, even after the slot is reused. Slots live in a deque, so values are
+// never moved once inserted. Unlike GenerationalHandleTable, values may own resources and are destroyed on removal.
+template <typename T>
+class GenerationalSlab {
+ public:
+  using Handle = int64_t;
+  static constexpr Handle kInvalidHandle = 0;
+
+  GenerationalSlab() = default;
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(GenerationalSlab);
+
+  Handle Insert(T&& value) {
+    uint32_t index;
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      index = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    Slot& slot = slots_[index];
+    slot.value = std::move(value);
+    slot.live = true;
+    live_count_++;
+    return (static_cast<Handle>(slot.generation) << 32) | index;
+  }
+
+  T* Get(Handle handle) {
+    Slot* slot = Resolve(handle);
+    return slot != nullptr ? &slot->value : nullptr;
+  }
+
+  bool Contains(Handle handle) const { return const_cast<GenerationalSlab*>(this)->Resolve(handle) != nullptr; }
+
+  // Destroy the value of |handle|. Returns false if the handle is stale.
+  bool Remove(Handle handle) {
+    Slot* slot = Resolve(handle);
+    if (slot == nullptr)
+      return false;
+    slot->value = T();
+    slot->live = false;
+    // Generation 0 is never handed out, so kInvalidHandle never resolves.
+    if (++slot->generation == 0)
+      slot->generation = 1;
+    free_slots_.push_back(static_cast<uint32_t>(handle));
+    live_count_--;
+    return true;
+  }
+
+  // Remove a batch of handles at once, skipping stale and duplicated ones. Returns the number of values removed.
+  size_t RemoveAll(const Handle* handles, size_t count) {
+    size_t removed = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (Remove(handles[i]))
+        removed++;
+    }
+    return removed;
+  }
+
+  // Destroy every value. Handles given out before are not tracked anymore and must be dropped as well.
+  void Clear() {
+    slots_.clear();
+    free_slots_.clear();
+    live_count_ = 0;
+  }
+
+  size_t size() const { return live_count_; }
+
+ private:
+  struct Slot {
+    T value{};
+    uint32_t generation{1};
+    bool live{false};
+  };
+
+  Slot* Resolve(Handle handle) {
+    auto index = static_cast<uint32_t>(handle);
+    auto generation = static_cast<uint32_t>(static_cast<uint64_t>(handle) >> 32);
+    if (UNLIKELY(index >= slots_.size()))
+      return nullptr;
+    Slot& slot = slots_[index];
+    return slot.live && slot.generation == generation ? &slot : nullptr;
+  }
+
+  std::deque<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  size_t live_count_{0};
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_GENERATIONAL_SLAB_H_
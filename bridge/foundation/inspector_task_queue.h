@@ -23,11 +23,6 @@ class InspectorTaskQueue : public TaskQueue {
     }
     return instance_;
   };
-  int32_t registerTask(const Task& task, void* data) override {
-    int32_t taskId = TaskQueue::registerTask(task, data);
-    return taskId;
-  }
-
  private:
   int32_t m_contextId{-1};
   static std::mutex inspector_task_creation_mutex_;
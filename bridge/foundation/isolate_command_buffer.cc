@@ -45,8 +45,132 @@ void IsolateCommandBuffer::addCommand(const IsolateCommandItem& item, bool reque
   }
 #endif
 
+  if (cancelPairedCommands(item)) {
+    return;
+  }
+
   buffer_[size_] = item;
   size_++;
+  if (item.type == static_cast<int32_t>(IsolateCommand::kSetProperty)) {
+    deferred_writes_++;
+  }
+  trackCommand(size_ - 1);
+}
+
+static const int32_t kCancelledCommand = -1;
+
+static bool IsSameListener(const IsolateCommandItem& add_item, const IsolateCommandItem& remove_item) {
+  auto* options = reinterpret_cast<DartEventListenerOptions*>(add_item.nativePtr2);
+  bool add_capture = options != nullptr && options->capture;
+  bool remove_capture = remove_item.nativePtr2 == 0x01;
+  return add_capture == remove_capture && add_item.args_01_length == remove_item.args_01_length &&
+         memcmp(reinterpret_cast<const uint16_t*>(add_item.string_01),
+                reinterpret_cast<const uint16_t*>(remove_item.string_01),
+                sizeof(uint16_t) * add_item.args_01_length) == 0;
+}
+
+bool IsolateCommandBuffer::cancelPairedCommands(const IsolateCommandItem& item) {
+  auto type = static_cast<IsolateCommand>(item.type);
+  if (type == IsolateCommand::kDisposeBindingObject) {
+    // The address may be reused by an object created later in this batch.
+    pending_listeners_.erase(item.nativePtr);
+
+    auto created = created_objects_.find(item.nativePtr);
+    if (created == created_objects_.end())
+      return false;
+
+    // Dart never saw this object, so native owns its NativeBindingObject.
+    for (int64_t index : created->second) {
+      cancelCommand(index);
+    }
+    created_objects_.erase(created);
+    dart_free(reinterpret_cast<void*>(item.nativePtr));
+    return true;
+  }
+
+  if (type == IsolateCommand::kRemoveEvent) {
+    auto pending = pending_listeners_.find(item.nativePtr);
+    if (pending == pending_listeners_.end())
+      return false;
+
+    auto& indices = pending->second;
+    for (auto it = indices.begin(); it != indices.end(); it++) {
+      if (!IsSameListener(buffer_[*it], item))
+        continue;
+      cancelCommand(*it);
+      indices.erase(it);
+      dart_free(reinterpret_cast<void*>(item.string_01));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void IsolateCommandBuffer::trackCommand(int64_t index) {
+  const IsolateCommandItem& item = buffer_[index];
+  auto type = static_cast<IsolateCommand>(item.type);
+  if (type == IsolateCommand::kCreateEventTarget) {
+    created_objects_[item.nativePtr] = {index};
+    return;
+  }
+
+  if (type == IsolateCommand::kAddEvent) {
+    pending_listeners_[item.nativePtr].emplace_back(index);
+  }
+
+  auto created = created_objects_.find(item.nativePtr);
+  if (created != created_objects_.end()) {
+    created->second.emplace_back(index);
+  }
+}
+
+void IsolateCommandBuffer::cancelCommand(int64_t index) {
+  IsolateCommandItem& item = buffer_[index];
+  if (item.type == kCancelledCommand)
+    return;
+
+  // Free what Dart would have freed or taken over.
+  if (item.string_01 != 0) {
+    dart_free(reinterpret_cast<void*>(item.string_01));
+  }
+  switch (static_cast<IsolateCommand>(item.type)) {
+    case IsolateCommand::kAddEvent:
+      dart_free(reinterpret_cast<void*>(item.nativePtr2));
+      break;
+    case IsolateCommand::kSetProperty: {
+      auto* value = reinterpret_cast<NativeValue*>(item.nativePtr2);
+      Native_FreeValue(*value);
+      dart_free(value);
+      deferred_writes_--;
+      break;
+    }
+    default:
+      break;
+  }
+
+  item = IsolateCommandItem();
+  item.type = kCancelledCommand;
+  cancelled_commands_++;
+}
+
+void IsolateCommandBuffer::removeCancelledCommands() {
+  if (cancelled_commands_ == 0)
+    return;
+
+  int64_t kept = 0;
+  for (int64_t i = 0; i < size_; i++) {
+    if (buffer_[i].type != kCancelledCommand) {
+      buffer_[kept++] = buffer_[i];
+    }
+  }
+  size_ = kept;
+  cancelled_commands_ = 0;
+
+  // Indices remembered during the batch moved.
+  batch_id_++;
+  created_objects_.clear();
+  pending_listeners_.clear();
 }
 
 IsolateCommandItem* IsolateCommandBuffer::data() {
@@ -58,13 +182,18 @@ int64_t IsolateCommandBuffer::size() {
 }
 
 bool IsolateCommandBuffer::empty() {
-  return size_ == 0;
+  return size_ == cancelled_commands_;
 }
 
 void IsolateCommandBuffer::clear() {
   size_ = 0;
   memset(buffer_, 0, sizeof(buffer_));
   update_batched_ = false;
+  deferred_writes_ = 0;
+  batch_id_++;
+  created_objects_.clear();
+  pending_listeners_.clear();
+  cancelled_commands_ = 0;
 }
 
 }  // namespace mercury
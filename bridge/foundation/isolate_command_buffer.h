@@ -7,6 +7,8 @@
 #define BRIDGE_FOUNDATION_ISOLATE_COMMAND_BUFFER_H_
 
 #include <cinttypes>
+#include <unordered_map>
+#include <vector>
 #include "bindings/qjs/native_string_utils.h"
 #include "native_value.h"
 
@@ -20,10 +22,22 @@ enum class IsolateCommand {
   kDisposeBindingObject,
   kAddEvent,
   kRemoveEvent,
+  // A binding property write deferred by write coalescing. nativePtr2 owns the NativeValue to set.
+  kSetProperty,
 };
 
 #define MAXIMUM_ISOLATE_COMMAND_SIZE 2048
 
+// The options of kAddEvent, pointed to by nativePtr2.
+struct DartEventListenerOptions : public DartReadable {
+  bool capture{false};
+};
+
+struct DartAddEventListenerOptions : public DartEventListenerOptions {
+  bool passive{false};
+  bool once{false};
+};
+
 struct IsolateCommandItem {
   IsolateCommandItem() = default;
   explicit IsolateCommandItem(int32_t type, SharedNativeString* args_01, void* nativePtr, void* nativePtr2)
@@ -54,13 +68,36 @@ class IsolateCommandBuffer {
   bool empty();
   void clear();
 
+  // Whether deferred binding property writes wait in this batch. Dart must receive them before any synchronous call.
+  bool HasDeferredWrites() const { return deferred_writes_ > 0; }
+  // Changes on every clear(), so command indices remembered during a batch are not mistaken for ones of a later batch.
+  int64_t batchId() const { return batch_id_; }
+
+  // Commands cancelled by the peephole pass stay in place during the batch, so command indices stay stable. Remove
+  // them before the commands are handed to Dart. This ends the peephole pass and changes the batch id.
+  void removeCancelledCommands();
+
  private:
   void addCommand(const IsolateCommandItem& item, bool request_isolate_update = true);
+  // Peephole pass over the batch. A kDisposeBindingObject of an object created in the same batch cancels every command
+  // of that object, and a kRemoveEvent cancels the kAddEvent of the same listener added in the same batch. Returns
+  // true when |item| was cancelled too and must not be added.
+  bool cancelPairedCommands(const IsolateCommandItem& item);
+  void trackCommand(int64_t index);
+  void cancelCommand(int64_t index);
+
+  // Indices of the commands of every object created in this batch, starting with its kCreateEventTarget.
+  std::unordered_map<int64_t, std::vector<int64_t>> created_objects_;
+  // Indices of the kAddEvent commands of this batch which were not removed yet, per object.
+  std::unordered_map<int64_t, std::vector<int64_t>> pending_listeners_;
+  int64_t cancelled_commands_{0};
 
   ExecutingContext* context_{nullptr};
   IsolateCommandItem* buffer_{nullptr};
   bool update_batched_{false};
   int64_t size_{0};
+  int64_t deferred_writes_{0};
+  int64_t batch_id_{0};
   int64_t max_size_{MAXIMUM_ISOLATE_COMMAND_SIZE};
 };
 
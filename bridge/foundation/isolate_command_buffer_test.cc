@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "isolate_command_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "core/binding_object.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+namespace {
+
+std::unique_ptr<SharedNativeString> NewEventType(const std::string& type) {
+  auto* chars = static_cast<uint16_t*>(dart_malloc(sizeof(uint16_t) * type.size()));
+  std::copy(type.begin(), type.end(), chars);
+  return std::make_unique<SharedNativeString>(chars, type.size());
+}
+
+DartAddEventListenerOptions* NewListenerOptions(bool capture) {
+  auto* options = new DartAddEventListenerOptions{};
+  options->capture = capture;
+  return options;
+}
+
+NativeValue* NewPendingValue(NativeValue value) {
+  auto* pending_value = static_cast<NativeValue*>(dart_malloc(sizeof(NativeValue)));
+  *pending_value = value;
+  return pending_value;
+}
+
+void* Capture(bool capture) {
+  return capture ? reinterpret_cast<void*>(0x01) : nullptr;
+}
+
+// Hand the batch over the way Dart reads it, and release what Dart would release.
+std::vector<IsolateCommand> Deliver(IsolateCommandBuffer* buffer) {
+  buffer->removeCancelledCommands();
+  std::vector<IsolateCommand> delivered;
+  for (int64_t i = 0; i < buffer->size(); i++) {
+    const IsolateCommandItem& item = buffer->data()[i];
+    auto type = static_cast<IsolateCommand>(item.type);
+    delivered.emplace_back(type);
+    if (item.string_01 != 0)
+      dart_free(reinterpret_cast<void*>(item.string_01));
+    if (type == IsolateCommand::kAddEvent)
+      dart_free(reinterpret_cast<void*>(item.nativePtr2));
+    if (type == IsolateCommand::kSetProperty) {
+      Native_FreeValue(*reinterpret_cast<NativeValue*>(item.nativePtr2));
+      dart_free(reinterpret_cast<void*>(item.nativePtr2));
+    }
+    if (type == IsolateCommand::kDisposeBindingObject)
+      dart_free(reinterpret_cast<void*>(item.nativePtr));
+  }
+  buffer->clear();
+  return delivered;
+}
+
+IsolateCommandBuffer* EmptyBuffer(ExecutingContext* context) {
+  auto* buffer = context->isolateCommandBuffer();
+  Deliver(buffer);
+  return buffer;
+}
+
+}  // namespace
+
+TEST(IsolateCommandBuffer, CreateThenDisposeCancelsEveryCommandOfTheObject) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* buffer = EmptyBuffer(env->page()->GetExecutingContext());
+
+  auto* kept = new NativeBindingObject(nullptr);
+  auto* temporary = new NativeBindingObject(nullptr);
+  buffer->addCommand(IsolateCommand::kCreateEventTarget, NewEventType("Kept"), kept, nullptr);
+  buffer->addCommand(IsolateCommand::kCreateEventTarget, NewEventType("Temporary"), temporary, nullptr);
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("click"), temporary, NewListenerOptions(false));
+  buffer->addCommand(IsolateCommand::kSetProperty, NewEventType("value"), temporary,
+                     NewPendingValue(Native_NewInt64(1)));
+  EXPECT_TRUE(buffer->HasDeferredWrites());
+  buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, temporary, nullptr);
+
+  EXPECT_FALSE(buffer->HasDeferredWrites());
+  EXPECT_FALSE(buffer->empty());
+  auto delivered = Deliver(buffer);
+  ASSERT_EQ(delivered.size(), 1);
+  EXPECT_EQ(delivered[0], IsolateCommand::kCreateEventTarget);
+
+  // Objects Dart already knows are disposed through Dart.
+  buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, kept, nullptr);
+  delivered = Deliver(buffer);
+  ASSERT_EQ(delivered.size(), 1);
+  EXPECT_EQ(delivered[0], IsolateCommand::kDisposeBindingObject);
+}
+
+TEST(IsolateCommandBuffer, AddThenRemoveCancelsTheSameListenerOnly) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* buffer = EmptyBuffer(env->page()->GetExecutingContext());
+  auto* target = new NativeBindingObject(nullptr);
+
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("click"), target, NewListenerOptions(false));
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("click"), target, NewListenerOptions(true));
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("input"), target, NewListenerOptions(false));
+  // Removes the bubbling click listener, but neither the capturing one nor the input one.
+  buffer->addCommand(IsolateCommand::kRemoveEvent, NewEventType("click"), target, Capture(false));
+  // Dart knows the scroll listener from an earlier batch.
+  buffer->addCommand(IsolateCommand::kRemoveEvent, NewEventType("scroll"), target, Capture(false));
+
+  auto delivered = Deliver(buffer);
+  std::vector<IsolateCommand> expected = {IsolateCommand::kAddEvent, IsolateCommand::kAddEvent,
+                                          IsolateCommand::kRemoveEvent};
+  EXPECT_EQ(delivered, expected);
+
+  // Removing then adding again must reach Dart in order.
+  buffer->addCommand(IsolateCommand::kRemoveEvent, NewEventType("input"), target, Capture(false));
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("input"), target, NewListenerOptions(false));
+  delivered = Deliver(buffer);
+  expected = {IsolateCommand::kRemoveEvent, IsolateCommand::kAddEvent};
+  EXPECT_EQ(delivered, expected);
+
+  buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, target, nullptr);
+  Deliver(buffer);
+}
+
+TEST(IsolateCommandBuffer, ReusedAddressIsNotMistakenForDisposedObject) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* buffer = EmptyBuffer(env->page()->GetExecutingContext());
+  auto* target = new NativeBindingObject(nullptr);
+
+  // Dart knows |target|. Its listener is added and the object disposed in this batch, then a new object is created
+  // at the same address.
+  buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("click"), target, NewListenerOptions(false));
+  buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, target, nullptr);
+  buffer->addCommand(IsolateCommand::kCreateEventTarget, NewEventType("Reused"), target, nullptr);
+  buffer->addCommand(IsolateCommand::kRemoveEvent, NewEventType("click"), target, Capture(false));
+
+  auto delivered = Deliver(buffer);
+  std::vector<IsolateCommand> expected = {IsolateCommand::kAddEvent, IsolateCommand::kDisposeBindingObject,
+                                          IsolateCommand::kCreateEventTarget, IsolateCommand::kRemoveEvent};
+  EXPECT_EQ(delivered, expected);
+}
+
+// Allocation churn: each frame creates 1000 event targets with a listener, of which 900 are collected and 100 survive,
+// and toggles a listener on each survivor. Counts the commands Dart receives.
+TEST(IsolateCommandBuffer, AllocationChurnBenchmark) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* buffer = EmptyBuffer(env->page()->GetExecutingContext());
+
+  const int kFrames = 100;
+  const int kObjectsPerFrame = 1000;
+  int64_t emitted = 0;
+  int64_t delivered = 0;
+  std::vector<NativeBindingObject*> survivors;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    std::vector<NativeBindingObject*> objects;
+    for (int i = 0; i < kObjectsPerFrame; i++) {
+      auto* object = new NativeBindingObject(nullptr);
+      buffer->addCommand(IsolateCommand::kCreateEventTarget, NewEventType("Div"), object, nullptr);
+      buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("click"), object, NewListenerOptions(false));
+      emitted += 2;
+      objects.emplace_back(object);
+    }
+    for (int i = 0; i < kObjectsPerFrame; i++) {
+      if (i % 10 == 0) {
+        survivors.emplace_back(objects[i]);
+        buffer->addCommand(IsolateCommand::kAddEvent, NewEventType("input"), objects[i], NewListenerOptions(false));
+        buffer->addCommand(IsolateCommand::kRemoveEvent, NewEventType("input"), objects[i], Capture(false));
+        emitted += 2;
+      } else {
+        buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, objects[i], nullptr);
+        emitted++;
+      }
+    }
+    delivered += Deliver(buffer).size();
+  }
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  // Only the creation and the click listener of every survivor are left.
+  EXPECT_EQ(delivered, int64_t(kFrames) * kObjectsPerFrame / 10 * 2);
+  std::cout << emitted << " commands emitted, " << delivered << " delivered to Dart, " << elapsed << "us" << std::endl;
+
+  for (auto* survivor : survivors) {
+    buffer->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, survivor, nullptr);
+  }
+  Deliver(buffer);
+}
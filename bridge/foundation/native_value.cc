@@ -142,4 +142,31 @@ NativeValue Native_NewJSON(JSContext* ctx, const ScriptValue& value, ExceptionSt
 #endif
 }
 
+void Native_FreeValue(const NativeValue& native_value) {
+  switch (native_value.tag) {
+    case NativeTag::TAG_STRING:
+      delete static_cast<AutoFreeNativeString*>(native_value.u.ptr);
+      break;
+    case NativeTag::TAG_JSON:
+      delete static_cast<const char*>(native_value.u.ptr);
+      break;
+    case NativeTag::TAG_UINT8_BYTES:
+#if WIN32
+      CoTaskMemFree(native_value.u.ptr);
+#else
+      free(native_value.u.ptr);
+#endif
+      break;
+    case NativeTag::TAG_LIST: {
+      auto* arr = static_cast<NativeValue*>(native_value.u.ptr);
+      for (uint32_t i = 0; i < native_value.uint32; i++) {
+        Native_FreeValue(arr[i]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 }  // namespace mercury
@@ -78,6 +78,10 @@ NativeValue Native_NewList(uint32_t argc, NativeValue* argv);
 NativeValue Native_NewPtr(JSPointerType pointerType, void* ptr);
 NativeValue Native_NewJSON(JSContext* ctx, const ScriptValue& value, ExceptionState& exception_state);
 
+// Release the memory owned by a NativeValue received from Dart which is dropped without being converted into a
+// JSValue. Converting a value takes over the same memory, so call one or the other, never both.
+void Native_FreeValue(const NativeValue& native_value);
+
 }  // namespace mercury
 
 #endif  // BRIDGE_NATIVE_VALUE_H
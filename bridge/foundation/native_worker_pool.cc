@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_worker_pool.h"
+#include <algorithm>
+
+namespace mercury {
+
+NativeWorkerPool* NativeWorkerPool::Shared() {
+  // Never destroyed: jobs may still be running while the process exits.
+  static auto* pool = new NativeWorkerPool(std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4));
+  return pool;
+}
+
+NativeWorkerPool::NativeWorkerPool(size_t thread_count) {
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back([this]() { WorkerMain(); });
+  }
+}
+
+NativeWorkerPool::~NativeWorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    shutdown_ = true;
+  }
+  condition_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void NativeWorkerPool::PostJob(Job&& job) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    jobs_.emplace_back(std::move(job));
+  }
+  condition_.notify_one();
+}
+
+void NativeWorkerPool::WorkerMain() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return shutdown_ || !jobs_.empty(); });
+      if (jobs_.empty())
+        return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+}  // namespace mercury
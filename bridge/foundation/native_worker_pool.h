@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_NATIVE_WORKER_POOL_H_
+#define BRIDGE_FOUNDATION_NATIVE_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "foundation/macros.h"
+
+namespace mercury {
+
+// A process wide pool of native threads for CPU heavy work of built-ins, such as encoding the bytes of a large Blob.
+// Jobs must be pure native code: they can not touch any JSValue, ScriptWrappable or ExecutingContext. Use
+// ExecutingContext::PostNativeWork() to get back to the JS thread with the result.
+class NativeWorkerPool {
+ public:
+  using Job = std::function<void()>;
+
+  static NativeWorkerPool* Shared();
+
+  explicit NativeWorkerPool(size_t thread_count);
+  ~NativeWorkerPool();
+  MERCURY_DISALLOW_COPY_ASSIGN_AND_MOVE(NativeWorkerPool);
+
+  void PostJob(Job&& job);
+  size_t ThreadCount() const { return threads_.size(); }
+
+ private:
+  void WorkerMain();
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<Job> jobs_;
+  bool shutdown_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_NATIVE_WORKER_POOL_H_
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_worker_pool.h"
+#include <modp_b64/modp_b64.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/dart_isolate_context.h"
+#include "core/executing_context.h"
+#include "core/mercury_isolate.h"
+#include "gtest/gtest.h"
+#include "include/mercury_bridge.h"
+#include "mercury_test_env.h"
+
+using namespace mercury;
+
+namespace {
+
+const size_t kBlobSize = 100 * 1024 * 1024;
+
+std::string EncodeBase64(const std::vector<uint8_t>& bytes) {
+  std::string buffer;
+  buffer.resize(modp_b64_encode_data_len(bytes.size()));
+  modp_b64_encode_data(buffer.data(), reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  return buffer;
+}
+
+// Simulates the JS thread event loop: returns the longest time one turn of the loop was blocked.
+template <typename Callback>
+int64_t LongestTurn(Callback&& turn, const std::atomic<bool>& done) {
+  int64_t longest = 0;
+  while (!done.load()) {
+    auto start = std::chrono::steady_clock::now();
+    turn();
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    longest = std::max<int64_t>(longest, elapsed);
+  }
+  return longest;
+}
+
+}  // namespace
+
+TEST(NativeWorkerPool, RunAllJobs) {
+  NativeWorkerPool pool(4);
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 1000; i++) {
+    pool.PostJob([&counter]() { counter++; });
+  }
+  while (counter.load() < 1000) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(NativeWorkerPool, JSThreadResponsivenessWhileReadingLargeBlob) {
+  std::vector<uint8_t> blob(kBlobSize, 'a');
+
+  std::atomic<bool> done{false};
+  bool encoded_on_thread = false;
+  int64_t blocked = LongestTurn(
+      [&]() {
+        if (!encoded_on_thread) {
+          encoded_on_thread = true;
+          EncodeBase64(blob);
+          done = true;
+        }
+      },
+      done);
+
+  done = false;
+  bool posted = false;
+  std::string result;
+  int64_t turns = 0;
+  int64_t offloaded = LongestTurn(
+      [&]() {
+        if (!posted) {
+          posted = true;
+          NativeWorkerPool::Shared()->PostJob([&]() {
+            result = EncodeBase64(blob);
+            done = true;
+          });
+        }
+        turns++;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      },
+      done);
+
+  EXPECT_EQ(result.size(), modp_b64_encode_data_len(kBlobSize));
+  std::cout << "base64 of 100MB blob, longest JS thread turn: on JS thread " << blocked << "us, on worker pool "
+            << offloaded << "us (" << turns << " turns ran meanwhile)" << std::endl;
+}
+
+TEST(NativeWorkerPool, DisposeContextWhileReadingBlob) {
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) {});
+  auto* dart_isolate_context = env->page()->GetExecutingContext()->dartIsolateContext();
+  fml::RefPtr<NativeTaskQueue> task_queue = dart_isolate_context->nativeTaskQueue();
+  // Pretend Dart listens to the queue, so the read runs on the pool instead of inline.
+  task_queue->setWakeupHook([](void* data) {}, nullptr);
+  task_queue->SetDartPort(1);
+
+  auto* isolate = static_cast<MercuryIsolate*>(allocateNewMercuryIsolate(dart_isolate_context, newMercuryIsolateId()));
+  std::string code = "new Blob(['a'.repeat(64 * 1024 * 1024)]).text();";
+  isolate->evaluateScript(code.c_str(), code.size(), "vm://", 0);
+
+  // Free the context, and the Blob with it, while the worker is still reading.
+  disposeMercuryIsolate(dart_isolate_context, isolate);
+  EXPECT_TRUE(dart_isolate_context->CollectDisposedIsolates(10 * 1000 * 1000));
+
+  // The completion finds no context and is dropped.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  size_t completed = 0;
+  while (completed == 0 && std::chrono::steady_clock::now() < deadline) {
+    completed = task_queue->flushTask();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(completed, 1);
+  task_queue->SetDartPort(ILLEGAL_PORT);
+}
@@ -7,29 +7,100 @@
 
 namespace mercury {
 
-int32_t TaskQueue::registerTask(const Task& task, void* data) {
-  std::lock_guard<std::mutex> guard(queue_mutex_);
-  auto taskData = new TaskData(task, data);
-  m_map[id++] = taskData;
-  return id - 1;
+TaskQueue::TaskQueue() : head_(&stub_), tail_(&stub_) {}
+
+TaskQueue::~TaskQueue() {
+  // Tasks still pending are dropped, free the nodes the queue owns.
+  while (TaskNode* node = Pop()) {
+    RunOrDrop(node, true);
+  }
+}
+
+void TaskQueue::setWakeupHook(WakeupHook hook, void* data) {
+  wakeup_data_ = data;
+  wakeup_hook_ = hook;
+}
+
+void TaskQueue::registerTask(const Task& task, void* data, const fml::RefPtr<TaskCancellationToken>& token) {
+  auto* node = new TaskNode(task, data);
+  node->token = token;
+  node->owned_by_queue_ = true;
+  postTaskNode(node);
+}
+
+void TaskQueue::postTaskNode(TaskNode* node) {
+  Push(node);
+  // Count after publishing so the consumer never waits on a counted node which is not linked yet for long.
+  if (pending_.fetch_add(1, std::memory_order_acq_rel) == 0 && wakeup_hook_ != nullptr) {
+    wakeup_hook_(wakeup_data_);
+  }
 }
 
-void TaskQueue::dispatchTask(int32_t taskId) {
-  std::lock_guard<std::mutex> guard(queue_mutex_);
-  if (m_map.count(taskId) > 0) {
-    m_map[taskId]->task(m_map[taskId]->data);
-    delete m_map[taskId];
-    m_map.erase(taskId);
+size_t TaskQueue::flushTask() {
+  size_t count = 0;
+  // Only the tasks pending now are run. Tasks posted meanwhile, including by the tasks run here, are left for the next
+  // flush, so busy producers or a task reposting itself cannot keep the consumer here.
+  int64_t budget = pending_.load(std::memory_order_acquire);
+  for (; budget > 0; budget--) {
+    TaskNode* node = Pop();
+    if (node == nullptr) {
+      // A producer has exchanged the head but not linked its node yet. Ask for another flush instead of waiting.
+      if (wakeup_hook_ != nullptr)
+        wakeup_hook_(wakeup_data_);
+      break;
+    }
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    bool cancelled = node->token && node->token->IsCancelled();
+    RunOrDrop(node, cancelled);
+    if (!cancelled)
+      count++;
   }
+  return count;
 }
 
-void TaskQueue::flushTask() {
-  std::lock_guard<std::mutex> guard(queue_mutex_);
-  for (auto& m : m_map) {
-    m.second->task(m.second->data);
-    delete m.second;
+void TaskQueue::Push(TaskNode* node) {
+  node->next_.store(nullptr, std::memory_order_relaxed);
+  TaskNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+  prev->next_.store(node, std::memory_order_release);
+}
+
+TaskNode* TaskQueue::Pop() {
+  TaskNode* tail = tail_;
+  TaskNode* next = tail->next_.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (next == nullptr)
+      return nullptr;
+    tail_ = next;
+    tail = next;
+    next = next->next_.load(std::memory_order_acquire);
+  }
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+  if (tail != head_.load(std::memory_order_acquire))
+    return nullptr;
+  // |tail| is the last node, park the stub behind it so it can be handed out.
+  Push(&stub_);
+  next = tail->next_.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+void TaskQueue::RunOrDrop(TaskNode* node, bool drop) {
+  // The task may free a caller owned node, read everything needed first.
+  bool owned_by_queue = node->owned_by_queue_;
+  Task callback = drop ? node->on_cancel : node->task;
+  void* data = node->data;
+  if (owned_by_queue) {
+    delete node;
+  }
+  if (callback != nullptr) {
+    callback(data);
   }
-  m_map.clear();
 }
 
 }  // namespace mercury
@@ -6,8 +6,8 @@
 #ifndef BRIDGE_TASK_QUEUE_H
 #define BRIDGE_TASK_QUEUE_H
 
-#include <mutex>
-#include <unordered_map>
+#include <atomic>
+#include <cinttypes>
 #include "ref_counter.h"
 #include "ref_ptr.h"
 
@@ -15,22 +15,72 @@ namespace mercury {
 
 using Task = void (*)(void*);
 
+// Shared by any number of posted tasks. Once cancelled, tasks holding the token are dropped instead of run.
+class TaskCancellationToken : public fml::RefCountedThreadSafe<TaskCancellationToken> {
+ public:
+  void Cancel() { cancelled_.store(true, std::memory_order_release); }
+  bool IsCancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<bool> cancelled_{false};
+
+  FML_FRIEND_MAKE_REF_COUNTED(TaskCancellationToken);
+  FML_FRIEND_REF_COUNTED_THREAD_SAFE(TaskCancellationToken);
+};
+
+// Intrusive queue entry. Callers may embed a TaskNode in their own data and post it with postTaskNode() to avoid an
+// allocation per task; the node must stay alive until its task has run or has been dropped by cancellation.
+struct TaskNode {
+  TaskNode() = default;
+  TaskNode(const Task& task, void* data) : task(task), data(data){};
+
+  Task task{nullptr};
+  void* data{nullptr};
+  // Called instead of |task| when the task is dropped by cancellation, so the owner can free |data|.
+  Task on_cancel{nullptr};
+  fml::RefPtr<TaskCancellationToken> token;
+
+ private:
+  std::atomic<TaskNode*> next_{nullptr};
+  bool owned_by_queue_{false};
+
+  friend class TaskQueue;
+};
+
+// A lock free multi-producer single-consumer task queue.
+//
+// Any thread may post tasks; a post is a single atomic exchange and never blocks. Tasks are run in posting order by
+// the consumer thread in flushTask(). When the queue turns from empty to non-empty the wakeup hook is called on the
+// posting thread, which lets the consumer integrate the queue with its own event loop instead of polling.
 class TaskQueue : public fml::RefCountedThreadSafe<TaskQueue> {
  public:
-  virtual int32_t registerTask(const Task& task, void* data);
-  void dispatchTask(int32_t taskId);
-  void flushTask();
+  using WakeupHook = void (*)(void* data);
+
+  TaskQueue();
+  virtual ~TaskQueue();
+
+  // Must be set before tasks are posted from other threads.
+  void setWakeupHook(WakeupHook hook, void* data);
+
+  void registerTask(const Task& task, void* data, const fml::RefPtr<TaskCancellationToken>& token = nullptr);
+  void postTaskNode(TaskNode* node);
+
+  // Consumer thread only. Runs the tasks pending when called and returns how many were run.
+  size_t flushTask();
+  bool hasPendingTasks() const { return pending_.load(std::memory_order_acquire) > 0; }
 
  private:
-  struct TaskData {
-    TaskData(const Task& task, void* data) : task(task), data(data){};
-    Task task;
-    void* data;
-  };
-
-  mutable std::mutex queue_mutex_;
-  std::unordered_map<int, TaskData*> m_map;
-  int64_t id{0};
+  void Push(TaskNode* node);
+  TaskNode* Pop();
+  void RunOrDrop(TaskNode* node, bool drop);
+
+  // Vyukov style intrusive queue: producers exchange |head_|, the consumer follows |tail_|.
+  std::atomic<TaskNode*> head_;
+  TaskNode* tail_;
+  TaskNode stub_;
+  std::atomic<int64_t> pending_{0};
+  WakeupHook wakeup_hook_{nullptr};
+  void* wakeup_data_{nullptr};
 
   FML_FRIEND_MAKE_REF_COUNTED(TaskQueue);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(TaskQueue);
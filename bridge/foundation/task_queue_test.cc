@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "task_queue.h"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+namespace {
+
+// The mutex and map based queue TaskQueue used to be, kept as the benchmark baseline.
+class LockedTaskQueue {
+ public:
+  int32_t registerTask(const Task& task, void* data) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map_[id_++] = new std::pair<Task, void*>(task, data);
+    return id_ - 1;
+  }
+  size_t flushTask() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t count = map_.size();
+    for (auto& m : map_) {
+      m.second->first(m.second->second);
+      delete m.second;
+    }
+    map_.clear();
+    return count;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<int, std::pair<Task, void*>*> map_;
+  int32_t id_{0};
+};
+
+void Increase(void* data) {
+  (*static_cast<int64_t*>(data))++;
+}
+
+struct RepostingTask {
+  TaskQueue* queue;
+  int runs{0};
+};
+
+void Repost(void* data) {
+  auto* task = static_cast<RepostingTask*>(data);
+  task->runs++;
+  task->queue->registerTask(Repost, task);
+}
+
+template <typename Queue>
+int64_t RunProducers(Queue& queue, int producers, int tasks_per_producer) {
+  int64_t counter = 0;
+  std::atomic<int> finished{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < producers; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < tasks_per_producer; j++) {
+        queue.registerTask(Increase, &counter);
+      }
+      finished++;
+    });
+  }
+  while (finished.load() < producers) {
+    queue.flushTask();
+  }
+  queue.flushTask();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter, static_cast<int64_t>(producers) * tasks_per_producer);
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+TEST(TaskQueue, RunTasksInPostingOrder) {
+  auto queue = fml::MakeRefCounted<TaskQueue>();
+  std::vector<int> order;
+  int values[3] = {0, 1, 2};
+  static std::vector<int>* order_ptr;
+  order_ptr = &order;
+  for (int& value : values) {
+    queue->registerTask([](void* data) { order_ptr->emplace_back(*static_cast<int*>(data)); }, &value);
+  }
+  EXPECT_EQ(queue->flushTask(), 3);
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+  EXPECT_FALSE(queue->hasPendingTasks());
+}
+
+TEST(TaskQueue, CancelledTasksAreDropped) {
+  auto queue = fml::MakeRefCounted<TaskQueue>();
+  auto token = fml::MakeRefCounted<TaskCancellationToken>();
+  int64_t counter = 0;
+  queue->registerTask(Increase, &counter, token);
+  queue->registerTask(Increase, &counter);
+  token->Cancel();
+  EXPECT_EQ(queue->flushTask(), 1);
+  EXPECT_EQ(counter, 1);
+}
+
+TEST(TaskQueue, IntrusiveNodeAndWakeupHook) {
+  auto queue = fml::MakeRefCounted<TaskQueue>();
+  int wakeups = 0;
+  queue->setWakeupHook([](void* data) { (*static_cast<int*>(data))++; }, &wakeups);
+  int64_t counter = 0;
+  TaskNode first(Increase, &counter);
+  TaskNode second(Increase, &counter);
+  queue->postTaskNode(&first);
+  queue->postTaskNode(&second);
+  EXPECT_EQ(wakeups, 1);
+  EXPECT_EQ(queue->flushTask(), 2);
+  EXPECT_EQ(counter, 2);
+  queue->postTaskNode(&first);
+  EXPECT_EQ(wakeups, 2);
+  queue->flushTask();
+}
+
+TEST(TaskQueue, TaskRepostingItselfRunsOncePerFlush) {
+  auto queue = fml::MakeRefCounted<TaskQueue>();
+  int wakeups = 0;
+  queue->setWakeupHook([](void* data) { (*static_cast<int*>(data))++; }, &wakeups);
+  RepostingTask task{queue.get()};
+  queue->registerTask(Repost, &task);
+  EXPECT_EQ(queue->flushTask(), 1);
+  EXPECT_EQ(task.runs, 1);
+  // The reposted task waits for the next flush, which the wakeup hook asks for.
+  EXPECT_TRUE(queue->hasPendingTasks());
+  EXPECT_EQ(wakeups, 2);
+  EXPECT_EQ(queue->flushTask(), 1);
+  EXPECT_EQ(task.runs, 2);
+}
+
+TEST(TaskQueue, ProducersBenchmark) {
+  const int kTasksPerProducer = 100000;
+  for (int producers : {1, 2, 4, 8, 16}) {
+    LockedTaskQueue locked_queue;
+    auto queue = fml::MakeRefCounted<TaskQueue>();
+    int64_t locked = RunProducers(locked_queue, producers, kTasksPerProducer);
+    int64_t lock_free = RunProducers(*queue, producers, kTasksPerProducer);
+    std::cout << producers << " producers: mutex " << locked << "us, lock free " << lock_free << "us" << std::endl;
+  }
+}
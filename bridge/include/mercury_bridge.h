@@ -21,6 +21,8 @@ typedef struct SharedNativeString SharedNativeString;
 typedef struct NativeValue NativeValue;
 typedef struct NativeScreen NativeScreen;
 typedef struct NativeByteCode NativeByteCode;
+typedef struct NativeEventDispatchRecord NativeEventDispatchRecord;
+typedef struct EventDispatchResult EventDispatchResult;
 
 struct MercuryInfo {
   const char* app_name{nullptr};
@@ -35,12 +37,18 @@ void* initDartIsolateContext(uint64_t* dart_methods, int32_t dart_methods_len);
 MERCURY_EXPORT_C
 void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercury_isolate_id);
 
+// Returns -1 when no more isolate ids can be allocated.
 MERCURY_EXPORT_C
 int64_t newMercuryIsolateId();
+// Give back an id from newMercuryIsolateId() when no isolate was allocated with it.
+MERCURY_EXPORT_C
+void releaseMercuryIsolateId(int64_t id);
 
 MERCURY_EXPORT_C
 void disposeMercuryIsolate(void* dart_isolate_context, void* ptr);
 MERCURY_EXPORT_C
+int8_t collectDisposedMercuryIsolates(void* dart_isolate_context, int64_t budget_in_microseconds);
+MERCURY_EXPORT_C
 int8_t evaluateScripts(void* ptr,
                        SharedNativeString* code,
                        uint8_t** parsed_bytecodes,
@@ -56,8 +64,26 @@ NativeValue* invokeModuleEvent(void* ptr,
                                void* event,
                                NativeValue* extra);
 MERCURY_EXPORT_C
+int32_t dispatchEventBatch(void* ptr, NativeEventDispatchRecord* records, int32_t count, EventDispatchResult* results);
+MERCURY_EXPORT_C
+int32_t registerWidgetElementShapes(void* ptr, uint16_t* buffer, int32_t length);
+// Off by default. When enabled, binding property writes succeed immediately and reach Dart at the next flush, so
+// failures of the Dart setters are not reported to JS.
+MERCURY_EXPORT_C
+void setBindingWriteCoalescing(void* ptr, int8_t enabled);
+MERCURY_EXPORT_C
 MercuryInfo* getMercuryInfo();
+// Bytes allocated on behalf of the JS context of the isolate. Only exact when the bridge is built with
+// ENABLE_CONTEXT_HEAP, returns 0 otherwise.
+MERCURY_EXPORT_C
+int64_t getMercuryIsolateHeapUsage(void* ptr);
+// One line per property access site of the live JS functions of the isolate, with the state of its inline cache and its hit and miss
+// counts since the last reset. The returned value is a string owned by the caller.
+MERCURY_EXPORT_C
+NativeValue* getInlineCacheStats(void* ptr, int8_t reset);
 
+// Hands the isolate commands to Dart. The cancelled commands are dropped first, so getIsolateCommandItemSize must be
+// called after this.
 MERCURY_EXPORT_C
 void* getIsolateCommandItems(void* page);
 MERCURY_EXPORT_C
@@ -69,5 +95,13 @@ MERCURY_EXPORT_C
 void init_dart_dynamic_linking(void* data);
 MERCURY_EXPORT_C
 void register_dart_context_finalizer(Dart_Handle dart_handle, void* dart_isolate_context);
+// Port native worker threads post to when work for the JS thread is done. 0 (ILLEGAL_PORT) unregisters it, native
+// work then runs on the JS thread.
+MERCURY_EXPORT_C
+void registerNativeTaskPort(void* dart_isolate_context, int64_t port);
+MERCURY_EXPORT_C
+int32_t flushNativeTasks(void* dart_isolate_context);
+MERCURY_EXPORT_C
+void releaseDartWires(void* dart_isolate_context, int64_t* wires, int32_t count);
 
 #endif  // MERCURY_BRIDGE_EXPORT_H
@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstring>
 #include <thread>
 
 #include "bindings/qjs/native_string_utils.h"
@@ -12,6 +13,7 @@
 #include "core/mercury_isolate.h"
 #include "foundation/isolate_command_buffer.h"
 #include "foundation/logging.h"
+#include "foundation/native_value.h"
 #include "include/mercury_bridge.h"
 
 #if defined(_WIN32)
@@ -37,8 +39,6 @@
 #define SYSTEM_NAME "unknown"
 #endif
 
-static std::atomic<int64_t> unique_page_id{0};
-
 void* initDartIsolateContext(uint64_t* dart_methods, int32_t dart_methods_len) {
   void* ptr = new mercury::DartIsolateContext(dart_methods, dart_methods_len);
   return ptr;
@@ -55,7 +55,15 @@ void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercu
 }
 
 int64_t newMercuryIsolateId() {
-  return unique_page_id++;
+  int32_t id = mercury::AllocateContextId();
+  if (id < 0) {
+    MERCURY_LOG(ERROR) << "Failed to allocate a Mercury isolate id: all context ids are in use." << std::endl;
+  }
+  return id;
+}
+
+void releaseMercuryIsolateId(int64_t id) {
+  mercury::ReleaseUnusedContextId(static_cast<int32_t>(id));
 }
 
 void disposeMercuryIsolate(void* dart_isolate_context, void* ptr) {
@@ -64,6 +72,10 @@ void disposeMercuryIsolate(void* dart_isolate_context, void* ptr) {
   ((mercury::DartIsolateContext*)dart_isolate_context)->RemoveIsolate(mercury_isolate);
 }
 
+int8_t collectDisposedMercuryIsolates(void* dart_isolate_context, int64_t budget_in_microseconds) {
+  return ((mercury::DartIsolateContext*)dart_isolate_context)->CollectDisposedIsolates(budget_in_microseconds) ? 1 : 0;
+}
+
 int8_t evaluateScripts(void* ptr,
                        SharedNativeString* code,
                        uint8_t** parsed_bytecodes,
@@ -96,6 +108,26 @@ NativeValue* invokeModuleEvent(void* ptr,
   return reinterpret_cast<NativeValue*>(result);
 }
 
+int32_t dispatchEventBatch(void* ptr, NativeEventDispatchRecord* records, int32_t count, EventDispatchResult* results) {
+  auto mercury_isolate = reinterpret_cast<mercury::MercuryIsolate*>(ptr);
+  assert(std::this_thread::get_id() == mercury_isolate->currentThread());
+  return mercury_isolate->dispatchEventBatch(reinterpret_cast<mercury::NativeEventDispatchRecord*>(records), count,
+                                             reinterpret_cast<mercury::EventDispatchResult*>(results));
+}
+
+int32_t registerWidgetElementShapes(void* ptr, uint16_t* buffer, int32_t length) {
+  auto mercury_isolate = reinterpret_cast<mercury::MercuryIsolate*>(ptr);
+  assert(std::this_thread::get_id() == mercury_isolate->currentThread());
+  auto* context = mercury_isolate->GetExecutingContext();
+  return context->dartIsolateContext()->EnsureData()->RegisterWidgetElementShapes(context->ctx(), buffer, length);
+}
+
+void setBindingWriteCoalescing(void* ptr, int8_t enabled) {
+  auto mercury_isolate = reinterpret_cast<mercury::MercuryIsolate*>(ptr);
+  assert(std::this_thread::get_id() == mercury_isolate->currentThread());
+  mercury_isolate->GetExecutingContext()->SetBindingWriteCoalescing(enabled == 1);
+}
+
 static MercuryInfo* mercuryInfo{nullptr};
 
 MercuryInfo* getMercuryInfo() {
@@ -110,9 +142,30 @@ MercuryInfo* getMercuryInfo() {
   return mercuryInfo;
 }
 
+int64_t getMercuryIsolateHeapUsage(void* ptr) {
+  auto mercury_isolate = reinterpret_cast<mercury::MercuryIsolate*>(ptr);
+  assert(std::this_thread::get_id() == mercury_isolate->currentThread());
+  return mercury_isolate->GetExecutingContext()->GetScriptState()->HeapUsage();
+}
+
+NativeValue* getInlineCacheStats(void* ptr, int8_t reset) {
+  auto mercury_isolate = reinterpret_cast<mercury::MercuryIsolate*>(ptr);
+  assert(std::this_thread::get_id() == mercury_isolate->currentThread());
+  JSContext* ctx = mercury_isolate->GetExecutingContext()->ctx();
+  JSValue stats = JS_GetInlineCacheStats(ctx, reset == 1);
+  const char* chars = JS_ToCString(ctx, stats);
+  auto* return_value = static_cast<mercury::NativeValue*>(malloc(sizeof(mercury::NativeValue)));
+  mercury::NativeValue tmp = mercury::Native_NewCString(chars != nullptr ? chars : "");
+  memcpy(return_value, &tmp, sizeof(mercury::NativeValue));
+  JS_FreeCString(ctx, chars);
+  JS_FreeValue(ctx, stats);
+  return reinterpret_cast<NativeValue*>(return_value);
+}
+
 void* getIsolateCommandItems(void* isolate_) {
   auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
   assert(std::this_thread::get_id() == isolate->currentThread());
+  isolate->GetExecutingContext()->isolateCommandBuffer()->removeCancelledCommands();
   return isolate->GetExecutingContext()->isolateCommandBuffer()->data();
 }
 
@@ -144,3 +197,18 @@ void register_dart_context_finalizer(Dart_Handle dart_handle, void* dart_isolate
   Dart_NewFinalizableHandle_DL(dart_handle, reinterpret_cast<void*>(dart_isolate_context),
                                sizeof(mercury::DartIsolateContext), finalize_dart_context);
 }
+
+void registerNativeTaskPort(void* dart_isolate_context, int64_t port) {
+  ((mercury::DartIsolateContext*)dart_isolate_context)->nativeTaskQueue()->SetDartPort(port);
+}
+
+int32_t flushNativeTasks(void* dart_isolate_context) {
+  auto* context = (mercury::DartIsolateContext*)dart_isolate_context;
+  assert(context->valid());
+  return static_cast<int32_t>(context->nativeTaskQueue()->flushTask());
+}
+
+void releaseDartWires(void* dart_isolate_context, int64_t* wires, int32_t count) {
+  assert(((mercury::DartIsolateContext*)dart_isolate_context)->valid());
+  mercury::ReleaseDartWires(wires, count);
+}
@@ -27,13 +27,21 @@ namespace mercury {
 
 using EventConstructorFunction = Event* (*)(ExecutingContext* context, const AtomicString& type, RawEvent* raw_event);
 
-using EventMap = std::unordered_map<AtomicString, EventConstructorFunction, AtomicString::KeyHasher>;
+using EventDiscardFunction = void (*)(RawEvent* raw_event);
+
+struct EventFunctions {
+  EventConstructorFunction create;
+  EventDiscardFunction discard;
+};
+
+using EventMap = std::unordered_map<AtomicString, EventFunctions, AtomicString::KeyHasher>;
 
 static thread_local EventMap* g_event_constructors = nullptr;
 
 struct CreateEventFunctionMapData {
   const AtomicString& tag;
   EventConstructorFunction func;
+  EventDiscardFunction discard;
 };
 
 <% _.forEach(data, (item, index) => { %>
@@ -48,6 +56,12 @@ struct CreateEventFunctionMapData {
       }
       return MakeGarbageCollected<Event>(context, type, toNativeEvent<NativeEvent>(raw_event));
     }
+
+    static void <%= _.upperFirst(item) %>EventDiscarder(RawEvent* raw_event) {
+      if (raw_event->length == sizeof(Native<%= _.upperFirst(item) %>Event) / sizeof(int64_t)) {
+        <%= _.upperFirst(_.camelCase(item)) %>Event::FreeNativeEvent(toNativeEvent<Native<%= _.upperFirst(item) %>Event>(raw_event));
+      }
+    }
   <% } else if (_.isObject(item)) { %>
     static Event* <%= item.class %>Constructor(ExecutingContext* context, const AtomicString& type, RawEvent* raw_event) {
       if (raw_event == nullptr) {
@@ -58,6 +72,12 @@ struct CreateEventFunctionMapData {
       }
       return MakeGarbageCollected<Event>(context, type, toNativeEvent<NativeEvent>(raw_event));
     }
+
+    static void <%= item.class %>Discarder(RawEvent* raw_event) {
+      if (raw_event->length == sizeof(Native<%= _.upperFirst(item.class) %>) / sizeof(int64_t)) {
+        <%= item.class %>::FreeNativeEvent(toNativeEvent<Native<%= _.upperFirst(item.class) %>>(raw_event));
+      }
+    }
   <% } %>
 <% }); %>
 
@@ -71,10 +91,10 @@ static void CreateEventFunctionMap() {
 
       <% _.forEach(data, (item, index) => { %>
           <% if (_.isString(item)) { %>
-            {event_type_names::k<%= item %>, <%= _.upperFirst(item) %>EventConstructor},
+            {event_type_names::k<%= item %>, <%= _.upperFirst(item) %>EventConstructor, <%= _.upperFirst(item) %>EventDiscarder},
           <% } else if (_.isObject(item)) { %>
             <% _.forEach(item.types, function(type) { %>
-              {event_type_names::k<%= type %>, <%= item.class %>Constructor},
+              {event_type_names::k<%= type %>, <%= item.class %>Constructor, <%= item.class %>Discarder},
             <% }) %>
           <% } %>
       <% }); %>
@@ -82,7 +102,7 @@ static void CreateEventFunctionMap() {
   };
 
   for (size_t i = 0; i < std::size(data); i++)
-    g_event_constructors->insert(std::make_pair(data[i].tag, data[i].func));
+    g_event_constructors->insert(std::make_pair(data[i].tag, EventFunctions{data[i].func, data[i].discard}));
 }
 
 Event* EventFactory::Create(ExecutingContext* context, const AtomicString& type, RawEvent* raw_event) {
@@ -100,10 +120,28 @@ Event* EventFactory::Create(ExecutingContext* context, const AtomicString& type,
     }
     return MakeGarbageCollected<Event>(context, type, toNativeEvent<NativeEvent>(raw_event));
   }
-  EventConstructorFunction function = it->second;
+  EventConstructorFunction function = it->second.create;
   return function(context, type, raw_event);
 }
 
+void EventFactory::Discard(const AtomicString& type, RawEvent* raw_event) {
+  if (raw_event == nullptr)
+    return;
+  if (!g_event_constructors)
+    CreateEventFunctionMap();
+
+  if (raw_event->is_custom_event) {
+    CustomEvent::FreeNativeEvent(toNativeEvent<NativeCustomEvent>(raw_event));
+    return;
+  }
+
+  // Plain events own no members besides their props, which stay with Dart.
+  auto it = g_event_constructors->find(type);
+  if (it == g_event_constructors->end())
+    return;
+  it->second.discard(raw_event);
+}
+
 void EventFactory::Dispose() {
   delete g_event_constructors;
   g_event_constructors = nullptr;
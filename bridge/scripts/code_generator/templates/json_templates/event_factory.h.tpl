@@ -15,6 +15,8 @@ class EventFactory {
  public:
   // If |local_name| is unknown, nullptr is returned.
   static Event* Create(ExecutingContext* context, const AtomicString& type, RawEvent* raw_event);
+  // Release the members owned by a raw event from Dart which no listener will observe, without creating an Event.
+  static void Discard(const AtomicString& type, RawEvent* raw_event);
   static void Dispose();
 };
 
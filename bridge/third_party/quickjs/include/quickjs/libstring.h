@@ -0,0 +1,62 @@
+/*
+ * String search and scan kernels on 8-bit and 16-bit character buffers
+ *
+ * Copyright (c) 2022-present The WebF authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef LIBSTRING_H
+#define LIBSTRING_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Search and scan kernels on 8-bit (Latin-1) and 16-bit (UTF-16) character
+   buffers, vectorized with SSE2 or NEON when available. Positions and
+   lengths are character counts. */
+
+/* Return the index of the first 'c' in 's', or -1 */
+int lstr_find_char8(const uint8_t *s, int len, int c);
+int lstr_find_char16(const uint16_t *s, int len, int c);
+
+/* Return the index of the first occurrence of 'needle' in 's', or -1 */
+int lstr_find8(const uint8_t *s, int len, const uint8_t *needle, int needle_len);
+int lstr_find16(const uint16_t *s, int len, const uint16_t *needle, int needle_len);
+int lstr_find16_8(const uint16_t *s, int len, const uint8_t *needle, int needle_len);
+
+/* Return the index of the first character which is not white space or a
+   line terminator, or 'len' */
+int lstr_skip_space8(const uint8_t *s, int len);
+int lstr_skip_space16(const uint16_t *s, int len);
+/* Return the length of 's' without its trailing white space and line
+   terminators */
+int lstr_trim_end8(const uint8_t *s, int len);
+int lstr_trim_end16(const uint16_t *s, int len);
+
+/* Return non zero if all the characters of 's' are below 0x100 */
+int lstr_is_latin1_16(const uint16_t *s, int len);
+
+#ifdef __cplusplus
+} /* extern "C" { */
+#endif
+
+#endif /* LIBSTRING_H */
@@ -359,6 +359,15 @@ DEF(   is_undefined, 1, 1, 1, none)
 DEF(        is_null, 1, 1, 1, none)
 DEF(typeof_is_undefined, 1, 1, 1, none)
 DEF( typeof_is_function, 1, 1, 1, none)
+
+/* superinstructions emitted by resolve_labels() for the most frequent
+   opcode pairs */
+DEF(  get_loc0_loc1, 1, 0, 2, none)
+DEF(   lt_if_false8, 2, 2, 0, label8)
+DEF(  lte_if_false8, 2, 2, 0, label8) /* must come after lt_if_false8 */
+DEF(   gt_if_false8, 2, 2, 0, label8) /* must come after lte_if_false8 */
+DEF(  gte_if_false8, 2, 2, 0, label8) /* must come after gt_if_false8 */
+DEF(   add_put_loc8, 2, 2, 0, loc8)
 #endif
 
 DEF(      get_field_ic, 5, 1, 1, none)
@@ -338,6 +338,7 @@ typedef struct JSMallocState {
   size_t malloc_size;
   size_t malloc_limit;
   void* opaque; /* user opaque */
+  void* heap; /* mi_heap_t* receiving new allocations, NULL for the default heap */
 } JSMallocState;
 
 typedef struct JSMallocFunctions {
@@ -354,6 +355,11 @@ JSRuntime *JS_NewRuntime(void);
 void JS_SetRuntimeInfo(JSRuntime *rt, const char *info);
 void JS_SetMemoryLimit(JSRuntime *rt, size_t limit);
 void JS_SetGCThreshold(JSRuntime *rt, size_t gc_threshold);
+/* Only effective with ENABLE_MI_MALLOC: route the following allocations of
+   the runtime into the given mi_heap_t (NULL selects the default heap).
+   Returns the previously selected heap. */
+void *JS_SetMallocHeap(JSRuntime *rt, void *heap);
+void *JS_GetMallocHeap(JSRuntime *rt);
 /* use 0 to disable maximum stack size check */
 void JS_SetMaxStackSize(JSRuntime *rt, size_t stack_size);
 /* should be called when changing thread to update the stack top value
@@ -435,6 +441,9 @@ typedef struct JSMemoryUsage {
 
 void JS_ComputeMemoryUsage(JSRuntime *rt, JSMemoryUsage *s);
 void JS_DumpMemoryUsage(FILE *fp, const JSMemoryUsage *s, JSRuntime *rt);
+/* one line per property access site of the live functions of 'ctx' with
+   its inline cache state and hit/miss counters */
+JSValue JS_GetInlineCacheStats(JSContext *ctx, JS_BOOL reset);
 
 /* atom support */
 #define JS_ATOM_NULL 0
@@ -39,16 +39,20 @@ void js_array_finalizer(JSRuntime* rt, JSValue val) {
   JSObject* p = JS_VALUE_GET_OBJ(val);
   int i;
 
-  for (i = 0; i < p->u.array.count; i++) {
-    JS_FreeValueRT(rt, p->u.array.u.values[i]);
+  if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+    for (i = 0; i < p->u.array.count; i++) {
+      JS_FreeValueRT(rt, p->u.array.u.values[i]);
+    }
   }
-  js_free_rt(rt, p->u.array.u.values);
+  js_free_rt(rt, p->u.array.u.ptr);
 }
 
 void js_array_mark(JSRuntime* rt, JSValueConst val, JS_MarkFunc* mark_func) {
   JSObject* p = JS_VALUE_GET_OBJ(val);
   int i;
 
+  if (p->u.array.kind != JS_ARRAY_KIND_VALUE)
+    return;
   for (i = 0; i < p->u.array.count; i++) {
     JS_MarkValue(rt, p->u.array.u.values[i], mark_func);
   }
@@ -88,7 +92,7 @@ BOOL js_get_fast_array(JSContext* ctx, JSValueConst obj, JSValue** arrpp, uint32
   /* Try and handle fast arrays explicitly */
   if (JS_VALUE_GET_TAG(obj) == JS_TAG_OBJECT) {
     JSObject* p = JS_VALUE_GET_OBJ(obj);
-    if (p->class_id == JS_CLASS_ARRAY && p->fast_array) {
+    if (p->class_id == JS_CLASS_ARRAY && p->fast_array && p->u.array.kind == JS_ARRAY_KIND_VALUE) {
       *countp = p->u.array.count;
       *arrpp = p->u.array.u.values;
       return TRUE;
@@ -102,23 +106,61 @@ BOOL js_get_fast_array(JSContext* ctx, JSValueConst obj, JSValue** arrpp, uint32
 int expand_fast_array(JSContext *ctx, JSObject *p, uint32_t new_len)
 {
   uint32_t new_size;
-  size_t slack;
-  JSValue *new_array_prop;
+  size_t slack, elem_size;
+  void *new_array_prop;
   /* XXX: potential arithmetic overflow */
+  elem_size = js_array_kind_size(p->u.array.kind);
   new_size = max_int(new_len, p->u.array.u1.size * 9 / 2);
-  new_array_prop = js_realloc2(ctx, p->u.array.u.values, sizeof(JSValue) * new_size, &slack);
+  new_array_prop = js_realloc2(ctx, p->u.array.u.ptr, elem_size * new_size, &slack);
   if (!new_array_prop)
     return -1;
-  new_size += slack / sizeof(*new_array_prop);
-  p->u.array.u.values = new_array_prop;
+  new_size += slack / elem_size;
+  p->u.array.u.ptr = new_array_prop;
   p->u.array.u1.size = new_size;
   return 0;
 }
 
+/* Move the elements of the fast array 'p' to the more general 'kind'.
+   Return -1 if memory error. */
+int js_array_widen(JSContext* ctx, JSObject* p, JSArrayKindEnum kind) {
+  uint32_t i, len;
+  void* tab;
+
+  assert(kind > p->u.array.kind);
+  tab = NULL;
+  if (p->u.array.u1.size > 0) {
+    tab = js_malloc(ctx, js_array_kind_size(kind) * p->u.array.u1.size);
+    if (!tab)
+      return -1;
+  }
+  len = p->u.array.count;
+  if (p->u.array.kind == JS_ARRAY_KIND_INT32) {
+    int32_t* src = p->u.array.u.int32_ptr;
+    if (kind == JS_ARRAY_KIND_FLOAT64) {
+      double* dst = tab;
+      for (i = 0; i < len; i++)
+        dst[i] = src[i];
+    } else {
+      JSValue* dst = tab;
+      for (i = 0; i < len; i++)
+        dst[i] = JS_NewInt32(ctx, src[i]);
+    }
+  } else {
+    double* src = p->u.array.u.double_ptr;
+    JSValue* dst = tab;
+    for (i = 0; i < len; i++)
+      dst[i] = JS_NewFloat64(ctx, src[i]);
+  }
+  js_free(ctx, p->u.array.u.ptr);
+  p->u.array.u.ptr = tab;
+  p->u.array.kind = kind;
+  return 0;
+}
+
 __exception int js_append_enumerate(JSContext* ctx, JSValue* sp) {
   JSValue iterator, enumobj, method, value;
   int is_array_iterator;
-  JSValue* arrp;
+  JSObject* p;
   uint32_t i, count32, pos;
 
   if (JS_VALUE_GET_TAG(sp[-2]) != JS_TAG_INT) {
@@ -148,8 +190,10 @@ __exception int js_append_enumerate(JSContext* ctx, JSValue* sp) {
     JS_FreeValue(ctx, enumobj);
     return -1;
   }
-  if (is_array_iterator && JS_IsCFunction(ctx, method, (JSCFunction*)js_array_iterator_next, 0) && js_get_fast_array(ctx, sp[-1], &arrp, &count32)) {
+  if (is_array_iterator && JS_IsCFunction(ctx, method, (JSCFunction*)js_array_iterator_next, 0) && js_is_fast_array(ctx, sp[-1])) {
     uint32_t len;
+    p = JS_VALUE_GET_OBJ(sp[-1]);
+    count32 = p->u.array.count;
     if (js_get_length32(ctx, &len, sp[-1]))
       goto exception;
     /* if len > count32, the elements >= count32 might be read in
@@ -158,7 +202,7 @@ __exception int js_append_enumerate(JSContext* ctx, JSValue* sp) {
       goto general_case;
     /* Handle fast arrays explicitly */
     for (i = 0; i < count32; i++) {
-      if (JS_DefinePropertyValueUint32(ctx, sp[-3], pos++, JS_DupValue(ctx, arrp[i]), JS_PROP_C_W_E) < 0)
+      if (JS_DefinePropertyValueUint32(ctx, sp[-3], pos++, js_fast_array_get(ctx, p, i), JS_PROP_C_W_E) < 0)
         goto exception;
     }
   } else {
@@ -224,16 +268,28 @@ int JS_CopySubArray(JSContext* ctx, JSValueConst obj, int64_t to_pos, int64_t fr
       if (dir < 0) {
         l = min_int64(l, from + 1);
         l = min_int64(l, to + 1);
-        for(j = 0; j < l; j++) {
-          set_value(ctx, &p->u.array.u.values[to - j],
-                    JS_DupValue(ctx, p->u.array.u.values[from - j]));
+        if (p->u.array.kind != JS_ARRAY_KIND_VALUE) {
+          size_t elem_size = js_array_kind_size(p->u.array.kind);
+          memmove((uint8_t*)p->u.array.u.ptr + (to - l + 1) * elem_size,
+                  (uint8_t*)p->u.array.u.ptr + (from - l + 1) * elem_size, l * elem_size);
+        } else {
+          for(j = 0; j < l; j++) {
+            set_value(ctx, &p->u.array.u.values[to - j],
+                      JS_DupValue(ctx, p->u.array.u.values[from - j]));
+          }
         }
       } else {
         l = min_int64(l, len - from);
         l = min_int64(l, len - to);
-        for(j = 0; j < l; j++) {
-          set_value(ctx, &p->u.array.u.values[to + j],
-                    JS_DupValue(ctx, p->u.array.u.values[from + j]));
+        if (p->u.array.kind != JS_ARRAY_KIND_VALUE) {
+          size_t elem_size = js_array_kind_size(p->u.array.kind);
+          memmove((uint8_t*)p->u.array.u.ptr + to * elem_size,
+                  (uint8_t*)p->u.array.u.ptr + from * elem_size, l * elem_size);
+        } else {
+          for(j = 0; j < l; j++) {
+            set_value(ctx, &p->u.array.u.values[to + j],
+                      JS_DupValue(ctx, p->u.array.u.values[from + j]));
+          }
         }
       }
       i += l;
@@ -552,6 +608,35 @@ int js_typed_array_get_length_internal(JSContext* ctx, JSValueConst obj);
 
 JSValue js_typed_array___speciesCreate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
 
+/* Read the element 'k' of 'obj' from the storage of a fast array. The
+   callbacks of the iteration builtins can modify the array, so it is
+   checked again for each element. Return FALSE if the element must be
+   looked up. */
+static BOOL js_array_get_dense_element(JSContext* ctx, JSValueConst obj, int64_t k, JSValue* pval) {
+  JSObject* p;
+
+  if (!js_is_fast_array(ctx, obj))
+    return FALSE;
+  p = JS_VALUE_GET_OBJ(obj);
+  if (k >= p->u.array.count)
+    return FALSE;
+  *pval = js_fast_array_get(ctx, p, k);
+  return TRUE;
+}
+
+/* Define the element 'k' of the array 'arr' built by map or filter.
+   Appending to a fast array does not need a property lookup. */
+static int js_array_define_result(JSContext* ctx, JSValueConst arr, int64_t k, JSValue val) {
+  JSObject* p;
+
+  if (js_is_fast_array(ctx, arr)) {
+    p = JS_VALUE_GET_OBJ(arr);
+    if (k == p->u.array.count && p->extensible)
+      return add_fast_array_element(ctx, p, val, JS_PROP_THROW);
+  }
+  return JS_DefinePropertyValueInt64(ctx, arr, k, val, JS_PROP_C_W_E | JS_PROP_THROW);
+}
+
 JSValue js_array_every(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int special) {
   JSValue obj, val, index_val, res, ret;
   JSValueConst args[3];
@@ -593,6 +678,12 @@ JSValue js_array_every(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
       ret = JS_ArraySpeciesCreate(ctx, obj, JS_NewInt64(ctx, len));
       if (JS_IsException(ret))
         goto exception;
+      /* allocate the result of mapping a fast array at once */
+      if (js_is_fast_array(ctx, obj) && JS_VALUE_GET_OBJ(obj)->u.array.count == len && js_is_fast_array(ctx, ret)) {
+        JSObject* p = JS_VALUE_GET_OBJ(ret);
+        if (p->u.array.u1.size < len && expand_fast_array(ctx, p, len))
+          goto exception;
+      }
       break;
     case special_filter:
       ret = JS_ArraySpeciesCreate(ctx, obj, JS_NewInt32(ctx, 0));
@@ -620,6 +711,8 @@ JSValue js_array_every(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
       if (JS_IsException(val))
         goto exception;
       present = TRUE;
+    } else if (js_array_get_dense_element(ctx, obj, k, &val)) {
+      present = TRUE;
     } else {
       present = JS_TryGetPropertyInt64(ctx, obj, k, &val);
       if (present < 0)
@@ -652,7 +745,7 @@ JSValue js_array_every(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
           }
           break;
         case special_map:
-          if (JS_DefinePropertyValueInt64(ctx, ret, k, res, JS_PROP_C_W_E | JS_PROP_THROW) < 0)
+          if (js_array_define_result(ctx, ret, k, res) < 0)
             goto exception;
           break;
         case special_map | special_TA:
@@ -662,7 +755,7 @@ JSValue js_array_every(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
         case special_filter:
         case special_filter | special_TA:
           if (JS_ToBoolFree(ctx, res)) {
-            if (JS_DefinePropertyValueInt64(ctx, ret, n++, JS_DupValue(ctx, val), JS_PROP_C_W_E | JS_PROP_THROW) < 0)
+            if (js_array_define_result(ctx, ret, n++, JS_DupValue(ctx, val)) < 0)
               goto exception;
           }
           break;
@@ -740,6 +833,8 @@ JSValue js_array_reduce(JSContext* ctx, JSValueConst this_val, int argc, JSValue
         if (JS_IsException(acc))
           goto exception;
         break;
+      } else if (js_array_get_dense_element(ctx, obj, k1, &acc)) {
+        break;
       } else {
         present = JS_TryGetPropertyInt64(ctx, obj, k1, &acc);
         if (present < 0)
@@ -756,6 +851,8 @@ JSValue js_array_reduce(JSContext* ctx, JSValueConst this_val, int argc, JSValue
       if (JS_IsException(val))
         goto exception;
       present = TRUE;
+    } else if (js_array_get_dense_element(ctx, obj, k1, &val)) {
+      present = TRUE;
     } else {
       present = JS_TryGetPropertyInt64(ctx, obj, k1, &val);
       if (present < 0)
@@ -822,6 +919,49 @@ exception:
   return JS_EXCEPTION;
 }
 
+/* Return the index of the first element of the fast array 'p' from 'n'
+   equal to 'val', or -1. The elements must be stored as numbers. */
+static int64_t js_fast_array_find_number(JSObject* p, int64_t n, JSValueConst val, BOOL same_value_zero) {
+  int64_t len = p->u.array.count;
+  double d;
+
+  if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+    d = JS_VALUE_GET_INT(val);
+  else if (JS_VALUE_GET_NORM_TAG(val) == JS_TAG_FLOAT64)
+    d = JS_VALUE_GET_FLOAT64(val);
+  else
+    return -1;
+  if (p->u.array.kind == JS_ARRAY_KIND_INT32) {
+    int32_t *tab = p->u.array.u.int32_ptr;
+    int32_t v;
+    if (!(d >= INT32_MIN && d <= INT32_MAX))
+      return -1;
+    v = (int32_t)d;
+    if (v != d)
+      return -1;
+    for (; n < len; n++) {
+      if (tab[n] == v)
+        return n;
+    }
+  } else {
+    double *tab = p->u.array.u.double_ptr;
+    if (isnan(d)) {
+      if (same_value_zero) {
+        for (; n < len; n++) {
+          if (isnan(tab[n]))
+            return n;
+        }
+      }
+      return -1;
+    }
+    for (; n < len; n++) {
+      if (tab[n] == d)
+        return n;
+    }
+  }
+  return -1;
+}
+
 JSValue js_array_includes(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
   JSValue obj, val;
   int64_t len, n, res;
@@ -846,6 +986,13 @@ JSValue js_array_includes(JSContext* ctx, JSValueConst this_val, int argc, JSVal
           goto done;
         }
       }
+    } else if (js_is_fast_array(ctx, obj) && n < JS_VALUE_GET_OBJ(obj)->u.array.count) {
+      JSObject* p = JS_VALUE_GET_OBJ(obj);
+      if (js_fast_array_find_number(p, n, argv[0], TRUE) >= 0) {
+        res = TRUE;
+        goto done;
+      }
+      n = p->u.array.count;
     }
     for (; n < len; n++) {
       val = JS_GetPropertyInt64(ctx, obj, n);
@@ -890,6 +1037,12 @@ JSValue js_array_indexOf(JSContext* ctx, JSValueConst this_val, int argc, JSValu
           goto done;
         }
       }
+    } else if (js_is_fast_array(ctx, obj) && n < JS_VALUE_GET_OBJ(obj)->u.array.count) {
+      JSObject* p = JS_VALUE_GET_OBJ(obj);
+      res = js_fast_array_find_number(p, n, argv[0], FALSE);
+      if (res >= 0)
+        goto done;
+      n = p->u.array.count;
     }
     for (; n < len; n++) {
       int present = JS_TryGetPropertyInt64(ctx, obj, n, &val);
@@ -1107,6 +1260,17 @@ JSValue js_array_pop(JSContext* ctx, JSValueConst this_val, int argc, JSValueCon
         res = arrp[count32 - 1];
         p->u.array.count--;
       }
+    } else if (js_is_fast_array(ctx, obj) && JS_VALUE_GET_OBJ(obj)->u.array.count == len) {
+      /* the elements are stored as numbers */
+      JSObject* p = JS_VALUE_GET_OBJ(obj);
+      size_t elem_size = js_array_kind_size(p->u.array.kind);
+      if (shift) {
+        res = js_fast_array_get(ctx, p, 0);
+        memmove(p->u.array.u.ptr, (uint8_t*)p->u.array.u.ptr + elem_size, (len - 1) * elem_size);
+      } else {
+        res = js_fast_array_get(ctx, p, len - 1);
+      }
+      p->u.array.count--;
     } else {
       if (shift) {
         res = JS_GetPropertyInt64(ctx, obj, 0);
@@ -1194,6 +1358,28 @@ JSValue js_array_reverse(JSContext* ctx, JSValueConst this_val, int argc, JSValu
     }
     return obj;
   }
+  if (js_is_fast_array(ctx, obj) && JS_VALUE_GET_OBJ(obj)->u.array.count == len) {
+    /* the elements are stored as numbers */
+    JSObject* p = JS_VALUE_GET_OBJ(obj);
+    uint32_t ll, hh;
+
+    if (p->u.array.kind == JS_ARRAY_KIND_INT32) {
+      int32_t *tab = p->u.array.u.int32_ptr, v;
+      for (ll = 0, hh = len - 1; len > 1 && ll < hh; ll++, hh--) {
+        v = tab[ll];
+        tab[ll] = tab[hh];
+        tab[hh] = v;
+      }
+    } else {
+      double *tab = p->u.array.u.double_ptr, d;
+      for (ll = 0, hh = len - 1; len > 1 && ll < hh; ll++, hh--) {
+        d = tab[ll];
+        tab[ll] = tab[hh];
+        tab[hh] = d;
+      }
+    }
+    return obj;
+  }
 
   for (l = 0, h = len - 1; l < h; l++, h--) {
     l_present = JS_TryGetPropertyInt64(ctx, obj, l, &lval);
@@ -1240,8 +1426,7 @@ JSValue js_array_slice(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
   JSValue obj, arr, val, len_val;
   int64_t len, start, k, final, n, count, del_count, new_len;
   int kPresent;
-  JSValue* arrp;
-  uint32_t count32, i, item_count;
+  uint32_t i, item_count;
 
   arr = JS_UNDEFINED;
   obj = JS_ToObject(ctx, this_val);
@@ -1290,10 +1475,11 @@ JSValue js_array_slice(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
      JS_CreateDataPropertyUint32() won't modify obj in case arr is
      an exotic object */
   /* Special case fast arrays */
-  if (js_get_fast_array(ctx, obj, &arrp, &count32) && js_is_fast_array(ctx, arr)) {
+  if (js_is_fast_array(ctx, obj) && js_is_fast_array(ctx, arr)) {
+    JSObject* p = JS_VALUE_GET_OBJ(obj);
     /* XXX: should share code with fast array constructor */
-    for (; k < final && k < count32; k++, n++) {
-      if (JS_CreateDataPropertyUint32(ctx, arr, n, JS_DupValue(ctx, arrp[k]), JS_PROP_THROW) < 0)
+    for (; k < final && k < p->u.array.count; k++, n++) {
+      if (JS_CreateDataPropertyUint32(ctx, arr, n, js_fast_array_get(ctx, p, k), JS_PROP_THROW) < 0)
         goto exception;
     }
   }
@@ -1538,13 +1724,252 @@ exception:
   return 0;
 }
 
+/* Default order of two int32 values: compare their decimal
+   representations without converting them to strings. */
+static int js_array_cmp_int32(const void* a, const void* b, void* opaque) {
+  int32_t x = JS_VALUE_GET_INT(((const ValueSlot*)a)->val);
+  int32_t y = JS_VALUE_GET_INT(((const ValueSlot*)b)->val);
+  uint64_t ux, uy, px, py;
+
+  if (x == y)
+    return 0;
+  /* '-' sorts before the digits */
+  if ((x < 0) != (y < 0))
+    return x < 0 ? -1 : 1;
+  ux = x < 0 ? -(int64_t)x : x;
+  uy = y < 0 ? -(int64_t)y : y;
+  /* scale the shorter number to the length of the other one */
+  for (px = 10; px <= ux; px *= 10)
+    continue;
+  for (py = 10; py <= uy; py *= 10)
+    continue;
+  if (px < py) {
+    ux *= py / px;
+    /* a prefix sorts first */
+    return ux <= uy ? -1 : 1;
+  } else if (px > py) {
+    uy *= px / py;
+    return ux < uy ? -1 : 1;
+  }
+  return ux < uy ? -1 : 1;
+}
+
+/* Default order of two strings */
+static int js_array_cmp_string(const void* a, const void* b, void* opaque) {
+  struct array_sort_context* psc = opaque;
+  return js_string_compare(psc->ctx, JS_VALUE_GET_STRING(((const ValueSlot*)a)->val),
+                           JS_VALUE_GET_STRING(((const ValueSlot*)b)->val));
+}
+
+/* Stable merge sort of ValueSlot arrays in the style of TimSort:
+   ascending and descending runs already in the array are kept, short
+   runs are extended with a binary insertion sort, and the runs are
+   merged by pairs of similar lengths. Nearly sorted arrays take linear
+   time. */
+
+#define SORT_MIN_MERGE 64
+#define SORT_MAX_RUNS 85
+
+typedef int (*ValueSlotCmpFunc)(const void* a, const void* b, void* opaque);
+
+typedef struct ValueSlotSort {
+  ValueSlot* tab;
+  ValueSlot* tmp;
+  ValueSlotCmpFunc cmp;
+  void* opaque;
+  int run_count;
+  size_t run_base[SORT_MAX_RUNS];
+  size_t run_len[SORT_MAX_RUNS];
+} ValueSlotSort;
+
+/* sort tab[0..n) knowing that tab[0..start) is sorted */
+static void js_sort_insertion(ValueSlot* tab, size_t start, size_t n, ValueSlotCmpFunc cmp, void* opaque) {
+  size_t i, lo, hi, mid;
+  ValueSlot v;
+
+  for (i = start; i < n; i++) {
+    v = tab[i];
+    lo = 0;
+    hi = i;
+    /* insert after the equal elements to keep the sort stable */
+    while (lo < hi) {
+      mid = (lo + hi) >> 1;
+      if (cmp(&v, &tab[mid], opaque) < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    memmove(&tab[lo + 1], &tab[lo], (i - lo) * sizeof(tab[0]));
+    tab[lo] = v;
+  }
+}
+
+/* Return the length of the run starting at tab[0]. A strictly
+   descending run is reversed. */
+static size_t js_sort_count_run(ValueSlot* tab, size_t n, ValueSlotCmpFunc cmp, void* opaque) {
+  size_t i, l, h;
+  ValueSlot v;
+
+  if (n < 2)
+    return n;
+  if (cmp(&tab[1], &tab[0], opaque) < 0) {
+    for (i = 2; i < n && cmp(&tab[i], &tab[i - 1], opaque) < 0; i++)
+      continue;
+    for (l = 0, h = i - 1; l < h; l++, h--) {
+      v = tab[l];
+      tab[l] = tab[h];
+      tab[h] = v;
+    }
+  } else {
+    for (i = 2; i < n && cmp(&tab[i], &tab[i - 1], opaque) >= 0; i++)
+      continue;
+  }
+  return i;
+}
+
+/* Return the index of the first element of tab[0..n) greater than 'v'
+   if 'right' is TRUE, or not less than 'v' otherwise. */
+static size_t js_sort_search(const ValueSlot* v, const ValueSlot* tab, size_t n, BOOL right, ValueSlotCmpFunc cmp, void* opaque) {
+  size_t lo = 0, hi = n, mid;
+  int c;
+
+  while (lo < hi) {
+    mid = (lo + hi) >> 1;
+    c = cmp(v, &tab[mid], opaque);
+    if (c < 0 || (c == 0 && !right))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+/* merge the consecutive sorted runs a[0..n1) and a[n1..n1+n2) */
+static void js_sort_merge(ValueSlotSort* ss, ValueSlot* a, size_t n1, size_t n2) {
+  ValueSlot *b, *tmp = ss->tmp, *dst;
+  size_t i, j, k;
+
+  /* the elements of the first run before the second run are in place */
+  b = a + n1;
+  k = js_sort_search(&b[0], a, n1, TRUE, ss->cmp, ss->opaque);
+  a += k;
+  n1 -= k;
+  if (n1 == 0)
+    return;
+  /* and so are the elements of the second run after the first run */
+  n2 = js_sort_search(&a[n1 - 1], b, n2, FALSE, ss->cmp, ss->opaque);
+  if (n2 == 0)
+    return;
+  if (n1 <= n2) {
+    /* merge from the start with a copy of the first run */
+    memcpy(tmp, a, n1 * sizeof(a[0]));
+    dst = a;
+    i = j = 0;
+    while (i < n1 && j < n2) {
+      if (ss->cmp(&b[j], &tmp[i], ss->opaque) < 0)
+        *dst++ = b[j++];
+      else
+        *dst++ = tmp[i++];
+    }
+    memcpy(dst, tmp + i, (n1 - i) * sizeof(a[0]));
+  } else {
+    /* merge from the end with a copy of the second run */
+    memcpy(tmp, b, n2 * sizeof(a[0]));
+    dst = b + n2;
+    i = n1;
+    j = n2;
+    while (i > 0 && j > 0) {
+      if (ss->cmp(&tmp[j - 1], &a[i - 1], ss->opaque) < 0)
+        *--dst = a[--i];
+      else
+        *--dst = tmp[--j];
+    }
+    memcpy(dst - j, tmp, j * sizeof(a[0]));
+  }
+}
+
+static void js_sort_merge_at(ValueSlotSort* ss, int i) {
+  js_sort_merge(ss, ss->tab + ss->run_base[i], ss->run_len[i], ss->run_len[i + 1]);
+  ss->run_len[i] += ss->run_len[i + 1];
+  if (i == ss->run_count - 3) {
+    ss->run_base[i + 1] = ss->run_base[i + 2];
+    ss->run_len[i + 1] = ss->run_len[i + 2];
+  }
+  ss->run_count--;
+}
+
+/* keep the run lengths decreasing faster than the Fibonacci numbers so
+   that the merges stay balanced */
+static void js_sort_merge_collapse(ValueSlotSort* ss) {
+  size_t* len = ss->run_len;
+  int n;
+
+  while (ss->run_count > 1) {
+    n = ss->run_count - 2;
+    if ((n > 0 && len[n - 1] <= len[n] + len[n + 1]) || (n > 1 && len[n - 2] <= len[n - 1] + len[n])) {
+      if (len[n - 1] < len[n + 1])
+        n--;
+    } else if (len[n] > len[n + 1]) {
+      break;
+    }
+    js_sort_merge_at(ss, n);
+  }
+}
+
+/* Return -1 if memory error */
+static int js_sort_values(JSContext* ctx, ValueSlot* tab, size_t n, ValueSlotCmpFunc cmp, void* opaque) {
+  ValueSlotSort ss;
+  size_t min_run, lo, run, r;
+  int i;
+
+  if (n < SORT_MIN_MERGE) {
+    js_sort_insertion(tab, js_sort_count_run(tab, n, cmp, opaque), n, cmp, opaque);
+    return 0;
+  }
+  ss.tab = tab;
+  ss.tmp = js_malloc(ctx, (n / 2) * sizeof(tab[0]));
+  if (!ss.tmp)
+    return -1;
+  ss.cmp = cmp;
+  ss.opaque = opaque;
+  ss.run_count = 0;
+  /* min_run is between SORT_MIN_MERGE / 2 and SORT_MIN_MERGE, and
+     n / min_run is a power of 2 or slightly less */
+  r = 0;
+  for (min_run = n; min_run >= SORT_MIN_MERGE; min_run >>= 1)
+    r |= min_run & 1;
+  min_run += r;
+  for (lo = 0; lo < n; lo += run) {
+    run = js_sort_count_run(tab + lo, n - lo, cmp, opaque);
+    if (run < min_run) {
+      r = n - lo < min_run ? n - lo : min_run;
+      js_sort_insertion(tab + lo, run, r, cmp, opaque);
+      run = r;
+    }
+    ss.run_base[ss.run_count] = lo;
+    ss.run_len[ss.run_count] = run;
+    ss.run_count++;
+    js_sort_merge_collapse(&ss);
+  }
+  while (ss.run_count > 1) {
+    i = ss.run_count - 2;
+    if (i > 0 && ss.run_len[i - 1] < ss.run_len[i + 1])
+      i--;
+    js_sort_merge_at(&ss, i);
+  }
+  js_free(ctx, ss.tmp);
+  return 0;
+}
+
 JSValue js_array_sort(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
   struct array_sort_context asc = {ctx, 0, 0, argv[0]};
   JSValue obj = JS_UNDEFINED;
   ValueSlot* array = NULL;
-  size_t array_size = 0, pos = 0, n = 0;
+  size_t array_size = 0, pos = 0, n = 0, int_count = 0, string_count = 0;
   int64_t i, len, undefined_count = 0;
   int present;
+  ValueSlotCmpFunc cmp;
+  JSObject* p;
 
   if (!JS_IsUndefined(asc.method)) {
     if (check_function(ctx, asc.method))
@@ -1555,12 +1980,14 @@ JSValue js_array_sort(JSContext* ctx, JSValueConst this_val, int argc, JSValueCo
   if (js_get_length64(ctx, &len, obj))
     goto exception;
 
-  /* XXX: should special case fast arrays */
   for (i = 0; i < len; i++) {
     if (pos >= array_size) {
       size_t new_size, slack;
       ValueSlot* new_array;
       new_size = (array_size + (array_size >> 1) + 31) & ~15;
+      /* the elements of a fast array are all present */
+      if (js_is_fast_array(ctx, obj) && new_size < JS_VALUE_GET_OBJ(obj)->u.array.count)
+        new_size = JS_VALUE_GET_OBJ(obj)->u.array.count;
       new_array = js_realloc2(ctx, array, new_size * sizeof(*array), &slack);
       if (new_array == NULL)
         goto exception;
@@ -1568,29 +1995,49 @@ JSValue js_array_sort(JSContext* ctx, JSValueConst this_val, int argc, JSValueCo
       array = new_array;
       array_size = new_size;
     }
-    present = JS_TryGetPropertyInt64(ctx, obj, i, &array[pos].val);
-    if (present < 0)
-      goto exception;
-    if (present == 0)
-      continue;
+    if (!js_array_get_dense_element(ctx, obj, i, &array[pos].val)) {
+      present = JS_TryGetPropertyInt64(ctx, obj, i, &array[pos].val);
+      if (present < 0)
+        goto exception;
+      if (present == 0)
+        continue;
+    }
     if (JS_IsUndefined(array[pos].val)) {
       undefined_count++;
       continue;
     }
+    int_count += JS_VALUE_GET_TAG(array[pos].val) == JS_TAG_INT;
+    string_count += JS_VALUE_GET_TAG(array[pos].val) == JS_TAG_STRING;
     array[pos].str = NULL;
     array[pos].pos = i;
     pos++;
   }
-  rqsort(array, pos, sizeof(*array), js_array_cmp_generic, &asc);
+  /* the default order compares the values converted to strings */
+  cmp = js_array_cmp_generic;
+  if (!asc.has_method) {
+    if (int_count == pos)
+      cmp = js_array_cmp_int32;
+    else if (string_count == pos)
+      cmp = js_array_cmp_string;
+  }
+  if (js_sort_values(ctx, array, pos, cmp, &asc))
+    goto exception;
   if (asc.exception)
     goto exception;
 
-  /* XXX: should special case fast arrays */
   while (n < pos) {
     if (array[n].str)
       JS_FreeValue(ctx, JS_MKPTR(JS_TAG_STRING, array[n].str));
     if (array[n].pos == n) {
       JS_FreeValue(ctx, array[n].val);
+    } else if (js_is_fast_array(ctx, obj) && n < JS_VALUE_GET_OBJ(obj)->u.array.count) {
+      /* checked for each element: the comparison function may have
+         modified the array */
+      p = JS_VALUE_GET_OBJ(obj);
+      if (js_fast_array_set(ctx, p, n, array[n].val) < 0) {
+        n++;
+        goto exception;
+      }
     } else {
       if (JS_SetPropertyInt64(ctx, obj, n, array[n].val) < 0) {
         n++;
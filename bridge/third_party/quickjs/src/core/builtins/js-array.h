@@ -51,10 +51,136 @@ JSValue js_array_iterator_next(JSContext* ctx, JSValueConst this_val, int argc,
 
 JSValue js_create_array_iterator(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int magic);
 BOOL js_is_fast_array(JSContext* ctx, JSValueConst obj);
-/* Access an Array's internal JSValue array if available */
+/* Access an Array's internal JSValue array if available. It is not
+   available when the elements are stored as numbers. */
 BOOL js_get_fast_array(JSContext* ctx, JSValueConst obj, JSValue** arrpp, uint32_t* countp);
 
 int expand_fast_array(JSContext* ctx, JSObject* p, uint32_t new_len);
+int js_array_widen(JSContext* ctx, JSObject* p, JSArrayKindEnum kind);
+
+static inline size_t js_array_kind_size(JSArrayKindEnum kind) {
+  switch (kind) {
+    case JS_ARRAY_KIND_INT32:
+      return sizeof(int32_t);
+    case JS_ARRAY_KIND_FLOAT64:
+      return sizeof(double);
+    default:
+      return sizeof(JSValue);
+  }
+}
+
+/* Return the least general element kind that can store 'val' */
+static inline JSArrayKindEnum js_array_value_kind(JSValueConst val) {
+  switch (JS_VALUE_GET_NORM_TAG(val)) {
+    case JS_TAG_INT:
+      return JS_ARRAY_KIND_INT32;
+    case JS_TAG_FLOAT64: {
+      double d = JS_VALUE_GET_FLOAT64(val);
+      /* -0 must be kept */
+      if (d >= INT32_MIN && d <= INT32_MAX && d == (int32_t)d && (d != 0 || !signbit(d)))
+        return JS_ARRAY_KIND_INT32;
+      return JS_ARRAY_KIND_FLOAT64;
+    }
+    default:
+      return JS_ARRAY_KIND_VALUE;
+  }
+}
+
+/* Return the element 'idx' < count of the fast array 'p'. As for
+   Float64Array, integral doubles are not converted back to int32. */
+static inline JSValue js_fast_array_get(JSContext* ctx, JSObject* p, uint32_t idx) {
+  switch (p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+      return JS_NewInt32(ctx, p->u.array.u.int32_ptr[idx]);
+    case JS_ARRAY_KIND_FLOAT64:
+      return __JS_NewFloat64(ctx, p->u.array.u.double_ptr[idx]);
+    default:
+      return JS_DupValue(ctx, p->u.array.u.values[idx]);
+  }
+}
+
+/* Store 'val' in the slot 'idx' < size of the fast array 'p' without
+   freeing its previous content. The kind of 'p' must be able to store
+   'val'. */
+static inline void js_fast_array_init(JSObject* p, uint32_t idx, JSValue val) {
+  switch (p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+      if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+        p->u.array.u.int32_ptr[idx] = JS_VALUE_GET_INT(val);
+      else
+        p->u.array.u.int32_ptr[idx] = (int32_t)JS_VALUE_GET_FLOAT64(val);
+      break;
+    case JS_ARRAY_KIND_FLOAT64:
+      if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+        p->u.array.u.double_ptr[idx] = JS_VALUE_GET_INT(val);
+      else
+        p->u.array.u.double_ptr[idx] = JS_VALUE_GET_FLOAT64(val);
+      break;
+    default:
+      p->u.array.u.values[idx] = val;
+      break;
+  }
+}
+
+/* Replace the element 'idx' < count of the fast array 'p' by 'val'.
+   Return -1 if memory error ('val' is freed). */
+static inline int js_fast_array_set(JSContext* ctx, JSObject* p, uint32_t idx, JSValue val) {
+  JSArrayKindEnum kind;
+  JSValue old_val;
+
+  switch (p->u.array.kind) {
+    case JS_ARRAY_KIND_INT32:
+      if (likely(JS_VALUE_GET_TAG(val) == JS_TAG_INT)) {
+        p->u.array.u.int32_ptr[idx] = JS_VALUE_GET_INT(val);
+        return 0;
+      }
+      break;
+    case JS_ARRAY_KIND_FLOAT64:
+      if (JS_VALUE_GET_TAG(val) == JS_TAG_INT) {
+        p->u.array.u.double_ptr[idx] = JS_VALUE_GET_INT(val);
+        return 0;
+      } else if (JS_TAG_IS_FLOAT64(JS_VALUE_GET_TAG(val))) {
+        p->u.array.u.double_ptr[idx] = JS_VALUE_GET_FLOAT64(val);
+        return 0;
+      }
+      break;
+    default:
+      old_val = p->u.array.u.values[idx];
+      p->u.array.u.values[idx] = val;
+      JS_FreeValue(ctx, old_val);
+      return 0;
+  }
+  kind = js_array_value_kind(val);
+  if (kind > p->u.array.kind) {
+    if (js_array_widen(ctx, p, kind)) {
+      JS_FreeValue(ctx, val);
+      return -1;
+    }
+    if (kind == JS_ARRAY_KIND_VALUE) {
+      p->u.array.u.values[idx] = val;
+      return 0;
+    }
+  }
+  js_fast_array_init(p, idx, val);
+  return 0;
+}
+
+/* Read 'obj[prop]' without a call when 'obj' is a fast array and 'prop'
+   one of its indexes. Return FALSE if the generic path must be used. */
+static inline BOOL js_get_fast_array_element(JSContext* ctx, JSValueConst obj, JSValueConst prop, JSValue* pval) {
+  JSObject* p;
+  uint32_t idx;
+
+  if (JS_VALUE_GET_TAG(obj) != JS_TAG_OBJECT || JS_VALUE_GET_TAG(prop) != JS_TAG_INT)
+    return FALSE;
+  p = JS_VALUE_GET_OBJ(obj);
+  idx = JS_VALUE_GET_INT(prop);
+  /* 'count' is 0 when the array is not a fast array */
+  if (p->class_id != JS_CLASS_ARRAY || idx >= p->u.array.count)
+    return FALSE;
+  *pval = js_fast_array_get(ctx, p, idx);
+  return TRUE;
+}
 
 int JS_CopySubArray(JSContext* ctx, JSValueConst obj, int64_t to_pos, int64_t from_pos, int64_t count, int dir);
 JSValue js_array_constructor(JSContext* ctx, JSValueConst new_target, int argc, JSValueConst* argv);
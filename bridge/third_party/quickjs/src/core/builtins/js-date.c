@@ -505,7 +505,7 @@ JSValue js_date_constructor(JSContext* ctx, JSValueConst new_target, int argc, J
       }
     }
     v = JS_ToPrimitive(ctx, argv[0], HINT_NONE);
-    if (JS_IsString(v)) {
+    if (JS_VALUE_GET_TAG(v) == JS_TAG_STRING || JS_VALUE_GET_TAG(v) == JS_TAG_STRING_ROPE) {
       dv = js_Date_parse(ctx, JS_UNDEFINED, 1, (JSValueConst*)&v);
       JS_FreeValue(ctx, v);
       if (JS_IsException(dv))
@@ -248,7 +248,7 @@ JSValue* build_arg_list(JSContext* ctx, uint32_t* plen, JSValueConst array_arg)
   if ((p->class_id == JS_CLASS_ARRAY || p->class_id == JS_CLASS_ARGUMENTS) && p->fast_array &&
       len == p->u.array.count) {
     for (i = 0; i < len; i++) {
-      tab[i] = JS_DupValue(ctx, p->u.array.u.values[i]);
+      tab[i] = js_fast_array_get(ctx, p, i);
     }
   } else {
     for (i = 0; i < len; i++) {
@@ -27,14 +27,25 @@
 #include "../convertion.h"
 #include "../exception.h"
 #include "../function.h"
+#include "../malloc.h"
 #include "../object.h"
 #include "../parser.h"
 #include "../runtime.h"
+#include "../shape.h"
 #include "../string.h"
 #include "../types.h"
 #include "js-array.h"
 #include "js-function.h"
 #include "js-object.h"
+#include "quickjs/libregexp.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define JSON_USE_NEON
+#endif
 
 /* JSON */
 
@@ -174,8 +185,677 @@ fail:
   return JS_EXCEPTION;
 }
 
-JSValue JS_ParseJSON2(JSContext *ctx, const char *buf, size_t buf_len,
-                      const char *filename, int flags)
+/* Fast path for standard JSON. Structural characters, string contents
+   and whitespace runs are scanned 16 bytes at a time, objects reuse the
+   shape of the previous object found at the same place (e.g. the
+   previous element of an array) and arrays are built as fast arrays.
+   Anything unusual (syntax errors, non standard escapes, invalid UTF-8,
+   deep nesting) makes it give up, and the input is parsed again by the
+   tokenizer based parser above, which also reports the errors. */
+
+#define JSON_SHAPE_CACHE_SIZE 64
+
+typedef enum {
+  JSON_FAST_OK,
+  JSON_FAST_BAIL,
+  JSON_FAST_EXCEPTION,
+} JSONFastStatus;
+
+typedef struct JSONFastParser {
+  JSContext *ctx;
+  const uint8_t *p;
+  const uint8_t *end;
+  /* values and property names of the arrays and objects being built */
+  JSValue *values;
+  JSAtom *atoms;
+  uint32_t values_count;
+  uint32_t values_size;
+  uint32_t atoms_count;
+  uint32_t atoms_size;
+  /* shape of the last object built at a given depth and member
+     position, so that sibling objects with the same keys share it */
+  JSShape *shapes[JSON_SHAPE_CACHE_SIZE];
+} JSONFastParser;
+
+static inline BOOL json_is_space(int c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/* Return a pointer to the first '"', '\\' or control character in
+   [p, end), or 'end'. '*pnon_ascii' is set if bytes >= 0x80 were
+   skipped. */
+static const uint8_t *json_scan_string(const uint8_t *p, const uint8_t *end,
+                                       BOOL *pnon_ascii)
+{
+#if defined(JSON_USE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(0x20);
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    /* the signed comparison also matches the bytes >= 0x80 */
+    __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                   _mm_cmplt_epi8(v, space));
+    uint32_t high = _mm_movemask_epi8(v);
+    uint32_t mask = _mm_movemask_epi8(special) & ~high;
+    if (mask) {
+      int pos = ctz32(mask);
+      if (high & ((1u << pos) - 1))
+        *pnon_ascii = TRUE;
+      return p + pos;
+    }
+    if (high)
+      *pnon_ascii = TRUE;
+    p += 16;
+  }
+#elif defined(JSON_USE_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(0x20);
+  while (end - p >= 16) {
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, space));
+    uint8x16_t high = vcgeq_u8(v, vdupq_n_u8(0x80));
+    /* 4 bits per byte */
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+    uint64_t high_mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(high), 4)), 0);
+    if (mask) {
+      int pos = ctz64(mask) >> 2;
+      if (pos > 0 && (high_mask << (64 - 4 * pos)))
+        *pnon_ascii = TRUE;
+      return p + pos;
+    }
+    if (high_mask)
+      *pnon_ascii = TRUE;
+    p += 16;
+  }
+#endif
+  while (p < end) {
+    int c = *p;
+    if (c == '"' || c == '\\' || c < 0x20)
+      break;
+    if (c >= 0x80)
+      *pnon_ascii = TRUE;
+    p++;
+  }
+  return p;
+}
+
+static const uint8_t *json_skip_spaces(const uint8_t *p, const uint8_t *end)
+{
+  /* most separators are followed by at most one space */
+  if (p < end && json_is_space(*p))
+    p++;
+  if (p >= end || !json_is_space(*p))
+    return p;
+#if defined(JSON_USE_SSE2)
+  {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)p);
+      __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+      uint32_t mask = ~_mm_movemask_epi8(ws) & 0xffff;
+      if (mask)
+        return p + ctz32(mask);
+      p += 16;
+    }
+  }
+#elif defined(JSON_USE_NEON)
+  while (end - p >= 16) {
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+                             vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+    uint64_t mask = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(ws), 4)), 0);
+    if (mask)
+      return p + (ctz64(mask) >> 2);
+    p += 16;
+  }
+#endif
+  while (p < end && json_is_space(*p))
+    p++;
+  return p;
+}
+
+/* Check that [p, end) is well formed UTF-8. Surrogate code points are
+   accepted because JS_ToCStringLen() produces them for lone
+   surrogates. */
+static BOOL json_utf8_is_valid(const uint8_t *p, const uint8_t *end)
+{
+  while (p < end) {
+#if defined(JSON_USE_SSE2)
+    while (end - p >= 16 && _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p)) == 0)
+      p += 16;
+#elif defined(JSON_USE_NEON)
+    while (end - p >= 16 &&
+           vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vcgeq_u8(vld1q_u8(p), vdupq_n_u8(0x80))), 4)), 0) == 0)
+      p += 16;
+#endif
+    while (p < end && *p < 0x80)
+      p++;
+    if (p >= end)
+      break;
+    if (p[0] >= 0xc2 && p[0] <= 0xdf) {
+      if (end - p < 2 || (p[1] & 0xc0) != 0x80)
+        return FALSE;
+      p += 2;
+    } else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+      if (end - p < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[0] == 0xe0 && p[1] < 0xa0))
+        return FALSE;
+      p += 3;
+    } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+      if (end - p < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80 ||
+          (p[0] == 0xf0 && p[1] < 0x90) || (p[0] == 0xf4 && p[1] >= 0x90))
+        return FALSE;
+      p += 4;
+    } else {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* [p, end) must be valid UTF-8 */
+static int json_buffer_write_utf8(StringBuffer *b, const uint8_t *p, const uint8_t *end)
+{
+  const uint8_t *p_start;
+  while (p < end) {
+    p_start = p;
+    while (p < end && *p < 0x80)
+      p++;
+    if (p > p_start && string_buffer_write8(b, p_start, p - p_start))
+      return -1;
+    if (p < end && string_buffer_putc(b, unicode_from_utf8(p, end - p, &p)))
+      return -1;
+  }
+  return 0;
+}
+
+static inline int json_hex_digit(int c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+/* Parse the string starting after the opening quote. For ASCII strings
+   without escapes, [*pstart, *pend) is set to their contents and, unless
+   'want_value' is set, no string is created, so that property names can
+   be matched against a shape first. */
+static JSONFastStatus json_fast_parse_string(JSONFastParser *jp, JSValue *pval, const uint8_t **pstart,
+                                             const uint8_t **pend, BOOL want_value)
+{
+  JSContext *ctx = jp->ctx;
+  const uint8_t *p = jp->p, *q;
+  BOOL non_ascii = FALSE;
+  StringBuffer b_s, *b = &b_s;
+  int c, i, h;
+
+  q = json_scan_string(p, jp->end, &non_ascii);
+  if (q >= jp->end || *q < 0x20)
+    return JSON_FAST_BAIL;
+  if (q - p > JS_STRING_LEN_MAX)
+    return JSON_FAST_BAIL;
+  if (non_ascii && !json_utf8_is_valid(p, q))
+    return JSON_FAST_BAIL;
+  if (*q == '"') {
+    jp->p = q + 1;
+    *pval = JS_UNDEFINED;
+    if (non_ascii) {
+      *pstart = *pend = NULL;
+      *pval = JS_NewStringLen(ctx, (const char *)p, q - p);
+    } else {
+      *pstart = p;
+      *pend = q;
+      if (!want_value)
+        return JSON_FAST_OK;
+      *pval = js_new_string8(ctx, p, q - p);
+    }
+    return JS_IsException(*pval) ? JSON_FAST_EXCEPTION : JSON_FAST_OK;
+  }
+
+  /* escapes */
+  if (string_buffer_init(ctx, b, (q - p) + 16))
+    return JSON_FAST_EXCEPTION;
+  for (;;) {
+    if (json_buffer_write_utf8(b, p, q))
+      goto exception;
+    if (*q == '"')
+      break;
+    /* backslash */
+    if (q + 1 >= jp->end)
+      goto bail;
+    p = q + 2;
+    switch (q[1]) {
+      case '"':
+      case '\\':
+      case '/':
+        c = q[1];
+        break;
+      case 'b':
+        c = '\b';
+        break;
+      case 'f':
+        c = '\f';
+        break;
+      case 'n':
+        c = '\n';
+        break;
+      case 'r':
+        c = '\r';
+        break;
+      case 't':
+        c = '\t';
+        break;
+      case 'u':
+        c = 0;
+        for (i = 0; i < 4; i++) {
+          if (p >= jp->end || (h = json_hex_digit(*p)) < 0)
+            goto bail;
+          c = (c << 4) | h;
+          p++;
+        }
+        break;
+      default:
+        goto bail;
+    }
+    if (string_buffer_putc16(b, c))
+      goto exception;
+    non_ascii = FALSE;
+    q = json_scan_string(p, jp->end, &non_ascii);
+    if (q >= jp->end || *q < 0x20)
+      goto bail;
+    if (non_ascii && !json_utf8_is_valid(p, q))
+      goto bail;
+  }
+  jp->p = q + 1;
+  *pstart = *pend = NULL;
+  *pval = string_buffer_end(b);
+  return JS_IsException(*pval) ? JSON_FAST_EXCEPTION : JSON_FAST_OK;
+bail:
+  string_buffer_free(b);
+  return JSON_FAST_BAIL;
+exception:
+  string_buffer_free(b);
+  return JSON_FAST_EXCEPTION;
+}
+
+static JSONFastStatus json_fast_parse_number(JSONFastParser *jp, JSValue *pval)
+{
+  const uint8_t *p = jp->p, *start = p, *int_start;
+  char buf[64];
+  BOOL is_int = TRUE;
+  uint32_t n;
+
+  if (*p == '-')
+    p++;
+  int_start = p;
+  if (p >= jp->end) {
+    return JSON_FAST_BAIL;
+  } else if (*p == '0') {
+    p++;
+  } else if (*p >= '1' && *p <= '9') {
+    while (p < jp->end && is_digit(*p))
+      p++;
+  } else {
+    return JSON_FAST_BAIL;
+  }
+  if (p < jp->end && *p == '.') {
+    p++;
+    if (p >= jp->end || !is_digit(*p))
+      return JSON_FAST_BAIL;
+    while (p < jp->end && is_digit(*p))
+      p++;
+    is_int = FALSE;
+  }
+  if (p < jp->end && (*p == 'e' || *p == 'E')) {
+    p++;
+    if (p < jp->end && (*p == '+' || *p == '-'))
+      p++;
+    if (p >= jp->end || !is_digit(*p))
+      return JSON_FAST_BAIL;
+    while (p < jp->end && is_digit(*p))
+      p++;
+    is_int = FALSE;
+  }
+  jp->p = p;
+
+  if (is_int && p - int_start <= 9 && !(start[0] == '-' && int_start[0] == '0')) {
+    n = 0;
+    while (int_start < p)
+      n = n * 10 + (*int_start++ - '0');
+    *pval = JS_NewInt32(jp->ctx, start[0] == '-' ? -(int32_t)n : (int32_t)n);
+    return JSON_FAST_OK;
+  }
+  if (p - start >= sizeof(buf))
+    return JSON_FAST_BAIL;
+  memcpy(buf, start, p - start);
+  buf[p - start] = '\0';
+  *pval = JS_NewFloat64(jp->ctx, js_strtod(buf, 10, !is_int));
+  return JSON_FAST_OK;
+}
+
+static int json_fast_push_value(JSONFastParser *jp, JSValue val)
+{
+  if (unlikely(jp->values_count >= jp->values_size)) {
+    uint32_t new_size = max_int(16, jp->values_size * 3 / 2);
+    JSValue *new_values = js_realloc(jp->ctx, jp->values, sizeof(JSValue) * new_size);
+    if (!new_values) {
+      JS_FreeValue(jp->ctx, val);
+      return -1;
+    }
+    jp->values = new_values;
+    jp->values_size = new_size;
+  }
+  jp->values[jp->values_count++] = val;
+  return 0;
+}
+
+static int json_fast_push_atom(JSONFastParser *jp, JSAtom atom)
+{
+  if (unlikely(jp->atoms_count >= jp->atoms_size)) {
+    uint32_t new_size = max_int(16, jp->atoms_size * 3 / 2);
+    JSAtom *new_atoms = js_realloc(jp->ctx, jp->atoms, sizeof(JSAtom) * new_size);
+    if (!new_atoms) {
+      JS_FreeAtom(jp->ctx, atom);
+      return -1;
+    }
+    jp->atoms = new_atoms;
+    jp->atoms_size = new_size;
+  }
+  jp->atoms[jp->atoms_count++] = atom;
+  return 0;
+}
+
+static void json_fast_pop(JSONFastParser *jp, uint32_t values_base, uint32_t atoms_base)
+{
+  while (jp->values_count > values_base)
+    JS_FreeValue(jp->ctx, jp->values[--jp->values_count]);
+  while (jp->atoms_count > atoms_base)
+    JS_FreeAtom(jp->ctx, jp->atoms[--jp->atoms_count]);
+}
+
+/* TRUE if the property name [start, end) is 'atom' */
+static BOOL json_atom_equals(JSRuntime *rt, JSAtom atom, const uint8_t *start, const uint8_t *end)
+{
+  JSString *str;
+  if (__JS_AtomIsTaggedInt(atom))
+    return FALSE;
+  str = rt->atom_array[atom];
+  return !str->is_wide_char && str->len == end - start && memcmp(str->u.str8, start, end - start) == 0;
+}
+
+static JSONFastStatus json_fast_parse_value(JSONFastParser *jp, JSValue *pval, int depth, int position);
+
+static JSONFastStatus json_fast_parse_object(JSONFastParser *jp, JSValue *pval, int depth, int position)
+{
+  JSContext *ctx = jp->ctx;
+  uint32_t values_base = jp->values_count, atoms_base = jp->atoms_count, count, i;
+  JSShape **pshape = &jp->shapes[(depth * 31 + position) & (JSON_SHAPE_CACHE_SIZE - 1)];
+  JSShape *sh = *pshape;
+  const uint8_t *key_start, *key_end;
+  BOOL match = (sh != NULL);
+  JSONFastStatus status;
+  JSValue key, val, obj;
+  JSAtom atom;
+
+  jp->p = json_skip_spaces(jp->p, jp->end);
+  if (jp->p < jp->end && *jp->p == '}') {
+    jp->p++;
+    count = 0;
+    goto done;
+  }
+  for (count = 0;; count++) {
+    if (jp->p >= jp->end || *jp->p != '"')
+      goto bail;
+    jp->p++;
+    status = json_fast_parse_string(jp, &key, &key_start, &key_end, FALSE);
+    if (status != JSON_FAST_OK)
+      goto fail;
+    if (match && count < sh->prop_count && key_start &&
+        json_atom_equals(ctx->rt, sh->prop[count].atom, key_start, key_end)) {
+      atom = JS_DupAtom(ctx, sh->prop[count].atom);
+    } else {
+      match = FALSE;
+      if (key_start)
+        atom = JS_NewAtomLen(ctx, (const char *)key_start, key_end - key_start);
+      else
+        atom = JS_ValueToAtom(ctx, key);
+      JS_FreeValue(ctx, key);
+      if (atom == JS_ATOM_NULL)
+        goto exception;
+    }
+    if (json_fast_push_atom(jp, atom))
+      goto exception;
+
+    jp->p = json_skip_spaces(jp->p, jp->end);
+    if (jp->p >= jp->end || *jp->p != ':')
+      goto bail;
+    jp->p = json_skip_spaces(jp->p + 1, jp->end);
+    status = json_fast_parse_value(jp, &val, depth + 1, count);
+    if (status != JSON_FAST_OK)
+      goto fail;
+    if (json_fast_push_value(jp, val))
+      goto exception;
+
+    jp->p = json_skip_spaces(jp->p, jp->end);
+    if (jp->p >= jp->end)
+      goto bail;
+    if (*jp->p == '}') {
+      jp->p++;
+      count++;
+      break;
+    }
+    if (*jp->p != ',')
+      goto bail;
+    jp->p = json_skip_spaces(jp->p + 1, jp->end);
+  }
+
+done:
+  if (match && count == sh->prop_count) {
+    /* same keys in the same order as the previous object */
+    JSObject *p;
+    obj = JS_NewObjectFromShape(ctx, js_dup_shape(sh), JS_CLASS_OBJECT);
+    if (JS_IsException(obj))
+      goto exception;
+    p = JS_VALUE_GET_OBJ(obj);
+    for (i = 0; i < count; i++)
+      p->prop[i].u.value = jp->values[values_base + i];
+    jp->values_count = values_base;
+  } else {
+    obj = JS_NewObject(ctx);
+    if (JS_IsException(obj))
+      goto exception;
+    for (i = 0; i < count; i++) {
+      val = jp->values[values_base + i];
+      jp->values[values_base + i] = JS_UNDEFINED;
+      if (JS_DefinePropertyValue(ctx, obj, jp->atoms[atoms_base + i], val, JS_PROP_C_W_E) < 0) {
+        JS_FreeValue(ctx, obj);
+        goto exception;
+      }
+    }
+    jp->values_count = values_base;
+    /* remember the shape if the next object with the same keys can use
+       it as is */
+    sh = JS_VALUE_GET_OBJ(obj)->shape;
+    if (sh->is_hashed && sh->prop_count == count && sh->deleted_prop_count == 0 && count > 0) {
+      if (*pshape)
+        js_free_shape(ctx->rt, *pshape);
+      *pshape = js_dup_shape(sh);
+    }
+  }
+  json_fast_pop(jp, values_base, atoms_base);
+  *pval = obj;
+  return JSON_FAST_OK;
+bail:
+  status = JSON_FAST_BAIL;
+  goto fail;
+exception:
+  status = JSON_FAST_EXCEPTION;
+fail:
+  json_fast_pop(jp, values_base, atoms_base);
+  return status;
+}
+
+static JSONFastStatus json_fast_parse_array(JSONFastParser *jp, JSValue *pval, int depth)
+{
+  JSContext *ctx = jp->ctx;
+  uint32_t values_base = jp->values_count, count, i;
+  JSArrayKindEnum kind, kind1;
+  JSONFastStatus status;
+  JSValue val, arr;
+  JSObject *p;
+
+  jp->p = json_skip_spaces(jp->p, jp->end);
+  if (jp->p < jp->end && *jp->p == ']') {
+    jp->p++;
+  } else {
+    for (;;) {
+      /* all the elements share the same shape cache entry */
+      status = json_fast_parse_value(jp, &val, depth + 1, 0);
+      if (status != JSON_FAST_OK)
+        goto fail;
+      if (json_fast_push_value(jp, val))
+        goto exception;
+      jp->p = json_skip_spaces(jp->p, jp->end);
+      if (jp->p >= jp->end)
+        goto bail;
+      if (*jp->p == ']') {
+        jp->p++;
+        break;
+      }
+      if (*jp->p != ',')
+        goto bail;
+      jp->p = json_skip_spaces(jp->p + 1, jp->end);
+    }
+  }
+
+  count = jp->values_count - values_base;
+  arr = JS_NewArray(ctx);
+  if (JS_IsException(arr))
+    goto exception;
+  if (count > 0) {
+    p = JS_VALUE_GET_OBJ(arr);
+    /* store numbers unboxed when all the elements are numbers */
+    kind = JS_ARRAY_KIND_INT32;
+    for(i = 0; i < count && kind != JS_ARRAY_KIND_VALUE; i++) {
+      kind1 = js_array_value_kind(jp->values[values_base + i]);
+      if (kind1 > kind)
+        kind = kind1;
+    }
+    p->u.array.kind = kind;
+    if (expand_fast_array(ctx, p, count)) {
+      JS_FreeValue(ctx, arr);
+      goto exception;
+    }
+    if (kind == JS_ARRAY_KIND_VALUE) {
+      memcpy(p->u.array.u.values, jp->values + values_base, sizeof(JSValue) * count);
+    } else {
+      for(i = 0; i < count; i++)
+        js_fast_array_init(p, i, jp->values[values_base + i]);
+    }
+    p->u.array.count = count;
+    p->prop[0].u.value = JS_NewUint32(ctx, count);
+    jp->values_count = values_base;
+  }
+  *pval = arr;
+  return JSON_FAST_OK;
+bail:
+  status = JSON_FAST_BAIL;
+  goto fail;
+exception:
+  status = JSON_FAST_EXCEPTION;
+fail:
+  json_fast_pop(jp, values_base, jp->atoms_count);
+  return status;
+}
+
+static inline BOOL json_is_ident_char(int c)
+{
+  return c >= 128 || ((lre_id_continue_table_ascii[c >> 5] >> (c & 31)) & 1);
+}
+
+static JSONFastStatus json_fast_parse_literal(JSONFastParser *jp, const char *str, size_t len)
+{
+  const uint8_t *p = jp->p;
+  if ((size_t)(jp->end - p) < len || memcmp(p, str, len) != 0)
+    return JSON_FAST_BAIL;
+  if (p + len < jp->end && json_is_ident_char(p[len]))
+    return JSON_FAST_BAIL;
+  jp->p = p + len;
+  return JSON_FAST_OK;
+}
+
+static JSONFastStatus json_fast_parse_value(JSONFastParser *jp, JSValue *pval, int depth, int position)
+{
+  const uint8_t *start, *end;
+
+  if (jp->p >= jp->end)
+    return JSON_FAST_BAIL;
+  switch (*jp->p) {
+    case '{':
+    case '[':
+      if (js_check_stack_overflow(jp->ctx->rt, 0))
+        return JSON_FAST_BAIL;
+      jp->p++;
+      if (jp->p[-1] == '{')
+        return json_fast_parse_object(jp, pval, depth, position);
+      return json_fast_parse_array(jp, pval, depth);
+    case '"':
+      jp->p++;
+      return json_fast_parse_string(jp, pval, &start, &end, TRUE);
+    case 't':
+      *pval = JS_TRUE;
+      return json_fast_parse_literal(jp, "true", 4);
+    case 'f':
+      *pval = JS_FALSE;
+      return json_fast_parse_literal(jp, "false", 5);
+    case 'n':
+      *pval = JS_NULL;
+      return json_fast_parse_literal(jp, "null", 4);
+    default:
+      return json_fast_parse_number(jp, pval);
+  }
+}
+
+/* Return JSON_FAST_BAIL if the slow parser must be used */
+static JSONFastStatus json_parse_fast(JSContext *ctx, const char *buf, size_t buf_len, JSValue *pval)
+{
+  JSONFastParser jp_s, *jp = &jp_s;
+  JSONFastStatus status;
+  int i;
+
+  memset(jp, 0, sizeof(*jp));
+  jp->ctx = ctx;
+  jp->p = (const uint8_t *)buf;
+  jp->end = jp->p + buf_len;
+  jp->p = json_skip_spaces(jp->p, jp->end);
+  status = json_fast_parse_value(jp, pval, 0, 0);
+  if (status == JSON_FAST_OK) {
+    jp->p = json_skip_spaces(jp->p, jp->end);
+    if (jp->p != jp->end) {
+      JS_FreeValue(ctx, *pval);
+      status = JSON_FAST_BAIL;
+    }
+  }
+  for (i = 0; i < JSON_SHAPE_CACHE_SIZE; i++) {
+    if (jp->shapes[i])
+      js_free_shape(ctx->rt, jp->shapes[i]);
+  }
+  js_free(ctx, jp->values);
+  js_free(ctx, jp->atoms);
+  return status;
+}
+
+static JSValue json_parse_tokens(JSContext *ctx, const char *buf, size_t buf_len,
+                                 const char *filename, int flags)
 {
   JSParseState s1, *s = &s1;
   JSValue val = JS_UNDEFINED;
@@ -198,6 +878,24 @@ fail:
   return JS_EXCEPTION;
 }
 
+JSValue JS_ParseJSON2(JSContext *ctx, const char *buf, size_t buf_len,
+                      const char *filename, int flags)
+{
+  JSValue val;
+
+  if (!(flags & JS_PARSE_JSON_EXT)) {
+    switch (json_parse_fast(ctx, buf, buf_len, &val)) {
+      case JSON_FAST_OK:
+        return val;
+      case JSON_FAST_EXCEPTION:
+        return JS_EXCEPTION;
+      case JSON_FAST_BAIL:
+        break;
+    }
+  }
+  return json_parse_tokens(ctx, buf, buf_len, filename, flags);
+}
+
 JSValue JS_ParseJSON(JSContext *ctx, const char *buf, size_t buf_len,
                      const char *filename)
 {
@@ -284,7 +982,11 @@ JSValue js_json_parse(JSContext *ctx, JSValueConst this_val,
   str = JS_ToCStringLen(ctx, &len, argv[0]);
   if (!str)
     return JS_EXCEPTION;
-  obj = JS_ParseJSON(ctx, str, len, "<input>");
+  /* the reviver walks the result, keep the parser it was written with */
+  if (argc > 1 && JS_IsFunction(ctx, argv[1]))
+    obj = json_parse_tokens(ctx, str, len, "<input>", 0);
+  else
+    obj = JS_ParseJSON(ctx, str, len, "<input>");
   JS_FreeCString(ctx, str);
   if (JS_IsException(obj))
     return obj;
@@ -307,15 +1009,402 @@ JSValue js_json_parse(JSContext *ctx, JSValueConst this_val,
   return obj;
 }
 
+#define JSON_SHAPE_ENTRY_CACHE_BITS 8
+/* larger output buffers are handed over to the result string */
+#define JSON_STRINGIFY_BUFFER_MAX_SIZE (1 << 20)
+
+/* Layout of a shape as seen by JSON.stringify. The entry keeps a
+   reference to the atoms of its snapshot, so a shape allocated later at
+   the same address only matches if it has the same properties. */
+typedef struct JSONShapeEntry {
+  int ref_count;
+  JSShape *shape;
+  int prop_count;
+  /* an own property is named toJSON */
+  BOOL has_to_json;
+  /* the enumerable string keys are 8 bit strings which are not array
+     indexes and name plain data properties */
+  BOOL is_plain;
+  JSShapeProperty *props; /* snapshot of shape->prop */
+  /* the '"key":' text of property i is keys[key_offsets[i]] to
+     keys[key_offsets[i + 1]], empty if the property is not written */
+  uint32_t *key_offsets;
+  uint8_t *keys;
+} JSONShapeEntry;
+
+typedef struct JSONStringifyCache {
+  JSONShapeEntry *shapes[1 << JSON_SHAPE_ENTRY_CACHE_BITS];
+  /* 8 bit output buffer kept between calls */
+  JSString *buffer;
+  int buffer_size;
+} JSONStringifyCache;
+
 typedef struct JSONStringifyContext {
   JSValueConst replacer_func;
-  JSValue stack;
+  JSObject **stack;
+  int stack_len;
+  int stack_size;
   JSValue property_list;
   JSValue gap;
   JSValue empty;
   StringBuffer *b;
+  JSONStringifyCache *cache;
+  /* no replacer nor gap: plain objects and fast arrays are written from
+     their shape */
+  BOOL fast;
+  /* incremented each time toJSON, a replacer or a getter may have run */
+  uint32_t check_count;
+  /* prototypes known to have no toJSON in their chain, for objects and
+     arrays, valid while check_count is unchanged */
+  JSObject *plain_protos[2];
+  uint32_t plain_protos_check_count[2];
 } JSONStringifyContext;
 
+static void json_shape_entry_free(JSRuntime *rt, JSONShapeEntry *e)
+{
+  int i;
+
+  if (--e->ref_count > 0)
+    return;
+  for(i = 0; i < e->prop_count; i++)
+    JS_FreeAtomRT(rt, e->props[i].atom);
+  js_free_rt(rt, e);
+}
+
+void js_free_json_stringify_cache(JSRuntime *rt)
+{
+  JSONStringifyCache *cache = rt->json_stringify_cache;
+  int i;
+
+  if (!cache)
+    return;
+  for(i = 0; i < countof(cache->shapes); i++) {
+    if (cache->shapes[i])
+      json_shape_entry_free(rt, cache->shapes[i]);
+  }
+  js_free_rt(rt, cache->buffer);
+  js_free_rt(rt, cache);
+  rt->json_stringify_cache = NULL;
+}
+
+static JSONStringifyCache *json_get_stringify_cache(JSRuntime *rt)
+{
+  if (!rt->json_stringify_cache)
+    rt->json_stringify_cache = js_mallocz_rt(rt, sizeof(JSONStringifyCache));
+  return rt->json_stringify_cache;
+}
+
+static inline BOOL json_needs_escape(uint32_t c)
+{
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+/* Return the first character of [p, end) which is escaped in a JSON
+   string. */
+static const uint8_t *json_scan_escape8(const uint8_t *p, const uint8_t *end)
+{
+#if defined(JSON_USE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1f);
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    /* v <= 0x1f as unsigned bytes */
+    __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                   _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+    uint32_t mask = _mm_movemask_epi8(special);
+    if (mask)
+      return p + ctz32(mask);
+    p += 16;
+  }
+#elif defined(JSON_USE_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t control = vdupq_n_u8(0x1f);
+  while (end - p >= 16) {
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcleq_u8(v, control));
+    /* 4 bits per byte */
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+    if (mask)
+      return p + (ctz64(mask) >> 2);
+    p += 16;
+  }
+#endif
+  while (p < end && !json_needs_escape(*p))
+    p++;
+  return p;
+}
+
+/* same escapes as JS_ToQuotedString() */
+static int json_write_escape(StringBuffer *b, uint32_t c)
+{
+  static const char hex[] = "0123456789abcdef";
+  uint8_t buf[6];
+
+  switch (c) {
+    case '\t':
+      c = 't';
+      goto quote;
+    case '\r':
+      c = 'r';
+      goto quote;
+    case '\n':
+      c = 'n';
+      goto quote;
+    case '\b':
+      c = 'b';
+      goto quote;
+    case '\f':
+      c = 'f';
+      goto quote;
+    case '\"':
+    case '\\':
+    quote:
+      buf[0] = '\\';
+      buf[1] = c;
+      return string_buffer_write8(b, buf, 2);
+    default:
+      buf[0] = '\\';
+      buf[1] = 'u';
+      buf[2] = hex[(c >> 12) & 15];
+      buf[3] = hex[(c >> 8) & 15];
+      buf[4] = hex[(c >> 4) & 15];
+      buf[5] = hex[c & 15];
+      return string_buffer_write8(b, buf, 6);
+  }
+}
+
+static int json_write_quoted8(StringBuffer *b, const uint8_t *p, uint32_t len)
+{
+  const uint8_t *end = p + len, *q;
+
+  if (string_buffer_putc8(b, '\"'))
+    return -1;
+  for(;;) {
+    q = json_scan_escape8(p, end);
+    if (q > p && string_buffer_write8(b, p, q - p))
+      return -1;
+    if (q == end)
+      break;
+    if (json_write_escape(b, *q))
+      return -1;
+    p = q + 1;
+  }
+  return string_buffer_putc8(b, '\"');
+}
+
+static int json_write_quoted16(StringBuffer *b, const uint16_t *p, uint32_t len)
+{
+  uint32_t i, start, c;
+
+  if (string_buffer_putc8(b, '\"'))
+    return -1;
+  for(i = start = 0; i < len; i++) {
+    c = p[i];
+    if (!json_needs_escape(c) && (c & 0xf800) != 0xd800)
+      continue;
+    /* surrogate pairs are copied, lone surrogates are escaped */
+    if ((c & 0xfc00) == 0xd800 && i + 1 < len && (p[i + 1] & 0xfc00) == 0xdc00) {
+      i++;
+      continue;
+    }
+    if (i > start && string_buffer_write16(b, p + start, i - start))
+      return -1;
+    if (json_write_escape(b, c))
+      return -1;
+    start = i + 1;
+  }
+  if (len > start && string_buffer_write16(b, p + start, len - start))
+    return -1;
+  return string_buffer_putc8(b, '\"');
+}
+
+static int json_write_quoted(StringBuffer *b, JSString *p)
+{
+  if (p->is_wide_char)
+    return json_write_quoted16(b, p->u.str16, p->len);
+  else
+    return json_write_quoted8(b, p->u.str8, p->len);
+}
+
+static int json_write_number(StringBuffer *b, JSValueConst val)
+{
+  char buf[JS_DTOA_BUF_SIZE];
+  double d;
+
+  if (JS_VALUE_GET_TAG(val) == JS_TAG_INT)
+    return string_buffer_puts8(b, i64toa(buf + sizeof(buf), JS_VALUE_GET_INT(val), 10));
+  d = JS_VALUE_GET_FLOAT64(val);
+  if (!isfinite(d))
+    return string_buffer_puts8(b, "null");
+  js_dtoa1(buf, d, 10, 0, JS_DTOA_VAR_FORMAT);
+  return string_buffer_puts8(b, buf);
+}
+
+static BOOL json_shape_entry_matches(JSONShapeEntry *e, JSShape *sh)
+{
+  return e->shape == sh && e->prop_count == sh->prop_count &&
+         !memcmp(e->props, get_shape_prop(sh), sh->prop_count * sizeof(JSShapeProperty));
+}
+
+static JSONShapeEntry *json_shape_entry_new(JSContext *ctx, JSShape *sh)
+{
+  JSRuntime *rt = ctx->rt;
+  StringBuffer kb_s, *kb = &kb_s;
+  JSONShapeEntry *e, *e1;
+  JSShapeProperty *pr;
+  JSAtomStruct *str;
+  size_t keys_offset;
+  uint32_t idx;
+  int i, n;
+
+  n = sh->prop_count;
+  keys_offset = sizeof(JSONShapeEntry) + n * sizeof(JSShapeProperty) + (n + 1) * sizeof(uint32_t);
+  e = js_malloc(ctx, keys_offset);
+  if (!e)
+    return NULL;
+  if (string_buffer_init(ctx, kb, 0)) {
+    js_free(ctx, e);
+    return NULL;
+  }
+  e->ref_count = 1;
+  e->shape = sh;
+  e->prop_count = n;
+  e->has_to_json = FALSE;
+  e->is_plain = TRUE;
+  e->props = (JSShapeProperty *)(e + 1);
+  e->key_offsets = (uint32_t *)(e->props + n);
+  memcpy(e->props, get_shape_prop(sh), n * sizeof(JSShapeProperty));
+  for(i = 0; i < n; i++) {
+    pr = &e->props[i];
+    JS_DupAtomRT(rt, pr->atom);
+    e->key_offsets[i] = kb->len;
+    if (pr->atom == JS_ATOM_toJSON)
+      e->has_to_json = TRUE;
+    if (pr->atom == JS_ATOM_NULL || !(pr->flags & JS_PROP_ENUMERABLE) || !e->is_plain)
+      continue;
+    if (__JS_AtomIsTaggedInt(pr->atom)) {
+      e->is_plain = FALSE;
+      continue;
+    }
+    str = rt->atom_array[pr->atom];
+    if (str->atom_type != JS_ATOM_TYPE_STRING)
+      continue;
+    if (str->is_wide_char || (pr->flags & JS_PROP_TMASK) != JS_PROP_NORMAL ||
+        JS_AtomIsArrayIndex(ctx, &idx, pr->atom)) {
+      e->is_plain = FALSE;
+      continue;
+    }
+    json_write_quoted8(kb, str->u.str8, str->len);
+    string_buffer_putc8(kb, ':');
+  }
+  e->key_offsets[n] = kb->len;
+  if (kb->error_status) {
+    json_shape_entry_free(rt, e);
+    return NULL;
+  }
+  e1 = js_realloc(ctx, e, keys_offset + kb->len);
+  if (!e1) {
+    string_buffer_free(kb);
+    json_shape_entry_free(rt, e);
+    return NULL;
+  }
+  e = e1;
+  e->props = (JSShapeProperty *)(e + 1);
+  e->key_offsets = (uint32_t *)(e->props + n);
+  e->keys = (uint8_t *)e + keys_offset;
+  memcpy(e->keys, kb->str->u.str8, kb->len);
+  string_buffer_free(kb);
+  return e;
+}
+
+static JSONShapeEntry *json_find_shape_entry(JSContext *ctx, JSONStringifyCache *cache, JSShape *sh)
+{
+  JSONShapeEntry *e, **pe;
+  uintptr_t h;
+
+  h = (uintptr_t)sh;
+  h = (h >> 4) ^ (h >> (4 + JSON_SHAPE_ENTRY_CACHE_BITS));
+  pe = &cache->shapes[h & ((1 << JSON_SHAPE_ENTRY_CACHE_BITS) - 1)];
+  e = *pe;
+  if (likely(e && json_shape_entry_matches(e, sh)))
+    return e;
+  e = json_shape_entry_new(ctx, sh);
+  if (!e)
+    return NULL;
+  if (*pe)
+    json_shape_entry_free(ctx->rt, *pe);
+  *pe = e;
+  return e;
+}
+
+static BOOL json_proto_is_plain(JSONStringifyContext *jsc, JSObject *proto, int kind)
+{
+  JSObject *p;
+
+  if (jsc->plain_protos[kind] == proto &&
+      jsc->plain_protos_check_count[kind] == jsc->check_count)
+    return TRUE;
+  for(p = proto; p != NULL; p = p->shape->proto) {
+    if (p->is_exotic && p->class_id != JS_CLASS_ARRAY)
+      return FALSE;
+    if (find_own_property1(p, JS_ATOM_toJSON))
+      return FALSE;
+  }
+  jsc->plain_protos[kind] = proto;
+  jsc->plain_protos_check_count[kind] = jsc->check_count;
+  return TRUE;
+}
+
+/* Return 1 and the shape entry of 'p' if it is written by the fast path:
+   a plain object with plain data properties or a fast array, with no
+   toJSON method. Return -1 if exception. */
+static int json_fast_entry(JSContext *ctx, JSONStringifyContext *jsc, JSObject *p, JSONShapeEntry **pe)
+{
+  JSONShapeEntry *e;
+  int kind;
+
+  if (p->class_id == JS_CLASS_OBJECT) {
+    kind = 0;
+  } else if (p->class_id == JS_CLASS_ARRAY && p->fast_array &&
+             JS_VALUE_GET_TAG(p->prop[0].u.value) == JS_TAG_INT &&
+             JS_VALUE_GET_INT(p->prop[0].u.value) == p->u.array.count) {
+    kind = 1;
+  } else {
+    return 0;
+  }
+  e = json_find_shape_entry(ctx, jsc->cache, p->shape);
+  if (!e)
+    return -1;
+  if (e->has_to_json || (kind == 0 && !e->is_plain))
+    return 0;
+  if (!json_proto_is_plain(jsc, p->shape->proto, kind))
+    return 0;
+  *pe = e;
+  return 1;
+}
+
+static BOOL json_stack_has(JSONStringifyContext *jsc, JSObject *p)
+{
+  int i;
+
+  for(i = 0; i < jsc->stack_len; i++) {
+    if (jsc->stack[i] == p)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static int json_stack_push(JSContext *ctx, JSONStringifyContext *jsc, JSObject *p)
+{
+  if (js_resize_array(ctx, (void **)&jsc->stack, sizeof(jsc->stack[0]),
+                      &jsc->stack_size, jsc->stack_len + 1))
+    return -1;
+  jsc->stack[jsc->stack_len++] = p;
+  return 0;
+}
+
 JSValue JS_ToQuotedStringFree(JSContext *ctx, JSValue val) {
   JSValue r = JS_ToQuotedString(ctx, val);
   JS_FreeValue(ctx, val);
@@ -328,6 +1417,7 @@ JSValue js_json_check(JSContext *ctx, JSONStringifyContext *jsc,
   JSValue v;
   JSValueConst args[2];
 
+  jsc->check_count++;
   if (JS_IsObject(val)
 #ifdef CONFIG_BIGNUM
       ||  JS_IsBigInt(ctx, val)   /* XXX: probably useless */
@@ -362,6 +1452,7 @@ JSValue js_json_check(JSContext *ctx, JSONStringifyContext *jsc,
       if (JS_IsFunction(ctx, val))
         break;
     case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
     case JS_TAG_INT:
     case JS_TAG_FLOAT64:
 #ifdef CONFIG_BIGNUM
@@ -385,12 +1476,193 @@ exception:
   return JS_EXCEPTION;
 }
 
+int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
+                          JSValueConst holder, JSValue val,
+                          JSValueConst indent);
+
+/* Prepare a member value for json_write_member(): *pe is set if it is an
+   object written by the fast path, other objects go through
+   js_json_check(). Return JS_UNDEFINED if the member is skipped. */
+static JSValue json_fast_member(JSContext *ctx, JSONStringifyContext *jsc,
+                                JSValueConst holder, JSValue val,
+                                JSAtom atom, uint32_t index,
+                                JSONShapeEntry **pe)
+{
+  JSValue key;
+  int ret;
+
+  *pe = NULL;
+  switch (JS_VALUE_GET_NORM_TAG(val)) {
+    case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
+    case JS_TAG_INT:
+    case JS_TAG_FLOAT64:
+    case JS_TAG_BOOL:
+    case JS_TAG_NULL:
+      return val;
+    case JS_TAG_UNDEFINED:
+    case JS_TAG_SYMBOL:
+      JS_FreeValue(ctx, val);
+      return JS_UNDEFINED;
+    case JS_TAG_OBJECT:
+      ret = json_fast_entry(ctx, jsc, JS_VALUE_GET_OBJ(val), pe);
+      if (ret < 0) {
+        JS_FreeValue(ctx, val);
+        return JS_EXCEPTION;
+      }
+      if (ret)
+        return val;
+      break;
+    default:
+      break;
+  }
+  if (atom != JS_ATOM_NULL)
+    key = JS_AtomToString(ctx, atom);
+  else
+    key = JS_ToStringFree(ctx, JS_NewInt64(ctx, index));
+  if (JS_IsException(key)) {
+    JS_FreeValue(ctx, val);
+    return JS_EXCEPTION;
+  }
+  val = js_json_check(ctx, jsc, holder, val, key);
+  JS_FreeValue(ctx, key);
+  return val;
+}
+
+static int json_write_fast(JSContext *ctx, JSONStringifyContext *jsc,
+                           JSValue val, JSONShapeEntry *e);
+
+static inline int json_write_member(JSContext *ctx, JSONStringifyContext *jsc,
+                                    JSValueConst holder, JSValue val,
+                                    JSONShapeEntry *e)
+{
+  if (e)
+    return json_write_fast(ctx, jsc, val, e);
+  return js_json_to_str(ctx, jsc, holder, val, jsc->empty);
+}
+
+static int json_write_fast_array(JSContext *ctx, JSONStringifyContext *jsc,
+                                 JSValueConst val)
+{
+  JSObject *p = JS_VALUE_GET_OBJ(val);
+  JSONShapeEntry *e;
+  uint32_t i, len;
+  JSValue v;
+
+  len = p->u.array.count;
+  string_buffer_putc8(jsc->b, '[');
+  for(i = 0; i < len; i++) {
+    if (i > 0)
+      string_buffer_putc8(jsc->b, ',');
+    /* toJSON may have modified the array */
+    if (likely(p->fast_array && i < p->u.array.count)) {
+      v = js_fast_array_get(ctx, p, i);
+    } else {
+      v = JS_GetPropertyInt64(ctx, val, i);
+      if (JS_IsException(v))
+        return -1;
+      jsc->check_count++;
+    }
+    v = json_fast_member(ctx, jsc, val, v, JS_ATOM_NULL, i, &e);
+    if (JS_IsException(v))
+      return -1;
+    if (JS_IsUndefined(v))
+      v = JS_NULL;
+    if (json_write_member(ctx, jsc, val, v, e))
+      return -1;
+  }
+  return string_buffer_putc8(jsc->b, ']');
+}
+
+static int json_write_fast_object(JSContext *ctx, JSONStringifyContext *jsc,
+                                  JSValueConst val, JSONShapeEntry *e)
+{
+  JSObject *p = JS_VALUE_GET_OBJ(val);
+  JSONShapeEntry *e1;
+  uint32_t check_count, key_start, key_len;
+  BOOL has_content, same_shape;
+  int i, ret;
+  JSValue v;
+
+  /* keep the snapshot of the keys if the cache entry is replaced */
+  e->ref_count++;
+  ret = -1;
+  has_content = FALSE;
+  same_shape = TRUE;
+  check_count = jsc->check_count;
+  string_buffer_putc8(jsc->b, '{');
+  for(i = 0; i < e->prop_count; i++) {
+    key_start = e->key_offsets[i];
+    key_len = e->key_offsets[i + 1] - key_start;
+    if (key_len == 0)
+      continue;
+    if (same_shape && check_count != jsc->check_count) {
+      /* toJSON or a getter may have modified the object */
+      same_shape = p->shape == e->shape && json_shape_entry_matches(e, p->shape);
+      check_count = jsc->check_count;
+    }
+    if (likely(same_shape)) {
+      v = JS_DupValue(ctx, p->prop[i].u.value);
+    } else {
+      v = JS_GetProperty(ctx, val, e->props[i].atom);
+      if (JS_IsException(v))
+        goto done;
+    }
+    v = json_fast_member(ctx, jsc, val, v, e->props[i].atom, 0, &e1);
+    if (JS_IsException(v))
+      goto done;
+    if (JS_IsUndefined(v))
+      continue;
+    if (has_content)
+      string_buffer_putc8(jsc->b, ',');
+    string_buffer_write8(jsc->b, e->keys + key_start, key_len);
+    if (json_write_member(ctx, jsc, val, v, e1))
+      goto done;
+    has_content = TRUE;
+  }
+  ret = string_buffer_putc8(jsc->b, '}');
+done:
+  json_shape_entry_free(ctx->rt, e);
+  return ret;
+}
+
+/* write a plain object or a fast array from its shape */
+static int json_write_fast(JSContext *ctx, JSONStringifyContext *jsc,
+                           JSValue val, JSONShapeEntry *e)
+{
+  JSObject *p = JS_VALUE_GET_OBJ(val);
+  int ret;
+
+  if (js_check_stack_overflow(ctx->rt, 0)) {
+    JS_ThrowStackOverflow(ctx);
+    goto exception;
+  }
+  if (json_stack_has(jsc, p)) {
+    JS_ThrowTypeError(ctx, "circular reference");
+    goto exception;
+  }
+  if (json_stack_push(ctx, jsc, p))
+    goto exception;
+  if (p->class_id == JS_CLASS_ARRAY)
+    ret = json_write_fast_array(ctx, jsc, val);
+  else
+    ret = json_write_fast_object(ctx, jsc, val, e);
+  jsc->stack_len--;
+  JS_FreeValue(ctx, val);
+  return ret;
+
+exception:
+  JS_FreeValue(ctx, val);
+  return -1;
+}
+
 int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
                           JSValueConst holder, JSValue val,
                           JSValueConst indent)
 {
   JSValue indent1, sep, sep1, tab, v, prop;
   JSObject *p;
+  JSONShapeEntry *e;
   int64_t i, len;
   int cl, ret;
   BOOL has_content;
@@ -404,6 +1676,13 @@ int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
   switch (JS_VALUE_GET_NORM_TAG(val)) {
     case JS_TAG_OBJECT:
       p = JS_VALUE_GET_OBJ(val);
+      if (jsc->fast) {
+        ret = json_fast_entry(ctx, jsc, p, &e);
+        if (ret < 0)
+          goto exception;
+        if (ret)
+          return json_write_fast(ctx, jsc, val, e);
+      }
       cl = p->class_id;
       if (cl == JS_CLASS_STRING) {
         val = JS_ToStringFree(ctx, val);
@@ -431,10 +1710,7 @@ int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
         goto exception;
       }
 #endif
-      v = js_array_includes(ctx, jsc->stack, 1, (JSValueConst *)&val);
-      if (JS_IsException(v))
-        goto exception;
-      if (JS_ToBoolFree(ctx, v)) {
+      if (json_stack_has(jsc, p)) {
         JS_ThrowTypeError(ctx, "circular reference");
         goto exception;
       }
@@ -452,8 +1728,7 @@ int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
         sep = JS_DupValue(ctx, jsc->empty);
         sep1 = JS_DupValue(ctx, jsc->empty);
       }
-      v = js_array_push(ctx, jsc->stack, 1, (JSValueConst *)&val, 0);
-      if (check_exception_free(ctx, v))
+      if (json_stack_push(ctx, jsc, p))
         goto exception;
       ret = JS_IsArray(ctx, val);
       if (ret < 0)
@@ -533,8 +1808,7 @@ int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
         }
         string_buffer_putc8(jsc->b, '}');
       }
-      if (check_exception_free(ctx, js_array_pop(ctx, jsc->stack, 0, NULL, 0)))
-        goto exception;
+      jsc->stack_len--;
       JS_FreeValue(ctx, val);
       JS_FreeValue(ctx, tab);
       JS_FreeValue(ctx, sep);
@@ -542,23 +1816,23 @@ int js_json_to_str(JSContext *ctx, JSONStringifyContext *jsc,
       JS_FreeValue(ctx, indent1);
       JS_FreeValue(ctx, prop);
       return 0;
-    case JS_TAG_STRING:
-      val = JS_ToQuotedStringFree(ctx, val);
+    case JS_TAG_STRING_ROPE:
+      val = js_flatten_string_value(ctx, val);
       if (JS_IsException(val))
-        goto exception;
-      goto concat_value;
+        return -1;
+      /* fall through */
+    case JS_TAG_STRING:
+      ret = json_write_quoted(jsc->b, JS_VALUE_GET_STRING(val));
+      JS_FreeValue(ctx, val);
+      return ret;
     case JS_TAG_FLOAT64:
-      if (!isfinite(JS_VALUE_GET_FLOAT64(val))) {
-        val = JS_NULL;
-      }
-      goto concat_value;
     case JS_TAG_INT:
+      return json_write_number(jsc->b, val);
 #ifdef CONFIG_BIGNUM
     case JS_TAG_BIG_FLOAT:
 #endif
     case JS_TAG_BOOL:
     case JS_TAG_NULL:
-    concat_value:
       return string_buffer_concat_value_free(jsc->b, val);
 #ifdef CONFIG_BIGNUM
     case JS_TAG_BIG_INT:
@@ -580,6 +1854,46 @@ exception:
   return -1;
 }
 
+/* start with the output buffer kept by the previous call */
+static int json_buffer_init(JSContext *ctx, JSONStringifyCache *cache, StringBuffer *b)
+{
+  if (!cache || !cache->buffer)
+    return string_buffer_init(ctx, b, 0);
+  b->ctx = ctx;
+  b->str = cache->buffer;
+  b->len = 0;
+  b->size = cache->buffer_size;
+  b->is_wide_char = 0;
+  b->error_status = 0;
+  cache->buffer = NULL;
+  return 0;
+}
+
+static void json_buffer_free(JSONStringifyCache *cache, StringBuffer *b)
+{
+  if (cache && !cache->buffer && b->str && !b->is_wide_char &&
+      b->size <= JSON_STRINGIFY_BUFFER_MAX_SIZE) {
+    cache->buffer = b->str;
+    cache->buffer_size = b->size;
+    b->str = NULL;
+  } else {
+    string_buffer_free(b);
+  }
+}
+
+static JSValue json_buffer_end(JSContext *ctx, JSONStringifyCache *cache, StringBuffer *b)
+{
+  JSValue ret;
+
+  if (!cache || b->error_status || b->is_wide_char ||
+      b->size > JSON_STRINGIFY_BUFFER_MAX_SIZE)
+    return string_buffer_end(b);
+  /* copy the text and keep the buffer */
+  ret = js_new_string8(ctx, b->str->u.str8, b->len);
+  json_buffer_free(cache, b);
+  return ret;
+}
+
 JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
                          JSValueConst replacer, JSValueConst space0)
 {
@@ -590,18 +1904,22 @@ JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
   int64_t i, j, n;
 
   jsc->replacer_func = JS_UNDEFINED;
-  jsc->stack = JS_UNDEFINED;
+  jsc->stack = NULL;
+  jsc->stack_len = 0;
+  jsc->stack_size = 0;
   jsc->property_list = JS_UNDEFINED;
   jsc->gap = JS_UNDEFINED;
   jsc->b = &b_s;
   jsc->empty = JS_AtomToString(ctx, JS_ATOM_empty_string);
+  jsc->cache = json_get_stringify_cache(ctx->rt);
+  jsc->fast = FALSE;
+  jsc->check_count = 0;
+  jsc->plain_protos[0] = jsc->plain_protos[1] = NULL;
+  jsc->plain_protos_check_count[0] = jsc->plain_protos_check_count[1] = 0;
   ret = JS_UNDEFINED;
   wrapper = JS_UNDEFINED;
 
-  string_buffer_init(ctx, jsc->b, 0);
-  jsc->stack = JS_NewArray(ctx);
-  if (JS_IsException(jsc->stack))
-    goto exception;
+  json_buffer_init(ctx, jsc->cache, jsc->b);
   if (JS_IsFunction(ctx, replacer)) {
     jsc->replacer_func = replacer;
   } else {
@@ -635,7 +1953,7 @@ JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
           v = JS_ToStringFree(ctx, v);
           if (JS_IsException(v))
             goto exception;
-        } else if (!JS_IsString(v)) {
+        } else if (JS_VALUE_GET_TAG(v) != JS_TAG_STRING && JS_VALUE_GET_TAG(v) != JS_TAG_STRING_ROPE) {
           JS_FreeValue(ctx, v);
           continue;
         }
@@ -666,6 +1984,9 @@ JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
       goto exception;
     }
   }
+  space = js_flatten_string_value(ctx, space);
+  if (JS_IsException(space))
+    goto exception;
   if (JS_IsNumber(space)) {
     int n;
     if (JS_ToInt32Clamp(ctx, &n, space, 0, 10, 0))
@@ -680,6 +2001,8 @@ JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
   JS_FreeValue(ctx, space);
   if (JS_IsException(jsc->gap))
     goto exception;
+  jsc->fast = jsc->cache && JS_IsUndefined(jsc->replacer_func) &&
+              JS_IsUndefined(jsc->property_list) && JS_IsEmptyString(jsc->gap);
   wrapper = JS_NewObject(ctx);
   if (JS_IsException(wrapper))
     goto exception;
@@ -698,19 +2021,19 @@ JSValue JS_JSONStringify(JSContext *ctx, JSValueConst obj,
   if (js_json_to_str(ctx, jsc, wrapper, val, jsc->empty))
     goto exception;
 
-  ret = string_buffer_end(jsc->b);
+  ret = json_buffer_end(ctx, jsc->cache, jsc->b);
   goto done;
 
 exception:
   ret = JS_EXCEPTION;
 done1:
-  string_buffer_free(jsc->b);
+  json_buffer_free(jsc->cache, jsc->b);
 done:
   JS_FreeValue(ctx, wrapper);
   JS_FreeValue(ctx, jsc->empty);
   JS_FreeValue(ctx, jsc->gap);
   JS_FreeValue(ctx, jsc->property_list);
-  JS_FreeValue(ctx, jsc->stack);
+  js_free(ctx, jsc->stack);
   return ret;
 }
 
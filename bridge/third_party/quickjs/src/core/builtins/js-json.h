@@ -28,4 +28,6 @@
 
 #include "quickjs/quickjs.h"
 
+void js_free_json_stringify_cache(JSRuntime* rt);
+
 #endif
\ No newline at end of file
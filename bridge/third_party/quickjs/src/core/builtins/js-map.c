@@ -174,6 +174,12 @@ JSValueConst map_normalize_key(JSContext *ctx, JSValueConst key)
   /* convert -0.0 to +0.0 */
   if (JS_TAG_IS_FLOAT64(tag) && JS_VALUE_GET_FLOAT64(key) == 0.0) {
     key = JS_NewInt32(ctx, 0);
+  } else if (tag == JS_TAG_STRING_ROPE) {
+    /* the flat string is owned by the rope */
+    JSString *p = js_flatten_string_rope(ctx, key);
+    if (!p)
+      return JS_EXCEPTION;
+    key = JS_MKPTR(JS_TAG_STRING, p);
   }
   return key;
 }
@@ -386,6 +392,8 @@ JSValue js_map_set(JSContext *ctx, JSValueConst this_val,
   if (!s)
     return JS_EXCEPTION;
   key = map_normalize_key(ctx, argv[0]);
+  if (JS_IsException(key))
+    return JS_EXCEPTION;
   if (s->is_weak && !JS_IsObject(key))
     return JS_ThrowTypeErrorNotAnObject(ctx);
   if (magic & MAGIC_SET)
@@ -414,6 +422,8 @@ JSValue js_map_get(JSContext *ctx, JSValueConst this_val,
   if (!s)
     return JS_EXCEPTION;
   key = map_normalize_key(ctx, argv[0]);
+  if (JS_IsException(key))
+    return JS_EXCEPTION;
   mr = map_find_record(ctx, s, key);
   if (!mr)
     return JS_UNDEFINED;
@@ -431,6 +441,8 @@ JSValue js_map_has(JSContext *ctx, JSValueConst this_val,
   if (!s)
     return JS_EXCEPTION;
   key = map_normalize_key(ctx, argv[0]);
+  if (JS_IsException(key))
+    return JS_EXCEPTION;
   mr = map_find_record(ctx, s, key);
   return JS_NewBool(ctx, (mr != NULL));
 }
@@ -445,6 +457,8 @@ JSValue js_map_delete(JSContext *ctx, JSValueConst this_val,
   if (!s)
     return JS_EXCEPTION;
   key = map_normalize_key(ctx, argv[0]);
+  if (JS_IsException(key))
+    return JS_EXCEPTION;
   mr = map_find_record(ctx, s, key);
   if (!mr)
     return JS_FALSE;
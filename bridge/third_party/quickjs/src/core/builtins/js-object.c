@@ -71,6 +71,13 @@ JSValue JS_ToObject(JSContext* ctx, JSValueConst val) {
     case JS_TAG_FLOAT64:
       obj = JS_NewObjectClass(ctx, JS_CLASS_NUMBER);
       goto set_value;
+    case JS_TAG_STRING_ROPE:
+      val = js_flatten_string_value(ctx, JS_DupValue(ctx, val));
+      if (JS_IsException(val))
+        return JS_EXCEPTION;
+      obj = JS_ToObject(ctx, val);
+      JS_FreeValue(ctx, val);
+      return obj;
     case JS_TAG_STRING:
       /* XXX: should call the string constructor */
       {
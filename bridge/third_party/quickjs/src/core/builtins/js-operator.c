@@ -76,14 +76,19 @@ BOOL js_strict_eq2(JSContext* ctx, JSValue op1, JSValue op2, JSStrictEqModeEnum
     case JS_TAG_UNDEFINED:
       res = (tag1 == tag2);
       break;
-    case JS_TAG_STRING: {
+    case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE: {
       JSString *p1, *p2;
-      if (tag1 != tag2) {
+      if (tag2 != JS_TAG_STRING && tag2 != JS_TAG_STRING_ROPE) {
         res = FALSE;
-      } else {
+      } else if (tag1 == JS_TAG_STRING && tag2 == JS_TAG_STRING) {
         p1 = JS_VALUE_GET_STRING(op1);
         p2 = JS_VALUE_GET_STRING(op2);
         res = (js_string_compare(ctx, p1, p2) == 0);
+      } else {
+        /* compare the leaves in place instead of flattening */
+        res = (JS_VALUE_GET_STRING(op1)->len == JS_VALUE_GET_STRING(op2)->len &&
+               js_string_rope_compare(op1, op2) == 0);
       }
     } break;
     case JS_TAG_SYMBOL: {
@@ -304,6 +309,7 @@ __exception int js_operator_typeof(JSContext* ctx, JSValueConst op1) {
       atom = JS_ATOM_boolean;
       break;
     case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
       atom = JS_ATOM_string;
       break;
     case JS_TAG_OBJECT: {
@@ -29,6 +29,7 @@
 #include "../function.h"
 #include "../object.h"
 #include "../runtime.h"
+#include "../string.h"
 #include "js-array.h"
 #include "js-async-function.h"
 #include "js-async-generator.h"
@@ -131,6 +132,23 @@ void JS_SetHostPromiseRejectionTracker(JSRuntime *rt,
   rt->host_promise_rejection_tracker_opaque = opaque;
 }
 
+/* The tracker is embedder code, which only sees flat strings. The
+   rejection is not reported if the string rope cannot be flattened. */
+static void call_host_promise_rejection_tracker(JSContext *ctx, JSValueConst promise,
+                                                JSValueConst reason, BOOL is_handled)
+{
+  JSRuntime *rt = ctx->rt;
+
+  if (!rt->host_promise_rejection_tracker)
+    return;
+  if (js_flatten_string_const(ctx, &reason)) {
+    JS_FreeValue(ctx, JS_GetException(ctx));
+    return;
+  }
+  rt->host_promise_rejection_tracker(ctx, promise, reason, is_handled,
+                                     rt->host_promise_rejection_tracker_opaque);
+}
+
 void fulfill_or_reject_promise(JSContext *ctx, JSValueConst promise,
                                       JSValueConst value, BOOL is_reject)
 {
@@ -146,13 +164,8 @@ void fulfill_or_reject_promise(JSContext *ctx, JSValueConst promise,
 #ifdef DUMP_PROMISE
   printf("fulfill_or_reject_promise: is_reject=%d\n", is_reject);
 #endif
-  if (s->promise_state == JS_PROMISE_REJECTED && !s->is_handled) {
-    JSRuntime *rt = ctx->rt;
-    if (rt->host_promise_rejection_tracker) {
-      rt->host_promise_rejection_tracker(ctx, promise, value, FALSE,
-                                         rt->host_promise_rejection_tracker_opaque);
-    }
-  }
+  if (s->promise_state == JS_PROMISE_REJECTED && !s->is_handled)
+    call_host_promise_rejection_tracker(ctx, promise, value, FALSE);
 
   list_for_each_safe(el, el1, &s->promise_reactions[is_reject]) {
     rd = list_entry(el, JSPromiseReactionData, link);
@@ -882,13 +895,8 @@ __exception int perform_promise_then(JSContext *ctx,
       list_add_tail(&rd_array[i]->link, &s->promise_reactions[i]);
   } else {
     JSValueConst args[5];
-    if (s->promise_state == JS_PROMISE_REJECTED && !s->is_handled) {
-      JSRuntime *rt = ctx->rt;
-      if (rt->host_promise_rejection_tracker) {
-        rt->host_promise_rejection_tracker(ctx, promise, s->promise_result,
-                                           TRUE, rt->host_promise_rejection_tracker_opaque);
-      }
-    }
+    if (s->promise_state == JS_PROMISE_REJECTED && !s->is_handled)
+      call_host_promise_rejection_tracker(ctx, promise, s->promise_result, TRUE);
     i = s->promise_state - JS_PROMISE_FULFILLED;
     rd = rd_array[i];
     args[0] = rd->resolving_funcs[0];
@@ -28,12 +28,14 @@
 #include "../exception.h"
 #include "../function.h"
 #include "../object.h"
+#include "../runtime.h"
 #include "../string.h"
 #include "../types.h"
 #include "js-function.h"
 #include "js-object.h"
 #include "js-array.h"
 #include "quickjs/libregexp.h"
+#include "quickjs/libstring.h"
 
 /* String */
 
@@ -149,6 +151,8 @@ JSValue js_string_constructor(JSContext* ctx, JSValueConst new_target, int argc,
 JSValue js_thisStringValue(JSContext* ctx, JSValueConst this_val) {
   if (JS_VALUE_GET_TAG(this_val) == JS_TAG_STRING)
     return JS_DupValue(ctx, this_val);
+  if (JS_VALUE_GET_TAG(this_val) == JS_TAG_STRING_ROPE)
+    return js_flatten_string_value(ctx, JS_DupValue(ctx, this_val));
 
   if (JS_VALUE_GET_TAG(this_val) == JS_TAG_OBJECT) {
     JSObject* p = JS_VALUE_GET_OBJ(this_val);
@@ -383,21 +387,12 @@ int string_cmp(JSString* p1, JSString* p2, int x1, int x2, int len) {
 
 int string_indexof_char(JSString* p, int c, int from) {
   /* assuming 0 <= from <= p->len */
-  int i, len = p->len;
-  if (p->is_wide_char) {
-    for (i = from; i < len; i++) {
-      if (p->u.str16[i] == c)
-        return i;
-    }
-  } else {
-    if ((c & ~0xff) == 0) {
-      for (i = from; i < len; i++) {
-        if (p->u.str8[i] == (uint8_t)c)
-          return i;
-      }
-    }
-  }
-  return -1;
+  int i;
+  if (p->is_wide_char)
+    i = lstr_find_char16(p->u.str16 + from, p->len - from, c);
+  else
+    i = lstr_find_char8(p->u.str8 + from, p->len - from, c);
+  return i < 0 ? -1 : from + i;
 }
 
 int string_indexof(JSString* p1, JSString* p2, int from) {
@@ -405,6 +400,18 @@ int string_indexof(JSString* p1, JSString* p2, int from) {
   int c, i, j, len1 = p1->len, len2 = p2->len;
   if (len2 == 0)
     return from;
+  if (p1->is_wide_char) {
+    if (p2->is_wide_char)
+      i = lstr_find16(p1->u.str16 + from, len1 - from, p2->u.str16, len2);
+    else
+      i = lstr_find16_8(p1->u.str16 + from, len1 - from, p2->u.str8, len2);
+    return i < 0 ? -1 : from + i;
+  }
+  if (!p2->is_wide_char) {
+    i = lstr_find8(p1->u.str8 + from, len1 - from, p2->u.str8, len2);
+    return i < 0 ? -1 : from + i;
+  }
+  /* wide needle in a narrow string: only matches if it is Latin-1 */
   for (i = from, c = string_get(p2, 0); i + len2 <= len1; i = j + 1) {
     j = string_indexof_char(p1, c, i);
     if (j < 0 || j + len2 > len1)
@@ -469,7 +476,9 @@ JSValue js_string_indexOf(JSContext* ctx, JSValueConst this_val, int argc, JSVal
     inc = 1;
   }
   ret = -1;
-  if (len >= v_len && inc * (stop - start) >= 0) {
+  if (len >= v_len && inc > 0 && stop >= start) {
+    ret = string_indexof(p, p1, start);
+  } else if (len >= v_len && inc * (stop - start) >= 0) {
     for (i = start;; i += inc) {
       if (!string_cmp(p, p1, i, 0, v_len)) {
         ret = i;
@@ -533,7 +542,10 @@ JSValue js_string_includes(JSContext* ctx, JSValueConst this_val, int argc, JSVa
     }
     start = stop = pos;
   }
-  if (start >= 0 && start <= stop) {
+  if (magic == 0) {
+    if (start <= stop)
+      ret = string_indexof(p, p1, start) >= 0;
+  } else if (start >= 0 && start <= stop) {
     for (i = start;; i++) {
       if (!string_cmp(p, p1, i, 0, v_len)) {
         ret = 1;
@@ -646,7 +658,7 @@ JSValue js_string___GetSubstitution(JSContext* ctx, JSValueConst this_val, int a
   namedCaptures = argv[4];
   rep = argv[5];
 
-  if (!JS_IsString(rep) || !JS_IsString(str))
+  if (JS_VALUE_GET_TAG(rep) != JS_TAG_STRING || JS_VALUE_GET_TAG(str) != JS_TAG_STRING)
     return JS_ThrowTypeError(ctx, "not a string");
 
   sp = JS_VALUE_GET_STRING(str);
@@ -744,7 +756,7 @@ JSValue js_string_replace(JSContext* ctx, JSValueConst this_val, int argc, JSVal
   JSString *sp, *searchp;
   StringBuffer b_s, *b = &b_s;
   int pos, functionalReplace, endOfLastMatch;
-  BOOL is_first;
+  BOOL is_first, is_plain;
 
   if (JS_IsUndefined(O) || JS_IsNull(O))
     return JS_ThrowTypeError(ctx, "cannot convert to object");
@@ -785,6 +797,8 @@ JSValue js_string_replace(JSContext* ctx, JSValueConst this_val, int argc, JSVal
 
   sp = JS_VALUE_GET_STRING(str);
   searchp = JS_VALUE_GET_STRING(search_str);
+  /* without '$' patterns, the replacement is inserted as is */
+  is_plain = !functionalReplace && string_indexof_char(JS_VALUE_GET_STRING(replaceValue_str), '$', 0) < 0;
   endOfLastMatch = 0;
   is_first = TRUE;
   for (;;) {
@@ -808,7 +822,9 @@ JSValue js_string_replace(JSContext* ctx, JSValueConst this_val, int argc, JSVal
         break;
       }
     }
-    if (functionalReplace) {
+    if (is_plain) {
+      repl_str = JS_DupValue(ctx, replaceValue_str);
+    } else if (functionalReplace) {
       args[0] = search_str;
       args[1] = JS_NewInt32(ctx, pos);
       args[2] = str;
@@ -903,6 +919,23 @@ JSValue js_string_split(JSContext* ctx, JSValueConst this_val, int argc, JSValue
       goto add_tail;
     goto done;
   }
+  if (r == 1) {
+    /* single character separator: the pieces are appended directly to
+       the new fast array */
+    JSObject* pa = JS_VALUE_GET_OBJ(A);
+    int c = string_get(rp, 0);
+    while ((e = string_indexof_char(sp, c, p)) >= 0) {
+      T = js_sub_string(ctx, sp, p, e);
+      if (JS_IsException(T))
+        goto exception;
+      if (add_fast_array_element(ctx, pa, T, 0) < 0)
+        goto exception;
+      if (++lengthA == lim)
+        goto done;
+      p = e + 1;
+    }
+    goto add_tail;
+  }
   q = p;
   for (q = p; (q += !r) <= s - r - !r; q = p = e + r) {
     e = string_indexof(sp, rp, q);
@@ -1140,13 +1173,16 @@ JSValue js_string_trim(JSContext* ctx, JSValueConst this_val, int argc, JSValueC
   p = JS_VALUE_GET_STRING(str);
   a = 0;
   b = len = p->len;
-  if (magic & 1) {
-    while (a < len && lre_is_space(string_get(p, a)))
-      a++;
-  }
-  if (magic & 2) {
-    while (b > a && lre_is_space(string_get(p, b - 1)))
-      b--;
+  if (p->is_wide_char) {
+    if (magic & 1)
+      a = lstr_skip_space16(p->u.str16, len);
+    if (magic & 2)
+      b = a + lstr_trim_end16(p->u.str16 + a, len - a);
+  } else {
+    if (magic & 1)
+      a = lstr_skip_space8(p->u.str8, len);
+    if (magic & 2)
+      b = a + lstr_trim_end8(p->u.str8 + a, len - a);
   }
   ret = js_sub_string(ctx, p, a, b);
   JS_FreeValue(ctx, str);
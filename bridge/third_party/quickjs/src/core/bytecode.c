@@ -140,10 +140,12 @@ typedef enum BCTagEnum {
   BC_TAG_OBJECT_REFERENCE,
 } BCTagEnum;
 
+/* bumped whenever the opcode set changes, so that bytecode compiled by an
+   older engine is rejected instead of being misinterpreted */
 #ifdef CONFIG_BIGNUM
-#define BC_BASE_VERSION 2
+#define BC_BASE_VERSION 4
 #else
-#define BC_BASE_VERSION 1
+#define BC_BASE_VERSION 3
 #endif
 #define BC_BE_VERSION 0x40
 #ifdef WORDS_BIGENDIAN
@@ -514,6 +516,13 @@ static int JS_WriteFunctionTag(BCWriterState* s, JSValueConst obj) {
   uint32_t flags;
   int idx, i;
 
+  if (b->is_lazy) {
+    /* write the generated bytecode instead of the source */
+    if (js_compile_lazy_function(s->ctx, b))
+      goto fail;
+    b = JS_VALUE_GET_PTR(b->cpool[0]);
+  }
+
   bc_put_u8(s, BC_TAG_FUNCTION_BYTECODE);
   flags = idx = 0;
   bc_set_flags(&flags, &idx, b->has_prototype, 1);
@@ -820,6 +829,13 @@ static int JS_WriteObjectRec(BCWriterState* s, JSValueConst obj) {
       bc_put_u8(s, BC_TAG_STRING);
       JS_WriteString(s, p);
     } break;
+    case JS_TAG_STRING_ROPE: {
+      JSString* p = js_flatten_string_rope(s->ctx, obj);
+      if (!p)
+        goto fail;
+      bc_put_u8(s, BC_TAG_STRING);
+      JS_WriteString(s, p);
+    } break;
     case JS_TAG_FUNCTION_BYTECODE:
       if (!s->allow_bytecode)
         goto invalid_tag;
@@ -24,9 +24,11 @@
  */
 
 #include "convertion.h"
+#include <float.h>
 #include "builtins/js-big-num.h"
 #include "exception.h"
 #include "function.h"
+#include "number_tables.h"
 #include "quickjs/libregexp.h"
 #include "string.h"
 
@@ -265,7 +267,8 @@ redo:
       if (JS_IsException(val))
         return JS_EXCEPTION;
       goto redo;
-    case JS_TAG_STRING: {
+    case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE: {
       const char* str;
       const char* p;
       size_t len;
@@ -732,6 +735,10 @@ int JS_ToBoolFree(JSContext* ctx, JSValue val) {
       JS_FreeValue(ctx, val);
       return ret;
     }
+    case JS_TAG_STRING_ROPE:
+      /* a rope is never empty */
+      JS_FreeValue(ctx, val);
+      return TRUE;
 #ifdef CONFIG_BIGNUM
     case JS_TAG_BIG_INT:
     case JS_TAG_BIG_FLOAT: {
@@ -771,12 +778,193 @@ int JS_ToBool(JSContext* ctx, JSValueConst val) {
   return JS_ToBoolFree(ctx, JS_DupValue(ctx, val));
 }
 
-/* XXX: remove */
+typedef struct UInt128 {
+  uint64_t hi;
+  uint64_t lo;
+} UInt128;
+
+static inline UInt128 mul_u64_full(uint64_t a, uint64_t b) {
+  UInt128 r;
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a * b;
+  r.hi = (uint64_t)(p >> 64);
+  r.lo = (uint64_t)p;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t hi_hi = a_hi * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+  r.hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  r.lo = (cross << 32) | (uint32_t)lo_lo;
+#endif
+  return r;
+}
+
+static const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/* Eisel-Lemire: return the correctly rounded IEEE bits of w * 10^q, or
+   -1 in the rare cases where the 128-bit product cannot decide the
+   rounding. 'w' must be non zero. */
+static int64_t eisel_lemire(uint64_t w, int64_t q) {
+  UInt128 product;
+  uint64_t mantissa;
+  int lz, upper_bit;
+  int64_t power2;
+  const uint64_t* pow5;
+
+  if (q < POWERS_OF_FIVE_MIN_EXP)
+    return 0;
+  if (q > POWERS_OF_FIVE_MAX_EXP)
+    return (uint64_t)0x7ff << 52;
+  lz = clz64(w);
+  w <<= lz;
+  pow5 = &powers_of_five_128[2 * (q - POWERS_OF_FIVE_MIN_EXP)];
+  product = mul_u64_full(w, pow5[0]);
+  /* only 55 bits of the product are needed: refine with the low half of
+     the power of five when the truncated bits are all ones */
+  if ((product.hi & 0x1ff) == 0x1ff) {
+    UInt128 second = mul_u64_full(w, pow5[1]);
+    product.lo += second.hi;
+    if (second.hi > product.lo)
+      product.hi++;
+  }
+  if (product.lo == (uint64_t)-1 && (q < -27 || q > 55))
+    return -1;
+  upper_bit = product.hi >> 63;
+  mantissa = product.hi >> (upper_bit + 9);
+  /* floor(log2(10^q)) + 63 + 1023 */
+  power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 1023;
+  if (power2 <= 0) {
+    /* subnormal */
+    if (-power2 + 1 >= 64)
+      return 0;
+    mantissa >>= -power2 + 1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    power2 = mantissa < ((uint64_t)1 << 52) ? 0 : 1;
+    return (power2 << 52) | (mantissa & (((uint64_t)1 << 52) - 1));
+  }
+  /* exact ties are rounded to even */
+  if (product.lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1) {
+    if ((mantissa << (upper_bit + 9)) == product.hi)
+      mantissa &= ~(uint64_t)1;
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= ((uint64_t)2 << 52)) {
+    mantissa = (uint64_t)1 << 52;
+    power2++;
+  }
+  if (power2 >= 0x7ff)
+    return (uint64_t)0x7ff << 52;
+  return (power2 << 52) | (mantissa & (((uint64_t)1 << 52) - 1));
+}
+
+/* Parse the decimal number produced by js_atof() ([-]digits[.digits]
+   [e[+-]digits]). Return FALSE when it has more than 19 significant
+   digits or is too close to a rounding boundary, so that the caller
+   falls back to strtod(). */
+static BOOL js_strtod_fast(const char* p, double* pres) {
+  uint64_t w;
+  int64_t q, e;
+  int n_digits, c;
+  BOOL is_neg, seen_dot, exp_neg;
+  union {
+    double d;
+    uint64_t u;
+  } u;
+
+  is_neg = (*p == '-');
+  if (is_neg)
+    p++;
+  w = 0;
+  q = 0;
+  n_digits = 0;
+  seen_dot = FALSE;
+  for (;; p++) {
+    c = *p;
+    if (c == '.' && !seen_dot) {
+      seen_dot = TRUE;
+      continue;
+    }
+    if (!is_digit(c))
+      break;
+    if (n_digits == 0 && c == '0') {
+      /* leading zero */
+      if (seen_dot)
+        q--;
+    } else if (n_digits < 19) {
+      w = w * 10 + (c - '0');
+      n_digits++;
+      if (seen_dot)
+        q--;
+    } else {
+      if (c != '0')
+        return FALSE;
+      if (!seen_dot)
+        q++;
+    }
+  }
+  if (c == 'e' || c == 'E') {
+    p++;
+    exp_neg = FALSE;
+    if (*p == '+') {
+      p++;
+    } else if (*p == '-') {
+      exp_neg = TRUE;
+      p++;
+    }
+    e = 0;
+    while (is_digit(*p)) {
+      if (e < 100000)
+        e = e * 10 + (*p - '0');
+      p++;
+    }
+    q += exp_neg ? -e : e;
+  }
+
+  if (w == 0) {
+    u.u = 0;
+  } else {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    /* w and 10^|q| are both exact doubles: a single rounding */
+    if (w <= ((uint64_t)1 << 53) && q >= -22 && q <= 22) {
+      u.d = (double)w;
+      if (q < 0)
+        u.d /= exact_powers_of_ten[-q];
+      else
+        u.d *= exact_powers_of_ten[q];
+      *pres = is_neg ? -u.d : u.d;
+      return TRUE;
+    }
+#endif
+    int64_t bits = eisel_lemire(w, q);
+    if (bits < 0)
+      return FALSE;
+    u.u = bits;
+  }
+  if (is_neg)
+    u.u |= (uint64_t)1 << 63;
+  *pres = u.d;
+  return TRUE;
+}
+
+/* decimal numbers are always correctly rounded, whether they are
+   integers or not */
 double js_strtod(const char* p, int radix, BOOL is_float) {
   double d;
   int c;
 
-  if (!is_float || radix != 10) {
+  if (radix == 10) {
+    if (!js_strtod_fast(p, &d))
+      d = strtod(p, NULL);
+  } else {
     uint64_t n_max, n;
     int int_exp, is_neg;
 
@@ -790,10 +978,7 @@ double js_strtod(const char* p, int radix, BOOL is_float) {
     while (*p == '0')
       p++;
     n = 0;
-    if (radix == 10)
-      n_max = ((uint64_t)-1 - 9) / 10; /* most common case */
-    else
-      n_max = ((uint64_t)-1 - (radix - 1)) / radix;
+    n_max = ((uint64_t)-1 - (radix - 1)) / radix;
     /* XXX: could be more precise */
     int_exp = 0;
     while (*p != '\0') {
@@ -813,8 +998,6 @@ double js_strtod(const char* p, int radix, BOOL is_float) {
     }
     if (is_neg)
       d = -d;
-  } else {
-    d = strtod(p, NULL);
   }
   return d;
 }
@@ -1328,6 +1511,167 @@ void js_ecvt1(double d, int n_digits, int* decpt, int* sign, char* buf, int roun
   *decpt = atoi(buf1 + n_digits + 2 + (n_digits > 1)) + 1;
 }
 
+/* Grisu3 shortest double to decimal conversion (F. Loitsch, "Printing
+   Floating-Point Numbers Quickly and Accurately with Integers"). It
+   gives the shortest digits that round trip, closest to the exact value,
+   for about 99.5% of the doubles and reports failure otherwise. */
+
+typedef struct DiyFp {
+  uint64_t f;
+  int e;
+} DiyFp;
+
+static inline DiyFp diy_fp_make(uint64_t f, int e) {
+  DiyFp r;
+  r.f = f;
+  r.e = e;
+  return r;
+}
+
+/* upper 64 bits of the product, rounded */
+static inline DiyFp diy_fp_mul(DiyFp a, DiyFp b) {
+  UInt128 p = mul_u64_full(a.f, b.f);
+  return diy_fp_make(p.hi + (p.lo >> 63), a.e + b.e + 64);
+}
+
+static inline DiyFp diy_fp_normalize(DiyFp a) {
+  int shift = clz64(a.f);
+  return diy_fp_make(a.f << shift, a.e - shift);
+}
+
+static const uint32_t small_powers_of_ten[] = {
+    0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/* the scaled value is kept in [2^(alpha + 64), 2^(gamma + 64)) so that
+   its integral part fits in 32 bits */
+#define GRISU_MIN_TARGET_EXP (-60)
+#define GRISU_MAX_TARGET_EXP (-32)
+
+static BOOL grisu_round_weed(char* buf,
+                             int len,
+                             uint64_t distance_too_high_w,
+                             uint64_t unsafe_interval,
+                             uint64_t rest,
+                             uint64_t ten_kappa,
+                             uint64_t unit) {
+  uint64_t small_distance = distance_too_high_w - unit;
+  uint64_t big_distance = distance_too_high_w + unit;
+
+  /* move the last digit down as long as it brings the result closer to
+     the exact value and stays in the safe interval */
+  while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+         (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)) {
+    buf[len - 1]--;
+    rest += ten_kappa;
+  }
+  /* the imprecision of the boundaries does not allow to choose */
+  if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+      (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+    return FALSE;
+  return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+static BOOL grisu_digit_gen(DiyFp low, DiyFp w, DiyFp high, char* buf, int* plen, int* pkappa) {
+  uint64_t unit = 1;
+  DiyFp too_low = diy_fp_make(low.f - unit, low.e);
+  DiyFp too_high = diy_fp_make(high.f + unit, high.e);
+  uint64_t unsafe_interval = too_high.f - too_low.f;
+  int shift = -w.e;
+  uint64_t one = (uint64_t)1 << shift;
+  uint32_t integrals = (uint32_t)(too_high.f >> shift);
+  uint64_t fractionals = too_high.f & (one - 1);
+  uint32_t divisor;
+  int kappa, len;
+
+  kappa = ((64 - shift + 1) * 1233 >> 12) + 1;
+  if (integrals < small_powers_of_ten[kappa])
+    kappa--;
+  divisor = small_powers_of_ten[kappa];
+
+  len = 0;
+  while (kappa > 0) {
+    uint64_t rest;
+    buf[len++] = '0' + integrals / divisor;
+    integrals %= divisor;
+    kappa--;
+    rest = ((uint64_t)integrals << shift) + fractionals;
+    if (rest < unsafe_interval) {
+      *plen = len;
+      *pkappa = kappa;
+      return grisu_round_weed(buf, len, too_high.f - w.f, unsafe_interval, rest, (uint64_t)divisor << shift, unit);
+    }
+    divisor /= 10;
+  }
+  for (;;) {
+    fractionals *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+    buf[len++] = '0' + (int)(fractionals >> shift);
+    fractionals &= one - 1;
+    kappa--;
+    if (fractionals < unsafe_interval) {
+      *plen = len;
+      *pkappa = kappa;
+      return grisu_round_weed(buf, len, (too_high.f - w.f) * unit, unsafe_interval, fractionals, one, unit);
+    }
+  }
+}
+
+/* 'd' must be finite and strictly positive. Return the number of digits
+   written to 'buf' (at most 17) or 0 if Grisu3 cannot decide. */
+static int grisu3(double d, char* buf, int* decpt) {
+  union {
+    double d;
+    uint64_t u;
+  } u;
+  uint64_t f;
+  int e, biased_e, min_exp, k, index, len, kappa;
+  DiyFp w, m_plus, m_minus, ten_mk;
+  const CachedPowerOfTen* cached;
+
+  u.d = d;
+  biased_e = (u.u >> 52) & 0x7ff;
+  f = u.u & (((uint64_t)1 << 52) - 1);
+  if (biased_e != 0) {
+    f += (uint64_t)1 << 52;
+    e = biased_e - 1075;
+  } else {
+    e = -1074;
+  }
+
+  /* boundaries halfway to the neighbouring doubles. The lower one is
+     closer when the significand is a power of two. */
+  m_plus = diy_fp_normalize(diy_fp_make((f << 1) + 1, e - 1));
+  if ((u.u & (((uint64_t)1 << 52) - 1)) == 0 && biased_e > 1)
+    m_minus = diy_fp_make((f << 2) - 1, e - 2);
+  else
+    m_minus = diy_fp_make((f << 1) - 1, e - 1);
+  m_minus.f <<= m_minus.e - m_plus.e;
+  m_minus.e = m_plus.e;
+  w = diy_fp_normalize(diy_fp_make(f, e));
+
+  /* select 10^-k such that w * 10^-k has a binary exponent in
+     [GRISU_MIN_TARGET_EXP, GRISU_MAX_TARGET_EXP] */
+  min_exp = GRISU_MIN_TARGET_EXP - (w.e + 64);
+  k = (int)ceil((min_exp + 63) * 0.30102999566398114);
+  index = (-CACHED_POWERS_MIN_DECIMAL_EXP + k - 1) / CACHED_POWERS_DECIMAL_EXP_STEP + 1;
+  cached = &cached_powers_of_ten[index];
+  ten_mk = diy_fp_make(cached->f, cached->e);
+
+  if (!grisu_digit_gen(diy_fp_mul(m_minus, ten_mk), diy_fp_mul(w, ten_mk), diy_fp_mul(m_plus, ten_mk), buf, &len,
+                       &kappa))
+    return 0;
+  /* no need to keep the trailing zeros */
+  while (len >= 2 && buf[len - 1] == '0') {
+    len--;
+    kappa++;
+  }
+  buf[len] = '\0';
+  *decpt = len + kappa - cached->k;
+  return len;
+}
+
 /* needed because ecvt usually limits the number of digits to
    17. Return the number of digits. */
 int js_ecvt(double d, int n_digits, int* decpt, int* sign, char* buf, BOOL is_fixed) {
@@ -1336,6 +1680,13 @@ int js_ecvt(double d, int n_digits, int* decpt, int* sign, char* buf, BOOL is_fi
 
   if (!is_fixed) {
     unsigned int n_digits_min, n_digits_max;
+    if (isfinite(d) && d != 0) {
+      n_digits = grisu3(fabs(d), buf, decpt);
+      if (n_digits > 0) {
+        *sign = (d < 0);
+        return n_digits;
+      }
+    }
     /* find the minimum amount of digits (XXX: inefficient but simple) */
     n_digits_min = 1;
     n_digits_max = 17;
@@ -1532,6 +1883,8 @@ JSValue JS_ToStringInternal(JSContext* ctx, JSValueConst val, BOOL is_ToProperty
   switch (tag) {
     case JS_TAG_STRING:
       return JS_DupValue(ctx, val);
+    case JS_TAG_STRING_ROPE:
+      return js_flatten_string_value(ctx, JS_DupValue(ctx, val));
     case JS_TAG_INT:
       snprintf(buf, sizeof(buf), "%d", JS_VALUE_GET_INT(val));
       str = buf;
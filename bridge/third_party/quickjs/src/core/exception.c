@@ -126,6 +126,14 @@ JSValue JS_GetException(JSContext *ctx)
   JSRuntime *rt = ctx->rt;
   val = rt->current_exception;
   rt->current_exception = JS_NULL;
+  if (unlikely(JS_VALUE_GET_TAG(val) == JS_TAG_STRING_ROPE)) {
+    /* a thrown string rope is returned as its flat string */
+    val = js_flatten_string_value(ctx, val);
+    if (JS_IsException(val)) {
+      val = rt->current_exception;
+      rt->current_exception = JS_NULL;
+    }
+  }
   return val;
 }
 
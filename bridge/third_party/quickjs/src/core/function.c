@@ -207,6 +207,39 @@ JSValue js_call_bound_function(JSContext* ctx,
   }
 }
 
+/* Call a native function. Native functions are embedder code, which
+   only knows JS_TAG_STRING: the string ropes of 'this_obj' and 'argv' are
+   replaced by their flat string. These are owned by the ropes, which the
+   caller keeps alive during the call. */
+static JSValue js_call_native(JSContext* ctx,
+                              JSClassCall* call_func,
+                              JSValueConst func_obj,
+                              JSValueConst this_obj,
+                              int argc,
+                              JSValueConst* argv,
+                              int flags) {
+  JSValueConst* flat_argv;
+  int i;
+
+  if (js_flatten_string_const(ctx, &this_obj))
+    return JS_EXCEPTION;
+  for (i = 0; i < argc; i++) {
+    if (unlikely(JS_VALUE_GET_TAG(argv[i]) == JS_TAG_STRING_ROPE))
+      goto flatten_args;
+  }
+  return call_func(ctx, func_obj, this_obj, argc, argv, flags);
+flatten_args:
+  if (js_check_stack_overflow(ctx->rt, sizeof(JSValue) * argc))
+    return JS_ThrowStackOverflow(ctx);
+  flat_argv = alloca(sizeof(JSValue) * argc);
+  for (i = 0; i < argc; i++) {
+    flat_argv[i] = argv[i];
+    if (js_flatten_string_const(ctx, &flat_argv[i]))
+      return JS_EXCEPTION;
+  }
+  return call_func(ctx, func_obj, this_obj, argc, flat_argv, flags);
+}
+
 /* argv[] is modified if (flags & JS_CALL_FLAG_COPY_ARGV) = 0. */
 JSValue JS_CallInternal(JSContext* caller_ctx,
                                JSValueConst func_obj,
@@ -286,9 +319,17 @@ JSValue JS_CallInternal(JSContext* caller_ctx,
     not_a_function:
       return JS_ThrowTypeError(caller_ctx, "not a function");
     }
-    return call_func(caller_ctx, func_obj, this_obj, argc, (JSValueConst*)argv, flags);
+    return js_call_native(caller_ctx, call_func, func_obj, this_obj, argc, (JSValueConst*)argv, flags);
   }
   b = p->u.func.function_bytecode;
+  if (unlikely(b->is_lazy)) {
+    if (js_compile_lazy_function(b->realm, b))
+      return JS_EXCEPTION;
+    /* the function object keeps the generated bytecode */
+    p->u.func.function_bytecode = JS_VALUE_GET_PTR(JS_DupValue(caller_ctx, b->cpool[0]));
+    JS_FreeValue(caller_ctx, JS_MKPTR(JS_TAG_FUNCTION_BYTECODE, b));
+    b = p->u.func.function_bytecode;
+  }
 
   if (unlikely(argc < b->arg_count || (flags & JS_CALL_FLAG_COPY_ARGV))) {
     arg_allocated_size = b->arg_count;
@@ -1012,6 +1053,11 @@ restart:
       BREAK;
       CASE(OP_get_loc3) : * sp++ = JS_DupValue(ctx, var_buf[3]);
       BREAK;
+      CASE(OP_get_loc0_loc1) :
+        sp[0] = JS_DupValue(ctx, var_buf[0]);
+        sp[1] = JS_DupValue(ctx, var_buf[1]);
+        sp += 2;
+      BREAK;
       CASE(OP_put_loc0) : set_value(ctx, &var_buf[0], *--sp);
       BREAK;
       CASE(OP_put_loc1) : set_value(ctx, &var_buf[1], *--sp);
@@ -1482,10 +1528,10 @@ restart:
         atom = get_u32(pc);
         pc += 4;
         
-        val = JS_GetPropertyInternal(ctx, sp[-1], atom, sp[-1], ic, FALSE);
+        val = js_get_property_internal(ctx, sp[-1], atom, sp[-1], ic, FALSE);
         if (unlikely(JS_IsException(val)))
           goto exception;
-        if (ic != NULL && ic->updated == TRUE) {
+        if (ic != NULL && ic->updated == TRUE && get_ic_atom(ic, ic->updated_offset) == atom) {
           ic->updated = FALSE;
           put_u8(pc - 5, OP_get_field_ic);
           put_u32(pc - 4, ic->updated_offset);
@@ -1505,7 +1551,7 @@ restart:
         atom = get_ic_atom(ic, ic_offset);
         pc += 4;
         
-        val = JS_GetPropertyInternalWithIC(ctx, sp[-1], atom, sp[-1], ic, ic_offset, FALSE);
+        val = js_get_property_internal_with_ic(ctx, sp[-1], atom, sp[-1], ic, ic_offset, FALSE);
         ic->updated = FALSE;
         if (unlikely(JS_IsException(val)))
           goto exception;
@@ -1520,10 +1566,10 @@ restart:
         atom = get_u32(pc);
         pc += 4;
 
-        val = JS_GetPropertyInternal(ctx, sp[-1], atom, sp[-1], NULL, FALSE);
+        val = js_get_property_internal(ctx, sp[-1], atom, sp[-1], ic, FALSE);
         if (unlikely(JS_IsException(val)))
           goto exception;
-        if (ic != NULL && ic->updated == TRUE) {
+        if (ic != NULL && ic->updated == TRUE && get_ic_atom(ic, ic->updated_offset) == atom) {
           ic->updated = FALSE;
           put_u8(pc - 5, OP_get_field2_ic);
           put_u32(pc - 4, ic->updated_offset);
@@ -1542,7 +1588,7 @@ restart:
         atom = get_ic_atom(ic, ic_offset);
         pc += 4;
         
-        val = JS_GetPropertyInternalWithIC(ctx, sp[-1], atom, sp[-1], ic, ic_offset, FALSE);
+        val = js_get_property_internal_with_ic(ctx, sp[-1], atom, sp[-1], ic, ic_offset, FALSE);
         ic->updated = FALSE;
         if (unlikely(JS_IsException(val)))
           goto exception;
@@ -1561,7 +1607,7 @@ restart:
         sp -= 2;
         if (unlikely(ret < 0))
           goto exception;
-        if (ic != NULL && ic->updated == TRUE) {
+        if (ic != NULL && ic->updated == TRUE && get_ic_atom(ic, ic->updated_offset) == atom) {
           ic->updated = FALSE;
           put_u8(pc - 5, OP_put_field_ic);
           put_u32(pc - 4, ic->updated_offset);
@@ -1746,6 +1792,12 @@ restart:
       CASE(OP_get_array_el) : {
         JSValue val;
 
+        if (likely(js_get_fast_array_element(ctx, sp[-2], sp[-1], &val))) {
+          JS_FreeValue(ctx, sp[-2]);
+          sp[-2] = val;
+          sp--;
+          BREAK;
+        }
         val = JS_GetPropertyValue(ctx, sp[-2], sp[-1]);
         JS_FreeValue(ctx, sp[-2]);
         sp[-2] = val;
@@ -1758,6 +1810,10 @@ restart:
       CASE(OP_get_array_el2) : {
         JSValue val;
 
+        if (likely(js_get_fast_array_element(ctx, sp[-2], sp[-1], &val))) {
+          sp[-1] = val;
+          BREAK;
+        }
         val = JS_GetPropertyValue(ctx, sp[-2], sp[-1]);
         sp[-1] = val;
         if (unlikely(JS_IsException(val)))
@@ -1789,7 +1845,7 @@ restart:
         atom = JS_ValueToAtom(ctx, sp[-1]);
         if (unlikely(atom == JS_ATOM_NULL))
           goto exception;
-        val = JS_GetPropertyInternal(ctx, sp[-2], atom, sp[-3], NULL, FALSE);
+        val = js_get_property_internal(ctx, sp[-2], atom, sp[-3], NULL, FALSE);
         JS_FreeAtom(ctx, atom);
         if (unlikely(JS_IsException(val)))
           goto exception;
@@ -1804,6 +1860,19 @@ restart:
       CASE(OP_put_array_el) : {
         int ret;
 
+        if (likely(JS_VALUE_GET_TAG(sp[-3]) == JS_TAG_OBJECT && JS_VALUE_GET_TAG(sp[-2]) == JS_TAG_INT)) {
+          JSObject* p = JS_VALUE_GET_OBJ(sp[-3]);
+          uint32_t idx = JS_VALUE_GET_INT(sp[-2]);
+          /* overwrite an element of a fast array */
+          if (p->class_id == JS_CLASS_ARRAY && idx < p->u.array.count) {
+            ret = js_fast_array_set(ctx, p, idx, sp[-1]);
+            JS_FreeValue(ctx, sp[-3]);
+            sp -= 3;
+            if (unlikely(ret < 0))
+              goto exception;
+            BREAK;
+          }
+        }
         ret = JS_SetPropertyValue(ctx, sp[-3], sp[-2], sp[-1], JS_PROP_THROW_STRICT);
         JS_FreeValue(ctx, sp[-3]);
         sp -= 3;
@@ -1914,6 +1983,32 @@ restart:
         }
       }
       BREAK;
+#if SHORT_OPCODES
+      CASE(OP_add_put_loc8) : {
+        JSValue op1, op2;
+        int idx;
+        op1 = sp[-2];
+        op2 = sp[-1];
+        idx = *pc;
+        pc += 1;
+        if (likely(JS_VALUE_IS_BOTH_INT(op1, op2))) {
+          int64_t r;
+          r = (int64_t)JS_VALUE_GET_INT(op1) + JS_VALUE_GET_INT(op2);
+          if (unlikely((int)r != r))
+            goto add_put_loc8_slow;
+          sp[-2] = JS_NewInt32(ctx, r);
+        } else if (JS_VALUE_IS_BOTH_FLOAT(op1, op2)) {
+          sp[-2] = __JS_NewFloat64(ctx, JS_VALUE_GET_FLOAT64(op1) + JS_VALUE_GET_FLOAT64(op2));
+        } else {
+        add_put_loc8_slow:
+          if (js_add_slow(ctx, sp))
+            goto exception;
+        }
+        sp -= 2;
+        set_value(ctx, &var_buf[idx], sp[0]);
+      }
+      BREAK;
+#endif
       CASE(OP_add_loc) : {
         JSValue* pv;
         int idx;
@@ -1928,13 +2023,21 @@ restart:
             goto add_loc_slow;
           *pv = JS_NewInt32(ctx, r);
           sp--;
-        } else if (JS_VALUE_GET_TAG(*pv) == JS_TAG_STRING) {
+        } else if (JS_VALUE_IS_BOTH_FLOAT(*pv, sp[-1])) {
+          *pv = __JS_NewFloat64(ctx, JS_VALUE_GET_FLOAT64(*pv) + JS_VALUE_GET_FLOAT64(sp[-1]));
+          sp--;
+        } else if (JS_VALUE_GET_TAG(*pv) == JS_TAG_STRING || JS_VALUE_GET_TAG(*pv) == JS_TAG_STRING_ROPE) {
           JSValue op1;
           op1 = sp[-1];
           sp--;
           op1 = JS_ToPrimitiveFree(ctx, op1, HINT_NONE);
           if (JS_IsException(op1))
             goto exception;
+          /* the local is usually the only reference to the string */
+          if (js_concat_string_in_place(ctx, *pv, op1)) {
+            JS_FreeValue(ctx, op1);
+            BREAK;
+          }
           op1 = JS_ConcatString(ctx, JS_DupValue(ctx, *pv), op1);
           if (JS_IsException(op1))
             goto exception;
@@ -2346,6 +2449,36 @@ restart:
       OP_CMP(OP_strict_eq, ==, js_strict_eq_slow(ctx, sp, 0));
       OP_CMP(OP_strict_neq, !=, js_strict_eq_slow(ctx, sp, 1));
 
+#if SHORT_OPCODES
+#define OP_CMP_IF_FALSE8(opcode, cmp_opcode, binary_op)                               \
+  CASE(opcode) : {                                                                     \
+    JSValue op1, op2;                                                                  \
+    int res;                                                                           \
+    op1 = sp[-2];                                                                      \
+    op2 = sp[-1];                                                                      \
+    pc += 1;                                                                           \
+    if (likely(JS_VALUE_IS_BOTH_INT(op1, op2))) {                                      \
+      res = JS_VALUE_GET_INT(op1) binary_op JS_VALUE_GET_INT(op2);                     \
+    } else {                                                                           \
+      if (js_relational_slow(ctx, sp, cmp_opcode))                                     \
+        goto exception;                                                                \
+      res = JS_VALUE_GET_BOOL(sp[-2]);                                                 \
+    }                                                                                  \
+    sp -= 2;                                                                           \
+    if (!res) {                                                                        \
+      pc += (int8_t)pc[-1] - 1;                                                        \
+    }                                                                                  \
+    if (unlikely(js_poll_interrupts(ctx)))                                             \
+      goto exception;                                                                  \
+  }                                                                                    \
+  BREAK
+
+      OP_CMP_IF_FALSE8(OP_lt_if_false8, OP_lt, <);
+      OP_CMP_IF_FALSE8(OP_lte_if_false8, OP_lte, <=);
+      OP_CMP_IF_FALSE8(OP_gt_if_false8, OP_gt, >);
+      OP_CMP_IF_FALSE8(OP_gte_if_false8, OP_gte, >=);
+#endif
+
 #ifdef CONFIG_BIGNUM
       CASE(OP_mul_pow10) : if (rt->bigfloat_ops.mul_pow10(ctx, sp)) goto exception;
       sp--;
@@ -2465,7 +2598,7 @@ restart:
           }
           switch (opcode) {
             case OP_with_get_var:
-              val = JS_GetProperty(ctx, obj, atom);
+              val = js_get_property_internal(ctx, obj, atom, obj, NULL, FALSE);
               if (unlikely(JS_IsException(val)))
                 goto exception;
               set_value(ctx, &sp[-1], val);
@@ -2628,8 +2761,10 @@ exception:
   return ret_val;
 }
 
+/* The public call functions return the flat string of the string ropes,
+   the internal JS_CallFree() does not */
 JSValue JS_Call(JSContext* ctx, JSValueConst func_obj, JSValueConst this_obj, int argc, JSValueConst* argv) {
-  return JS_CallInternal(ctx, func_obj, this_obj, JS_UNDEFINED, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV);
+  return js_flatten_string_value(ctx, JS_CallInternal(ctx, func_obj, this_obj, JS_UNDEFINED, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV));
 }
 
 JSValue JS_CallFree(JSContext* ctx, JSValue func_obj, JSValueConst this_obj, int argc, JSValueConst* argv) {
@@ -2669,7 +2804,7 @@ JSValue JS_CallConstructorInternal(JSContext* ctx,
     not_a_function:
       return JS_ThrowTypeError(ctx, "not a function");
     }
-    return call_func(ctx, func_obj, new_target, argc, (JSValueConst*)argv, flags);
+    return js_call_native(ctx, call_func, func_obj, new_target, argc, (JSValueConst*)argv, flags);
   }
 
   b = p->u.func.function_bytecode;
@@ -2716,11 +2851,11 @@ JSValue JS_CallConstructor2(JSContext* ctx,
                             JSValueConst new_target,
                             int argc,
                             JSValueConst* argv) {
-  return JS_CallConstructorInternal(ctx, func_obj, new_target, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV);
+  return js_flatten_string_value(ctx, JS_CallConstructorInternal(ctx, func_obj, new_target, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV));
 }
 
 JSValue JS_CallConstructor(JSContext* ctx, JSValueConst func_obj, int argc, JSValueConst* argv) {
-  return JS_CallConstructorInternal(ctx, func_obj, func_obj, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV);
+  return js_flatten_string_value(ctx, JS_CallConstructorInternal(ctx, func_obj, func_obj, argc, (JSValue*)argv, JS_CALL_FLAG_COPY_ARGV));
 }
 
 JSValue JS_Invoke(JSContext* ctx, JSValueConst this_val, JSAtom atom, int argc, JSValueConst* argv) {
@@ -2728,7 +2863,7 @@ JSValue JS_Invoke(JSContext* ctx, JSValueConst this_val, JSAtom atom, int argc,
   func_obj = JS_GetProperty(ctx, this_val, atom);
   if (JS_IsException(func_obj))
     return func_obj;
-  return JS_CallFree(ctx, func_obj, this_val, argc, argv);
+  return js_flatten_string_value(ctx, JS_CallFree(ctx, func_obj, this_val, argc, argv));
 }
 
 /* Note: at least 'length' arguments will be readable in 'argv' */
@@ -65,6 +65,14 @@ __maybe_unused void JS_DumpObject(JSRuntime* rt, JSObject* p) {
         printf(", ");
       switch (p->class_id) {
         case JS_CLASS_ARRAY:
+          if (p->u.array.kind == JS_ARRAY_KIND_INT32) {
+            printf("%d", p->u.array.u.int32_ptr[i]);
+            break;
+          } else if (p->u.array.kind == JS_ARRAY_KIND_FLOAT64) {
+            printf("%.14g", p->u.array.u.double_ptr[i]);
+            break;
+          }
+          /* fall thru */
         case JS_CLASS_ARGUMENTS:
           JS_DumpValueShort(rt, p->u.array.u.values[i]);
           break;
@@ -235,6 +243,9 @@ __maybe_unused void JS_DumpValueShort(JSRuntime* rt, JSValueConst val) {
       p = JS_VALUE_GET_STRING(val);
       JS_DumpString(rt, p);
     } break;
+    case JS_TAG_STRING_ROPE:
+      printf("[string rope %u]", JS_VALUE_GET_STRING_ROPE(val)->len);
+      break;
     case JS_TAG_FUNCTION_BYTECODE: {
       JSFunctionBytecode* b = JS_VALUE_GET_PTR(val);
       char buf[ATOM_GET_STR_BUF_SIZE];
@@ -473,6 +484,9 @@ void __JS_FreeValueRT(JSRuntime* rt, JSValue v) {
         js_free_rt(rt, p);
       }
     } break;
+    case JS_TAG_STRING_ROPE:
+      js_free_string_rope(rt, JS_VALUE_GET_STRING_ROPE(v));
+      break;
     case JS_TAG_OBJECT:
     case JS_TAG_FUNCTION_BYTECODE: {
       JSGCObjectHeader* p = JS_VALUE_GET_PTR(v);
@@ -634,22 +648,15 @@ void mark_children(JSRuntime* rt, JSGCObjectHeader* gp, JS_MarkFunc* mark_func)
     case JS_GC_OBJ_TYPE_FUNCTION_BYTECODE:
       /* the template objects can be part of a cycle */
       {
-        int i, j;
-        InlineCacheRingItem *buffer;
+        int i;
         JSFunctionBytecode* b = (JSFunctionBytecode*)gp;
         for (i = 0; i < b->cpool_count; i++) {
           JS_MarkValue(rt, b->cpool[i], mark_func);
         }
         if (b->realm)
           mark_func(rt, &b->realm->header);
-        if (b->ic) {
-          for (i = 0; i < b->ic->count; i++) {
-            buffer = b->ic->cache[i].buffer;
-            for (j = 0; j < IC_CACHE_ITEM_CAPACITY; j++)
-              if (buffer[j].shape)
-                mark_func(rt, &buffer[j].shape->header);
-          }
-        }
+        if (b->ic)
+          mark_ic(rt, b->ic, mark_func);
       }
       break;
     case JS_GC_OBJ_TYPE_VAR_REF: {
@@ -792,6 +799,10 @@ void gc_free_cycles(JSRuntime* rt) {
 }
 
 void JS_RunGC(JSRuntime* rt) {
+  /* the megamorphic inline cache entries are not referenced by any GC
+     object */
+  flush_ic_stub_cache(rt);
+
   /* decrement the reference of the children of each object. mark =
      1 after this pass. */
   gc_decref(rt);
@@ -24,6 +24,7 @@
  */
 
 #include "ic.h"
+#include "string.h"
 
 static force_inline uint32_t get_index_hash(JSAtom atom, int hash_bits) {
   return (atom * 0x9e370001) >> (32 - hash_bits);
@@ -99,15 +100,58 @@ fail:
   return -1;
 }
 
+static void free_ic_item(JSRuntime *rt, InlineCacheRingItem *item) {
+  uint32_t i;
+  js_free_shape_null(rt, item->shape);
+  if (item->proto_shapes) {
+    for (i = 0; i < item->proto_depth; i++)
+      js_free_shape(rt, item->proto_shapes[i]);
+    js_free_rt(rt, item->proto_shapes);
+  }
+  item->shape = NULL;
+  item->proto_shapes = NULL;
+  item->proto_depth = 0;
+}
+
+/* The item holds a reference to the shapes of the receiver and of the
+   prototypes up to the holder, so they are cloned instead of being
+   modified in place and comparing the pointers is enough to validate
+   the item. */
+static int init_ic_item(JSRuntime *rt, InlineCacheRingItem *item,
+                        JSObject *object, uint32_t prop_offset,
+                        int prop_flags, uint32_t proto_depth) {
+  JSShape **proto_shapes;
+  JSObject *p;
+  uint32_t i;
+  proto_shapes = NULL;
+  if (proto_depth > 0) {
+    proto_shapes = js_malloc_rt(rt, sizeof(proto_shapes[0]) * proto_depth);
+    if (unlikely(!proto_shapes))
+      return -1;
+    p = object;
+    for (i = 0; i < proto_depth; i++) {
+      p = p->shape->proto;
+      proto_shapes[i] = js_dup_shape(p->shape);
+    }
+  }
+  item->shape = js_dup_shape(object->shape);
+  item->prop_offset = prop_offset;
+  item->prop_flags = prop_flags;
+  item->proto_depth = proto_depth;
+  item->proto_shapes = proto_shapes;
+  return 0;
+}
+
 int free_ic(InlineCache *ic) {
   uint32_t i, j;
   InlineCacheHashSlot *ch, *ch_next;
   InlineCacheRingItem *buffer;
-  for (i = 0; i < ic->count; i++) {
+  /* the ring is only allocated by rebuild_ic() */
+  for (i = 0; ic->cache != NULL && i < ic->count; i++) {
     buffer = ic->cache[i].buffer;
     JS_FreeAtom(ic->ctx, ic->cache[i].atom);
     for (j = 0; j < IC_CACHE_ITEM_CAPACITY; j++) {
-      js_free_shape_null(ic->ctx->rt, buffer[j].shape);
+      free_ic_item(ic->ctx->rt, buffer + j);
     }
   }
   for (i = 0; i < ic->capacity; i++) {
@@ -117,20 +161,103 @@ int free_ic(InlineCache *ic) {
       js_free(ic->ctx, ch);
     }
   }
-  if (ic->count > 0)
-    js_free(ic->ctx, ic->cache);
+  js_free(ic->ctx, ic->cache);
   js_free(ic->ctx, ic->hash);
   js_free(ic->ctx, ic);
   return 0;
 }
 
-uint32_t add_ic_slot(InlineCache *ic, JSAtom atom, JSObject *object,
-                     uint32_t prop_offset) {
+void mark_ic(JSRuntime *rt, InlineCache *ic, JS_MarkFunc *mark_func) {
+  uint32_t i, j, k;
+  InlineCacheRingItem *buffer;
+  /* the ring is only allocated by rebuild_ic() */
+  for (i = 0; ic->cache != NULL && i < ic->count; i++) {
+    buffer = ic->cache[i].buffer;
+    for (j = 0; j < IC_CACHE_ITEM_CAPACITY; j++) {
+      if (!buffer[j].shape)
+        continue;
+      mark_func(rt, &buffer[j].shape->header);
+      for (k = 0; k < buffer[j].proto_depth; k++)
+        mark_func(rt, &buffer[j].proto_shapes[k]->header);
+    }
+  }
+}
+
+static force_inline uint32_t get_stub_hash(JSAtom atom, JSShape *shape) {
+  return ((uint32_t)((uintptr_t)shape >> 3) ^ atom) * 0x9e370001 >>
+         (32 - IC_STUB_CACHE_BITS);
+}
+
+InlineCacheRingItem *find_ic_stub(JSRuntime *rt, JSAtom atom, JSShape *shape) {
+  InlineCacheStubEntry *e;
+  if (!rt->ic_stub_cache)
+    return NULL;
+  e = rt->ic_stub_cache + get_stub_hash(atom, shape);
+  if (e->item.shape == shape && e->atom == atom)
+    return &e->item;
+  return NULL;
+}
+
+static int add_ic_stub(JSContext *ctx, JSAtom atom, JSObject *object,
+                       uint32_t prop_offset, int prop_flags,
+                       uint32_t proto_depth) {
+  JSRuntime *rt = ctx->rt;
+  InlineCacheStubEntry *e;
+  if (!rt->ic_stub_cache) {
+    rt->ic_stub_cache = js_mallocz_rt(
+        rt, sizeof(InlineCacheStubEntry) << IC_STUB_CACHE_BITS);
+    if (unlikely(!rt->ic_stub_cache))
+      return -1;
+  }
+  e = rt->ic_stub_cache + get_stub_hash(atom, object->shape);
+  if (e->item.shape) {
+    free_ic_item(rt, &e->item);
+    JS_FreeAtomRT(rt, e->atom);
+    e->atom = JS_ATOM_NULL;
+  }
+  if (init_ic_item(rt, &e->item, object, prop_offset, prop_flags, proto_depth))
+    return -1;
+  e->atom = JS_DupAtom(ctx, atom);
+  return 0;
+}
+
+/* The stub cache holds references to shapes, and through them to
+   prototypes, that no function accounts for: it is emptied before the
+   cycles are collected. */
+void flush_ic_stub_cache(JSRuntime *rt) {
+  InlineCacheStubEntry *e;
+  uint32_t i;
+  if (!rt->ic_stub_cache)
+    return;
+  for (i = 0; i < (1 << IC_STUB_CACHE_BITS); i++) {
+    e = rt->ic_stub_cache + i;
+    if (e->item.shape) {
+      free_ic_item(rt, &e->item);
+      JS_FreeAtomRT(rt, e->atom);
+      e->atom = JS_ATOM_NULL;
+    }
+  }
+}
+
+void free_ic_stub_cache(JSRuntime *rt) {
+  flush_ic_stub_cache(rt);
+  js_free_rt(rt, rt->ic_stub_cache);
+  rt->ic_stub_cache = NULL;
+}
+
+/* Cache the property of 'object' found 'proto_depth' objects up its
+   prototype chain. Return the offset of the cache slot of 'atom' or -1
+   if it cannot be cached. */
+int32_t add_ic_slot(InlineCache *ic, JSAtom atom, JSObject *object,
+                    uint32_t prop_offset, int prop_flags, uint32_t proto_depth) {
   int32_t i;
   uint32_t h;
   InlineCacheHashSlot *ch;
   InlineCacheRingSlot *cr;
-  JSShape *sh;
+  InlineCacheRingItem *buffer;
+  JSRuntime *rt = ic->ctx->rt;
+  if (proto_depth > IC_PROTO_DEPTH_MAX)
+    return -1;
   cr = NULL;
   h = get_index_hash(atom, ic->hash_bits);
   for (ch = ic->hash[h]; ch != NULL; ch = ch->next)
@@ -138,25 +265,32 @@ uint32_t add_ic_slot(InlineCache *ic, JSAtom atom, JSObject *object,
       cr = ic->cache + ch->index;
       break;
     }
+  if (unlikely(cr == NULL))
+    return -1;
 
-  assert(cr != NULL);
-  i = cr->index;
-  for (;;) {
-    if (object->shape == cr->buffer[i].shape) {
-      cr->buffer[i].prop_offset = prop_offset;
-      goto end;
+  buffer = cr->buffer;
+  for (i = 0; i < IC_CACHE_ITEM_CAPACITY; i++) {
+    if (buffer[i].shape == object->shape)
+      goto update;
+  }
+  if (!cr->megamorphic) {
+    for (i = 0; i < IC_CACHE_ITEM_CAPACITY; i++) {
+      if (!buffer[i].shape)
+        goto update;
     }
-
-    i = (i + 1) % IC_CACHE_ITEM_CAPACITY;
-    if (unlikely(i == cr->index))
-      break;
+    /* keep the shapes seen first in the ring and the others in the
+       stub cache shared by the whole runtime */
+    cr->megamorphic = TRUE;
   }
+  if (add_ic_stub(ic->ctx, atom, object, prop_offset, prop_flags, proto_depth))
+    return -1;
+  return ch->index;
 
-  sh = cr->buffer[i].shape;
-  cr->buffer[i].shape = js_dup_shape(object->shape);
-  js_free_shape_null(ic->ctx->rt, sh);
-  cr->buffer[i].prop_offset = prop_offset;
-end:
+update:
+  free_ic_item(rt, buffer + i);
+  if (init_ic_item(rt, buffer + i, object, prop_offset, prop_flags, proto_depth))
+    return -1;
+  cr->index = i;
   return ch->index;
 }
 
@@ -179,4 +313,56 @@ uint32_t add_ic_slot1(InlineCache *ic, JSAtom atom) {
   ic->count += 1;
 end:
   return 0;
-}
\ No newline at end of file
+}
+JSValue JS_GetInlineCacheStats(JSContext *ctx, JS_BOOL reset) {
+  JSRuntime *rt = ctx->rt;
+  struct list_head *el;
+  JSGCObjectHeader *gp;
+  JSFunctionBytecode *b;
+  InlineCacheRingSlot *cr;
+  StringBuffer b_s, *sb = &b_s;
+  char atom_buf[ATOM_GET_STR_BUF_SIZE];
+  char line[128];
+  uint32_t i, j, shape_count;
+
+  string_buffer_init(ctx, sb, 0);
+  list_for_each(el, &rt->gc_obj_list) {
+    gp = list_entry(el, JSGCObjectHeader, link);
+    if (gp->gc_obj_type != JS_GC_OBJ_TYPE_FUNCTION_BYTECODE)
+      continue;
+    b = (JSFunctionBytecode *)gp;
+    /* other contexts of the runtime keep their own statistics */
+    if (!b->ic || b->realm != ctx)
+      continue;
+    for (i = 0; i < b->ic->count; i++) {
+      cr = b->ic->cache + i;
+      if (cr->hits == 0 && cr->misses == 0)
+        continue;
+      shape_count = 0;
+      for (j = 0; j < IC_CACHE_ITEM_CAPACITY; j++) {
+        if (cr->buffer[j].shape)
+          shape_count++;
+      }
+      if (b->has_debug && b->debug.filename != JS_ATOM_NULL) {
+        string_buffer_puts8(sb, JS_AtomGetStr(ctx, atom_buf, sizeof(atom_buf), b->debug.filename));
+        snprintf(line, sizeof(line), ":%d ", b->debug.line_num);
+        string_buffer_puts8(sb, line);
+      }
+      if (b->func_name != JS_ATOM_NULL && b->func_name != JS_ATOM_empty_string)
+        string_buffer_puts8(sb, JS_AtomGetStr(ctx, atom_buf, sizeof(atom_buf), b->func_name));
+      else
+        string_buffer_puts8(sb, "<anonymous>");
+      string_buffer_puts8(sb, " .");
+      string_buffer_puts8(sb, JS_AtomGetStr(ctx, atom_buf, sizeof(atom_buf), cr->atom));
+      snprintf(line, sizeof(line), " %s shapes=%u hits=%u misses=%u\n",
+               cr->megamorphic ? "megamorphic" : shape_count > 1 ? "polymorphic" : "monomorphic",
+               shape_count, cr->hits, cr->misses);
+      string_buffer_puts8(sb, line);
+      if (reset) {
+        cr->hits = 0;
+        cr->misses = 0;
+      }
+    }
+  }
+  return string_buffer_end(sb);
+}
@@ -34,11 +34,17 @@ InlineCache *init_ic(JSContext *ctx);
 int rebuild_ic(InlineCache *ic);
 int resize_ic_hash(InlineCache *ic);
 int free_ic(InlineCache *ic);
-uint32_t add_ic_slot(InlineCache *ic, JSAtom atom, JSObject *object,
-                     uint32_t prop_offset);
+int32_t add_ic_slot(InlineCache *ic, JSAtom atom, JSObject *object,
+                    uint32_t prop_offset, int prop_flags, uint32_t proto_depth);
 uint32_t add_ic_slot1(InlineCache *ic, JSAtom atom);
-force_inline int32_t get_ic_prop_offset(InlineCache *ic, uint32_t cache_offset,
-                                        JSShape *shape) {
+void mark_ic(JSRuntime *rt, InlineCache *ic, JS_MarkFunc *mark_func);
+InlineCacheRingItem *find_ic_stub(JSRuntime *rt, JSAtom atom, JSShape *shape);
+void flush_ic_stub_cache(JSRuntime *rt);
+void free_ic_stub_cache(JSRuntime *rt);
+
+force_inline InlineCacheRingItem *get_ic_item(InlineCache *ic,
+                                              uint32_t cache_offset,
+                                              JSShape *shape) {
   uint32_t i;
   InlineCacheRingSlot *cr;
   InlineCacheRingItem *buffer;
@@ -49,7 +55,8 @@ force_inline int32_t get_ic_prop_offset(InlineCache *ic, uint32_t cache_offset,
     buffer = cr->buffer + i;
     if (likely(buffer->shape == shape)) {
       cr->index = i;
-      return buffer->prop_offset;
+      cr->hits++;
+      return buffer;
     }
 
     i = (i + 1) % IC_CACHE_ITEM_CAPACITY;
@@ -58,8 +65,37 @@ force_inline int32_t get_ic_prop_offset(InlineCache *ic, uint32_t cache_offset,
     }
   }
 
-  return -1;
+  if (cr->megamorphic) {
+    buffer = find_ic_stub(ic->ctx->rt, cr->atom, shape);
+    if (buffer) {
+      cr->hits++;
+      return buffer;
+    }
+  }
+  cr->misses++;
+  return NULL;
+}
+
+/* Return the object holding the property cached by 'item' for the
+   receiver 'p', or NULL if a prototype changed since it was cached. */
+force_inline JSObject *get_ic_holder(JSObject *p, InlineCacheRingItem *item) {
+  JSShape *sh;
+  uint32_t i;
+  if (likely(item->proto_depth == 0))
+    return p;
+  /* the exotic behaviors of the receiver come before its prototypes */
+  if (unlikely(p->is_exotic) && p->class_id != JS_CLASS_ARRAY)
+    return NULL;
+  sh = item->shape;
+  for (i = 0; i < item->proto_depth; i++) {
+    p = sh->proto;
+    sh = item->proto_shapes[i];
+    if (unlikely(p->shape != sh))
+      return NULL;
+  }
+  return p;
 }
+
 force_inline JSAtom get_ic_atom(InlineCache *ic, uint32_t cache_offset) {
   assert(cache_offset < ic->capacity);
   return ic->cache[cache_offset].atom;
@@ -196,7 +196,7 @@ void* js_def_malloc(JSMallocState* s, size_t size) {
     return NULL;
 
 #if ENABLE_MI_MALLOC
-  ptr = mi_malloc(size);
+  ptr = s->heap ? mi_heap_malloc(s->heap, size) : mi_malloc(size);
 #else
   ptr = malloc(size);
 #endif
@@ -245,7 +245,7 @@ void* js_def_realloc(JSMallocState* s, void* ptr, size_t size) {
     return NULL;
 
 #if ENABLE_MI_MALLOC
-  ptr = mi_realloc(ptr, size);
+  ptr = s->heap ? mi_heap_realloc(s->heap, ptr, size) : mi_realloc(ptr, size);
 #else
   ptr = realloc(ptr, size);
 #endif
@@ -260,4 +260,16 @@ void* js_def_realloc(JSMallocState* s, void* ptr, size_t size) {
 void JS_SetGCThreshold(JSRuntime *rt, size_t gc_threshold)
 {
   rt->malloc_gc_threshold = gc_threshold;
-}
\ No newline at end of file
+}
+
+void* JS_SetMallocHeap(JSRuntime* rt, void* heap) {
+  void* prev = rt->malloc_state.heap;
+#if ENABLE_MI_MALLOC
+  rt->malloc_state.heap = heap;
+#endif
+  return prev;
+}
+
+void* JS_GetMallocHeap(JSRuntime* rt) {
+  return rt->malloc_state.heap;
+}
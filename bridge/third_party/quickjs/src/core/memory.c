@@ -106,6 +106,13 @@ static void compute_value_size(JSValueConst val, JSMemoryUsage_helper *hp)
     case JS_TAG_STRING:
       compute_jsstring_size(JS_VALUE_GET_STRING(val), hp);
       break;
+    case JS_TAG_STRING_ROPE: {
+      JSStringRopeIter it;
+      JSString* p;
+      js_string_rope_iter_init(&it, val);
+      while ((p = js_string_rope_iter_next(&it)) != NULL)
+        compute_jsstring_size(p, hp);
+    } break;
 #ifdef CONFIG_BIGNUM
     case JS_TAG_BIG_INT:
     case JS_TAG_BIG_FLOAT:
@@ -220,13 +227,15 @@ void JS_ComputeMemoryUsage(JSRuntime *rt, JSMemoryUsage *s)
         s->array_count++;
         if (p->fast_array) {
           s->fast_array_count++;
-          if (p->u.array.u.values) {
+          if (p->u.array.u.ptr) {
             s->memory_used_count++;
             s->memory_used_size += p->u.array.count *
-                                   sizeof(*p->u.array.u.values);
+                                   js_array_kind_size(p->u.array.kind);
             s->fast_array_elements += p->u.array.count;
-            for (i = 0; i < p->u.array.count; i++) {
-              compute_value_size(p->u.array.u.values[i], hp);
+            if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+              for (i = 0; i < p->u.array.count; i++) {
+                compute_value_size(p->u.array.u.values[i], hp);
+              }
             }
           }
         }
@@ -53,6 +53,7 @@ JSValue JS_GetPropertyValue(JSContext* ctx, JSValueConst this_obj, JSValue prop)
       goto slow_path;
     switch (p->class_id) {
       case JS_CLASS_ARRAY:
+        return js_fast_array_get(ctx, p, idx);
       case JS_CLASS_ARGUMENTS:
         return JS_DupValue(ctx, p->u.array.u.values[idx]);
       case JS_CLASS_INT8_ARRAY:
@@ -94,7 +95,7 @@ JSValue JS_GetPropertyValue(JSContext* ctx, JSValueConst this_obj, JSValue prop)
 }
 
 JSValue JS_GetPropertyUint32(JSContext* ctx, JSValueConst this_obj, uint32_t idx) {
-  return JS_GetPropertyValue(ctx, this_obj, JS_NewUint32(ctx, idx));
+  return js_flatten_string_value(ctx, JS_GetPropertyValue(ctx, this_obj, JS_NewUint32(ctx, idx)));
 }
 
 /* Check if an object has a generalized numeric property. Return value:
@@ -191,6 +192,13 @@ JSProperty* add_property(JSContext* ctx, JSObject* p, JSAtom prop, int prop_flag
       js_free_shape(ctx->rt, p->shape);
       p->shape = new_sh;
     }
+  } else if (sh->header.ref_count != 1) {
+    /* the shape of a prototype held by an inline cache */
+    new_sh = js_clone_shape(ctx, sh);
+    if (!new_sh)
+      return NULL;
+    js_free_shape(ctx->rt, p->shape);
+    p->shape = new_sh;
   }
   assert(p->shape->header.ref_count == 1);
   if (add_shape_property(ctx, &p->shape, p, prop, prop_flags))
@@ -206,6 +214,8 @@ no_inline __exception int convert_fast_array_to_array(JSContext* ctx, JSObject*
   JSValue* tab;
   uint32_t i, len, new_count;
 
+  if (p->u.array.kind != JS_ARRAY_KIND_VALUE && js_array_widen(ctx, p, JS_ARRAY_KIND_VALUE))
+    return -1;
   if (js_shape_prepare_update(ctx, p, NULL))
     return -1;
   len = p->u.array.count;
@@ -292,7 +302,8 @@ redo:
         if (p->class_id == JS_CLASS_ARRAY || p->class_id == JS_CLASS_ARGUMENTS) {
           /* Special case deleting the last element of a fast Array */
           if (idx == p->u.array.count - 1) {
-            JS_FreeValue(ctx, p->u.array.u.values[idx]);
+            if (p->u.array.kind == JS_ARRAY_KIND_VALUE)
+              JS_FreeValue(ctx, p->u.array.u.values[idx]);
             p->u.array.count = idx;
             return TRUE;
           }
@@ -386,14 +397,25 @@ static int JS_AutoInitProperty(JSContext *ctx, JSObject *p, JSAtom prop,
   return 0;
 }
 
-JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
-                               JSAtom prop, JSValueConst this_obj,
-                               InlineCache *ic, BOOL throw_ref_error)
+static void set_ic_slot(InlineCache *ic, JSAtom prop, JSObject *p, uint32_t offset, int prop_flags,
+                        uint32_t proto_depth) {
+  int32_t ic_offset;
+  ic_offset = add_ic_slot(ic, prop, p, offset, prop_flags, proto_depth);
+  if (ic_offset >= 0) {
+    ic->updated = TRUE;
+    ic->updated_offset = ic_offset;
+  }
+}
+
+JSValue js_get_property_internal(JSContext *ctx, JSValueConst obj,
+                                 JSAtom prop, JSValueConst this_obj,
+                                 InlineCache *ic, BOOL throw_ref_error)
 {
-  JSObject *p;
+  JSObject *p, *p0;
   JSProperty *pr;
   JSShapeProperty *prs;
   uint32_t tag, offset, proto_depth;
+  BOOL cacheable;
 
   offset = proto_depth = 0;
   tag = JS_VALUE_GET_TAG(obj);
@@ -405,13 +427,21 @@ JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
         return JS_ThrowTypeErrorAtom(ctx, "cannot read property '%s' of undefined", prop);
       case JS_TAG_EXCEPTION:
         return JS_EXCEPTION;
+      case JS_TAG_STRING_ROPE:
       case JS_TAG_STRING:
       {
+        /* only 'len' may be read before a rope is flattened */
         JSString *p1 = JS_VALUE_GET_STRING(obj);
         if (__JS_AtomIsTaggedInt(prop)) {
           uint32_t idx, ch;
           idx = __JS_AtomToUInt32(prop);
           if (idx < p1->len) {
+            if (tag == JS_TAG_STRING_ROPE) {
+              /* indexed access flattens the rope */
+              p1 = js_flatten_string_rope(ctx, obj);
+              if (!p1)
+                return JS_EXCEPTION;
+            }
             if (p1->is_wide_char)
               ch = p1->u.str16[idx];
             else
@@ -430,14 +460,25 @@ JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
     p = JS_VALUE_GET_OBJ(JS_GetPrototypePrimitive(ctx, obj));
     if (!p)
       return JS_UNDEFINED;
+    /* the cache of a string receiver is looked up with the shape of
+       String.prototype */
+    cacheable = (tag == JS_TAG_STRING || tag == JS_TAG_STRING_ROPE);
   } else {
     p = JS_VALUE_GET_OBJ(obj);
+    /* the shape of an object which is not hashed is modified in place */
+    cacheable = p->shape->is_hashed;
   }
+  cacheable = cacheable && ic != NULL;
+  p0 = p;
 
   for(;;) {
     prs = find_own_property_ic(&pr, p, prop, &offset);
     if (prs) {
       /* found */
+      if (cacheable && (prs->flags & JS_PROP_TMASK) != JS_PROP_VARREF &&
+          (prs->flags & JS_PROP_TMASK) != JS_PROP_AUTOINIT) {
+        set_ic_slot(ic, prop, p0, offset, prs->flags, proto_depth);
+      }
       if (unlikely(prs->flags & JS_PROP_TMASK)) {
         if ((prs->flags & JS_PROP_TMASK) == JS_PROP_GETSET) {
           if (unlikely(!pr->u.getset.getter)) {
@@ -460,15 +501,12 @@ JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
           continue;
         }
       } else {
-        // basic poly ic is only used for fast path
-        if (ic != NULL && proto_depth == 0 && p->shape->is_hashed) {
-          ic->updated = TRUE;
-          ic->updated_offset = add_ic_slot(ic, prop, p, offset);
-        }
         return JS_DupValue(ctx, pr->u.value);
       }
     }
     if (unlikely(p->is_exotic)) {
+      if (p->class_id != JS_CLASS_ARRAY)
+        cacheable = FALSE;
       /* exotic behaviors */
       if (p->fast_array) {
         if (__JS_AtomIsTaggedInt(prop)) {
@@ -498,6 +536,9 @@ JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
             /* XXX: should pass throw_ref_error */
             /* Note: if 'p' is a prototype, it can be
                freed in the called function */
+            /* the exotic methods only see flat strings */
+            if (js_flatten_string_const(ctx, &this_obj))
+              return JS_EXCEPTION;
             obj1 = JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, p));
             retval = em->get_property(ctx, obj1, prop, this_obj);
             JS_FreeValue(ctx, obj1);
@@ -539,22 +580,56 @@ JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
   }
 }
 
-JSValue JS_GetPropertyInternalWithIC(JSContext *ctx, JSValueConst obj,
-                               JSAtom prop, JSValueConst this_obj,
-                               InlineCache *ic, int32_t offset, 
-                               BOOL throw_ref_error) 
+JSValue js_get_property_internal_with_ic(JSContext *ctx, JSValueConst obj,
+                                         JSAtom prop, JSValueConst this_obj,
+                                         InlineCache *ic, int32_t offset,
+                                         BOOL throw_ref_error)
 {
   uint32_t tag;
   JSObject *p;
+  InlineCacheRingItem *item;
+  JSProperty *pr;
   tag = JS_VALUE_GET_TAG(obj);
-  if (unlikely(tag != JS_TAG_OBJECT))
+  if (likely(tag == JS_TAG_OBJECT)) {
+    p = JS_VALUE_GET_OBJ(obj);
+  } else if ((tag == JS_TAG_STRING || tag == JS_TAG_STRING_ROPE) && prop != JS_ATOM_length &&
+             !__JS_AtomIsTaggedInt(prop)) {
+    p = JS_VALUE_GET_OBJ(ctx->class_proto[JS_CLASS_STRING]);
+  } else {
     goto slow_path;
-  p = JS_VALUE_GET_OBJ(obj);
-  offset = get_ic_prop_offset(ic, offset, p->shape);
-  if (likely(offset >= 0))
-    return JS_DupValue(ctx, p->prop[offset].u.value);
+  }
+  item = get_ic_item(ic, offset, p->shape);
+  if (likely(item != NULL)) {
+    p = get_ic_holder(p, item);
+    if (unlikely(!p))
+      goto slow_path;
+    pr = &p->prop[item->prop_offset];
+    if (likely(!(item->prop_flags & JS_PROP_TMASK)))
+      return JS_DupValue(ctx, pr->u.value);
+    if (unlikely(!pr->u.getset.getter))
+      return JS_UNDEFINED;
+    return JS_CallFree(ctx, JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, pr->u.getset.getter)),
+                       this_obj, 0, NULL);
+  }
 slow_path:
-  return JS_GetPropertyInternal(ctx, obj, prop, this_obj, ic, throw_ref_error);      
+  return js_get_property_internal(ctx, obj, prop, this_obj, ic, throw_ref_error);
+}
+
+/* The string ropes are internal to the engine: the public getters return
+   their flat string */
+JSValue JS_GetPropertyInternal(JSContext *ctx, JSValueConst obj,
+                               JSAtom prop, JSValueConst this_obj,
+                               InlineCache *ic, BOOL throw_ref_error)
+{
+  return js_flatten_string_value(ctx, js_get_property_internal(ctx, obj, prop, this_obj, ic, throw_ref_error));
+}
+
+JSValue JS_GetPropertyInternalWithIC(JSContext *ctx, JSValueConst obj,
+                                     JSAtom prop, JSValueConst this_obj,
+                                     InlineCache *ic, int32_t offset,
+                                     BOOL throw_ref_error)
+{
+  return js_flatten_string_value(ctx, js_get_property_internal_with_ic(ctx, obj, prop, this_obj, ic, offset, throw_ref_error));
 }
 
 JSValue JS_GetOwnPropertyNames2(JSContext* ctx, JSValueConst obj1, int flags, int kind) {
@@ -1327,11 +1402,21 @@ retry:
 }
 
 int JS_GetOwnProperty(JSContext* ctx, JSPropertyDescriptor* desc, JSValueConst obj, JSAtom prop) {
+  int ret;
+
   if (JS_VALUE_GET_TAG(obj) != JS_TAG_OBJECT) {
     JS_ThrowTypeErrorNotAnObject(ctx);
     return -1;
   }
-  return JS_GetOwnPropertyInternal(ctx, desc, JS_VALUE_GET_OBJ(obj), prop);
+  ret = JS_GetOwnPropertyInternal(ctx, desc, JS_VALUE_GET_OBJ(obj), prop);
+  if (ret > 0 && desc && JS_VALUE_GET_TAG(desc->value) == JS_TAG_STRING_ROPE) {
+    desc->value = js_flatten_string_value(ctx, desc->value);
+    if (JS_IsException(desc->value)) {
+      js_free_desc(ctx, desc);
+      return -1;
+    }
+  }
+  return ret;
 }
 
 /* allowed flags:
@@ -1539,7 +1624,8 @@ redo_prop_update:
               goto redo_prop_update;
           }
           if (flags & JS_PROP_HAS_VALUE) {
-            set_value(ctx, &p->u.array.u.values[idx], JS_DupValue(ctx, val));
+            if (js_fast_array_set(ctx, p, idx, JS_DupValue(ctx, val)))
+              return -1;
           }
           return TRUE;
         }
@@ -1682,6 +1768,13 @@ int JS_SetPropertyGeneric(JSContext* ctx, JSValueConst obj, JSAtom prop, JSValue
     if (p->is_exotic) {
       const JSClassExoticMethods* em = ctx->rt->class_array[p->class_id].exotic;
       if (em && em->set_property) {
+        /* the exotic methods only see flat strings */
+        val = js_flatten_string_value(ctx, val);
+        if (JS_IsException(val) || js_flatten_string_const(ctx, &this_obj)) {
+          JS_FreeValue(ctx, obj1);
+          JS_FreeValue(ctx, val);
+          return -1;
+        }
         ret = em->set_property(ctx, obj1, prop, val, this_obj, flags);
         JS_FreeValue(ctx, obj1);
         JS_FreeValue(ctx, val);
@@ -1771,11 +1864,15 @@ int JS_SetPropertyInternal(JSContext* ctx, JSValueConst this_obj, JSAtom prop, J
   JSProperty* pr;
   uint32_t tag;
   JSPropertyDescriptor desc;
-  int ret, offset;
+  int ret;
+  uint32_t offset, proto_depth;
+  BOOL cacheable;
 #if 0
     printf("JS_SetPropertyInternal: "); print_atom(ctx, prop); printf("\n");
 #endif
   offset = 0;
+  proto_depth = 0;
+  cacheable = FALSE;
   tag = JS_VALUE_GET_TAG(this_obj);
   if (unlikely(tag != JS_TAG_OBJECT)) {
     switch (tag) {
@@ -1800,10 +1897,8 @@ retry:
   if (prs) {
     if (likely((prs->flags & (JS_PROP_TMASK | JS_PROP_WRITABLE | JS_PROP_LENGTH)) == JS_PROP_WRITABLE)) {
       /* fast case */
-      if (ic != NULL && p->shape->is_hashed) {
-        ic->updated = TRUE;
-        ic->updated_offset = add_ic_slot(ic, prop, p, offset);
-      }
+      if (ic != NULL && p->shape->is_hashed)
+        set_ic_slot(ic, prop, p, offset, prs->flags, 0);
       set_value(ctx, &pr->u.value, val);
       return TRUE;
     } else if (prs->flags & JS_PROP_LENGTH) {
@@ -1811,6 +1906,8 @@ retry:
       assert(prop == JS_ATOM_length);
       return set_array_length(ctx, p, val, flags);
     } else if ((prs->flags & JS_PROP_TMASK) == JS_PROP_GETSET) {
+      if (ic != NULL && p->shape->is_hashed)
+        set_ic_slot(ic, prop, p, offset, prs->flags, 0);
       return call_setter(ctx, pr->u.getset.setter, this_obj, val, flags);
     } else if ((prs->flags & JS_PROP_TMASK) == JS_PROP_VARREF) {
       /* JS_PROP_WRITABLE is always true for variable
@@ -1833,8 +1930,11 @@ retry:
   }
 
   p1 = p;
+  cacheable = ic != NULL && p->shape->is_hashed;
   for (;;) {
     if (p1->is_exotic) {
+      if (p1->class_id != JS_CLASS_ARRAY)
+        cacheable = FALSE;
       if (p1->fast_array) {
         if (__JS_AtomIsTaggedInt(prop)) {
           uint32_t idx = __JS_AtomToUInt32(prop);
@@ -1866,6 +1966,12 @@ retry:
         if (em) {
           JSValue obj1;
           if (em->set_property) {
+            /* the exotic methods only see flat strings */
+            val = js_flatten_string_value(ctx, val);
+            if (JS_IsException(val) || js_flatten_string_const(ctx, &this_obj)) {
+              JS_FreeValue(ctx, val);
+              return -1;
+            }
             /* set_property can free the prototype */
             obj1 = JS_DupValue(ctx, JS_MKPTR(JS_TAG_OBJECT, p1));
             ret = em->set_property(ctx, obj1, prop, val, this_obj, flags);
@@ -1911,14 +2017,19 @@ retry:
       }
     }
     p1 = p1->shape->proto;
+    proto_depth++;
   prototype_lookup:
     if (!p1)
       break;
 
   retry2:
-    prs = find_own_property(&pr, p1, prop);
+    prs = find_own_property_ic(&pr, p1, prop, &offset);
     if (prs) {
       if ((prs->flags & JS_PROP_TMASK) == JS_PROP_GETSET) {
+        /* setters found on a prototype are cached, not data properties
+           which are shadowed by the assignment */
+        if (cacheable)
+          set_ic_slot(ic, prop, p, offset, prs->flags, proto_depth);
         return call_setter(ctx, pr->u.getset.setter, this_obj, val, flags);
       } else if ((prs->flags & JS_PROP_TMASK) == JS_PROP_AUTOINIT) {
         /* Instantiate property and retry (potentially useless) */
@@ -1977,15 +2088,26 @@ retry:
 
 int JS_SetPropertyInternalWithIC(JSContext* ctx, JSValueConst this_obj, JSAtom prop, JSValue val, int flags, InlineCache *ic, int32_t offset) {
   uint32_t tag;
-  JSObject *p;
+  JSObject *p, *p1;
+  InlineCacheRingItem *item;
   tag = JS_VALUE_GET_TAG(this_obj);
   if (unlikely(tag != JS_TAG_OBJECT))
     goto slow_path;
   p = JS_VALUE_GET_OBJ(this_obj);
-  offset = get_ic_prop_offset(ic, offset, p->shape);
-  if (likely(offset >= 0)) {
-    set_value(ctx, &p->prop[offset].u.value, val);
-    return TRUE;
+  item = get_ic_item(ic, offset, p->shape);
+  if (likely(item != NULL)) {
+    /* the items recorded by the property reads of the same function are
+       also found here */
+    if (likely(item->proto_depth == 0 &&
+               (item->prop_flags & (JS_PROP_TMASK | JS_PROP_WRITABLE | JS_PROP_LENGTH)) == JS_PROP_WRITABLE)) {
+      set_value(ctx, &p->prop[item->prop_offset].u.value, val);
+      return TRUE;
+    }
+    if ((item->prop_flags & JS_PROP_TMASK) == JS_PROP_GETSET) {
+      p1 = get_ic_holder(p, item);
+      if (likely(p1 != NULL))
+        return call_setter(ctx, p1->prop[item->prop_offset].u.getset.setter, this_obj, val, flags);
+    }
   }
 slow_path:
   return JS_SetPropertyInternal(ctx, this_obj, prop, val, flags, ic);
@@ -2029,7 +2151,8 @@ int JS_SetPropertyValue(JSContext* ctx, JSValueConst this_obj, JSValue prop, JSV
           /* add element */
           return add_fast_array_element(ctx, p, val, flags);
         }
-        set_value(ctx, &p->u.array.u.values[idx], val);
+        if (js_fast_array_set(ctx, p, idx, val))
+          return -1;
         break;
       case JS_CLASS_ARGUMENTS:
         if (unlikely(idx >= (uint32_t)p->u.array.count))
@@ -31,6 +31,16 @@
 #include "shape.h"
 #include "types.h"
 
+/* JS_GetPropertyInternal() and JS_GetPropertyInternalWithIC() for the
+   interpreter: string ropes are returned as is */
+JSValue js_get_property_internal(JSContext* ctx, JSValueConst obj, JSAtom prop, JSValueConst this_obj, InlineCache* ic, BOOL throw_ref_error);
+JSValue js_get_property_internal_with_ic(JSContext* ctx,
+                                         JSValueConst obj,
+                                         JSAtom prop,
+                                         JSValueConst this_obj,
+                                         InlineCache* ic,
+                                         int32_t offset,
+                                         BOOL throw_ref_error);
 JSValue JS_GetPropertyValue(JSContext* ctx, JSValueConst this_obj, JSValue prop);
 
 /* Check if an object has a generalized numeric property. Return value:
@@ -3340,8 +3340,11 @@ fail:
 static __exception int js_parse_array_literal(JSParseState *s)
 {
   uint32_t idx;
-  BOOL need_length;
+  BOOL need_length, is_call_arg;
 
+  /* the functions of an array passed as call argument, such as the
+     modules of a webpack bundle, are compiled like call arguments */
+  is_call_arg = (s->token.ptr == s->call_arg_ptr);
   if (next_token(s))
     return -1;
   /* small regular arrays are created on the stack */
@@ -3349,6 +3352,8 @@ static __exception int js_parse_array_literal(JSParseState *s)
   while (s->token.val != ']' && idx < 32) {
     if (s->token.val == ',' || s->token.val == TOK_ELLIPSIS)
       break;
+    if (is_call_arg)
+      s->call_arg_ptr = s->token.ptr;
     if (js_parse_assign_expr(s))
       return -1;
     idx++;
@@ -3370,6 +3375,8 @@ static __exception int js_parse_array_literal(JSParseState *s)
       break;
     need_length = TRUE;
     if (s->token.val != ',') {
+      if (is_call_arg)
+        s->call_arg_ptr = s->token.ptr;
       if (js_parse_assign_expr(s))
         return -1;
       emit_op(s, OP_define_field);
@@ -4416,11 +4423,22 @@ static __exception int js_parse_postfix_expr(JSParseState *s, int parse_flags)
       }
       break;
     case TOK_FUNCTION:
-      if (js_parse_function_decl(s, JS_PARSE_FUNC_EXPR,
-                                 JS_FUNC_NORMAL, JS_ATOM_NULL,
-                                 s->token.ptr, s->token.line_num,
-                                 s->token.column_num))
-        return -1;
+      {
+        JSFunctionDef *fd1;
+        /* the previous token always exists here */
+        BOOL is_paren = (s->last_ptr[-1] == '(');
+        BOOL is_call_arg = (s->token.ptr == s->call_arg_ptr);
+        if (js_parse_function_decl2(s, JS_PARSE_FUNC_EXPR,
+                                    JS_FUNC_NORMAL, JS_ATOM_NULL,
+                                    s->token.ptr, s->token.line_num,
+                                    s->token.column_num,
+                                    JS_PARSE_EXPORT_NONE, &fd1))
+          return -1;
+        /* '(function() {...})()', 'function() {...}()' and
+           'f(a, function() {...})', such as the factory of a UMD
+           wrapper */
+        fd1->is_paren_func_expr = is_paren || is_call_arg || s->token.val == '(';
+      }
       break;
     case TOK_CLASS:
       if (js_parse_class(s, TRUE, JS_PARSE_EXPORT_NONE))
@@ -4728,6 +4746,7 @@ static __exception int js_parse_postfix_expr(JSParseState *s, int parse_flags)
         }
         if (s->token.val == TOK_ELLIPSIS)
           break;
+        s->call_arg_ptr = s->token.ptr;
         if (js_parse_assign_expr(s))
           return -1;
         arg_count++;
@@ -7477,6 +7496,7 @@ JSFunctionDef *js_new_function_def(JSContext *ctx,
     list_add_tail(&fd->link, &parent->child_list);
     fd->js_mode = parent->js_mode;
     fd->parent_scope_level = parent->scope_level;
+    fd->allow_lazy = parent->allow_lazy;
   }
 
   fd->is_eval = is_eval;
@@ -7574,6 +7594,8 @@ static void js_free_function_def(JSContext *ctx, JSFunctionDef *fd)
   dbuf_free(&fd->pc2column);
 
   js_free(ctx, fd->source);
+  if (fd->ic)
+    free_ic(fd->ic);
 
   if (fd->parent) {
     /* remove in parent list */
@@ -8468,14 +8490,9 @@ static int resolve_scope_var(JSContext *ctx, JSFunctionDef *s,
     for (idx = fd->scopes[scope_level].first; idx >= 0;) {
       vd = &fd->vars[idx];
       if (vd->var_name == var_name) {
-        if (op == OP_scope_put_var || op == OP_scope_make_ref) {
-          if (vd->is_const) {
-            dbuf_putc(bc, OP_throw_error);
-            dbuf_put_u32(bc, JS_DupAtom(ctx, var_name));
-            dbuf_putc(bc, JS_THROW_VAR_RO);
-            goto done;
-          }
-        }
+        /* a const variable is captured even if it is only assigned
+           (which throws), so that the closure variables of a lazy
+           function are the same when it is compiled */
         var_idx = idx;
         break;
       } else if (vd->var_name == JS_ATOM__with_ && !is_pseudo_var) {
@@ -9190,6 +9207,10 @@ static BOOL code_match(CodeContext *s, int pos, ...)
       if (op == OP_line_num) {
         line_num = get_u32(tab + pos + 1);
         pos = pos_next;
+      } else if (op == OP_column_num) {
+        /* the matched code is replaced as a whole, so the column
+           numbers inside the pattern are dropped */
+        pos = pos_next;
       } else {
         break;
       }
@@ -9974,7 +9995,7 @@ static BOOL code_has_label(CodeContext *s, int pos, int label)
 {
   while (pos < s->bc_len) {
     int op = s->bc_buf[pos];
-    if (op == OP_line_num) {
+    if (op == OP_line_num || op == OP_column_num) {
       pos += 5;
       continue;
     }
@@ -10012,6 +10033,7 @@ static int find_jump_target(JSFunctionDef *s, int label, int *pop, int *pline)
           if (pline)
             *pline = get_u32(s->byte_code.buf + pos + 1);
           /* fall thru */
+        case OP_column_num:
         case OP_label:
           pos += opcode_info[op].size;
           continue;
@@ -10038,6 +10060,49 @@ done:
   return label;
 }
 
+/* fold the integer operation 'a op b'. Return FALSE if the result is
+   not an int32 or if the operation cannot be folded */
+static BOOL fold_int32_op(int op, int a, int b, int *pres)
+{
+  int64_t r;
+
+  switch(op) {
+    case OP_add:
+      r = (int64_t)a + b;
+      break;
+    case OP_sub:
+      r = (int64_t)a - b;
+      break;
+    case OP_mul:
+      r = (int64_t)a * b;
+      /* the result is -0 */
+      if (r == 0 && (a | b) < 0)
+        return FALSE;
+      break;
+    case OP_and:
+      r = a & b;
+      break;
+    case OP_or:
+      r = a | b;
+      break;
+    case OP_xor:
+      r = a ^ b;
+      break;
+    case OP_shl:
+      r = (int32_t)((uint32_t)a << (b & 0x1f));
+      break;
+    case OP_sar:
+      r = a >> (b & 0x1f);
+      break;
+    default:
+      return FALSE;
+  }
+  if (r != (int32_t)r)
+    return FALSE;
+  *pres = r;
+  return TRUE;
+}
+
 static void push_short_int(DynBuf *bc_out, int val)
 {
 #if SHORT_OPCODES
@@ -10130,6 +10195,8 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
   int label;
 #if SHORT_OPCODES
   JumpSlot *jp;
+  /* position of the last emitted opcode that can start a superinstruction */
+  int fuse_pos = -1;
 #endif
 
   label_slots = s->label_slots;
@@ -10248,6 +10315,10 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
         ls = &label_slots[label];
         assert(ls->addr == -1);
         ls->addr = bc_out.size;
+#if SHORT_OPCODES
+        /* do not fuse opcodes across a jump target */
+        fuse_pos = -1;
+#endif
         /* resolve the relocation entries */
         for(re = ls->first_reloc; re != NULL; re = re_next) {
           int diff = ls->addr - re->addr;
@@ -10373,6 +10444,11 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
         add_pc2line_info(s, bc_out.size, line_num);
         if (op == OP_goto) {
           pos_next = skip_dead_code(s, bc_buf, bc_len, pos_next, &line_num);
+          /* jump over dead code to the next live instruction: remove jump */
+          if (OPTIMIZE && code_has_label(&cc, pos_next, label)) {
+            update_label(s, label, -1);
+            break;
+          }
         }
         assert(label >= 0 && label < s->label_count);
         ls = &label_slots[label];
@@ -10383,6 +10459,31 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
         jp->pos = bc_out.size + 1;
         jp->label = label;
 
+        if (OPTIMIZE && op == OP_if_false && fuse_pos >= 0 && fuse_pos == bc_out.size - 1 &&
+            bc_out.buf[fuse_pos] >= OP_lt && bc_out.buf[fuse_pos] <= OP_gte) {
+          /* transform lt/lte/gt/gte if_false8(l1) -> lt/lte/gt/gte_if_false8(l1) */
+          int diff = ls->addr == -1 ? ls->pos2 - pos - 1 : ls->addr - bc_out.size;
+          jp->fuse_op = OP_lt_if_false8 + (bc_out.buf[fuse_pos] - OP_lt);
+          fuse_pos = -1;
+          if (diff == (int8_t)diff) {
+            jp->op = jp->fuse_op;
+            jp->size = 1;
+            jp->pos = bc_out.size;
+            bc_out.buf[bc_out.size - 1] = jp->op;
+            if (ls->addr == -1) {
+              dbuf_putc(&bc_out, 0);
+              if (!add_reloc(ctx, ls, bc_out.size - 1, 1))
+                goto fail;
+            } else {
+              dbuf_putc(&bc_out, diff);
+            }
+            break;
+          }
+          /* keep the 32 bit jump: the opcodes are fused if it can be
+             shortened later */
+          goto has_long_label;
+        }
+
         if (ls->addr == -1) {
           int diff = ls->pos2 - pos - 1;
           if (diff < 128 && (op == OP_if_false || op == OP_if_true || op == OP_goto)) {
@@ -10420,6 +10521,7 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
             break;
           }
         }
+      has_long_label:
 #endif
         dbuf_putc(&bc_out, op);
         dbuf_put_u32(&bc_out, ls->addr - bc_out.size);
@@ -10530,8 +10632,22 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
 
       case OP_push_i32:
         if (OPTIMIZE) {
-          /* transform i32(val) neg -> i32(-val) */
           val = get_i32(bc_buf + pos + 1);
+          /* fold constant integer expressions: i32(a) i32(b) op -> i32(a op b) */
+          while (!(s->js_mode & JS_MODE_MATH) && code_match(&cc, pos_next, OP_push_i32, -1)) {
+            int pos1 = cc.pos;
+            int line1 = cc.line_num;
+            int val1 = cc.label;
+            if (!code_match(&cc, pos1, M4(OP_add, OP_sub, OP_mul, OP_and), -1) &&
+                !code_match(&cc, pos1, M4(OP_or, OP_xor, OP_shl, OP_sar), -1))
+              break;
+            if (!fold_int32_op(cc.op, val, val1, &val))
+              break;
+            if (line1 >= 0) line_num = line1;
+            if (cc.line_num >= 0) line_num = cc.line_num;
+            pos_next = cc.pos;
+          }
+          /* transform i32(val) neg -> i32(-val) */
           if ((val != INT32_MIN && val != 0)
               &&  code_match(&cc, pos_next, OP_neg, -1)) {
             if (cc.line_num >= 0) line_num = cc.line_num;
@@ -10562,6 +10678,20 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
         goto no_change;
 
 #if SHORT_OPCODES
+      case OP_add:
+      case OP_lt:
+      case OP_lte:
+      case OP_gt:
+      case OP_gte:
+        if (OPTIMIZE) {
+          /* may be fused with the following put_loc or if_false */
+          add_pc2line_info(s, bc_out.size, line_num);
+          fuse_pos = bc_out.size;
+          dbuf_putc(&bc_out, op);
+          break;
+        }
+        goto no_change;
+
       case OP_push_const:
       case OP_fclosure:
         if (OPTIMIZE) {
@@ -10700,6 +10830,16 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
                 pos_next = cc.pos;
               }
             }
+#if SHORT_OPCODES
+            /* transformation: add put_loc(n) -> add_put_loc8(n) */
+            if (op1 == OP_put_loc && cc.idx < 256 && fuse_pos >= 0 && fuse_pos == bc_out.size - 1 &&
+                bc_out.buf[fuse_pos] == OP_add) {
+              bc_out.buf[fuse_pos] = OP_add_put_loc8;
+              dbuf_putc(&bc_out, cc.idx);
+              fuse_pos = -1;
+              break;
+            }
+#endif
             add_pc2line_info(s, bc_out.size, line_num);
             put_short_code(&bc_out, op1, cc.idx);
             if (line2 >= 0) line_num = line2;
@@ -10776,7 +10916,18 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
             pos_next = cc.pos;
             break;
           }
+#if SHORT_OPCODES
+          /* transformation: get_loc0 get_loc(1) -> get_loc0_loc1 */
+          if (idx == 1 && fuse_pos >= 0 && fuse_pos == bc_out.size - 1 && bc_out.buf[fuse_pos] == OP_get_loc0) {
+            bc_out.buf[fuse_pos] = OP_get_loc0_loc1;
+            fuse_pos = -1;
+            break;
+          }
+#endif
           add_pc2line_info(s, bc_out.size, line_num);
+#if SHORT_OPCODES
+          fuse_pos = bc_out.size;
+#endif
           put_short_code(&bc_out, op, idx);
           break;
         }
@@ -10807,6 +10958,16 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
             pos_next = cc.pos;
             break;
           }
+#if SHORT_OPCODES
+          /* transformation: add put_loc(n) -> add_put_loc8(n) */
+          if (op == OP_put_loc && idx < 256 && fuse_pos >= 0 && fuse_pos == bc_out.size - 1 &&
+              bc_out.buf[fuse_pos] == OP_add) {
+            bc_out.buf[fuse_pos] = OP_add_put_loc8;
+            dbuf_putc(&bc_out, idx);
+            fuse_pos = -1;
+            break;
+          }
+#endif
           add_pc2line_info(s, bc_out.size, line_num);
           put_short_code(&bc_out, op, idx);
           break;
@@ -10931,6 +11092,19 @@ static __exception int resolve_labels(JSContext *ctx, JSFunctionDef *s)
         case OP_goto:
           pos = jp->pos;
           diff = s->label_slots[jp->label].addr - pos;
+          if (jp->fuse_op) {
+            /* transform lt/lte/gt/gte if_false(l1) -> lt/lte/gt/gte_if_false8(l1):
+               the offset moves to the if_false opcode and the offset of a
+               forward jump decreases by 3 */
+            if (diff >= -129 && diff <= 130) {
+              bc_out.buf[pos - 2] = jp->op = jp->fuse_op;
+              jp->size = 1;
+              jp->pos = --pos;
+              delta = 4;
+              goto shrink;
+            }
+            break;
+          }
           if (diff >= -128 && diff <= 127 + delta) {
             //put_u8(bc_out.buf + pos, diff);
             jp->size = 1;
@@ -11158,6 +11332,10 @@ static __exception int compute_stack_size(JSContext *ctx,
         break;
       case OP_if_true8:
       case OP_if_false8:
+      case OP_lt_if_false8:
+      case OP_lte_if_false8:
+      case OP_gt_if_false8:
+      case OP_gte_if_false8:
         diff = (int8_t)bc_buf[pos + 1];
         if (ss_check(ctx, s, pos + 1 + diff, op, stack_len))
           goto fail;
@@ -11246,19 +11424,11 @@ static int add_module_variables(JSContext *ctx, JSFunctionDef *fd)
   return 0;
 }
 
-/* create a function object from a function definition. The function
-   definition is freed. All the child functions are also created. It
-   must be done this way to resolve all the variables. */
-static JSValue js_create_function(JSContext *ctx, JSFunctionDef *fd)
+/* recompute scope linkage */
+static void link_function_scopes(JSFunctionDef *fd)
 {
-  JSValue func_obj;
-  JSFunctionBytecode *b;
-  struct list_head *el, *el1;
-  int stack_size, scope, idx;
-  int function_size, byte_code_offset, cpool_offset;
-  int closure_var_offset, vardefs_offset;
+  int scope, idx;
 
-  /* recompute scope linkage */
   for (scope = 0; scope < fd->scope_count; scope++) {
     fd->scopes[scope].first = -1;
   }
@@ -11283,6 +11453,144 @@ static JSValue js_create_function(JSContext *ctx, JSFunctionDef *fd)
       vd->scope_next = fd->scopes[scope].first;
     }
   }
+}
+
+static BOOL js_function_def_has_eval_call(JSFunctionDef *fd)
+{
+  struct list_head *el;
+
+  if (fd->has_eval_call)
+    return TRUE;
+  list_for_each(el, &fd->child_list) {
+    if (js_function_def_has_eval_call(list_entry(el, JSFunctionDef, link)))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/* Return TRUE if the bytecode of the child function 'fd' can be
+   generated on its first call. Its source is then parsed again with
+   its closure variables as the only visible outer variables, so they
+   must be plain variables: with objects, eval variable objects and
+   private names in the enclosing scopes prevent it. */
+static BOOL js_function_def_can_be_lazy(JSFunctionDef *fd)
+{
+  JSFunctionDef *fd1;
+  int idx;
+
+  if (!fd->allow_lazy || fd->is_paren_func_expr || !fd->source ||
+      fd->func_kind != JS_FUNC_NORMAL ||
+      (fd->func_type != JS_PARSE_FUNC_STATEMENT &&
+       fd->func_type != JS_PARSE_FUNC_VAR &&
+       fd->func_type != JS_PARSE_FUNC_EXPR))
+    return FALSE;
+  if (js_function_def_has_eval_call(fd))
+    return FALSE;
+  for (fd1 = fd; fd1->parent; fd1 = fd1->parent) {
+    if (fd1->parent->has_eval_call)
+      return FALSE;
+    for (idx = fd1->parent->scopes[fd1->parent_scope_level].first; idx >= 0;) {
+      JSVarDef *vd = &fd1->parent->vars[idx];
+      if (vd->var_name == JS_ATOM__with_ ||
+          vd->var_kind >= JS_VAR_PRIVATE_FIELD)
+        return FALSE;
+      idx = vd->scope_next;
+    }
+  }
+  return TRUE;
+}
+
+/* Resolve the variables of 'fd' and of its children without generating
+   their bytecode. */
+static int resolve_function_def_variables(JSContext *ctx, JSFunctionDef *fd)
+{
+  struct list_head *el;
+
+  link_function_scopes(fd);
+  list_for_each(el, &fd->child_list) {
+    if (resolve_function_def_variables(ctx, list_entry(el, JSFunctionDef, link)))
+      return -1;
+  }
+  return resolve_variables(ctx, fd);
+}
+
+/* Create the bytecode of a function which is compiled on its first
+   call. Only its closure variables are kept with the source code: they
+   are captured by the enclosing functions as if it was compiled. */
+static JSValue js_create_lazy_function(JSContext *ctx, JSFunctionDef *fd)
+{
+  JSFunctionBytecode *b;
+  int function_size, cpool_offset, closure_var_offset;
+
+  if (resolve_function_def_variables(ctx, fd))
+    goto fail;
+
+  function_size = sizeof(*b);
+  cpool_offset = function_size;
+  function_size += sizeof(*b->cpool);
+  closure_var_offset = function_size;
+  function_size += fd->closure_var_count * sizeof(*fd->closure_var);
+
+  b = js_mallocz(ctx, function_size);
+  if (!b)
+    goto fail;
+  b->header.ref_count = 1;
+  b->is_lazy = 1;
+  b->is_func_expr = fd->is_func_expr;
+
+  b->func_name = fd->func_name;
+  fd->func_name = JS_ATOM_NULL;
+  b->defined_arg_count = fd->defined_arg_count;
+  b->cpool = (void *)((uint8_t*)b + cpool_offset);
+  b->cpool[0] = JS_UNDEFINED;
+  b->cpool_count = 1;
+
+  b->has_debug = 1;
+  b->debug.filename = fd->filename;
+  fd->filename = JS_ATOM_NULL;
+  b->debug.line_num = fd->line_num;
+  b->debug.column_num = fd->column_num;
+  b->debug.source = fd->source;
+  b->debug.source_len = fd->source_len;
+  fd->source = NULL;
+
+  b->closure_var_count = fd->closure_var_count;
+  if (b->closure_var_count) {
+    b->closure_var = (void *)((uint8_t*)b + closure_var_offset);
+    memcpy(b->closure_var, fd->closure_var, b->closure_var_count * sizeof(*b->closure_var));
+  }
+  fd->closure_var_count = 0;
+
+  b->has_prototype = fd->has_prototype;
+  b->has_simple_parameter_list = fd->has_simple_parameter_list;
+  b->js_mode = fd->js_mode;
+  b->func_kind = fd->func_kind;
+  b->new_target_allowed = fd->new_target_allowed;
+  b->arguments_allowed = fd->arguments_allowed;
+  b->backtrace_barrier = fd->backtrace_barrier;
+  b->realm = JS_DupContext(ctx);
+
+  add_gc_object(ctx->rt, &b->header, JS_GC_OBJ_TYPE_FUNCTION_BYTECODE);
+  js_free_function_def(ctx, fd);
+  return JS_MKPTR(JS_TAG_FUNCTION_BYTECODE, b);
+fail:
+  js_free_function_def(ctx, fd);
+  return JS_EXCEPTION;
+}
+
+/* create a function object from a function definition. The function
+   definition is freed. All the child functions are also created. It
+   must be done this way to resolve all the variables. */
+static JSValue js_create_function(JSContext *ctx, JSFunctionDef *fd)
+{
+  JSValue func_obj;
+  JSFunctionBytecode *b;
+  struct list_head *el, *el1;
+  int stack_size;
+  int function_size, byte_code_offset, cpool_offset;
+  int closure_var_offset, vardefs_offset;
+
+  link_function_scopes(fd);
 
   /* if the function contains an eval call, the closure variables
      are used to compile the eval and they must be ordered by scope,
@@ -11304,7 +11612,10 @@ static JSValue js_create_function(JSContext *ctx, JSFunctionDef *fd)
 
     fd1 = list_entry(el, JSFunctionDef, link);
     cpool_idx = fd1->parent_cpool_idx;
-    func_obj = js_create_function(ctx, fd1);
+    if (js_function_def_can_be_lazy(fd1))
+      func_obj = js_create_lazy_function(ctx, fd1);
+    else
+      func_obj = js_create_function(ctx, fd1);
     if (JS_IsException(func_obj))
       goto fail;
     /* save it in the constant pool */
@@ -12381,6 +12692,10 @@ JSValue __JS_EvalInternal(JSContext *ctx, JSValueConst this_obj,
     fd->arguments_allowed = TRUE;
   }
   fd->js_mode = js_mode;
+  /* the bytecode written by JS_WriteObject() must be complete */
+  fd->allow_lazy = (eval_type == JS_EVAL_TYPE_GLOBAL ||
+                    eval_type == JS_EVAL_TYPE_INDIRECT) &&
+                   !(flags & JS_EVAL_FLAG_COMPILE_ONLY);
   fd->func_name = JS_DupAtom(ctx, JS_ATOM__eval_);
   if (b) {
     if (add_closure_variables(ctx, fd, b, scope_idx))
@@ -12424,3 +12739,87 @@ fail1:
     js_free_module_def(ctx, m);
   return JS_EXCEPTION;
 }
+
+/* Generate the bytecode of the lazy function 'b' and store it in
+   b->cpool[0]. Its source is parsed again as a function expression
+   inside a wrapper whose closure variables are those of 'b', the same
+   way direct eval code sees the variables of its caller. The closure
+   variables of 'b' are added first to the new function so that they
+   keep their index. */
+int js_compile_lazy_function(JSContext *ctx, JSFunctionBytecode *b)
+{
+  JSParseState s1, *s = &s1;
+  JSFunctionDef *fd, *fd1;
+  JSFunctionBytecode *b1;
+  JSValue func_obj;
+  const char *filename;
+  int i;
+
+  if (!JS_IsUndefined(b->cpool[0]))
+    return 0;
+  filename = JS_AtomToCString(ctx, b->debug.filename);
+  if (!filename)
+    return -1;
+  js_parse_init(ctx, s, b->debug.source, b->debug.source_len, filename);
+  s->line_num = b->debug.line_num;
+  s->column_num_count = b->debug.column_num;
+  s->allow_html_comments = TRUE;
+
+  fd = js_new_function_def(ctx, NULL, TRUE, FALSE, filename,
+                           b->debug.line_num, b->debug.column_num);
+  if (!fd)
+    goto fail1;
+  s->cur_func = fd;
+  fd->eval_type = JS_EVAL_TYPE_DIRECT;
+  fd->js_mode = b->js_mode;
+  fd->allow_lazy = TRUE;
+  for (i = 0; i < b->closure_var_count; i++) {
+    JSClosureVar *cv = &b->closure_var[i];
+    if (add_closure_var(ctx, fd, cv->is_local, cv->is_arg, cv->var_idx,
+                        cv->var_name, cv->is_const, cv->is_lexical,
+                        cv->var_kind) < 0)
+      goto fail;
+  }
+
+  if (next_token(s))
+    goto fail;
+  if (js_parse_function_decl2(s, JS_PARSE_FUNC_EXPR, JS_FUNC_NORMAL,
+                              JS_ATOM_NULL, s->token.ptr,
+                              s->token.line_num, s->token.column_num,
+                              JS_PARSE_EXPORT_NONE, &fd1))
+    goto fail;
+  /* a function declaration does not see its own name */
+  fd1->is_func_expr = b->is_func_expr;
+  for (i = 0; i < b->closure_var_count; i++) {
+    JSClosureVar *cv = &b->closure_var[i];
+    if (add_closure_var(ctx, fd1, FALSE, cv->is_arg, i, cv->var_name,
+                        cv->is_const, cv->is_lexical, cv->var_kind) < 0)
+      goto fail;
+  }
+
+  func_obj = js_create_function(ctx, fd1);
+  if (JS_IsException(func_obj))
+    goto fail;
+  b1 = JS_VALUE_GET_PTR(func_obj);
+  if (b1->closure_var_count != b->closure_var_count) {
+    JS_FreeValue(ctx, func_obj);
+    JS_ThrowInternalError(ctx, "invalid closure variables in lazy function");
+    goto fail;
+  }
+  for (i = 0; i < b->closure_var_count; i++) {
+    b1->closure_var[i].is_local = b->closure_var[i].is_local;
+    b1->closure_var[i].var_idx = b->closure_var[i].var_idx;
+  }
+  b->cpool[0] = func_obj;
+
+  free_token(s, &s->token);
+  js_free_function_def(ctx, fd);
+  JS_FreeCString(ctx, filename);
+  return 0;
+fail:
+  free_token(s, &s->token);
+  js_free_function_def(ctx, fd);
+fail1:
+  JS_FreeCString(ctx, filename);
+  return -1;
+}
@@ -178,6 +178,7 @@ typedef struct JumpSlot {
   int size;
   int pos;
   int label;
+  int fuse_op; /* if non zero, superinstruction replacing the comparison before the jump */
 } JumpSlot;
 
 typedef struct LabelSlot {
@@ -248,6 +249,12 @@ typedef struct JSFunctionDef {
   BOOL is_derived_class_constructor;
   BOOL in_function_body;
   BOOL backtrace_barrier;
+  BOOL allow_lazy;                /* true if the child functions may be
+                                     compiled on their first call */
+  BOOL is_paren_func_expr;        /* function expression following or
+                                     followed by '(', or passed as a call
+                                     argument (possibly in an array): most
+                                     likely called soon */
   JSFunctionKindEnum func_kind : 8;
   JSParseFunctionEnum func_type : 8;
   uint8_t js_mode;  /* bitmap of JS_MODE_x */
@@ -383,6 +390,9 @@ typedef struct JSParseState {
   BOOL is_module; /* parsing a module */
   BOOL allow_html_comments;
   BOOL ext_json; /* true if accepting JSON superset */
+  /* start of the call argument, or of the element of an array passed as
+     call argument, being parsed */
+  const uint8_t *call_arg_ptr;
 } JSParseState;
 
 typedef struct JSOpCode {
@@ -434,6 +444,8 @@ JSValue js_module_ns_autoinit(JSContext* ctx, JSObject* p, JSAtom atom, void* op
 void js_free_module_def(JSContext* ctx, JSModuleDef* m);
 JSValue js_import_meta(JSContext* ctx);
 
+int js_compile_lazy_function(JSContext* ctx, JSFunctionBytecode* b);
+
 /* 'input' must be zero terminated i.e. input[input_len] = '\0'. */
 JSValue __JS_EvalInternal(JSContext *ctx, JSValueConst this_obj,
                                  const char *input, size_t input_len,
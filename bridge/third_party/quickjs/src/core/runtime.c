@@ -27,6 +27,7 @@
 #include "runtime.h"
 #include "builtins/js-array.h"
 #include "builtins/js-function.h"
+#include "builtins/js-json.h"
 #include "builtins/js-object.h"
 #include "builtins/js-proxy.h"
 #include "builtins/js-string.h"
@@ -385,6 +386,7 @@ JSValueConst JS_GetPrototypePrimitive(JSContext* ctx, JSValueConst val) {
       val = ctx->class_proto[JS_CLASS_BOOLEAN];
       break;
     case JS_TAG_STRING:
+    case JS_TAG_STRING_ROPE:
       val = ctx->class_proto[JS_CLASS_STRING];
       break;
     case JS_TAG_SYMBOL:
@@ -435,7 +437,7 @@ JSValue JS_GetGlobalVar(JSContext* ctx, JSAtom prop, BOOL throw_ref_error) {
       return JS_ThrowReferenceErrorUninitialized(ctx, prs->atom);
     return JS_DupValue(ctx, pr->u.value);
   }
-  return JS_GetPropertyInternal(ctx, ctx->global_obj, prop, ctx->global_obj, NULL, throw_ref_error);
+  return js_get_property_internal(ctx, ctx->global_obj, prop, ctx->global_obj, NULL, throw_ref_error);
 }
 
 /* construct a reference to a global variable */
@@ -778,8 +780,10 @@ int set_array_length(JSContext *ctx, JSObject *p, JSValue val,
   if (likely(p->fast_array)) {
     uint32_t old_len = p->u.array.count;
     if (len < old_len) {
-      for(i = len; i < old_len; i++) {
-        JS_FreeValue(ctx, p->u.array.u.values[i]);
+      if (p->u.array.kind == JS_ARRAY_KIND_VALUE) {
+        for(i = len; i < old_len; i++) {
+          JS_FreeValue(ctx, p->u.array.u.values[i]);
+        }
       }
       p->u.array.count = len;
     }
@@ -863,6 +867,7 @@ uint32_t typed_array_get_length(JSContext* ctx, JSObject* p) {
    TRUE and p->extensible = TRUE */
 int add_fast_array_element(JSContext* ctx, JSObject* p, JSValue val, int flags) {
   uint32_t new_len, array_len;
+  JSArrayKindEnum kind;
   /* extend the array by one */
   /* XXX: convert to slow array if new_len > 2^31-1 elements */
   new_len = p->u.array.count + 1;
@@ -878,13 +883,20 @@ int add_fast_array_element(JSContext* ctx, JSObject* p, JSValue val, int flags)
       p->prop[0].u.value = JS_NewInt32(ctx, new_len);
     }
   }
+  kind = js_array_value_kind(val);
+  if (unlikely(kind > p->u.array.kind)) {
+    if (js_array_widen(ctx, p, kind)) {
+      JS_FreeValue(ctx, val);
+      return -1;
+    }
+  }
   if (unlikely(new_len > p->u.array.u1.size)) {
     if (expand_fast_array(ctx, p, new_len)) {
       JS_FreeValue(ctx, val);
       return -1;
     }
   }
-  p->u.array.u.values[new_len - 1] = val;
+  js_fast_array_init(p, new_len - 1, val);
   p->u.array.count = new_len;
   return TRUE;
 }
@@ -948,6 +960,9 @@ int JS_CreateProperty(JSContext* ctx, JSObject* p, JSAtom prop, JSValueConst val
       const JSClassExoticMethods* em = ctx->rt->class_array[p->class_id].exotic;
       if (em) {
         if (em->define_own_property) {
+          /* the exotic methods only see flat strings */
+          if (js_flatten_string_const(ctx, &val))
+            return -1;
           return em->define_own_property(ctx, JS_MKPTR(JS_TAG_OBJECT, p), prop, val, getter, setter, flags);
         }
         ret = JS_IsExtensible(ctx, JS_MKPTR(JS_TAG_OBJECT, p));
@@ -1119,7 +1134,7 @@ const char* get_func_name(JSContext* ctx, JSValueConst func) {
   if ((prs->flags & JS_PROP_TMASK) != JS_PROP_NORMAL)
     return NULL;
   val = pr->u.value;
-  if (JS_VALUE_GET_TAG(val) != JS_TAG_STRING)
+  if (JS_VALUE_GET_TAG(val) != JS_TAG_STRING && JS_VALUE_GET_TAG(val) != JS_TAG_STRING_ROPE)
     return NULL;
   return JS_ToCString(ctx, val);
 }
@@ -2593,7 +2608,10 @@ void JS_FreeRuntime(JSRuntime* rt) {
   }
   init_list_head(&rt->job_list);
 
+  js_free_json_stringify_cache(rt);
+
   JS_RunGC(rt);
+  free_ic_stub_cache(rt);
 
 #ifdef DUMP_LEAKS
   /* leaking objects */
@@ -3099,7 +3117,7 @@ JSValue JS_EvalObject(JSContext* ctx, JSValueConst this_obj, JSValueConst val, i
   const char* str;
   size_t len;
 
-  if (!JS_IsString(val))
+  if (JS_VALUE_GET_TAG(val) != JS_TAG_STRING && JS_VALUE_GET_TAG(val) != JS_TAG_STRING_ROPE)
     return JS_DupValue(ctx, val);
   str = JS_ToCStringLen(ctx, &len, val);
   if (!str)
@@ -3115,7 +3133,7 @@ JSValue JS_EvalThis(JSContext* ctx, JSValueConst this_obj, const char* input, si
 
   assert(eval_type == JS_EVAL_TYPE_GLOBAL || eval_type == JS_EVAL_TYPE_MODULE);
   ret = JS_EvalInternal(ctx, this_obj, input, input_len, filename, eval_flags, -1);
-  return ret;
+  return js_flatten_string_value(ctx, ret);
 }
 
 JSValue JS_Eval(JSContext* ctx, const char* input, size_t input_len, const char* filename, int eval_flags) {
@@ -3154,5 +3172,5 @@ JSValue JS_EvalFunctionInternal(JSContext* ctx, JSValue fun_obj, JSValueConst th
 }
 
 JSValue JS_EvalFunction(JSContext* ctx, JSValue fun_obj) {
-  return JS_EvalFunctionInternal(ctx, fun_obj, ctx->global_obj, NULL, NULL);
+  return js_flatten_string_value(ctx, JS_EvalFunctionInternal(ctx, fun_obj, ctx->global_obj, NULL, NULL));
 }
\ No newline at end of file
@@ -496,6 +496,7 @@ JSValue JS_NewObjectFromShape(JSContext* ctx, JSShape* sh, JSClassID class_id) {
       p->u.array.u.values = NULL;
       p->u.array.count = 0;
       p->u.array.u1.size = 0;
+      p->u.array.kind = JS_ARRAY_KIND_INT32;
       /* the length property is always the first one */
       if (likely(sh == ctx->array_shape)) {
         pr = &p->prop[0];
@@ -510,6 +511,8 @@ JSValue JS_NewObjectFromShape(JSContext* ctx, JSShape* sh, JSClassID class_id) {
       p->prop[0].u.value = JS_UNDEFINED;
       break;
     case JS_CLASS_ARGUMENTS:
+      p->u.array.kind = JS_ARRAY_KIND_VALUE;
+      /* fall thru */
     case JS_CLASS_UINT8C_ARRAY:
     case JS_CLASS_INT8_ARRAY:
     case JS_CLASS_UINT8_ARRAY:
@@ -582,6 +585,18 @@ int js_shape_prepare_update(JSContext* ctx, JSObject* p, JSShapeProperty** pprs)
       js_shape_hash_unlink(ctx->rt, sh);
       sh->is_hashed = FALSE;
     }
+  } else if (sh->header.ref_count != 1) {
+    /* the shape of a prototype is also held by the inline caches
+       validating their entries with it */
+    if (pprs)
+      idx = *pprs - get_shape_prop(sh);
+    sh = js_clone_shape(ctx, sh);
+    if (!sh)
+      return -1;
+    js_free_shape(ctx->rt, p->shape);
+    p->shape = sh;
+    if (pprs)
+      *pprs = get_shape_prop(sh) + idx;
   }
   return 0;
 }
\ No newline at end of file
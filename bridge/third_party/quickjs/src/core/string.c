@@ -27,6 +27,7 @@
 #include "convertion.h"
 #include "exception.h"
 #include "quickjs/cutils.h"
+#include "quickjs/libstring.h"
 #include "quickjs/list.h"
 
 /* Note: the string contents are uninitialized */
@@ -1236,6 +1237,16 @@ int string_buffer_concat_value(StringBuffer* s, JSValueConst v) {
     /* prevent exception overload */
     return -1;
   }
+  if (JS_VALUE_GET_TAG(v) == JS_TAG_STRING_ROPE) {
+    /* copy the leaves without flattening the rope */
+    JSStringRopeIter it;
+    js_string_rope_iter_init(&it, v);
+    while ((p = js_string_rope_iter_next(&it)) != NULL) {
+      if (string_buffer_concat(s, p, 0, p->len))
+        return -1;
+    }
+    return 0;
+  }
   if (unlikely(JS_VALUE_GET_TAG(v) != JS_TAG_STRING)) {
     v1 = JS_ToString(s->ctx, v);
     if (JS_IsException(v1))
@@ -1258,6 +1269,11 @@ int string_buffer_concat_value_free(StringBuffer* s, JSValue v) {
     JS_FreeValue(s->ctx, v);
     return -1;
   }
+  if (JS_VALUE_GET_TAG(v) == JS_TAG_STRING_ROPE) {
+    res = string_buffer_concat_value(s, v);
+    JS_FreeValue(s->ctx, v);
+    return res;
+  }
   if (unlikely(JS_VALUE_GET_TAG(v) != JS_TAG_STRING)) {
     v = JS_ToStringFree(s->ctx, v);
     if (JS_IsException(v))
@@ -1353,11 +1369,7 @@ JSValue js_sub_string(JSContext* ctx, JSString* p, int start, int end) {
   if (p->is_wide_char && len > 0) {
     JSString* str;
     int i;
-    uint16_t c = 0;
-    for (i = start; i < end; i++) {
-      c |= p->u.str16[i];
-    }
-    if (c > 0xFF)
+    if (!lstr_is_latin1_16(p->u.str16 + start, len))
       return js_new_string16(ctx, p->u.str16 + start, len);
 
     str = js_alloc_string(ctx, len, 0);
@@ -1583,26 +1595,323 @@ void JS_FreeCString(JSContext* ctx, const char* ptr) {
   JS_FreeValue(ctx, JS_MKPTR(JS_TAG_STRING, p));
 }
 
+/* String ropes */
+
+static inline int js_string_value_depth(JSValueConst v) {
+  if (JS_VALUE_GET_TAG(v) == JS_TAG_STRING_ROPE)
+    return JS_VALUE_GET_STRING_ROPE(v)->depth;
+  return 0;
+}
+
+/* 'left' and 'right' are freed */
+static JSValue js_new_string_rope(JSContext* ctx, JSValue left, JSValue right) {
+  JSStringRope* r;
+
+  r = js_malloc(ctx, sizeof(*r));
+  if (unlikely(!r)) {
+    JS_FreeValue(ctx, left);
+    JS_FreeValue(ctx, right);
+    return JS_EXCEPTION;
+  }
+  r->header.ref_count = 1;
+  r->len = JS_VALUE_GET_STRING(left)->len + JS_VALUE_GET_STRING(right)->len;
+  r->is_wide_char = JS_VALUE_GET_STRING(left)->is_wide_char | JS_VALUE_GET_STRING(right)->is_wide_char;
+  r->depth = max_int(js_string_value_depth(left), js_string_value_depth(right)) + 1;
+  r->left = left;
+  r->right = right;
+  return JS_MKPTR(JS_TAG_STRING_ROPE, r);
+}
+
+/* Called when the reference count of 'r' drops to zero. The recursion
+   is bounded by JS_STRING_ROPE_MAX_DEPTH. */
+void js_free_string_rope(JSRuntime* rt, JSStringRope* r) {
+  JS_FreeValueRT(rt, r->left);
+  JS_FreeValueRT(rt, r->right);
+  js_free_rt(rt, r);
+}
+
+void js_string_rope_iter_init(JSStringRopeIter* it, JSValueConst val) {
+  it->stack[0] = val;
+  it->stack_len = 1;
+}
+
+/* Return the next flat string of the rope from left to right, or NULL
+   at the end */
+JSString* js_string_rope_iter_next(JSStringRopeIter* it) {
+  JSValueConst val;
+  JSStringRope* r;
+
+  if (it->stack_len == 0)
+    return NULL;
+  val = it->stack[--it->stack_len];
+  while (JS_VALUE_GET_TAG(val) == JS_TAG_STRING_ROPE) {
+    r = JS_VALUE_GET_STRING_ROPE(val);
+    if (!JS_IsNull(r->right))
+      it->stack[it->stack_len++] = r->right;
+    val = r->left;
+  }
+  return JS_VALUE_GET_STRING(val);
+}
+
+/* Copy the characters of the rope into a flat string the first time
+   they are needed and keep it in the rope instead of its children.
+   Return the flat string, which is owned by the rope, or NULL in case
+   of exception. */
+JSString* js_flatten_string_rope(JSContext* ctx, JSValueConst val) {
+  JSStringRope* r = JS_VALUE_GET_STRING_ROPE(val);
+  JSStringRopeIter it;
+  JSString *p, *p1;
+  uint32_t pos;
+
+  if (JS_IsNull(r->right))
+    return JS_VALUE_GET_STRING(r->left);
+  p = js_alloc_string(ctx, r->len, r->is_wide_char);
+  if (!p)
+    return NULL;
+  pos = 0;
+  js_string_rope_iter_init(&it, val);
+  while ((p1 = js_string_rope_iter_next(&it)) != NULL) {
+    if (p->is_wide_char)
+      copy_str16(p->u.str16 + pos, p1, 0, p1->len);
+    else
+      memcpy(p->u.str8 + pos, p1->u.str8, p1->len);
+    pos += p1->len;
+  }
+  if (!p->is_wide_char)
+    p->u.str8[pos] = '\0';
+  JS_FreeValue(ctx, r->left);
+  JS_FreeValue(ctx, r->right);
+  r->left = JS_MKPTR(JS_TAG_STRING, p);
+  r->right = JS_NULL;
+  r->depth = 0;
+  return p;
+}
+
+/* 'val' is a string rope and is freed */
+JSValue __js_flatten_string_value(JSContext* ctx, JSValue val) {
+  JSString* p;
+
+  p = js_flatten_string_rope(ctx, val);
+  if (p)
+    JS_DupValue(ctx, JS_MKPTR(JS_TAG_STRING, p));
+  JS_FreeValue(ctx, val);
+  if (!p)
+    return JS_EXCEPTION;
+  return JS_MKPTR(JS_TAG_STRING, p);
+}
+
+/* Compare two strings or string ropes without flattening them. Return
+   < 0, 0 or > 0 */
+int js_string_rope_compare(JSValueConst op1, JSValueConst op2) {
+  JSStringRopeIter it1, it2;
+  const JSString *p1, *p2;
+  uint32_t len1, len2, pos1, pos2, n;
+  int res;
+
+  len1 = JS_VALUE_GET_STRING(op1)->len;
+  len2 = JS_VALUE_GET_STRING(op2)->len;
+  js_string_rope_iter_init(&it1, op1);
+  js_string_rope_iter_init(&it2, op2);
+  p1 = js_string_rope_iter_next(&it1);
+  p2 = js_string_rope_iter_next(&it2);
+  pos1 = pos2 = 0;
+  while (p1 && p2) {
+    n = min_uint32(p1->len - pos1, p2->len - pos2);
+    if (p1->is_wide_char) {
+      if (p2->is_wide_char)
+        res = memcmp16(p1->u.str16 + pos1, p2->u.str16 + pos2, n);
+      else
+        res = memcmp16_8(p1->u.str16 + pos1, p2->u.str8 + pos2, n);
+    } else {
+      if (p2->is_wide_char)
+        res = -memcmp16_8(p2->u.str16 + pos2, p1->u.str8 + pos1, n);
+      else
+        res = memcmp(p1->u.str8 + pos1, p2->u.str8 + pos2, n);
+    }
+    if (res != 0)
+      return res;
+    pos1 += n;
+    pos2 += n;
+    if (pos1 == p1->len) {
+      p1 = js_string_rope_iter_next(&it1);
+      pos1 = 0;
+    }
+    if (pos2 == p2->len) {
+      p2 = js_string_rope_iter_next(&it2);
+      pos2 = 0;
+    }
+  }
+  if (len1 == len2)
+    return 0;
+  return len1 < len2 ? -1 : 1;
+}
+
+/* Concatenate two short flat strings into a rope leaf, which keeps room
+   to be appended to in place */
+static JSValue js_new_string_rope_leaf(JSContext* ctx, const JSString* p1, const JSString* p2) {
+  JSString* p;
+  uint32_t len;
+  int is_wide_char;
+
+  len = p1->len + p2->len;
+  is_wide_char = p1->is_wide_char | p2->is_wide_char;
+  p = js_alloc_string(ctx, JS_STRING_ROPE_SHORT_LEN, is_wide_char);
+  if (!p)
+    return JS_EXCEPTION;
+  if (!is_wide_char) {
+    memcpy(p->u.str8, p1->u.str8, p1->len);
+    memcpy(p->u.str8 + p1->len, p2->u.str8, p2->len);
+    p->u.str8[len] = '\0';
+  } else {
+    copy_str16(p->u.str16, p1, 0, p1->len);
+    copy_str16(p->u.str16 + p1->len, p2, 0, p2->len);
+  }
+  p->len = len;
+  return JS_MKPTR(JS_TAG_STRING, p);
+}
+
+/* op1 and op2 are strings or string ropes and are freed. The rope is
+   kept balanced by concatenating to its last (resp. first) child while
+   that child is shallower than the other one, which makes repeated
+   appends (resp. prepends) build a complete binary tree of leaves of
+   about JS_STRING_ROPE_SHORT_LEN characters. */
+static JSValue js_concat_string_rope(JSContext* ctx, JSValue op1, JSValue op2) {
+  JSStringRope* r;
+  JSString *p1, *p2;
+  JSValue ret, child;
+  uint32_t len1, len2;
+
+  /* a flattened rope is replaced by its flat string */
+  if (JS_VALUE_GET_TAG(op1) == JS_TAG_STRING_ROPE && JS_IsNull(JS_VALUE_GET_STRING_ROPE(op1)->right)) {
+    ret = JS_DupValue(ctx, JS_VALUE_GET_STRING_ROPE(op1)->left);
+    JS_FreeValue(ctx, op1);
+    op1 = ret;
+  }
+  if (JS_VALUE_GET_TAG(op2) == JS_TAG_STRING_ROPE && JS_IsNull(JS_VALUE_GET_STRING_ROPE(op2)->right)) {
+    ret = JS_DupValue(ctx, JS_VALUE_GET_STRING_ROPE(op2)->left);
+    JS_FreeValue(ctx, op2);
+    op2 = ret;
+  }
+  len1 = JS_VALUE_GET_STRING(op1)->len;
+  len2 = JS_VALUE_GET_STRING(op2)->len;
+  if (len2 == 0) {
+    JS_FreeValue(ctx, op2);
+    return op1;
+  }
+  if (len1 == 0) {
+    JS_FreeValue(ctx, op1);
+    return op2;
+  }
+  if (len1 + len2 > JS_STRING_LEN_MAX) {
+    JS_FreeValue(ctx, op1);
+    JS_FreeValue(ctx, op2);
+    return JS_ThrowInternalError(ctx, "string too long");
+  }
+
+  if (JS_VALUE_GET_TAG(op1) == JS_TAG_STRING && JS_VALUE_GET_TAG(op2) == JS_TAG_STRING) {
+    if (len1 + len2 < JS_STRING_ROPE_SHORT_LEN) {
+      p1 = JS_VALUE_GET_STRING(op1);
+      p2 = JS_VALUE_GET_STRING(op2);
+      ret = js_new_string_rope_leaf(ctx, p1, p2);
+      JS_FreeValue(ctx, op1);
+      JS_FreeValue(ctx, op2);
+      return ret;
+    }
+  } else if (JS_VALUE_GET_TAG(op1) == JS_TAG_STRING_ROPE &&
+             max_int(js_string_value_depth(JS_VALUE_GET_STRING_ROPE(op1)->right), js_string_value_depth(op2)) <
+                 js_string_value_depth(JS_VALUE_GET_STRING_ROPE(op1)->left)) {
+    r = JS_VALUE_GET_STRING_ROPE(op1);
+    child = js_concat_string_rope(ctx, JS_DupValue(ctx, r->right), op2);
+    if (JS_IsException(child)) {
+      JS_FreeValue(ctx, op1);
+      return JS_EXCEPTION;
+    }
+    ret = js_new_string_rope(ctx, JS_DupValue(ctx, r->left), child);
+    JS_FreeValue(ctx, op1);
+    return ret;
+  } else if (JS_VALUE_GET_TAG(op2) == JS_TAG_STRING_ROPE &&
+             max_int(js_string_value_depth(JS_VALUE_GET_STRING_ROPE(op2)->left), js_string_value_depth(op1)) <
+                 js_string_value_depth(JS_VALUE_GET_STRING_ROPE(op2)->right)) {
+    r = JS_VALUE_GET_STRING_ROPE(op2);
+    child = js_concat_string_rope(ctx, op1, JS_DupValue(ctx, r->left));
+    if (JS_IsException(child)) {
+      JS_FreeValue(ctx, op2);
+      return JS_EXCEPTION;
+    }
+    ret = js_new_string_rope(ctx, child, JS_DupValue(ctx, r->right));
+    JS_FreeValue(ctx, op2);
+    return ret;
+  }
+  ret = js_new_string_rope(ctx, op1, op2);
+  if (!JS_IsException(ret) && JS_VALUE_GET_STRING_ROPE(ret)->depth > JS_STRING_ROPE_MAX_DEPTH)
+    ret = js_flatten_string_value(ctx, ret);
+  return ret;
+}
+
+/* Append 'op2' to 'op1' without allocating memory when 'op1' has no
+   other reference and its last flat string has room for it. Return
+   TRUE if done. Nothing is freed. */
+BOOL js_concat_string_in_place(JSContext* ctx, JSValueConst op1, JSValueConst op2) {
+  JSValueConst val;
+  JSString *p1, *p2;
+  JSStringRope* r;
+
+  if (JS_VALUE_GET_TAG(op2) != JS_TAG_STRING)
+    return FALSE;
+  p2 = JS_VALUE_GET_STRING(op2);
+  if (JS_VALUE_GET_STRING(op1)->len + p2->len > JS_STRING_LEN_MAX)
+    return FALSE;
+  val = op1;
+  while (JS_VALUE_GET_TAG(val) == JS_TAG_STRING_ROPE) {
+    r = JS_VALUE_GET_STRING_ROPE(val);
+    if (r->header.ref_count != 1 || JS_IsNull(r->right))
+      return FALSE;
+    val = r->right;
+  }
+  if (JS_VALUE_GET_TAG(val) != JS_TAG_STRING)
+    return FALSE;
+  p1 = JS_VALUE_GET_STRING(val);
+  if (p1->header.ref_count != 1 || p1->atom_type || p1->is_wide_char != p2->is_wide_char ||
+      js_malloc_usable_size(ctx, p1) < sizeof(*p1) + ((p1->len + p2->len) << p2->is_wide_char) + 1 - p1->is_wide_char)
+    return FALSE;
+  if (p1->is_wide_char) {
+    memcpy(p1->u.str16 + p1->len, p2->u.str16, p2->len << 1);
+    p1->len += p2->len;
+  } else {
+    memcpy(p1->u.str8 + p1->len, p2->u.str8, p2->len);
+    p1->len += p2->len;
+    p1->u.str8[p1->len] = '\0';
+  }
+  for (val = op1; JS_VALUE_GET_TAG(val) == JS_TAG_STRING_ROPE; val = r->right) {
+    r = JS_VALUE_GET_STRING_ROPE(val);
+    r->len += p2->len;
+  }
+  return TRUE;
+}
+
 /* op1 and op2 are converted to strings. For convience, op1 or op2 =
-   JS_EXCEPTION are accepted and return JS_EXCEPTION.  */
+   JS_EXCEPTION are accepted and return JS_EXCEPTION. Long results are
+   string ropes. */
 JSValue JS_ConcatString(JSContext* ctx, JSValue op1, JSValue op2) {
   JSValue ret;
   JSString *p1, *p2;
 
-  if (unlikely(JS_VALUE_GET_TAG(op1) != JS_TAG_STRING)) {
+  if (unlikely(JS_VALUE_GET_TAG(op1) != JS_TAG_STRING && JS_VALUE_GET_TAG(op1) != JS_TAG_STRING_ROPE)) {
     op1 = JS_ToStringFree(ctx, op1);
     if (JS_IsException(op1)) {
       JS_FreeValue(ctx, op2);
       return JS_EXCEPTION;
     }
   }
-  if (unlikely(JS_VALUE_GET_TAG(op2) != JS_TAG_STRING)) {
+  if (unlikely(JS_VALUE_GET_TAG(op2) != JS_TAG_STRING && JS_VALUE_GET_TAG(op2) != JS_TAG_STRING_ROPE)) {
     op2 = JS_ToStringFree(ctx, op2);
     if (JS_IsException(op2)) {
       JS_FreeValue(ctx, op1);
       return JS_EXCEPTION;
     }
   }
+  if (JS_VALUE_GET_TAG(op1) == JS_TAG_STRING_ROPE || JS_VALUE_GET_TAG(op2) == JS_TAG_STRING_ROPE)
+    return js_concat_string_rope(ctx, op1, op2);
   p1 = JS_VALUE_GET_STRING(op1);
   p2 = JS_VALUE_GET_STRING(op2);
 
@@ -1624,8 +1933,10 @@ JSValue JS_ConcatString(JSContext* ctx, JSValue op1, JSValue op2) {
     JS_FreeValue(ctx, op2);
     return op1;
   }
+  if (p1->len + p2->len >= JS_STRING_ROPE_SHORT_LEN)
+    return js_concat_string_rope(ctx, op1, op2);
   ret = JS_ConcatString1(ctx, p1, p2);
   JS_FreeValue(ctx, op1);
   JS_FreeValue(ctx, op2);
   return ret;
-}
\ No newline at end of file
+}
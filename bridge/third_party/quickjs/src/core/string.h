@@ -233,6 +233,43 @@ JSValue JS_ConcatString3(JSContext* ctx, const char* str1, JSValue str2, const c
    JS_EXCEPTION are accepted and return JS_EXCEPTION.  */
 JSValue JS_ConcatString(JSContext* ctx, JSValue op1, JSValue op2);
 
+/* Iterate over the flat strings of a string rope */
+typedef struct JSStringRopeIter {
+  JSValueConst stack[JS_STRING_ROPE_MAX_DEPTH + 1];
+  int stack_len;
+} JSStringRopeIter;
+
+void js_free_string_rope(JSRuntime* rt, JSStringRope* r);
+void js_string_rope_iter_init(JSStringRopeIter* it, JSValueConst val);
+JSString* js_string_rope_iter_next(JSStringRopeIter* it);
+/* Return the flat string held by the rope 'val' (not duplicated), or
+   NULL in case of exception */
+JSString* js_flatten_string_rope(JSContext* ctx, JSValueConst val);
+JSValue __js_flatten_string_value(JSContext* ctx, JSValue val);
+/* Return the flat string of a string rope, or 'val' itself for any
+   other value ('val' is freed) */
+static inline JSValue js_flatten_string_value(JSContext* ctx, JSValue val) {
+  if (likely(JS_VALUE_GET_TAG(val) != JS_TAG_STRING_ROPE))
+    return val;
+  return __js_flatten_string_value(ctx, val);
+}
+/* Replace the string rope '*pval' by its flat string, which stays owned
+   by the rope. Return -1 in case of exception */
+static inline int js_flatten_string_const(JSContext* ctx, JSValueConst* pval) {
+  JSString* p;
+
+  if (likely(JS_VALUE_GET_TAG(*pval) != JS_TAG_STRING_ROPE))
+    return 0;
+  p = js_flatten_string_rope(ctx, *pval);
+  if (!p)
+    return -1;
+  *pval = JS_MKPTR(JS_TAG_STRING, p);
+  return 0;
+}
+/* return < 0, 0 or > 0 */
+int js_string_rope_compare(JSValueConst op1, JSValueConst op2);
+BOOL js_concat_string_in_place(JSContext* ctx, JSValueConst op1, JSValueConst op2);
+
 /* return a string atom containing name concatenated with str1 */
 JSAtom js_atom_concat_str(JSContext* ctx, JSAtom name, const char* str1);
 JSAtom js_atom_concat_num(JSContext* ctx, JSAtom name, uint32_t n);
@@ -127,12 +127,17 @@ typedef enum JSErrorEnum {
 #define JS_MAX_LOCAL_VARS 65536
 #define JS_STACK_SIZE_MAX 65534
 #define JS_STRING_LEN_MAX ((1 << 30) - 1)
+/* concatenations shorter than this are copied into a flat string */
+#define JS_STRING_ROPE_SHORT_LEN 256
+/* deeper ropes are flattened */
+#define JS_STRING_ROPE_MAX_DEPTH 48
 
 #define __exception __attribute__((warn_unused_result))
 
 typedef struct JSShape JSShape;
 typedef struct JSString JSString;
 typedef struct JSString JSAtomStruct;
+typedef struct JSStringRope JSStringRope;
 
 typedef enum {
     JS_GC_PHASE_NONE,
@@ -228,6 +233,10 @@ struct JSRuntime {
     int shape_hash_size;
     int shape_hash_count; /* number of hashed shapes */
     JSShape **shape_hash;
+    /* shape layouts and output buffer reused by JSON.stringify */
+    struct JSONStringifyCache *json_stringify_cache;
+    /* inline cache entries of the megamorphic sites, flushed by the GC */
+    struct InlineCacheStubEntry *ic_stub_cache;
 #ifdef CONFIG_BIGNUM
     bf_context_t bf_ctx;
     JSNumericOperations bigint_ops;
@@ -441,6 +450,25 @@ struct JSString {
     } u;
 };
 
+/* Concatenation of two strings which is only copied into a flat string
+   when its characters are needed. The first fields are laid out as in
+   JSString. */
+struct JSStringRope {
+    JSRefCountHeader header; /* must come first, 32-bit */
+    uint32_t len : 31;
+    uint8_t is_wide_char : 1;
+    uint8_t depth; /* 0 once flattened */
+    JSValue left; /* JS_TAG_STRING or JS_TAG_STRING_ROPE */
+    JSValue right; /* JS_NULL once flattened: 'left' is then the flat string */
+};
+
+/* Tag of the string ropes, next to the public JS_TAG_STRING. Ropes never
+   leave the engine: the public API hands out their flat string instead,
+   so JS_TAG_STRING is the only string tag the embedder sees. */
+#define JS_TAG_STRING_ROPE (-6)
+
+#define JS_VALUE_GET_STRING_ROPE(v) ((JSStringRope *)JS_VALUE_GET_PTR(v))
+
 typedef struct JSClosureVar {
     uint8_t is_local : 1;
     uint8_t is_arg : 1;
@@ -516,6 +544,8 @@ typedef struct JSVarDef {
 #define PC2COLUMN_OP_FIRST 1
 #define PC2COLUMN_DIFF_PC_MAX ((255 - PC2COLUMN_OP_FIRST) / PC2COLUMN_RANGE)
 #define IC_CACHE_ITEM_CAPACITY 8
+#define IC_PROTO_DEPTH_MAX 8
+#define IC_STUB_CACHE_BITS 10
 
 typedef enum JSFunctionKindEnum {
     JS_FUNC_NORMAL = 0,
@@ -525,16 +555,32 @@ typedef enum JSFunctionKindEnum {
 } JSFunctionKindEnum;
 
 typedef struct InlineCacheRingItem {
-    JSShape* shape;
-    uint32_t prop_offset;
+    JSShape* shape; /* shape of the receiver */
+    uint32_t prop_offset; /* offset of the property in the object holding it */
+    uint8_t prop_flags; /* JS_PROP_xxx flags of the property */
+    uint8_t proto_depth; /* 0 if the receiver holds the property */
+    /* shapes of the prototypes up to the one holding the property, the
+       entry is valid as long as every prototype still has its shape */
+    JSShape** proto_shapes;
 } InlineCacheRingItem;
 
 typedef struct InlineCacheRingSlot {
     JSAtom atom;
     InlineCacheRingItem buffer[IC_CACHE_ITEM_CAPACITY];
     uint8_t index;
+    /* more shapes than the ring can hold were seen: the entries that do
+       not fit are kept in the runtime stub cache */
+    uint8_t megamorphic;
+    uint32_t hits;
+    uint32_t misses;
 } InlineCacheRingSlot;
 
+/* entry of the per runtime cache shared by the megamorphic sites */
+typedef struct InlineCacheStubEntry {
+    JSAtom atom;
+    InlineCacheRingItem item;
+} InlineCacheStubEntry;
+
 typedef struct InlineCacheHashSlot {
     JSAtom atom;
     uint32_t index;
@@ -568,7 +614,11 @@ typedef struct JSFunctionBytecode {
     uint8_t has_debug : 1;
     uint8_t backtrace_barrier : 1; /* stop backtrace on this function */
     uint8_t read_only_bytecode : 1;
-    /* XXX: 4 bits available */
+    /* true if the bytecode is generated on the first call and stored in
+       cpool[0] (see js_compile_lazy_function()) */
+    uint8_t is_lazy : 1;
+    uint8_t is_func_expr : 1; /* only used by lazy functions */
+    /* XXX: 2 bits available */
     uint8_t *byte_code_buf; /* (self pointer) */
     int byte_code_len;
     JSAtom func_name;
@@ -837,6 +887,16 @@ struct JSShape {
     JSShapeProperty prop[0]; /* prop_size elements */
 };
 
+/* Storage of the elements of a fast array. An Array stores its elements
+   as int32_t or double while they are all numbers of that kind, and
+   moves to a more general kind when another value is stored. The kind
+   never goes back. Arguments objects always use JS_ARRAY_KIND_VALUE. */
+typedef enum JSArrayKindEnum {
+    JS_ARRAY_KIND_INT32,   /* u.array.u.int32_ptr */
+    JS_ARRAY_KIND_FLOAT64, /* u.array.u.double_ptr */
+    JS_ARRAY_KIND_VALUE,   /* u.array.u.values */
+} JSArrayKindEnum;
+
 struct JSObject {
     union {
         JSGCObjectHeader header;
@@ -909,19 +969,20 @@ struct JSObject {
                 uint8_t *uint8_ptr;     /* JS_CLASS_UINT8_ARRAY, JS_CLASS_UINT8C_ARRAY */
                 int16_t *int16_ptr;     /* JS_CLASS_INT16_ARRAY */
                 uint16_t *uint16_ptr;   /* JS_CLASS_UINT16_ARRAY */
-                int32_t *int32_ptr;     /* JS_CLASS_INT32_ARRAY */
+                int32_t *int32_ptr;     /* JS_CLASS_INT32_ARRAY, JS_ARRAY_KIND_INT32 */
                 uint32_t *uint32_ptr;   /* JS_CLASS_UINT32_ARRAY */
                 int64_t *int64_ptr;     /* JS_CLASS_INT64_ARRAY */
                 uint64_t *uint64_ptr;   /* JS_CLASS_UINT64_ARRAY */
                 float *float_ptr;       /* JS_CLASS_FLOAT32_ARRAY */
-                double *double_ptr;     /* JS_CLASS_FLOAT64_ARRAY */
+                double *double_ptr;     /* JS_CLASS_FLOAT64_ARRAY, JS_ARRAY_KIND_FLOAT64 */
             } u;
             uint32_t count; /* <= 2^31-1. 0 for a detached typed array */
-        } array;    /* 12/20 bytes */
+            uint8_t kind; /* JS_CLASS_ARRAY, JS_CLASS_ARGUMENTS: JSArrayKindEnum */
+        } array;    /* 13/21 bytes */
         JSRegExp regexp;    /* JS_CLASS_REGEXP: 8/16 bytes */
         JSValue object_data;    /* for JS_SetObjectData(): 8/16/16 bytes */
     } u;
-    /* byte sizes: 40/48/72 */
+    /* byte sizes: 44/48/72 */
 };
 
 typedef enum OPCodeFormat {
@@ -0,0 +1,458 @@
+/*
+ * String search and scan kernels on 8-bit and 16-bit character buffers,
+ * vectorized with SSE2 or NEON when available
+ *
+ * Copyright (c) 2022-present The WebF authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "quickjs/cutils.h"
+#include "quickjs/libstring.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define LSTR_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LSTR_NEON
+#endif
+
+/* A block is 16 bytes: 16 characters of an 8-bit string or 8 characters of
+   a 16-bit string. The comparisons return a mask holding one bit per
+   matching character, at position (index << LSTR_SHIFTn). */
+#if defined(LSTR_SSE2)
+
+#define LSTR_SIMD
+#define LSTR_SHIFT8  0
+#define LSTR_SHIFT16 1
+
+typedef __m128i lstr_vec;
+
+static inline lstr_vec lstr_splat8(int c)
+{
+    return _mm_set1_epi8((char)c);
+}
+
+static inline lstr_vec lstr_splat16(int c)
+{
+    return _mm_set1_epi16((short)c);
+}
+
+static inline lstr_vec lstr_load(const void *p)
+{
+    return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline uint64_t lstr_eq8(lstr_vec a, lstr_vec b)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+}
+
+static inline uint64_t lstr_eq16(lstr_vec a, lstr_vec b)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(a, b)) & 0x5555;
+}
+
+/* mask of the characters in [0x09, 0x0d] or equal to 0x20 */
+static inline uint64_t lstr_ascii_space8(lstr_vec a)
+{
+    lstr_vec t = _mm_subs_epu8(_mm_sub_epi8(a, _mm_set1_epi8(0x09)),
+                               _mm_set1_epi8(0x0d - 0x09));
+    return _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(t, _mm_setzero_si128()),
+                                          _mm_cmpeq_epi8(a, _mm_set1_epi8(0x20))));
+}
+
+static inline uint64_t lstr_ascii_space16(lstr_vec a)
+{
+    lstr_vec t = _mm_subs_epu16(_mm_sub_epi16(a, _mm_set1_epi16(0x09)),
+                                _mm_set1_epi16(0x0d - 0x09));
+    return _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(t, _mm_setzero_si128()),
+                                          _mm_cmpeq_epi16(a, _mm_set1_epi16(0x20)))) & 0x5555;
+}
+
+#define LSTR_ALL8  0xffffULL
+#define LSTR_ALL16 0x5555ULL
+
+/* non zero if one of the characters is >= 0x100 */
+static inline int lstr_has_wide16(lstr_vec a)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, _mm_set1_epi16((short)0xff00)),
+                                            _mm_setzero_si128())) != 0xffff;
+}
+
+static inline lstr_vec lstr_or(lstr_vec a, lstr_vec b)
+{
+    return _mm_or_si128(a, b);
+}
+
+#elif defined(LSTR_NEON)
+
+#define LSTR_SIMD
+#define LSTR_SHIFT8  2
+#define LSTR_SHIFT16 3
+
+typedef uint8x16_t lstr_vec;
+
+static inline lstr_vec lstr_splat8(int c)
+{
+    return vdupq_n_u8((uint8_t)c);
+}
+
+static inline lstr_vec lstr_splat16(int c)
+{
+    return vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)c));
+}
+
+static inline lstr_vec lstr_load(const void *p)
+{
+    return vld1q_u8((const uint8_t *)p);
+}
+
+/* narrow a byte mask to 4 bits per byte */
+static inline uint64_t lstr_movemask(uint8x16_t m)
+{
+    uint8x8_t n = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(n), 0);
+}
+
+static inline uint64_t lstr_eq8(lstr_vec a, lstr_vec b)
+{
+    return lstr_movemask(vceqq_u8(a, b)) & 0x1111111111111111ULL;
+}
+
+static inline uint64_t lstr_eq16(lstr_vec a, lstr_vec b)
+{
+    uint16x8_t m = vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b));
+    return lstr_movemask(vreinterpretq_u8_u16(m)) & 0x0101010101010101ULL;
+}
+
+static inline uint64_t lstr_ascii_space8(lstr_vec a)
+{
+    uint8x16_t m = vorrq_u8(vcleq_u8(vsubq_u8(a, vdupq_n_u8(0x09)), vdupq_n_u8(0x0d - 0x09)),
+                            vceqq_u8(a, vdupq_n_u8(0x20)));
+    return lstr_movemask(m) & 0x1111111111111111ULL;
+}
+
+static inline uint64_t lstr_ascii_space16(lstr_vec a)
+{
+    uint16x8_t w = vreinterpretq_u16_u8(a);
+    uint16x8_t m = vorrq_u16(vcleq_u16(vsubq_u16(w, vdupq_n_u16(0x09)), vdupq_n_u16(0x0d - 0x09)),
+                             vceqq_u16(w, vdupq_n_u16(0x20)));
+    return lstr_movemask(vreinterpretq_u8_u16(m)) & 0x0101010101010101ULL;
+}
+
+#define LSTR_ALL8  0x1111111111111111ULL
+#define LSTR_ALL16 0x0101010101010101ULL
+
+static inline int lstr_has_wide16(lstr_vec a)
+{
+    uint16x8_t w = vreinterpretq_u16_u8(a);
+    uint16x4_t r = vorr_u16(vget_low_u16(w), vget_high_u16(w));
+    return (vget_lane_u64(vreinterpret_u64_u16(r), 0) & 0xff00ff00ff00ff00ULL) != 0;
+}
+
+static inline lstr_vec lstr_or(lstr_vec a, lstr_vec b)
+{
+    return vorrq_u8(a, b);
+}
+
+#endif
+
+/* Same set as lre_is_space(): WhiteSpace and LineTerminator */
+static inline int lstr_is_space(uint32_t c)
+{
+    if (c < 0x100)
+        return c == 0x20 || (c - 0x09) <= (0x0d - 0x09) || c == 0xa0;
+    return c == 0x1680 || (c - 0x2000) <= (0x200a - 0x2000) ||
+        c == 0x2028 || c == 0x2029 || c == 0x202f || c == 0x205f ||
+        c == 0x3000 || c == 0xfeff;
+}
+
+int lstr_find_char8(const uint8_t *s, int len, int c)
+{
+    const uint8_t *q;
+
+    if ((unsigned)c > 0xff || len <= 0)
+        return -1;
+    q = memchr(s, c, len);
+    return q ? q - s : -1;
+}
+
+int lstr_find_char16(const uint16_t *s, int len, int c)
+{
+    int i = 0;
+
+    if ((unsigned)c > 0xffff)
+        return -1;
+#ifdef LSTR_SIMD
+    {
+        lstr_vec vc = lstr_splat16(c);
+        uint64_t m;
+
+        for (; i + 16 <= len; i += 16) {
+            m = lstr_eq16(lstr_load(s + i), vc);
+            if (m)
+                return i + (ctz64(m) >> LSTR_SHIFT16);
+            m = lstr_eq16(lstr_load(s + i + 8), vc);
+            if (m)
+                return i + 8 + (ctz64(m) >> LSTR_SHIFT16);
+        }
+        for (; i + 8 <= len; i += 8) {
+            m = lstr_eq16(lstr_load(s + i), vc);
+            if (m)
+                return i + (ctz64(m) >> LSTR_SHIFT16);
+        }
+    }
+#endif
+    for (; i < len; i++) {
+        if (s[i] == c)
+            return i;
+    }
+    return -1;
+}
+
+/* The substring searches look for the first and the last character of the
+   needle together, a block at a time, and only compare the candidates
+   which match both. */
+
+int lstr_find8(const uint8_t *s, int len, const uint8_t *needle, int needle_len)
+{
+    const uint8_t *q;
+    int i, last, c0, c1;
+
+    if (needle_len <= 0)
+        return 0;
+    if (needle_len > len)
+        return -1;
+    if (needle_len == 1)
+        return lstr_find_char8(s, len, needle[0]);
+    last = needle_len - 1;
+    c0 = needle[0];
+    c1 = needle[last];
+    i = 0;
+#ifdef LSTR_SIMD
+    {
+        lstr_vec v0 = lstr_splat8(c0), v1 = lstr_splat8(c1);
+        uint64_t m;
+        int j;
+
+        for (; i + last + 16 <= len; i += 16) {
+            m = lstr_eq8(lstr_load(s + i), v0) & lstr_eq8(lstr_load(s + i + last), v1);
+            while (m) {
+                j = i + (ctz64(m) >> LSTR_SHIFT8);
+                if (!memcmp(s + j + 1, needle + 1, last - 1))
+                    return j;
+                m &= m - 1;
+            }
+        }
+    }
+#endif
+    while (i + last < len) {
+        q = memchr(s + i, c0, len - last - i);
+        if (!q)
+            break;
+        i = q - s;
+        if (s[i + last] == c1 && !memcmp(s + i + 1, needle + 1, last - 1))
+            return i;
+        i++;
+    }
+    return -1;
+}
+
+int lstr_find16(const uint16_t *s, int len, const uint16_t *needle, int needle_len)
+{
+    int i, last, c0, c1;
+
+    if (needle_len <= 0)
+        return 0;
+    if (needle_len > len)
+        return -1;
+    if (needle_len == 1)
+        return lstr_find_char16(s, len, needle[0]);
+    last = needle_len - 1;
+    c0 = needle[0];
+    c1 = needle[last];
+    i = 0;
+#ifdef LSTR_SIMD
+    {
+        lstr_vec v0 = lstr_splat16(c0), v1 = lstr_splat16(c1);
+        uint64_t m;
+        int j;
+
+        for (; i + last + 8 <= len; i += 8) {
+            m = lstr_eq16(lstr_load(s + i), v0) & lstr_eq16(lstr_load(s + i + last), v1);
+            while (m) {
+                j = i + (ctz64(m) >> LSTR_SHIFT16);
+                if (!memcmp(s + j + 1, needle + 1, (last - 1) * 2))
+                    return j;
+                m &= m - 1;
+            }
+        }
+    }
+#endif
+    for (; i + last < len; i++) {
+        if (s[i] == c0 && s[i + last] == c1 &&
+            !memcmp(s + i + 1, needle + 1, (last - 1) * 2))
+            return i;
+    }
+    return -1;
+}
+
+static inline int lstr_match16_8(const uint16_t *s, const uint8_t *needle, int len)
+{
+    int k;
+
+    for (k = 0; k < len; k++) {
+        if (s[k] != needle[k])
+            return 0;
+    }
+    return 1;
+}
+
+int lstr_find16_8(const uint16_t *s, int len, const uint8_t *needle, int needle_len)
+{
+    int i, last, c0, c1;
+
+    if (needle_len <= 0)
+        return 0;
+    if (needle_len > len)
+        return -1;
+    if (needle_len == 1)
+        return lstr_find_char16(s, len, needle[0]);
+    last = needle_len - 1;
+    c0 = needle[0];
+    c1 = needle[last];
+    i = 0;
+#ifdef LSTR_SIMD
+    {
+        lstr_vec v0 = lstr_splat16(c0), v1 = lstr_splat16(c1);
+        uint64_t m;
+        int j;
+
+        for (; i + last + 8 <= len; i += 8) {
+            m = lstr_eq16(lstr_load(s + i), v0) & lstr_eq16(lstr_load(s + i + last), v1);
+            while (m) {
+                j = i + (ctz64(m) >> LSTR_SHIFT16);
+                if (lstr_match16_8(s + j + 1, needle + 1, last - 1))
+                    return j;
+                m &= m - 1;
+            }
+        }
+    }
+#endif
+    for (; i + last < len; i++) {
+        if (s[i] == c0 && s[i + last] == c1 &&
+            lstr_match16_8(s + i + 1, needle + 1, last - 1))
+            return i;
+    }
+    return -1;
+}
+
+/* The white space runs are skipped a block at a time while they only
+   contain ASCII white space, then character by character. */
+
+int lstr_skip_space8(const uint8_t *s, int len)
+{
+    int i = 0;
+
+#ifdef LSTR_SIMD
+    for (; i + 16 <= len; i += 16) {
+        uint64_t m = lstr_ascii_space8(lstr_load(s + i)) ^ LSTR_ALL8;
+        if (m) {
+            i += ctz64(m) >> LSTR_SHIFT8;
+            break;
+        }
+    }
+#endif
+    while (i < len && lstr_is_space(s[i]))
+        i++;
+    return i;
+}
+
+int lstr_skip_space16(const uint16_t *s, int len)
+{
+    int i = 0;
+
+#ifdef LSTR_SIMD
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m = lstr_ascii_space16(lstr_load(s + i)) ^ LSTR_ALL16;
+        if (m) {
+            i += ctz64(m) >> LSTR_SHIFT16;
+            break;
+        }
+    }
+#endif
+    while (i < len && lstr_is_space(s[i]))
+        i++;
+    return i;
+}
+
+int lstr_trim_end8(const uint8_t *s, int len)
+{
+#ifdef LSTR_SIMD
+    for (; len >= 16; len -= 16) {
+        uint64_t m = lstr_ascii_space8(lstr_load(s + len - 16)) ^ LSTR_ALL8;
+        if (m) {
+            len -= 15 - ((63 - clz64(m)) >> LSTR_SHIFT8);
+            break;
+        }
+    }
+#endif
+    while (len > 0 && lstr_is_space(s[len - 1]))
+        len--;
+    return len;
+}
+
+int lstr_trim_end16(const uint16_t *s, int len)
+{
+#ifdef LSTR_SIMD
+    for (; len >= 8; len -= 8) {
+        uint64_t m = lstr_ascii_space16(lstr_load(s + len - 8)) ^ LSTR_ALL16;
+        if (m) {
+            len -= 7 - ((63 - clz64(m)) >> LSTR_SHIFT16);
+            break;
+        }
+    }
+#endif
+    while (len > 0 && lstr_is_space(s[len - 1]))
+        len--;
+    return len;
+}
+
+int lstr_is_latin1_16(const uint16_t *s, int len)
+{
+    int i = 0;
+    uint16_t c = 0;
+
+#ifdef LSTR_SIMD
+    if (len >= 8) {
+        lstr_vec acc = lstr_load(s);
+        for (i = 8; i + 8 <= len; i += 8)
+            acc = lstr_or(acc, lstr_load(s + i));
+        if (lstr_has_wide16(acc))
+            return 0;
+    }
+#endif
+    for (; i < len; i++)
+        c |= s[i];
+    return c < 0x100;
+}
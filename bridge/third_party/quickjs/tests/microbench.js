@@ -241,6 +241,84 @@ function prop_delete(n)
     return n;
 }
 
+function method_call(n)
+{
+    var obj, sum, j;
+    class A { get_a() { return 1; } }
+    class B extends A { get_b() { return 2; } }
+    obj = new B();
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        sum += obj.get_a();
+        sum += obj.get_b();
+        sum += obj.get_a();
+        sum += obj.get_b();
+    }
+    global_res = sum;
+    return n * 4;
+}
+
+function make_shapes(count)
+{
+    var tab, obj, i;
+    tab = [];
+    for(i = 0; i < count; i++) {
+        obj = {};
+        obj["p" + i] = i;
+        obj.a = i;
+        tab.push(obj);
+    }
+    return tab;
+}
+
+function prop_read_polymorphic(n)
+{
+    var tab, sum, j;
+    tab = make_shapes(4);
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        sum += tab[0].a;
+        sum += tab[1].a;
+        sum += tab[2].a;
+        sum += tab[3].a;
+    }
+    global_res = sum;
+    return n * 4;
+}
+
+function prop_read_megamorphic(n)
+{
+    var tab, sum, i, j;
+    tab = make_shapes(32);
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        for(i = 0; i < 32; i++)
+            sum += tab[i].a;
+    }
+    global_res = sum;
+    return n * 32;
+}
+
+function prop_accessor(n)
+{
+    var obj, sum, j;
+    class A {
+        constructor() { this._a = 1; }
+        get a() { return this._a; }
+        set a(v) { this._a = v; }
+    }
+    obj = new A();
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        obj.a = j;
+        sum += obj.a;
+        obj.a = j;
+        sum += obj.a;
+    }
+    global_res = sum;
+    return n * 4;
+}
+
 function array_read(n)
 {
     var tab, len, sum, i, j;
@@ -740,6 +818,143 @@ function string_build4(n)
     return n * 100;
 }
 
+/* string concatenation loops building 1 KB to 10 MB strings, which are
+   then read once */
+function string_concat_bench(text) {
+    var sizes = [ 1e3, 1e4, 1e5, 1e6, 1e7 ];
+    var ops = {
+        append: function(n) {
+            var s = "", i = 0;
+            while (s.length < n)
+                s += "line " + i++ + "\n";
+            return s.charCodeAt(n >> 1);
+        },
+        append_prop: function(n) {
+            var o = { s: "" }, i = 0;
+            while (o.s.length < n)
+                o.s = o.s + "[" + i++ + "] " + "message";
+            return o.s.charCodeAt(n >> 1);
+        },
+        prepend: function(n) {
+            var s = "", i = 0;
+            while (s.length < n)
+                s = "line " + i++ + "\n" + s;
+            return s.charCodeAt(n >> 1);
+        },
+        json: function(n) {
+            var s = "[", i = 0;
+            while (s.length < n)
+                s += '{"id":' + i + ',"name":"item' + i++ + '"},';
+            return JSON.parse(s + "0]").length;
+        },
+    };
+    var total = 0, count = 0;
+    var n, i, j, name, reps, t, ti;
+
+    for (n of sizes) {
+        reps = Math.max(1, Math.min(100, 1e6 / n | 0));
+        for (name in ops) {
+            ti = 0;
+            for (j = 0; j < 3; j++) {
+                t = get_clock();
+                for (i = 0; i < reps; i++)
+                    global_res = ops[name](n);
+                t = get_clock() - t;
+                if (!ti || ti > t)
+                    ti = t;
+            }
+            ti /= reps * n;
+            total += ti;
+            count++;
+            if (string_concat_bench.verbose)
+                log_one("string_" + name + "_" + n, n, ti * 1e9 / clocks_per_sec);
+        }
+    }
+    return total / count;
+}
+string_concat_bench.bench = true;
+string_concat_bench.verbose = false;
+
+/* short concatenations, which stay flat strings */
+function string_concat_short(n)
+{
+    var i, j, r, a = "abc", b = "defgh";
+    for(j = 0; j < n; j++) {
+        for(i = 0; i < 100; i++)
+            r = a + b + i;
+        global_res = r;
+    }
+    return n * 100;
+}
+
+/* log and CSV parsing */
+
+var log_text, log_text16, csv_text;
+
+function make_parse_texts()
+{
+    var i, a = [], b = [];
+    if (log_text)
+        return;
+    for(i = 0; i < 1000; i++) {
+        a.push("2024-05-" + (10 + i % 20) + "T12:" + (10 + i % 50) + ":07.123Z " +
+               ["INFO ", "DEBUG", "WARN ", "ERROR"][i % 4] + " [worker-" + (i % 8) +
+               "] GET /api/v1/items/" + i + " status=" + (i % 17 ? 200 : 500) +
+               " latency_ms=" + (i % 97) + " user_agent=\"Mozilla/5.0\"");
+        b.push(i + ", item " + i + " ,  " + (i * 3.5) +
+               ",  description of item number " + i + " ,ok");
+    }
+    log_text = a.join("\n");
+    /* same lines in a 16 bit string */
+    log_text16 = log_text.replaceAll("GET", "GET\u2192");
+    csv_text = "id,name,price,description,status\n" + b.join("\n");
+}
+
+function log_scan(text, n)
+{
+    var i, j, lines, count, line;
+    for(j = 0; j < n; j++) {
+        lines = text.split("\n");
+        count = 0;
+        for(i = 0; i < lines.length; i++) {
+            line = lines[i];
+            if (line.includes("ERROR") || line.indexOf("status=500") >= 0)
+                count++;
+        }
+        global_res = count;
+    }
+    return n * lines.length;
+}
+
+function string_log_scan(n)
+{
+    make_parse_texts();
+    return log_scan(log_text, n);
+}
+
+function string_log_scan16(n)
+{
+    make_parse_texts();
+    return log_scan(log_text16, n);
+}
+
+function string_csv_parse(n)
+{
+    var i, j, k, rows, fields, sum;
+    make_parse_texts();
+    for(j = 0; j < n; j++) {
+        rows = csv_text.split("\n");
+        sum = 0;
+        for(i = 1; i < rows.length; i++) {
+            fields = rows[i].split(",");
+            for(k = 0; k < fields.length; k++)
+                sum += fields[k].trim().length;
+        }
+        global_res = sum;
+    }
+    return n * (rows.length - 1);
+}
+
 /* sort bench */
 
 function sort_bench(text) {
@@ -879,6 +1094,60 @@ function sort_bench(text) {
 sort_bench.bench = true;
 sort_bench.verbose = false;
 
+/* Array builtins on dense arrays of 10 to 1M elements. With -a, the
+   time of each builtin and size is logged in ns per element. */
+function array_builtins_bench(text) {
+    var sizes = [ 10, 100, 1000, 10000, 100000, 1000000 ];
+    var ops = {
+        map: function(a) { return a.map(function(x) { return x + 1; }); },
+        filter: function(a) { return a.filter(function(x) { return x & 1; }); },
+        forEach: function(a) { var s = 0; a.forEach(function(x) { s += x; }); return s; },
+        reduce: function(a) { return a.reduce(function(s, x) { return s + x; }, 0); },
+        indexOf: function(a) { return a.indexOf(-1); },
+        includes: function(a) { return a.includes(-1); },
+        sort_int: function(a) { return a.slice().sort(); },
+        sort_num: function(a) { return a.slice().sort(function(x, y) { return x - y; }); },
+        sort_sorted: function(a, sorted) { return sorted.slice().sort(function(x, y) { return x - y; }); },
+        sort_str: function(a, sorted, strs) { return strs.slice().sort(); },
+    };
+    var total = 0, count = 0;
+    var n, i, j, a, sorted, strs, name, reps, t, ti;
+
+    for (n of sizes) {
+        a = [];
+        sorted = [];
+        strs = [];
+        for (i = 0; i < n; i++) {
+            a.push((Math.random() * n) | 0);
+            sorted.push(i);
+            strs.push("k" + a[i]);
+        }
+        /* nearly sorted */
+        for (i = 0; i < n / 100; i++)
+            sorted[(Math.random() * n) | 0] = (Math.random() * n) | 0;
+        reps = Math.max(1, Math.min(1000, 100000 / n | 0));
+        for (name in ops) {
+            ti = 0;
+            for (j = 0; j < 3; j++) {
+                t = get_clock();
+                for (i = 0; i < reps; i++)
+                    global_res = ops[name](a, sorted, strs);
+                t = get_clock() - t;
+                if (!ti || ti > t)
+                    ti = t;
+            }
+            ti /= reps * n;
+            total += ti;
+            count++;
+            if (array_builtins_bench.verbose)
+                log_one("array_" + name + "_" + n, n, ti * 1e9 / clocks_per_sec);
+        }
+    }
+    return total / count;
+}
+array_builtins_bench.bench = true;
+array_builtins_bench.verbose = false;
+
 function int_to_string(n)
 {
     var s, r, j;
@@ -925,6 +1194,192 @@ function string_to_float(n)
     return n;
 }
 
+function number_array(len)
+{
+    var a, j;
+    a = [];
+    for(j = 0; j < len; j++)
+        a.push((j + 1) * 1.1 + 1 / (j + 3));
+    return a;
+}
+
+function json_number_stringify(n)
+{
+    var a, s, j;
+    a = number_array(100);
+    for(j = 0; j < n; j++) {
+        s = JSON.stringify(a);
+    }
+    global_res = s;
+    return n * a.length;
+}
+
+function json_number_parse(n)
+{
+    var s, r, j;
+    s = JSON.stringify(number_array(100));
+    for(j = 0; j < n; j++) {
+        r = JSON.parse(s);
+    }
+    global_res = r;
+    return n * r.length;
+}
+
+/* twitter.json-like: an array of records sharing their keys */
+function json_records_text()
+{
+    var a, j;
+    a = [];
+    for(j = 0; j < 100; j++) {
+        a.push({ id: 505874924095815700 + j, id_str: "50587492409581" + j,
+                 text: "RT @user" + j + ": \u00e9t\u00e9 \"quoted\" text " + j,
+                 truncated: false, retweet_count: j * 3, favorited: j % 2 == 0,
+                 user: { id: 1186275104 + j, name: "name" + j, screen_name: "screen_" + j,
+                         followers_count: j * 17, verified: false, lang: "ja" },
+                 entities: { hashtags: [], urls: [ "http://example.com/" + j ] } });
+    }
+    return JSON.stringify(a, null, 1);
+}
+
+/* canada.json-like: nested arrays of coordinates */
+function json_coordinates_text()
+{
+    var a, ring, j, k;
+    a = [];
+    for(j = 0; j < 10; j++) {
+        ring = [];
+        for(k = 0; k < 100; k++)
+            ring.push([-65.613616999999977 + k / 7, 43.420273000000009 - j / 3]);
+        a.push(ring);
+    }
+    return JSON.stringify({ type: "Polygon", coordinates: a });
+}
+
+function json_parse_records(n)
+{
+    var s, r, j;
+    s = json_records_text();
+    for(j = 0; j < n; j++) {
+        r = JSON.parse(s);
+    }
+    global_res = r;
+    return n * r.length;
+}
+
+function json_parse_coordinates(n)
+{
+    var s, r, j;
+    s = json_coordinates_text();
+    for(j = 0; j < n; j++) {
+        r = JSON.parse(s);
+    }
+    global_res = r;
+    return n * r.coordinates.length * r.coordinates[0].length;
+}
+
+/* a typical API response: records with string, number, boolean and
+   nested object fields */
+function json_stringify_records(n)
+{
+    var a, s, j;
+    a = JSON.parse(json_records_text());
+    for(j = 0; j < n; j++) {
+        s = JSON.stringify(a);
+    }
+    global_res = s;
+    return n * a.length;
+}
+
+function json_stringify_nested(n)
+{
+    var a, s, j;
+    a = { type: "Polygon", coordinates: JSON.parse(json_coordinates_text()).coordinates };
+    for(j = 0; j < 6; j++)
+        a = { depth: j, items: [ a, { id: j, name: "level" + j, tags: [ "a", "b" ] } ] };
+    for(j = 0; j < n; j++) {
+        s = JSON.stringify(a);
+    }
+    global_res = s;
+    return n;
+}
+
+/* a library of 100 functions of which the script only calls 10 */
+function script_text()
+{
+    var a, j;
+    a = [];
+    for(j = 0; j < 100; j++) {
+        a.push("function f" + j + "(o, n) {\n" +
+               "    var i, r = [];\n" +
+               "    for(i = 0; i < n; i++) {\n" +
+               "        if (o.kind == 'a' + i) r.push({ id: i, name: o.name + i });\n" +
+               "        else r.push(function () { return o.value * i + " + j + "; });\n" +
+               "    }\n" +
+               "    return r;\n" +
+               "}\n");
+    }
+    for(j = 0; j < 100; j += 10)
+        a.push("f" + j + "({ kind: 'b', name: 'x', value: 1 }, 2);\n");
+    return a.join("");
+}
+
+function script_load(n)
+{
+    var s, j;
+    s = script_text();
+    for(j = 0; j < n; j++) {
+        (0, eval)(s);
+    }
+    return n * 100;
+}
+
+function array_double_write(n)
+{
+    var tab, len, i, j;
+    len = 1000;
+    tab = [];
+    for(i = 0; i < len; i++)
+        tab[i] = i + 0.5;
+    for(j = 0; j < n; j++) {
+        for(i = 0; i < len; i++)
+            tab[i] = tab[i] * 0.5 + j;
+    }
+    global_res = tab[len - 1];
+    return len * n;
+}
+
+function array_number_sum(n)
+{
+    var tab, len, sum, i, j;
+    len = 1000;
+    tab = [];
+    for(i = 0; i < len; i++)
+        tab.push(i * 0.25);
+    sum = 0;
+    for(j = 0; j < n; j++) {
+        for(i = 0; i < len; i++)
+            sum += tab[i];
+    }
+    global_res = sum;
+    return len * n;
+}
+
+function array_number_search(n)
+{
+    var tab, len, i, j, r;
+    len = 1000;
+    tab = [];
+    for(i = 0; i < len; i++)
+        tab.push(i * 0.5);
+    r = 0;
+    for(j = 0; j < n; j++) {
+        r += tab.indexOf(499.5);
+        r += tab.includes(-1);
+    }
+    global_res = r;
+    return len * n * 2;
+}
+
 function load_result(filename)
 {
     var f, str, res;
@@ -959,6 +1414,10 @@ function main(argc, argv, g)
         prop_write,
         prop_create,
         prop_delete,
+        method_call,
+        prop_read_polymorphic,
+        prop_read_megamorphic,
+        prop_accessor,
         array_read,
         array_write,
         array_prop_create,
@@ -987,11 +1446,27 @@ function main(argc, argv, g)
         string_build2,
         //string_build3,
         //string_build4,
+        string_concat_bench,
+        string_concat_short,
+        string_log_scan,
+        string_log_scan16,
+        string_csv_parse,
         sort_bench,
         int_to_string,
         float_to_string,
         string_to_int,
         string_to_float,
+        json_number_stringify,
+        json_number_parse,
+        json_parse_records,
+        json_parse_coordinates,
+        json_stringify_records,
+        json_stringify_nested,
+        script_load,
+        array_double_write,
+        array_number_sum,
+        array_number_search,
+        array_builtins_bench,
     ];
     var tests = [];
     var i, j, n, f, name;
@@ -1010,6 +1485,8 @@ function main(argc, argv, g)
         name = argv[i++];
         if (name == "-a") {
             sort_bench.verbose = true;
+            array_builtins_bench.verbose = true;
+            string_concat_bench.verbose = true;
             continue;
         }
         if (name == "-t") {
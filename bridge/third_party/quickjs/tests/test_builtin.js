@@ -195,6 +195,167 @@ function test_array()
     assert(err && a.toString() === "1,2,3,4");
 }
 
+function test_array_kinds()
+{
+    var a, b, i, s;
+
+    /* int32 -> float64 -> generic */
+    a = [1, 2, 3];
+    a[1] = 2.5;
+    assert(a.join(), "1,2.5,3", "float64 store");
+    a.push(-0);
+    assert(Object.is(a[3], -0), true, "-0 kept");
+    a.push("x");
+    assert(a.join(), "1,2.5,3,0,x", "generic store");
+    a[0] = 4.0;
+    assert(a[0] === 4 && a.length === 5, true);
+
+    a = [1.5, 2];
+    a[1] = 2;
+    assert(a[1] === 2 && a[0] === 1.5, true);
+    a = [0x7fffffff];
+    a.push(0x80000000);
+    assert(a[1], 2147483648);
+
+    a = [1, NaN, 3, -0];
+    assert(a.includes(NaN), true, "includes NaN");
+    assert(a.indexOf(NaN), -1, "indexOf NaN");
+    assert(a.indexOf(0), 3);
+    assert(a.includes(0, 4), false);
+    assert([1, 2, 3].indexOf(3.0), 2);
+    assert([1, 2, 3].indexOf("3"), -1);
+    assert([1, 2, 3].includes(2, 2), false);
+
+    a = [1, 2, 3, 4];
+    assert(a.pop(), 4);
+    assert(a.shift(), 1);
+    assert(a.join(), "2,3");
+    a = [1.5, 2.5, 3.5];
+    assert(a.shift() + a.pop(), 5);
+    a = [1, 2, 3, 4, 5];
+    a.reverse();
+    assert(a.join(), "5,4,3,2,1", "reverse");
+    a.copyWithin(0, 3);
+    assert(a.join(), "2,1,3,2,1", "copyWithin");
+    a.splice(1, 2, 0.5);
+    assert(a.join(), "2,0.5,2,1", "splice");
+    assert(a.slice(1, 3).join(), "0.5,2", "slice");
+    a.unshift(7);
+    assert(a.join(), "7,2,0.5,2,1", "unshift");
+
+    /* holes and sparse conversion */
+    a = [1, 2, 3];
+    delete a[2];
+    assert(a.length === 2 || a[2] === undefined, true);
+    delete a[0];
+    assert(0 in a, false, "hole");
+    assert(a[1], 2);
+    a = [1, 2];
+    Object.defineProperty(a, "0", { get: function() { return 5; } });
+    assert(a[0] + a[1], 7, "accessor");
+
+    a = [];
+    for(i = 0; i < 100; i++)
+        a.push(i * 0.5);
+    s = 0;
+    for(i of a)
+        s += i;
+    assert(s, 2475, "for of");
+    assert(Math.max.apply(null, a), 49.5, "apply");
+    assert(Math.max(...a), 49.5, "spread");
+    b = [...a, "end"];
+    assert(b.length === 101 && b[100] === "end", true);
+
+    a = JSON.parse("[1,2,3.5,-4]");
+    a.push(5);
+    assert(JSON.stringify(a), "[1,2,3.5,-4,5]", "JSON");
+    assert(JSON.stringify(JSON.parse("[-0,1]")), "[0,1]");
+    assert(Object.is(JSON.parse("[-0]")[0], -0), true);
+}
+
+function test_array_iteration()
+{
+    var a, b, r, i, log;
+
+    /* the callbacks modify the array */
+    a = [1, 2, 3, 4, 5];
+    log = [];
+    a.forEach(function(x, i) { log.push(x); if (i == 1) a.length = 3; });
+    assert(log.join(), "1,2,3", "forEach shrink");
+    a = [1, 2, 3];
+    log = [];
+    a.forEach(function(x, i) { log.push(x); if (i == 0) a.push(9); });
+    assert(log.join(), "1,2,3", "forEach grow");
+    a = [1, 2, 3, 4];
+    r = a.map(function(x, i) { if (i == 0) delete a[2]; return x * 2; });
+    assert(r.length === 4 && !(2 in r) && r[3] === 8, true, "map hole");
+    a = [1, 2, 3];
+    r = a.map(function(x, i) { if (i == 0) a[1] = "b"; return x; });
+    assert(r.join(), "1,b,3", "map write");
+    a = [1, 2, 3, 4];
+    r = a.filter(function(x, i) { if (i == 0) a[3] = 3.5; return x > 2; });
+    assert(r.join(), "3,3.5", "filter");
+    a = [1, 2, 3];
+    Object.defineProperty(a, "1", { get: function() { return 5; } });
+    assert(a.reduce(function(s, x) { return s + x; }), 9, "reduce getter");
+    a = [, 1, , 2];
+    assert(a.reduce(function(s, x) { return s + x; }), 3, "reduce holes");
+    assert(a.reduceRight(function(s, x) { return s + "" + x; }), "21");
+    Array.prototype[5] = 6;
+    a = [1, 2];
+    a.length = 6;
+    assert(a.reduce(function(s, x) { return s + x; }), 9, "proto element");
+    delete Array.prototype[5];
+
+    class MyArray extends Array {}
+    b = MyArray.from([1, 2, 3]).map(function(x) { return x * 2; });
+    assert(b instanceof MyArray && b.join() === "2,4,6", true, "species");
+}
+
+function test_array_sort()
+{
+    var a, i, b;
+
+    /* default order: compare as strings */
+    a = [10, 9, 1, -1, -10, -9, 0, 100, 2147483647, -2147483648, 21];
+    a.sort();
+    assert(a.join(), "-1,-10,-2147483648,-9,0,1,10,100,21,2147483647,9", "int sort");
+    a = [3, 1.5, 20, "b", "a", 2];
+    a.sort();
+    assert(a.join(), "1.5,2,20,3,a,b", "mixed sort");
+    a = ["b", "", "ab", "a", "\u00e9", "B"];
+    a.sort();
+    assert(a.join("|"), "|B|a|ab|b|\u00e9", "string sort");
+    a = [3, undefined, , 1];
+    a.sort();
+    assert(a.length === 4 && a[0] === 1 && a[1] === 3 && a[2] === undefined && !(3 in a), true, "holes");
+
+    /* stable */
+    a = [];
+    for(i = 0; i < 1000; i++)
+        a.push({ k: i % 7, i: i });
+    a.sort(function(x, y) { return x.k - y.k; });
+    for(i = 1; i < a.length; i++) {
+        if (a[i - 1].k == a[i].k && a[i - 1].i > a[i].i)
+            break;
+    }
+    assert(i, a.length, "stable");
+
+    /* runs */
+    a = [];
+    for(i = 0; i < 1000; i++)
+        a.push(i < 500 ? 1000 - i : i);
+    a.sort(function(x, y) { return x - y; });
+    b = a.slice(1).every(function(x, i) { return a[i] <= x; });
+    assert(b, true, "runs");
+
+    /* the comparison function modifies the array */
+    a = [5, 4, 3, 2, 1];
+    a.sort(function(x, y) { a.length = 2; return x - y; });
+    assert(a.length === 5 && a[0] === 1 && a[4] === 5, true, "sort mutation");
+    assert_throws(TypeError, function() { [1, 2].sort(1); });
+}
+
 function test_string()
 {
     var a;
@@ -304,6 +465,108 @@ function test_string()
     assert("abc".padStart(Infinity, ""), "abc");
 }
 
+function test_string_search()
+{
+    var s, w, i, a;
+
+    /* matches past the first blocks, in 8 and 16 bit strings */
+    s = "abcdefghijklmnopqrstuvwxyz".repeat(4) + "needle,hay";
+    w = "\u4e2d" + s;
+    assert(s.indexOf("needle"), 104);
+    assert(w.indexOf("needle"), 105);
+    assert(w.indexOf("\u4e2d"), 0);
+    assert(s.indexOf("\u4e2d"), -1);
+    assert(s.indexOf("needle", 105), -1);
+    assert(s.indexOf("l", 105), 108);
+    assert(w.indexOf("l", 106), 109);
+    assert(s.indexOf("yz" + "ab"), 24);
+    assert(s.includes("le,h"), true);
+    assert(w.includes("le,h", 106), true);
+    assert(w.includes("le,h", 110), false);
+    assert(s.includes("needles"), false);
+    /* candidates matching the first and the last character only */
+    s = "aab".repeat(20) + "aaab";
+    assert(s.indexOf("aaab"), 60);
+    w = "\u0100ab".repeat(20) + "\u0100\u0100ab";
+    assert(w.indexOf("\u0100\u0100ab"), 60);
+
+    s = "x".repeat(40) + ";" + "y".repeat(40) + ";";
+    assert(s.split(";"), ["x".repeat(40), "y".repeat(40), ""]);
+    assert(s.split(";", 1), ["x".repeat(40)]);
+    w = "\u4e2d,".repeat(20);
+    a = w.split(",");
+    assert(a.length, 21);
+    assert(a[19] === "\u4e2d" && a[20] === "", true);
+    assert(w.split("\u4e2d").length, 21);
+    assert(s.split("\u4e2d"), [s]);
+    assert(s.replaceAll(";", "\n"), "x".repeat(40) + "\n" + "y".repeat(40) + "\n");
+    assert(w.replaceAll("\u4e2d,", "-"), "-".repeat(20));
+
+    s = " \t\n\r".repeat(10) + "\u00a0 text \u00a0" + " \t".repeat(10);
+    assert(s.trim(), "text");
+    assert(s.trimStart(), "text \u00a0" + " \t".repeat(10));
+    assert(s.trimEnd(), " \t\n\r".repeat(10) + "\u00a0 text");
+    w = " ".repeat(20) + "\u3000\ufeff\u4e2d\u2028" + " ".repeat(20);
+    assert(w.trim(), "\u4e2d");
+    assert(" ".repeat(33).trim(), "");
+    assert("\u3000".repeat(17).trim(), "");
+}
+
+function test_string_rope()
+{
+    var s, t, a, i, m, o;
+
+    /* long concatenations are built lazily */
+    s = "";
+    a = [];
+    for(i = 0; i < 10000; i++) {
+        s += "line " + i + "\n";
+        a.push("line " + i + "\n");
+    }
+    t = a.join("");
+    assert(s.length, t.length, "length");
+    assert(s === t, true, "strict eq");
+    assert(s == t, true, "eq");
+    assert(s < t + "a" && !(s < t), true, "relational");
+    assert(s[12345], t[12345], "index");
+    assert(s.indexOf("line 9999"), t.indexOf("line 9999"), "method");
+    assert(typeof s, "string", "typeof");
+    assert(String(s) === t && s.valueOf() === t, true, "to string");
+    assert(new String(s).length, t.length, "to object");
+    assert(JSON.stringify(s) === JSON.stringify(t), true, "json");
+    m = new Map();
+    m.set(s, 1);
+    assert(m.get(t), 1, "map key");
+    o = {};
+    o[s] = 2;
+    assert(o[t], 2, "property key");
+
+    /* a shared rope is not modified by appending to a copy */
+    t = s;
+    t += "!";
+    assert(t.length === s.length + 1 && s[s.length - 1] === "\n", true, "shared");
+
+    /* prepends, wide characters and mixed leaves */
+    s = "";
+    a = [];
+    for(i = 0; i < 5000; i++) {
+        s = "x" + i + s;
+        a.unshift("x" + i);
+    }
+    assert(s, a.join(""), "prepend");
+    s = "";
+    a = [];
+    for(i = 0; i < 5000; i++) {
+        t = (i % 7) ? "ab" : "\u1234";
+        s += t;
+        a.push(t);
+    }
+    assert(s, a.join(""), "wide");
+    s = "a".repeat(300);
+    t = "b".repeat(300);
+    assert((s + t) + (t + s), s + (t + t) + s, "tree shape");
+}
+
 function test_math()
 {
     var a;
@@ -344,6 +607,60 @@ function test_number()
     assert((-1.125).toFixed(2), "-1.13");
 }
 
+function test_number_conversion()
+{
+    var i, j, d, f64, u32, seed;
+
+    /* shortest round trip formatting */
+    assert(String(0.1), "0.1");
+    assert(String(1/3), "0.3333333333333333");
+    assert(String(123.456), "123.456");
+    assert(String(-1.5e-7), "-1.5e-7");
+    assert(String(0.000001), "0.000001");
+    assert(String(1e21), "1e+21");
+    assert(String(123e-20), "1.23e-18");
+    assert(String(2**53 + 2), "9007199254740994");
+    assert(String(5e-324), "5e-324");
+    assert(String(2.2250738585072014e-308), "2.2250738585072014e-308");
+    assert(String(Number.MAX_VALUE), "1.7976931348623157e+308");
+    assert(String(5.6236422431789955e+160), "5.623642243178996e+160");
+    assert((1.5e300).toExponential(), "1.5e+300");
+    assert((0.5).toString(), "0.5");
+
+    /* correctly rounded parsing */
+    assert(parseFloat("2.2250738585072011e-308"), 2.225073858507201e-308);
+    assert(parseFloat("2.4703282292062328e-324"), 5e-324);
+    assert(parseFloat("2.4703282292062327e-324"), 0);
+    assert(parseFloat("1.7976931348623158e308"), Number.MAX_VALUE);
+    assert(parseFloat("1.7976931348623159e308"), Infinity);
+    assert(parseFloat("9007199254740993"), 9007199254740992);
+    assert(parseFloat("9007199254740993.0"), 9007199254740992);
+    assert(parseFloat("9007199254740995.0"), 9007199254740996);
+    assert(parseFloat("0.1e-400"), 0);
+    assert(1 / parseFloat("-0.0"), -Infinity);
+    assert(parseFloat(".5e1"), 5);
+    assert(parseFloat("1234567890123456789012345678901234567890e-20"), 12345678901234567000);
+    assert(+"8.41e21", 8.41e21);
+    assert(JSON.parse("[1.5e-10, -0.0001, 123456.789e3]").toString(),
+           "1.5e-10,-0.0001,123456789");
+
+    /* random doubles round trip through the formatter and the parser */
+    f64 = new Float64Array(1);
+    u32 = new Uint32Array(f64.buffer);
+    seed = 1;
+    for(i = 0; i < 20000; i++) {
+        for(j = 0; j < 2; j++) {
+            seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+            u32[j] = seed ^ (seed >>> 11) * 2654435761;
+        }
+        d = f64[0];
+        if (!isFinite(d))
+            continue;
+        assert(+String(d), d, "round trip " + d);
+        assert(JSON.parse(JSON.stringify(d)), d);
+    }
+}
+
 function test_eval2()
 {
     var g_call_count = 0;
@@ -479,6 +796,237 @@ function test_json()
 ]`);
 }
 
+function test_json_parse()
+{
+    var a, s, i, err;
+
+    /* sibling objects share the shape of the previous one only when
+       their keys come in the same order */
+    a = JSON.parse('[{"a":1,"b":2},{"a":3,"b":4},{"b":5,"a":6},{"a":7},{"a":8,"b":9,"c":10},{}]');
+    assert(JSON.stringify(a), '[{"a":1,"b":2},{"a":3,"b":4},{"b":5,"a":6},{"a":7},{"a":8,"b":9,"c":10},{}]');
+    assert(Object.keys(a[2]).toString(), "b,a");
+    a[1].c = 1;
+    assert(Object.keys(a[0]).toString(), "a,b");
+    a = JSON.parse('[{"a":1,"a":2},{"a":3,"a":4,"b":5},{"1":1,"0":0},{"__proto__":1},{"__proto__":2}]');
+    assert(JSON.stringify(a), '[{"a":2},{"a":4,"b":5},{"0":0,"1":1},{"__proto__":1},{"__proto__":2}]');
+    assert(Object.getPrototypeOf(a[4]), Object.prototype);
+    a = JSON.parse('[{"u":{"x":1}},{"u":{"x":2}},{"u":{"y":3}}]');
+    assert(a[1].u.x, 2);
+    assert(a[2].u.y, 3);
+    assert(a[2].u.x, undefined);
+
+    /* strings and numbers */
+    a = JSON.parse(' [ "\\u00e9\\n\\"\\/\\t\\ud83d\\ude00", "été 😀", -0, 0, -12, 2147483648, 1.5e3, 123456789012 ] ');
+    assert(a[0], "é\n\"/\t😀");
+    assert(a[1], "été 😀");
+    assert(Object.is(a[2], -0));
+    assert(Object.is(a[3], 0));
+    assert(a[4], -12);
+    assert(a[5], 2147483648);
+    assert(a[6], 1500);
+    assert(a[7], 123456789012);
+    s = "x".repeat(100) + "é" + "y".repeat(100);
+    assert(JSON.parse(JSON.stringify([s, s + "\n"])).toString(), [s, s + "\n"].toString());
+
+    /* invalid inputs still report errors */
+    ["[1,]", "{\"a\":1,}", "[01]", "[.5]", "[+1]", "tru", "truex", "'a'",
+     "[\"a\nb\"]", "[1] 2", "", " ", "{\"a\" 1}", "[-]", "[1e]"].forEach(function (s) {
+        err = false;
+        try {
+            JSON.parse(s);
+        } catch(e) {
+            err = e instanceof SyntaxError;
+        }
+        assert(err, true, "JSON.parse(" + s + ")");
+    });
+
+    /* nesting deeper than the fast path handles */
+    s = "[".repeat(1000) + "]".repeat(1000);
+    a = JSON.parse(s);
+    for(i = 0; i < 999; i++)
+        a = a[0];
+    assert(a.length, 0);
+}
+
+function test_json_stringify()
+{
+    var a, o, s, err;
+
+    /* escapes, wide strings and lone surrogates */
+    s = "x".repeat(40) + "\"\\\b\f\n\r\t\u0001\u001f\u007fé" + "y".repeat(40);
+    assert(JSON.stringify(s), '"' + "x".repeat(40) + '\\"\\\\\\b\\f\\n\\r\\t\\u0001\\u001f\u007fé' + "y".repeat(40) + '"');
+    assert(JSON.stringify(["中\ud800", "😀", "\udfff\ud800x"]), '["中\\ud800","😀","\\udfff\\ud800x"]');
+    assert(JSON.stringify({ "中": 1, "a\"b": 2, "é": 3 }), '{"中":1,"a\\"b":2,"é":3}');
+    assert(JSON.stringify([1, -0, 1.5, NaN, -Infinity, 1e21, 2147483648]), '[1,0,1.5,null,null,1e+21,2147483648]');
+
+    /* key order, skipped members, holes */
+    o = { b: 1, a: 2, u: undefined, f: function() {}, s: Symbol() };
+    o[1] = 3;
+    o[0] = 4;
+    o[Symbol()] = 5;
+    assert(JSON.stringify(o), '{"0":4,"1":3,"b":1,"a":2}');
+    a = [undefined, function() {}, Symbol(), , 1];
+    a.length = 6;
+    assert(JSON.stringify(a), '[null,null,null,null,1,null]');
+    o = { a: 1, b: 2 };
+    Object.defineProperty(o, "g", { get: function() { return [3]; }, enumerable: true });
+    Object.defineProperty(o, "h", { value: 4, enumerable: false });
+    assert(JSON.stringify([o, o]), '[{"a":1,"b":2,"g":[3]},{"a":1,"b":2,"g":[3]}]');
+
+    /* toJSON on the object, its prototype chain or a boxed value */
+    o = { a: [1], b: { c: 2 } };
+    assert(JSON.stringify(o), '{"a":[1],"b":{"c":2}}');
+    Object.prototype.toJSON = function(k) { return "O" + k; };
+    Array.prototype.toJSON = function(k) { return "A" + k; };
+    assert(JSON.stringify(o), '"O"');
+    assert(JSON.stringify([o]), '"A"');
+    delete Object.prototype.toJSON;
+    assert(JSON.stringify({ a: [1] }), '{"a":"Aa"}');
+    delete Array.prototype.toJSON;
+    assert(JSON.stringify(o), '{"a":[1],"b":{"c":2}}');
+    o.b.toJSON = function(k) { return k + "!"; };
+    assert(JSON.stringify(o), '{"a":[1],"b":"b!"}');
+    BigInt.prototype.toJSON = function() { return this.toString(); };
+    assert(JSON.stringify({ n: 1n }), '{"n":"1"}');
+    delete BigInt.prototype.toJSON;
+    assert_throws(TypeError, () => JSON.stringify({ n: [1n] }));
+
+    /* toJSON modifying the object being written */
+    o = { a: { toJSON: function() { delete o.b; o.z = 1; return 0; } }, b: 1, c: 2 };
+    assert(JSON.stringify(o), '{"a":0,"c":2}');
+    o = { a: { toJSON: function() { Object.defineProperty(o, "c", { get: function() { return "g"; } }); return 0; } }, b: 1, c: 2 };
+    assert(JSON.stringify(o), '{"a":0,"b":1,"c":"g"}');
+    a = [1, { toJSON: function() { a.length = 2; return 0; } }, 3, 4];
+    assert(JSON.stringify(a), '[1,0,null,null]');
+
+    /* cycles, also through toJSON */
+    o = { a: [] };
+    o.a.push(o);
+    assert_throws(TypeError, () => JSON.stringify(o));
+    o = { d: null };
+    o.d = { toJSON: function() { return [o]; } };
+    assert_throws(TypeError, () => JSON.stringify(o));
+    o = { x: 1 };
+    assert(JSON.stringify([o, { o: o }]), '[{"x":1},{"o":{"x":1}}]');
+
+    /* nesting, reentrancy and a large output */
+    s = JSON.stringify([{ toJSON: function() { return JSON.stringify({ a: [1, "b"] }); } }, "中"]);
+    assert(s, '["{\\"a\\":[1,\\"b\\"]}","中"]');
+    o = 1;
+    for(a = 0; a < 500; a++)
+        o = { a: [o] };
+    assert(JSON.stringify(o).length, 500 * 8 + 1);
+    s = JSON.stringify(new Array(200000).fill("abcdefgh"));
+    assert(s.length, 200000 * 11 + 1);
+    assert(JSON.stringify({ a: 1 }), '{"a":1}');
+    err = false;
+    try {
+        o = [];
+        for(a = 0; a < 1000000; a++)
+            o = [o];
+        JSON.stringify(o);
+    } catch(e) {
+        err = e instanceof InternalError;
+    }
+    assert(err, true, "stack overflow");
+}
+
+function test_inline_cache()
+{
+    var i, r, a, b, o, objs, log;
+
+    function call_m(o) { return o.m(); }
+    function get_x(o) { return o.x; }
+    function set_x(o, v) { o.x = v; }
+    function get_set_x(o, v) { var old = o.x; o.x = v; return old; }
+
+    /* methods found on the prototype chain */
+    class A { m() { return 1; } }
+    class B extends A {}
+    a = new A();
+    b = new B();
+    for(i = 0; i < 10; i++)
+        assert(call_m(a) + call_m(b), 2);
+    A.prototype.m = function() { return 2; };
+    assert(call_m(a) + call_m(b), 4);
+    B.prototype.m = function() { return 3; };
+    assert(call_m(a) + call_m(b), 5);
+    delete B.prototype.m;
+    assert(call_m(b), 2);
+    b.m = function() { return 4; };
+    assert(call_m(b), 4);
+    Object.setPrototypeOf(B.prototype, { m: function() { return 5; } });
+    assert(call_m(new B()), 5);
+    Array.prototype.m = function() { return this.length; };
+    assert(call_m([1, 2, 3]), 3);
+    delete Array.prototype.m;
+    for(i = 0; i < 3; i++)
+        assert("abc".charAt(i) + "abc".concat(), "abc"[i] + "abc");
+    String.prototype.charAt = function() { return "z"; };
+    assert("abc".charAt(0), "z");
+    delete String.prototype.charAt;
+
+    /* accessors on the object and its prototypes */
+    log = [];
+    o = { get x() { return this.v; }, set x(v) { log.push(v); } };
+    o.v = 1;
+    a = Object.create(o);
+    a.v = 2;
+    b = Object.create(a);
+    b.v = 3;
+    for(i = 0; i < 3; i++) {
+        assert(get_x(o) + get_x(a) + get_x(b), 6);
+        set_x(b, i);
+        set_x(o, i);
+    }
+    assert(log.join(), "0,0,1,1,2,2");
+    assert(Object.keys(b).join(), "v");
+    Object.defineProperty(a, "x", { get: function() { return 10; }, configurable: true });
+    assert(get_x(b), 10);
+    assert_throws(TypeError, function() { set_x(b, 1); });
+    delete a.x;
+    assert(get_x(b), 3);
+    set_x(b, 4);
+    assert(log.join(), "0,0,1,1,2,2,4");
+    Object.defineProperty(b, "x", { value: 5, writable: true });
+    assert(get_x(b), 5);
+
+    /* reads and writes of the same property in one function */
+    o = {};
+    Object.defineProperty(o, "x", { value: 1, writable: false });
+    a = { x: 1 };
+    for(i = 0; i < 3; i++)
+        assert(get_set_x(a, i), i == 0 ? 1 : i - 1);
+    assert_throws(TypeError, function() { get_set_x(o, 2); });
+    assert(o.x, 1);
+    a = Object.create({ x: 7 });
+    assert(get_set_x(a, 8), 7);
+    assert(Object.getPrototypeOf(a).x, 7);
+    assert(a.x, 8);
+
+    /* megamorphic sites */
+    objs = [];
+    for(i = 0; i < 64; i++) {
+        o = {};
+        o["p" + i] = i;
+        o.x = i;
+        objs.push(i & 1 ? Object.create(o) : o);
+    }
+    for(r = 0; r < 3; r++) {
+        for(i = 0; i < objs.length; i++) {
+            assert(get_x(objs[i]), i);
+            if (!(i & 1))
+                set_x(objs[i], i);
+        }
+    }
+    Object.getPrototypeOf(objs[1]).x = 100;
+    assert(get_x(objs[1]), 100);
+    Object.defineProperty(objs[2], "x", { get: function() { return 200; } });
+    assert(get_x(objs[2]), 200);
+    for(i = 3; i < objs.length; i++)
+        assert(get_x(objs[i]), i);
+}
+
 function test_date()
 {
     var d = new Date(1506098258091), a, s;
@@ -671,12 +1219,21 @@ test();
 test_function();
 test_enum();
 test_array();
+test_array_kinds();
+test_array_iteration();
+test_array_sort();
 test_string();
+test_string_search();
+test_string_rope();
 test_math();
 test_number();
+test_number_conversion();
 test_eval();
 test_typed_array();
 test_json();
+test_json_parse();
+test_json_stringify();
+test_inline_cache();
 test_date();
 test_regexp();
 test_symbol();
@@ -212,6 +212,114 @@ function test_eval_const()
     assert(success);
 }
 
+/* the functions of a global script are compiled on their first call */
+function test_lazy_function()
+{
+    var x = 1;
+    let y = 2;
+    const z = 3;
+    function get() { return x + y + z; }
+    function set(v) { x = v; y = v; }
+    function outer(a) {
+        var b = a * 2;
+        return function inner1(c) {
+            return function inner2() { return a + b + c + x; };
+        };
+    }
+    assert(get(), 6);
+    set(10);
+    assert(x + y, 20);
+    assert(get(), 23);
+    assert(outer(1)(2)(), 15);
+    assert(outer(1)(3)(), 16, "each closure is compiled once");
+
+    var tab = [];
+    for (let i = 0; i < 3; i++)
+        tab.push(function () { return i; });
+    assert(tab[0]() + tab[1]() + tab[2](), 3);
+
+    /* arguments */
+    function mapped(a) { arguments[0] = 2; return a; }
+    function unmapped(a) { "use strict"; arguments[0] = 2; return a; }
+    function arrow_args() { return (() => arguments.length)(); }
+    assert(mapped(1), 2);
+    assert(unmapped(1), 1);
+    assert(arrow_args(1, 2, 3), 3);
+
+    /* eval: functions calling eval are compiled eagerly, their
+       neighbours and the functions created by eval may be lazy */
+    function with_eval(s) {
+        var local = "local";
+        function lazy() { return local; }
+        return eval(s) + lazy();
+    }
+    assert(with_eval("local"), "locallocal");
+    assert(with_eval("(function () { return local; })()"), "locallocal");
+    var indirect = (0, eval)("(function () { var v = 'global'; return function () { return v; }; })");
+    assert(indirect()(), "global");
+
+    /* function expressions passed as call arguments, alone or in an
+       array, are compiled eagerly; their own children may be lazy */
+    var shared = 1;
+    function call(f, arg) { return f(arg); }
+    assert(call(function (a) { return a + shared; }, 2), 3);
+    assert(call(function (m) { return m[0]() + m[1](); },
+                [function () { return shared; },
+                 function () { function inner() { return shared; } return inner() + 1; }]), 3);
+    assert((function (factory) { return factory(); })(function () {
+        var hidden = 4;
+        return function () { return hidden + shared; };
+    })(), 5);
+
+    /* names, const and TDZ */
+    function decl() { return typeof decl; }
+    var expr = function named() { named = 1; return typeof named; };
+    assert(decl(), "function");
+    assert(expr(), "function");
+    function set_const() { z = 1; }
+    function read_tdz() { return tdz; }
+    assert_throws(TypeError, set_const);
+    assert_throws(ReferenceError, read_tdz);
+    let tdz = 1;
+    assert(read_tdz(), 1);
+
+    /* strict mode, this, defaults and rest parameters */
+    function strict_outer() {
+        "use strict";
+        return function () { return this; };
+    }
+    function params(a, b = a + 1, ...c) { return [a, b, c.length].join(); }
+    assert(strict_outer()(), undefined);
+    assert(params(1), "1,2,0");
+    assert(params(1, 5, 6, 7), "1,5,2");
+    assert(new (function () { this.t = new.target; })().t !== undefined);
+
+    /* source text, syntax errors and positions */
+    function source() {  /* comment */ return 1; }
+    assert(source.toString(), "function source() {  /* comment */ return 1; }");
+    assert_throws(SyntaxError, () => (0, eval)("function bad() { return 1 +; }"));
+    var thrower = (0, eval)("(0, function () {\n\n  throw Error('x');\n})");
+    try {
+        thrower();
+    } catch (e) {
+        assert(e.stack.includes(":3:"), true, e.stack);
+    }
+}
+
+function assert_throws(expected_error, func)
+{
+    var err = false;
+    try {
+        func();
+    } catch(e) {
+        err = true;
+        if (!(e instanceof expected_error))
+            throw Error("unexpected exception type");
+    }
+    if (!err)
+        throw Error("expected exception");
+}
+
 test_closure1();
 test_closure2();
 test_closure3();
@@ -219,3 +327,4 @@ test_arrow_function();
 test_with();
 test_eval_closure();
 test_eval_const();
+test_lazy_function();
@@ -218,6 +218,62 @@ function test_op2()
     assert(a.async === 3);
 }
 
+function test_peephole()
+{
+    var r, i, n, a, b, t, o, cnt;
+
+    /* constant folding */
+    r = 3 * (2 + 5) - (7 << 2) + (0x10 | 3) - (4 * 5) + (1 ^ 3) + (-8 >> 1);
+    assert(r, 21 - 28 + 19 - 20 + 2 - 4, "constant folding");
+    r = 0 * -1;
+    assert(Object.is(r, -0), true, "0 * -1 is -0");
+    r = 2147483647 + 1;
+    assert(r, 2147483648, "no int32 overflow");
+    r = 65536 * 65536;
+    assert(r, 4294967296, "no int32 overflow in mul");
+    r = 1 << 31;
+    assert(r, -2147483648, "1 << 31");
+
+    /* fused comparison and branch */
+    n = 0;
+    for(i = 0; i < 6; i++) {
+        if (i <= 2) n++;
+        if (i > 2) n += 10;
+        if (i >= 5) n += 100;
+    }
+    assert(n, 3 + 30 + 100, "fused comparisons");
+    n = 0;
+    for(i = 0; i < "3"; i++)
+        n++;
+    assert(n, 3, "fused comparison with a string");
+    cnt = 0;
+    o = { valueOf() { cnt++; return 2; } };
+    for(i = 0; i < o; i++);
+    assert(cnt, 3, "fused comparison calls valueOf");
+    n = 0;
+    for(i = 0.5; i < 3; i++)
+        n++;
+    assert(n, 3, "fused comparison with floats");
+    assert_throws(TypeError, function() { for(var i = 0; i < Symbol(); i++); });
+
+    /* fused local loads and stores */
+    a = 0;
+    b = 1;
+    for(i = 0; i < 10; i++) {
+        t = a + b;
+        a = b;
+        b = t;
+    }
+    assert(b, 89, "add_put_loc");
+    a = "a";
+    t = a + b;
+    assert(t, "a89", "add_put_loc with strings");
+    a = 0.5;
+    for(i = 0; i < 4; i++)
+        a += 0.25;
+    assert(a, 1.5, "add_loc with floats");
+}
+
 function test_delete()
 {
     var a, err;
@@ -531,6 +587,7 @@ test_cvt();
 test_eq();
 test_inc_dec();
 test_op2();
+test_peephole();
 test_delete();
 test_prototype();
 test_arguments();
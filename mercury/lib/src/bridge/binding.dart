@@ -11,6 +11,7 @@ import 'package:ffi/ffi.dart';
 import 'package:mercuryjs/bridge.dart';
 import 'package:mercuryjs/src/global/event.dart';
 import 'package:mercuryjs/src/global/event_target.dart';
+import 'package:mercuryjs/src/global/global.dart';
 import 'package:mercuryjs/foundation.dart';
 import 'package:mercuryjs/launcher.dart';
 
@@ -21,6 +22,7 @@ enum BindingMethodCallOperations {
   GetAllPropertyNames,
   AnonymousFunctionCall,
   AsyncAnonymousFunction,
+  GetProperties,
 }
 
 typedef NativeAsyncAnonymousFunctionCallback = Void Function(
@@ -35,7 +37,8 @@ List<BindingCallFunc> bindingCallMethodDispatchTable = [
   setterBindingCall,
   getPropertyNamesBindingCall,
   invokeBindingMethodSync,
-  invokeBindingMethodAsync
+  invokeBindingMethodAsync,
+  getPropertiesBindingCall
 ];
 
 // Dispatch the event to the binding side.
@@ -71,6 +74,7 @@ void _dispatchEventToNative(Event event, bool isCapture) {
     Pointer<EventDispatchResult> dispatchResult = fromNativeValue(controller.context, returnValue).cast<EventDispatchResult>();
     event.cancelable = dispatchResult.ref.canceled;
     event.propagationStopped = dispatchResult.ref.propagationStopped;
+    releaseDartWireLater(dispatchResult.ref.wire);
 
     event.sharedJSProps = Pointer.fromAddress(rawEvent.ref.bytes.elementAt(8).value);
     event.propLen = rawEvent.ref.bytes.elementAt(9).value;
@@ -150,6 +154,7 @@ abstract class BindingBridge {
   static void setup() {
     BindingObject.bind = _bindObject;
     BindingObject.unbind = _unbindObject;
+    BindingObject.registerShape(Global.shape);
   }
 
   static void teardown() {
@@ -4,6 +4,8 @@
  */
 
 import 'dart:ffi';
+import 'dart:isolate';
+import 'package:mercuryjs/foundation.dart';
 import 'package:mercuryjs/launcher.dart';
 
 import 'binding.dart';
@@ -16,6 +18,8 @@ class DartContext {
     registerDartContextFinalizer(this);
   }
   final Pointer<Void> pointer;
+  // Open while isolates are allocated, see openNativeTaskPort.
+  ReceivePort? nativeTaskPort;
 }
 
 DartContext dartContext = DartContext();
@@ -26,7 +30,13 @@ int initBridge(MercuryContextController view) {
   BindingBridge.setup();
 
   int mercuryIsolateId = newMercuryIsolateId();
-  allocateNewMercuryIsolate(mercuryIsolateId);
+  try {
+    allocateNewMercuryIsolate(mercuryIsolateId);
+  } catch (e) {
+    releaseMercuryIsolateId(mercuryIsolateId);
+    rethrow;
+  }
+  registerWidgetElementShapes(mercuryIsolateId, BindingObject.registeredShapes);
 
   return mercuryIsolateId;
 }
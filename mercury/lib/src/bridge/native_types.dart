@@ -47,6 +47,21 @@ class EventDispatchResult extends Struct {
 
   @Bool()
   external bool propagationStopped;
+
+  @Int64()
+  external int wire;
+}
+
+// One event of a batch passed to dispatchEventBatch.
+class NativeEventDispatchRecord extends Struct {
+  external Pointer<NativeBindingObject> target;
+
+  external Pointer<NativeString> type;
+
+  external Pointer<RawEvent> rawEvent;
+
+  @Int64()
+  external int isCapture;
 }
 
 class AddEventListenerOptions extends Struct {
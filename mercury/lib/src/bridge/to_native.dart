@@ -3,9 +3,11 @@
  * Copyright (C) 2022-present The WebF authors. All rights reserved.
  */
 
+import 'dart:async';
 import 'dart:collection';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
@@ -92,6 +94,153 @@ dynamic invokeModuleEvent(int contextId, String moduleName, Event? event, extra)
   return result;
 }
 
+typedef NativeGetMercuryIsolateHeapUsage = Int64 Function(Pointer<Void>);
+typedef DartGetMercuryIsolateHeapUsage = int Function(Pointer<Void>);
+
+final DartGetMercuryIsolateHeapUsage _getMercuryIsolateHeapUsage = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeGetMercuryIsolateHeapUsage>>('getMercuryIsolateHeapUsage')
+    .asFunction();
+
+// Bytes allocated on behalf of the JS context. Only exact when the bridge is built with ENABLE_CONTEXT_HEAP, returns 0
+// otherwise.
+int getMercuryIsolateHeapUsage(int contextId) {
+  if (!_allocatedMercuryIsolates.containsKey(contextId)) {
+    return 0;
+  }
+  return _getMercuryIsolateHeapUsage(_allocatedMercuryIsolates[contextId]!);
+}
+
+typedef NativeGetInlineCacheStats = Pointer<NativeValue> Function(Pointer<Void>, Int8 reset);
+typedef DartGetInlineCacheStats = Pointer<NativeValue> Function(Pointer<Void>, int reset);
+
+final DartGetInlineCacheStats _getInlineCacheStats =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeGetInlineCacheStats>>('getInlineCacheStats').asFunction();
+
+// One line per property access site of the live JS functions of the context, with the state of its inline cache and
+// its hit and miss counts since the last reset.
+String getInlineCacheStats(int contextId, {bool reset = false}) {
+  MercuryController? controller = MercuryController.getControllerOfJSContextId(contextId);
+  if (controller == null || !_allocatedMercuryIsolates.containsKey(contextId)) {
+    return '';
+  }
+  Pointer<NativeValue> stats = _getInlineCacheStats(_allocatedMercuryIsolates[contextId]!, reset ? 1 : 0);
+  String result = fromNativeValue(controller.context, stats);
+  malloc.free(stats);
+  return result;
+}
+
+typedef NativeDispatchEventBatch = Int32 Function(
+    Pointer<Void>, Pointer<NativeEventDispatchRecord> records, Int32 count, Pointer<EventDispatchResult> results);
+typedef DartDispatchEventBatch = int Function(
+    Pointer<Void>, Pointer<NativeEventDispatchRecord> records, int count, Pointer<EventDispatchResult> results);
+
+final DartDispatchEventBatch _dispatchEventBatch =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeDispatchEventBatch>>('dispatchEventBatch').asFunction();
+
+// Dispatch events to their current targets in one FFI call. Unlike dispatching them one by one, microtasks queued by
+// the listeners run once after the whole batch.
+void dispatchEventBatch(int contextId, List<Event> events, {bool isCapture = false}) {
+  if (events.isEmpty || !_allocatedMercuryIsolates.containsKey(contextId)) {
+    return;
+  }
+
+  Pointer<NativeEventDispatchRecord> records = malloc.allocate(sizeOf<NativeEventDispatchRecord>() * events.length);
+  Pointer<EventDispatchResult> results = malloc.allocate(sizeOf<EventDispatchResult>() * events.length);
+  List<Pointer<RawEvent>> rawEvents = List.generate(events.length, (i) => events[i].toRaw().cast<RawEvent>());
+
+  for (int i = 0; i < events.length; i++) {
+    NativeEventDispatchRecord record = records.elementAt(i).ref;
+    record.target = events[i].currentTarget?.pointer ?? nullptr;
+    record.type = stringToNativeString(events[i].type);
+    record.rawEvent = rawEvents[i];
+    record.isCapture = isCapture ? 1 : 0;
+  }
+
+  int dispatched = _dispatchEventBatch(_allocatedMercuryIsolates[contextId]!, records, events.length, results);
+  // All the events of a batch share one wire. Nothing was dispatched if the context is no longer valid.
+  if (dispatched > 0) {
+    releaseDartWireLater(results.ref.wire);
+  }
+
+  for (int i = 0; i < events.length; i++) {
+    if (dispatched == 0) {
+      malloc.free(rawEvents[i]);
+      continue;
+    }
+
+    Event event = events[i];
+    EventDispatchResult result = results.elementAt(i).ref;
+    event.cancelable = result.canceled;
+    event.propagationStopped = result.propagationStopped;
+
+    Pointer<RawEvent> rawEvent = rawEvents[i];
+    event.sharedJSProps = Pointer.fromAddress(rawEvent.ref.bytes.elementAt(8).value);
+    event.propLen = rawEvent.ref.bytes.elementAt(9).value;
+    event.allocateLen = rawEvent.ref.bytes.elementAt(10).value;
+    malloc.free(rawEvent);
+  }
+
+  malloc.free(records);
+  malloc.free(results);
+}
+
+typedef NativeRegisterWidgetElementShapes = Int32 Function(Pointer<Void>, Pointer<Uint16> buffer, Int32 length);
+typedef DartRegisterWidgetElementShapes = int Function(Pointer<Void>, Pointer<Uint16> buffer, int length);
+
+final DartRegisterWidgetElementShapes _registerWidgetElementShapes = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeRegisterWidgetElementShapes>>('registerWidgetElementShapes')
+    .asFunction();
+
+typedef NativeSetBindingWriteCoalescing = Void Function(Pointer<Void>, Int8 enabled);
+typedef DartSetBindingWriteCoalescing = void Function(Pointer<Void>, int enabled);
+
+final DartSetBindingWriteCoalescing _setBindingWriteCoalescing = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeSetBindingWriteCoalescing>>('setBindingWriteCoalescing')
+    .asFunction();
+
+// Let native defer binding property writes into the isolate commands, so a run of writes reaches Dart in one flush.
+// Off by default: a deferred write reports success to JS right away, so exceptions thrown by the Dart setter and
+// its return value never reach the script. Only enable it for isolates whose setters cannot fail.
+void setBindingWriteCoalescing(int contextId, bool enabled) {
+  if (!_allocatedMercuryIsolates.containsKey(contextId)) return;
+  _setBindingWriteCoalescing(_allocatedMercuryIsolates[contextId]!, enabled ? 1 : 0);
+}
+
+void _packShapeName(List<int> buffer, String name) {
+  assert(name.length <= 0xFFFF);
+  buffer.add(name.length);
+  buffer.addAll(name.codeUnits);
+}
+
+void _packShapeNames(List<int> buffer, List<String> names) {
+  assert(names.length <= 0xFFFF);
+  buffer.add(names.length);
+  names.forEach((name) => _packShapeName(buffer, name));
+}
+
+// Send the shapes of binding objects to native in one packed UTF-16 buffer, so looking up their properties and methods
+// never has to wait for the first instance to sync them.
+void registerWidgetElementShapes(int contextId, Iterable<BindingObjectShape> shapes) {
+  if (shapes.isEmpty || !_allocatedMercuryIsolates.containsKey(contextId)) {
+    return;
+  }
+
+  List<int> packed = [];
+  for (BindingObjectShape shape in shapes) {
+    _packShapeName(packed, shape.className);
+    _packShapeNames(packed, shape.properties);
+    _packShapeNames(packed, shape.syncMethods);
+    _packShapeNames(packed, shape.asyncMethods);
+    _packShapeNames(packed, shape.cacheableProperties);
+  }
+
+  Pointer<Uint16> buffer = malloc.allocate(sizeOf<Uint16>() * packed.length);
+  buffer.asTypedList(packed.length).setAll(0, packed);
+  int registered = _registerWidgetElementShapes(_allocatedMercuryIsolates[contextId]!, buffer, packed.length);
+  assert(registered == shapes.length);
+  malloc.free(buffer);
+}
+
 typedef DartDispatchEvent = int Function(int contextId, Pointer<NativeBindingObject> nativeBindingObject,
     Pointer<NativeString> eventType, Pointer<Void> nativeEvent, int isCustomEvent);
 
@@ -236,6 +385,32 @@ void disposeMercuryIsolate(int contextId) {
   Pointer<Void> mercuryIsolate = _allocatedMercuryIsolates[contextId]!;
   _disposeMercuryIsolate(dartContext.pointer, mercuryIsolate);
   _allocatedMercuryIsolates.remove(contextId);
+  _scheduleDisposedIsolatesCollection();
+  if (_allocatedMercuryIsolates.isEmpty) {
+    closeNativeTaskPort(dartContext);
+  }
+}
+
+typedef NativeCollectDisposedMercuryIsolates = Int8 Function(Pointer<Void>, Int64 budgetInMicroseconds);
+typedef DartCollectDisposedMercuryIsolates = int Function(Pointer<Void>, int budgetInMicroseconds);
+
+final DartCollectDisposedMercuryIsolates _collectDisposedMercuryIsolates = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeCollectDisposedMercuryIsolates>>('collectDisposedMercuryIsolates')
+    .asFunction();
+
+// Disposed isolates are freed in small slices between other tasks, so that running isolates keep their frame budget.
+const int _disposedIsolatesCollectionBudget = 2000;
+bool _disposedIsolatesCollectionScheduled = false;
+
+void _scheduleDisposedIsolatesCollection() {
+  if (_disposedIsolatesCollectionScheduled) return;
+  _disposedIsolatesCollectionScheduled = true;
+  Timer.run(() {
+    _disposedIsolatesCollectionScheduled = false;
+    if (_collectDisposedMercuryIsolates(dartContext.pointer, _disposedIsolatesCollectionBudget) == 0) {
+      _scheduleDisposedIsolatesCollection();
+    }
+  });
 }
 
 typedef NativeNewMercuryIsolateId = Int64 Function();
@@ -244,7 +419,23 @@ typedef DartNewMercuryIsolateId = int Function();
 final DartNewMercuryIsolateId _newMercuryIsolateId = MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeNewMercuryIsolateId>>('newMercuryIsolateId').asFunction();
 
 int newMercuryIsolateId() {
-  return _newMercuryIsolateId();
+  int id = _newMercuryIsolateId();
+  if (id < 0) {
+    throw FlutterError('Failed to allocate a Mercury isolate id.');
+  }
+  return id;
+}
+
+typedef NativeReleaseMercuryIsolateId = Void Function(Int64);
+typedef DartReleaseMercuryIsolateId = void Function(int);
+
+final DartReleaseMercuryIsolateId _releaseMercuryIsolateId = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeReleaseMercuryIsolateId>>('releaseMercuryIsolateId')
+    .asFunction();
+
+// Give back an id from newMercuryIsolateId() when no isolate was allocated with it.
+void releaseMercuryIsolateId(int id) {
+  _releaseMercuryIsolateId(id);
 }
 
 typedef NativeAllocateNewMercuryIsolate = Pointer<Void> Function(Pointer<Void>, Int32);
@@ -257,6 +448,7 @@ void allocateNewMercuryIsolate(int targetContextId) {
   Pointer<Void> mercuryIsolate = _allocateNewMercuryIsolate(dartContext.pointer, targetContextId);
   assert(!_allocatedMercuryIsolates.containsKey(targetContextId));
   _allocatedMercuryIsolates[targetContextId] = mercuryIsolate;
+  openNativeTaskPort(dartContext);
 }
 
 typedef NativeInitDartDynamicLinking = Void Function(Pointer<Void> data);
@@ -279,6 +471,68 @@ void registerDartContextFinalizer(DartContext dartContext) {
   _registerDartContextFinalizer(dartContext, dartContext.pointer);
 }
 
+typedef NativeRegisterNativeTaskPort = Void Function(Pointer<Void> dartContext, Int64 port);
+typedef DartRegisterNativeTaskPort = void Function(Pointer<Void> dartContext, int port);
+
+final DartRegisterNativeTaskPort _registerNativeTaskPort =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeRegisterNativeTaskPort>>('registerNativeTaskPort').asFunction();
+
+typedef NativeFlushNativeTasks = Int32 Function(Pointer<Void> dartContext);
+typedef DartFlushNativeTasks = int Function(Pointer<Void> dartContext);
+
+final DartFlushNativeTasks _flushNativeTasks =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeFlushNativeTasks>>('flushNativeTasks').asFunction();
+
+// Native worker threads post to this port when they have finished work for the JS thread, such as reading a Blob. An
+// open port keeps the Dart isolate alive, so it is only open while Mercury isolates are allocated.
+void openNativeTaskPort(DartContext dartContext) {
+  if (dartContext.nativeTaskPort != null) return;
+  ReceivePort receivePort = ReceivePort();
+  receivePort.listen((_) {
+    _flushNativeTasks(dartContext.pointer);
+  });
+  dartContext.nativeTaskPort = receivePort;
+  _registerNativeTaskPort(dartContext.pointer, receivePort.sendPort.nativePort);
+  // Run the work finished while the port was closed.
+  _flushNativeTasks(dartContext.pointer);
+}
+
+void closeNativeTaskPort(DartContext dartContext) {
+  ReceivePort? receivePort = dartContext.nativeTaskPort;
+  if (receivePort == null) return;
+  // ILLEGAL_PORT, native threads stop posting to the port before it is closed.
+  _registerNativeTaskPort(dartContext.pointer, 0);
+  receivePort.close();
+  dartContext.nativeTaskPort = null;
+}
+
+typedef NativeReleaseDartWires = Void Function(Pointer<Void> dartContext, Pointer<Int64> wires, Int32 count);
+typedef DartReleaseDartWires = void Function(Pointer<Void> dartContext, Pointer<Int64> wires, int count);
+
+final DartReleaseDartWires _releaseDartWires =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeReleaseDartWires>>('releaseDartWires').asFunction();
+
+List<int> _pendingDartWires = [];
+
+// The native side keeps the JS object of every event dispatched from Dart alive until its wire is released. Wires of
+// the current task are released together in one call once the task is done with its events.
+void releaseDartWireLater(int wire) {
+  if (wire == 0) return;
+  if (_pendingDartWires.isEmpty) {
+    scheduleMicrotask(_flushDartWires);
+  }
+  _pendingDartWires.add(wire);
+}
+
+void _flushDartWires() {
+  List<int> wires = _pendingDartWires;
+  _pendingDartWires = [];
+  Pointer<Int64> nativeWires = malloc.allocate(sizeOf<Int64>() * wires.length);
+  nativeWires.asTypedList(wires.length).setAll(0, wires);
+  _releaseDartWires(dartContext.pointer, nativeWires, wires.length);
+  malloc.free(nativeWires);
+}
+
 typedef NativeRegisterPluginByteCode = Void Function(Pointer<Uint8> bytes, Int32 length, Pointer<Utf8> pluginName);
 typedef DartRegisterPluginByteCode = void Function(Pointer<Uint8> bytes, int length, Pointer<Utf8> pluginName);
 
@@ -307,6 +561,7 @@ enum IsolateCommandType {
   disposeBindingObject,
   addEvent,
   removeEvent,
+  setProperty,
 }
 
 class IsolateCommandItem extends Struct {
@@ -430,6 +685,7 @@ void flushIsolateCommandWithContextId(int contextId) {
 
 void flushIsolateCommand(MercuryContextController context) {
   assert(_allocatedMercuryIsolates.containsKey(context.contextId));
+  // Fetching the items compacts the buffer, so read the length afterwards.
   Pointer<Uint64> nativeCommandItems = _getIsolateCommandItems(_allocatedMercuryIsolates[context.contextId]!);
   int commandLength = _getIsolateCommandItemSize(_allocatedMercuryIsolates[context.contextId]!);
 
@@ -464,6 +720,12 @@ void flushIsolateCommand(MercuryContextController context) {
           bool isCapture = command.nativePtr2.address == 1;
           context.removeEvent(nativePtr.cast<NativeBindingObject>(), command.args, isCapture: isCapture);
           break;
+        case IsolateCommandType.setProperty:
+          Pointer<NativeValue> nativeValue = command.nativePtr2.cast<NativeValue>();
+          context.setBindingProperty(
+              nativePtr.cast<NativeBindingObject>(), command.args, fromNativeValue(context, nativeValue));
+          malloc.free(nativeValue);
+          break;
         default:
           break;
       }
@@ -27,10 +27,14 @@ typedef BindingMethodCallback = dynamic Function(List args);
 typedef AsyncBindingMethodCallback = Future<dynamic> Function(List args);
 
 class BindingObjectProperty {
-  BindingObjectProperty({required this.getter, this.setter});
+  BindingObjectProperty({required this.getter, this.setter, this.cacheable = false});
 
   final BindingPropertyGetter getter;
   final BindingPropertySetter? setter;
+
+  // Native keeps the value read last and serves reads from it. The owner must call
+  // [BindingObject.invalidateProperties] whenever the value changes.
+  final bool cacheable;
 }
 
 abstract class BindingObjectMethod {
@@ -52,10 +56,34 @@ class AsyncBindingObjectMethod extends BindingObjectMethod {
   final AsyncBindingMethodCallback call;
 }
 
+// The properties and methods of a kind of BindingObject, keyed by the class name of its native counterpart. Registered
+// shapes are sent to native in one call when a context is created, before any instance exists.
+class BindingObjectShape {
+  const BindingObjectShape(this.className,
+      {this.properties = const [],
+      this.syncMethods = const [],
+      this.asyncMethods = const [],
+      this.cacheableProperties = const []});
+
+  final String className;
+  final List<String> properties;
+  final List<String> syncMethods;
+  final List<String> asyncMethods;
+  // The subset of [properties] whose values native may cache until they are invalidated.
+  final List<String> cacheableProperties;
+}
+
 abstract class BindingObject<T> extends Iterable<T> {
   static BindingObjectOperation? bind;
   static BindingObjectOperation? unbind;
 
+  static final Map<String, BindingObjectShape> _registeredShapes = {};
+  static Iterable<BindingObjectShape> get registeredShapes => _registeredShapes.values;
+
+  static void registerShape(BindingObjectShape shape) {
+    _registeredShapes[shape.className] = shape;
+  }
+
   // To make sure same kind of WidgetElement only sync once.
   static final Map<Type, bool> _alreadySyncClasses = {};
 
@@ -85,6 +113,7 @@ abstract class BindingObject<T> extends Iterable<T> {
     if (pointer!.ref.invokeBindingMethodFromDart == nullptr) return false;
 
     List<String> properties = _properties.keys.toList(growable: false);
+    List<String> cacheableProperties = properties.where((key) => _properties[key]!.cacheable).toList(growable: false);
     List<String> syncMethods = [];
     List<String> asyncMethods = [];
 
@@ -96,21 +125,41 @@ abstract class BindingObject<T> extends Iterable<T> {
       }
     });
 
-    Pointer<NativeValue> arguments = malloc.allocate(sizeOf<NativeValue>() * 3);
+    Pointer<NativeValue> arguments = malloc.allocate(sizeOf<NativeValue>() * 4);
     toNativeValue(arguments.elementAt(0), properties);
     toNativeValue(arguments.elementAt(1), syncMethods);
     toNativeValue(arguments.elementAt(2), asyncMethods);
+    toNativeValue(arguments.elementAt(3), cacheableProperties);
 
     DartInvokeBindingMethodsFromDart f = pointer!.ref.invokeBindingMethodFromDart.asFunction();
     Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
 
     Pointer<NativeValue> method = malloc.allocate(sizeOf<NativeValue>());
     toNativeValue(method, 'syncPropertiesAndMethods');
-    f(pointer!, returnValue, method, 3, arguments, {});
+    f(pointer!, returnValue, method, 4, arguments, {});
     malloc.free(arguments);
     return fromNativeValue(ownerContext, returnValue) == true;
   }
 
+  // Tell native the values of cacheable properties changed, so the next reads come back to Dart. Every cached value of
+  // this object is dropped when [keys] is null.
+  void invalidateProperties([List<String>? keys]) {
+    if (pointer == null || pointer!.ref.disposed || pointer!.ref.invokeBindingMethodFromDart == nullptr) return;
+
+    Pointer<NativeValue> arguments = malloc.allocate(sizeOf<NativeValue>());
+    toNativeValue(arguments, keys);
+
+    DartInvokeBindingMethodsFromDart f = pointer!.ref.invokeBindingMethodFromDart.asFunction();
+    Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
+
+    Pointer<NativeValue> method = malloc.allocate(sizeOf<NativeValue>());
+    toNativeValue(method, 'invalidatePropertyCache');
+    f(pointer!, returnValue, method, 1, arguments, {});
+    malloc.free(arguments);
+    malloc.free(method);
+    malloc.free(returnValue);
+  }
+
   final SplayTreeMap<String, BindingObjectProperty> _properties = SplayTreeMap();
   final SplayTreeMap<String, BindingObjectMethod> _methods = SplayTreeMap();
 
@@ -236,6 +285,24 @@ dynamic setterBindingCall(BindingObject bindingObject, List<dynamic> args) {
   return true;
 }
 
+// Read many properties in one call from native. Keys without a property read as null.
+dynamic getPropertiesBindingCall(BindingObject bindingObject, List<dynamic> args) {
+  Stopwatch? stopwatch;
+  if (isEnabledLog) {
+    stopwatch = Stopwatch()..start();
+  }
+
+  List<dynamic> result = List.generate(args.length, (i) {
+    BindingObjectProperty? property = bindingObject._properties[args[i]];
+    return property?.getter();
+  });
+
+  if (isEnabledLog) {
+    print('$bindingObject getBindingProperties keys: $args result: $result time: ${stopwatch!.elapsedMicroseconds}us');
+  }
+  return result;
+}
+
 dynamic getPropertyNamesBindingCall(BindingObject bindingObject, List<dynamic> args) {
   List<String> properties = bindingObject._properties.keys.toList();
   List<String> methods = bindingObject._methods.keys.toList();
@@ -13,6 +13,10 @@ class Global extends EventTarget {
   Global(BindingContext? context)
       : super(context);
 
+  // Global defines no properties or methods in Dart. Registering its empty shape spares the first global variable
+  // lookup a flush of the isolate commands to find that out.
+  static const BindingObjectShape shape = BindingObjectShape('globalThis');
+
   @override
   EventTarget? get parentEventTarget => null;
 
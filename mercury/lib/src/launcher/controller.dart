@@ -200,6 +200,15 @@ class MercuryContextController {
     }
   }
 
+  // Apply a property write native deferred into the isolate commands.
+  void setBindingProperty(Pointer<NativeBindingObject> nativePtr, String key, dynamic value) {
+    if (!hasBindingObject(nativePtr)) return;
+    BindingObject? bindingObject = getBindingObject<BindingObject>(nativePtr);
+    if (bindingObject != null) {
+      setterBindingCall(bindingObject, [key, value]);
+    }
+  }
+
   // Call from JS Bridge when the BindingObject class on the JS side had been Garbage collected.
   void disposeBindingObject(MercuryContextController context, Pointer<NativeBindingObject> pointer) async {
     BindingObject? bindingObject = getBindingObject(pointer);